@@ -0,0 +1,466 @@
+// Microbenchmarks of the hot paths, on Google Benchmark.
+//
+//   poly-bench [--capture=PATH] [--benchmark_filter=...] [--benchmark_out=FILE --benchmark_out_format=json]
+//
+// `cmake --build build --target bench` runs everything and writes
+// build/poly-bench.json. The results can be diffed between releases.
+// --capture adds BM_ParseRecordedFrames over the market frames of a
+// --capture directory or segment.
+//
+// operator new is replaced with a counting one, and the market-data
+// benchmarks report heap allocations per iteration as "allocs". Once warm,
+// the ingest path (frame -> parser -> pipeline -> book -> strategy) must
+// read 0.
+
+#include "api_server.hpp"
+#include "async_writer.hpp"
+#include "dump_detector.hpp"
+#include "frame_capture.hpp"
+#include "logger.hpp"
+#include "market_pipeline.hpp"
+#include "token_registry.hpp"
+#include "trading_engine.hpp"
+#include "websocket_client.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============ ALLOCATION COUNTER ============
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+
+void* counted_alloc(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* counted_alloc(std::size_t size, std::align_val_t align) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto alignment = static_cast<std::size_t>(align);
+    // aligned_alloc wants a multiple of the alignment
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void* p = std::aligned_alloc(alignment, rounded)) return p;
+    throw std::bad_alloc();
+}
+} // namespace
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return counted_alloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return counted_alloc(size, align); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+using namespace poly;
+
+// Allocations from construction to report(), per iteration - start it
+// right before the timed loop, after any warm-up
+class AllocationCount {
+public:
+    AllocationCount() : start_(g_allocations.load(std::memory_order_relaxed)) {}
+
+    void report(benchmark::State& state) const {
+        const auto count = g_allocations.load(std::memory_order_relaxed) - start_;
+        state.counters["allocs"] = benchmark::Counter(static_cast<double>(count), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    uint64_t start_;
+};
+
+using namespace poly;
+
+// A market whose window opened 10s before the engine's clock: every book
+// update is evaluated, but the prices stay clear of the entry threshold so
+// nothing trades and the state is the same for every iteration
+constexpr int64_t kWindowStart = 1700000000;
+const std::string kSlug = "btc-updown-15m-" + std::to_string(kWindowStart);
+const std::string kUpToken = "bench-up";
+const std::string kDownToken = "bench-down";
+
+std::chrono::system_clock::time_point bench_now() {
+    return std::chrono::system_clock::time_point(std::chrono::seconds(kWindowStart + 10));
+}
+
+std::string book_frame(const std::string& token, double best_bid, double best_ask, int depth) {
+    std::string frame = "{\"event_type\":\"book\",\"asset_id\":\"" + token + "\",\"market\":\"0xbench\",\"bids\":[";
+    char level[64];
+    for (int i = 0; i < depth; ++i) {
+        std::snprintf(level, sizeof(level), "%s{\"price\":\"%.2f\",\"size\":\"%d\"}", i ? "," : "", best_bid - 0.01 * i,
+                      100 + 10 * i);
+        frame += level;
+    }
+    frame += "],\"asks\":[";
+    for (int i = 0; i < depth; ++i) {
+        std::snprintf(level, sizeof(level), "%s{\"price\":\"%.2f\",\"size\":\"%d\"}", i ? "," : "", best_ask + 0.01 * i,
+                      100 + 10 * i);
+        frame += level;
+    }
+    frame += "],\"timestamp\":\"1700000010000\",\"hash\":\"0xabc\"}";
+    return frame;
+}
+
+// best_bid / best_ask: the book's top after the change, as the feed reports it
+std::string price_change_frame(const std::string& token, double price, int size, double best_bid, double best_ask) {
+    char frame[320];
+    std::snprintf(frame, sizeof(frame),
+                  "{\"market\":\"0xbench\",\"price_changes\":[{\"asset_id\":\"%s\",\"price\":\"%.2f\",\"size\":\"%d\","
+                  "\"side\":\"SELL\",\"hash\":\"0xdef\",\"best_bid\":\"%.2f\",\"best_ask\":\"%.2f\"}],"
+                  "\"timestamp\":\"1700000010000\",\"event_type\":\"price_change\"}",
+                  token.c_str(), price, size, best_bid, best_ask);
+    return frame;
+}
+
+OrderbookSnapshot book_snapshot(double best_bid, double best_ask, int depth) {
+    OrderbookSnapshot snapshot;
+    for (int i = 0; i < depth; ++i) {
+        snapshot.bids.push_back(BookLevel{Price::from_double(best_bid - 0.01 * i), Qty::from_units(100 + 10 * i)});
+        snapshot.asks.push_back(BookLevel{Price::from_double(best_ask + 0.01 * i), Qty::from_units(100 + 10 * i)});
+    }
+    snapshot.timestamp = bench_now();
+    return snapshot;
+}
+
+// Paper engine on the bench market, no threads
+struct InlineEngine {
+    TradingEngine engine{Config{}};
+
+    InlineEngine() {
+        engine.set_clock(bench_now);
+        engine.start_inline();
+        engine.set_market(kSlug, kUpToken, kDownToken);
+    }
+    ~InlineEngine() { engine.stop(); }
+};
+
+// Frames in, callbacks counted
+struct ParseHarness {
+    WebSocketPriceStream stream;  // Never started - frames are injected
+    size_t books = 0;
+    size_t deltas = 0;
+
+    ParseHarness() {
+        TokenRegistry::instance().intern(kUpToken);
+        TokenRegistry::instance().intern(kDownToken);
+        stream.set_orderbook_callback([this](const OrderbookUpdate&) { ++books; });
+        stream.set_book_delta_callback([this](const BookDelta&) { ++deltas; });
+    }
+};
+
+// ============ MESSAGE PARSING ============
+
+void BM_ParseBookFrame(benchmark::State& state) {
+    ParseHarness harness;
+    const std::string frame = book_frame(kUpToken, 0.44, 0.46, static_cast<int>(state.range(0)));
+    harness.stream.inject(frame, 0);
+    AllocationCount allocs;
+    for (auto _ : state) harness.stream.inject(frame, 0);
+    allocs.report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+    state.counters["books"] = static_cast<double>(harness.books);
+}
+BENCHMARK(BM_ParseBookFrame)->Arg(5)->Arg(20)->Arg(100);
+
+void BM_ParsePriceChangeFrame(benchmark::State& state) {
+    ParseHarness harness;
+    const std::string frame = price_change_frame(kUpToken, 0.46, 250, 0.44, 0.46);
+    harness.stream.inject(frame, 0);
+    AllocationCount allocs;
+    for (auto _ : state) harness.stream.inject(frame, 0);
+    allocs.report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+}
+BENCHMARK(BM_ParsePriceChangeFrame);
+
+// Frames of a capture, loaded by main() from --capture
+std::vector<std::string> g_recorded_frames;
+
+void BM_ParseRecordedFrames(benchmark::State& state) {
+    ParseHarness harness;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        for (const auto& frame : g_recorded_frames) {
+            harness.stream.inject(frame, 0);
+            bytes += frame.size();
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * g_recorded_frames.size()));
+}
+
+// ============ BOOK UPDATE + STRATEGY ============
+
+void BM_OrderbookUpdate(benchmark::State& state) {
+    InlineEngine bench;
+    const TokenId up = TokenRegistry::instance().intern(kUpToken);
+    const int depth = static_cast<int>(state.range(0));
+    // Two books in turn, so every update moves the top of book
+    const OrderbookSnapshot books[2] = {book_snapshot(0.44, 0.46, depth), book_snapshot(0.45, 0.47, depth)};
+    size_t i = 0;
+    AllocationCount allocs;
+    for (auto _ : state) bench.engine.on_orderbook_update(up, books[i++ & 1]);
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_OrderbookUpdate)->Arg(5)->Arg(20)->Arg(100);
+
+void BM_BookDeltaBatch(benchmark::State& state) {
+    InlineEngine bench;
+    const TokenId up = TokenRegistry::instance().intern(kUpToken);
+    bench.engine.on_orderbook_update(up, book_snapshot(0.44, 0.46, 20));
+
+    // Size changes at three ask levels, alternating so each one applies
+    std::vector<BookDelta> batches[2];
+    for (int b = 0; b < 2; ++b) {
+        for (int level = 0; level < 3; ++level) {
+            BookDelta delta;
+            delta.token = up;
+            delta.side = BookSide::ASK;
+            delta.price = Price::from_double(0.46 + 0.01 * level);
+            delta.size = Qty::from_units(100 + 25 * b + level);
+            batches[b].push_back(delta);
+        }
+    }
+    size_t i = 0;
+    bench.engine.on_book_deltas(batches[1].data(), batches[1].size());
+    AllocationCount allocs;
+    for (auto _ : state) {
+        const auto& batch = batches[i++ & 1];
+        bench.engine.on_book_deltas(batch.data(), batch.size());
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_BookDeltaBatch);
+
+// ============ INGEST (FRAME -> BOOK -> STRATEGY) ============
+
+// Book frames and level changes in turn, so the books and the strategy
+// see a change on every frame
+std::vector<std::string> ingest_frames(int depth) {
+    return {book_frame(kUpToken, 0.44, 0.46, depth), price_change_frame(kUpToken, 0.47, 250, 0.44, 0.46),
+            book_frame(kUpToken, 0.45, 0.47, depth), price_change_frame(kUpToken, 0.48, 300, 0.45, 0.47)};
+}
+
+// Parser straight into the engine, on the calling thread
+void BM_IngestFrames(benchmark::State& state) {
+    InlineEngine bench;
+    WebSocketPriceStream stream;
+    stream.set_orderbook_callback([&](const OrderbookUpdate& update) { bench.engine.on_orderbook_update(update); });
+    stream.set_book_delta_callback([&](const BookDelta& delta) { bench.engine.on_book_delta(delta); });
+    const auto frames = ingest_frames(static_cast<int>(state.range(0)));
+    for (const auto& frame : frames) stream.inject(frame, 0);
+
+    size_t i = 0;
+    AllocationCount allocs;
+    for (auto _ : state) stream.inject(frames[i++ & 3], 0);
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_IngestFrames)->Arg(5)->Arg(20)->Arg(100);
+
+// The live path: parser on this thread, books and strategy on the
+// pipeline's consumer thread. Allocations are counted until the consumer
+// has applied everything, so its side is included.
+void BM_PipelineIngest(benchmark::State& state) {
+    InlineEngine bench;
+    const TokenId sentinel = TokenRegistry::instance().intern("bench-sentinel");
+    std::atomic<int64_t> marker_seen{0};
+    int64_t marker_sent = 0;
+
+    auto pipeline = std::make_unique<MarketDataPipeline>();
+    pipeline->set_name("bench-pipeline");
+    pipeline->set_snapshot_handler([&](const OrderbookUpdate& update) { bench.engine.on_orderbook_update(update); });
+    pipeline->set_delta_handler([&](const BookDelta* deltas, size_t count) {
+        bench.engine.on_book_deltas(deltas, count);
+        const BookDelta& last = deltas[count - 1];
+        if (last.token == sentinel) marker_seen.store(last.size.micros(), std::memory_order_release);
+    });
+    // A numbered level change on a token the engine doesn't trade marks the
+    // end of the queue; re-sent if the ring was full
+    auto drain = [&] {
+        BookDelta marker;
+        marker.token = sentinel;
+        marker.size = Qty::from_micros(++marker_sent);
+        while (marker_seen.load(std::memory_order_acquire) < marker_sent) {
+            if (pipeline->stats().queue_depth == 0) pipeline->publish_delta(marker);
+            std::this_thread::yield();
+        }
+    };
+
+    WebSocketPriceStream stream;
+    stream.set_orderbook_callback([&](const OrderbookUpdate& update) { pipeline->publish_book(update); });
+    stream.set_book_delta_callback([&](const BookDelta& delta) { pipeline->publish_delta(delta); });
+    pipeline->start();
+    // Warm-up: enough books to size all three of the token's buffers
+    const auto frames = ingest_frames(20);
+    for (int round = 0; round < 4; ++round) {
+        for (const auto& frame : frames) stream.inject(frame, 0);
+    }
+    drain();
+
+    size_t i = 0;
+    AllocationCount allocs;
+    for (auto _ : state) stream.inject(frames[i++ & 3], 0);
+    drain();
+    allocs.report(state);
+    pipeline->stop();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["conflated"] = static_cast<double>(pipeline->stats().snapshots_conflated);
+}
+BENCHMARK(BM_PipelineIngest)->UseRealTime();
+
+// ============ STATUS ============
+
+void BM_GetStatus(benchmark::State& state) {
+    InlineEngine bench;
+    const TokenId up = TokenRegistry::instance().intern(kUpToken);
+    const TokenId down = TokenRegistry::instance().intern(kDownToken);
+    bench.engine.on_orderbook_update(up, book_snapshot(0.44, 0.46, 20));
+    bench.engine.on_orderbook_update(down, book_snapshot(0.52, 0.54, 20));
+    for (auto _ : state) benchmark::DoNotOptimize(bench.engine.get_status());
+}
+BENCHMARK(BM_GetStatus);
+
+void BM_StatusJson(benchmark::State& state) {
+    InlineEngine bench;
+    const TokenId up = TokenRegistry::instance().intern(kUpToken);
+    const TokenId down = TokenRegistry::instance().intern(kDownToken);
+    bench.engine.on_orderbook_update(up, book_snapshot(0.44, 0.46, 20));
+    bench.engine.on_orderbook_update(down, book_snapshot(0.52, 0.54, 20));
+    set_engine_ptr(&bench.engine);
+    for (auto _ : state) benchmark::DoNotOptimize(get_status_json());
+    set_engine_ptr(nullptr);
+}
+BENCHMARK(BM_StatusJson);
+
+// ============ DUMP DETECTOR ============
+
+// A random walk around 0.45 in 1ms steps
+std::vector<Price> walk(size_t n) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> step(-2, 2);
+    std::vector<Price> prices;
+    int ticks = 450;
+    for (size_t i = 0; i < n; ++i) {
+        ticks = std::max(10, std::min(990, ticks + step(rng)));
+        prices.push_back(Price::from_micros(ticks * 1000));
+    }
+    return prices;
+}
+
+void BM_DumpAddPrice(benchmark::State& state) {
+    DumpDetector detector;
+    const auto prices = walk(1 << 16);
+    int64_t now_ms = 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        detector.add_price(i & 1 ? Side::DOWN : Side::UP, prices[i & (prices.size() - 1)], now_ms++);
+        ++i;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_DumpAddPrice);
+
+void BM_DumpDetect(benchmark::State& state) {
+    DumpDetector detector;
+    const auto prices = walk(60000);
+    int64_t now_ms = 0;
+    for (const Price& price : prices) {
+        detector.add_price(Side::UP, price, now_ms);
+        detector.add_price(Side::DOWN, Price::from_units(1) - price, now_ms);
+        ++now_ms;
+    }
+    for (auto _ : state) benchmark::DoNotOptimize(detector.detect_dump(0.15, now_ms));
+}
+BENCHMARK(BM_DumpDetect);
+
+// ============ TRADE WRITER ============
+
+void BM_QueueTrade(benchmark::State& state) {
+    // Never started and nothing connected: measures the producer side only.
+    // The ring is swapped for an empty one (untimed) before it fills.
+    Database db("");
+    AsyncTradeWriter::Options options;
+    options.capacity = 1 << 16;
+    auto writer = std::make_unique<AsyncTradeWriter>(db, options);
+    size_t queued = 0;
+    for (auto _ : state) {
+        if (queued == options.capacity) {
+            state.PauseTiming();
+            writer = std::make_unique<AsyncTradeWriter>(db, options);
+            queued = 0;
+            state.ResumeTiming();
+        }
+        writer->queue_trade(PackedTrade::pack("paper_1700000010000000000", kSlug, 1, "UP", kUpToken, 10.0, 0.45,
+                                              4.5, 0.0, kWindowStart + 10));
+        ++queued;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_QueueTrade);
+
+bool load_recorded_frames(const std::string& path) {
+    CaptureReader reader;
+    std::string error;
+    if (!reader.open(path, error)) {
+        std::fprintf(stderr, "poly-bench: %s\n", error.c_str());
+        return false;
+    }
+    CaptureRecord record;
+    while (reader.next(record)) {
+        if (record.kind == CaptureKind::FRAME) g_recorded_frames.emplace_back(record.payload);
+        // The capture's own token ids, so its frames resolve
+        if (record.kind == CaptureKind::MARKET) {
+            MarketInfo market;
+            if (parse_market_record(record.payload, market)) {
+                TokenRegistry::instance().intern(market.up_token);
+                TokenRegistry::instance().intern(market.down_token);
+            }
+        }
+    }
+    std::fprintf(stderr, "poly-bench: %zu recorded frames from %s\n", g_recorded_frames.size(), path.c_str());
+    return !g_recorded_frames.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Logger::instance().set_level(LogLevel::WARN);
+
+    // Ours out, the rest to Google Benchmark
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--capture=", 0) == 0) {
+            if (!load_recorded_frames(arg.substr(10))) return 1;
+            benchmark::RegisterBenchmark("BM_ParseRecordedFrames", BM_ParseRecordedFrames);
+            continue;
+        }
+        args.push_back(argv[i]);
+    }
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
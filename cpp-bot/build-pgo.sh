@@ -0,0 +1,59 @@
+#!/bin/bash
+set -e
+
+# Profile-guided Release-Native build, trained on captured market data:
+#   1. instrumented build (preset pgo-generate)
+#   2. replay + backtest the captures to record where time goes
+#   3. optimised rebuild from that profile (preset pgo-use)
+#
+# Usage: ./build-pgo.sh CAPTURE_DIR [cmake -D options...]
+# CAPTURE_DIR is a --capture directory; the options go to both configures.
+# The result is build/poly-trader-cpp, like build.sh.
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NC='\033[0m'
+
+log_info() { echo -e "${GREEN}[INFO]${NC} $1"; }
+log_error() { echo -e "${RED}[ERROR]${NC} $1"; }
+
+CAPTURES="$1"
+shift || true
+if [ -z "$CAPTURES" ] || [ ! -d "$CAPTURES" ]; then
+    log_error "Usage: $0 CAPTURE_DIR (record one with poly-trader-cpp --capture=DIR)"
+    exit 1
+fi
+CAPTURES="$(cd "$CAPTURES" && pwd)"
+
+cd "$(dirname "$0")"
+JOBS=$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 4)
+PROFILES="$(pwd)/pgo-profiles"
+
+# ─── Stage 1: instrumented build ────────────────────────────────────
+
+log_info "Stage 1/3: instrumented build..."
+rm -rf "$PROFILES"
+cmake --preset pgo-generate -DPOLY_PGO_DIR="$PROFILES" "$@"
+cmake --build --preset pgo-generate -j"$JOBS"
+
+# ─── Stage 2: training runs ─────────────────────────────────────────
+
+# The replay drives the parser, books, strategy and paper orders as the
+# live feed would; the backtest sweeps the strategy over the same windows
+log_info "Stage 2/3: training on $CAPTURES..."
+./build/poly-trader-cpp --replay="$CAPTURES" --replay-speed=0 --log-level=warn
+./build/poly-backtest --data="$CAPTURES" --threads=1 > /dev/null
+
+if ls "$PROFILES"/*.profraw > /dev/null 2>&1; then
+    # Clang writes raw profiles; the rebuild reads one merged file
+    log_info "Merging Clang profiles..."
+    llvm-profdata merge -output="$PROFILES/default.profdata" "$PROFILES"/*.profraw
+fi
+
+# ─── Stage 3: optimised rebuild ─────────────────────────────────────
+
+log_info "Stage 3/3: optimised rebuild..."
+cmake --preset pgo-use -DPOLY_PGO_DIR="$PROFILES" "$@"
+cmake --build --preset pgo-use -j"$JOBS"
+
+log_info "✓ PGO build complete: build/poly-trader-cpp"
@@ -38,7 +38,7 @@ if [[ "$OSTYPE" == "darwin"* ]]; then
     fi
     
     log_info "Installing dependencies via Homebrew..."
-    brew install boost openssl nlohmann-json libpq curl || true
+    brew install boost openssl nlohmann-json libpq curl zlib || true
     
 elif [[ "$OSTYPE" == "linux-gnu"* ]]; then
     log_info "Detected Linux"
@@ -52,7 +52,8 @@ elif [[ "$OSTYPE" == "linux-gnu"* ]]; then
         libssl-dev \
         nlohmann-json3-dev \
         libpq-dev \
-        libcurl4-openssl-dev
+        libcurl4-openssl-dev \
+        zlib1g-dev
 fi
 
 # Create build directory
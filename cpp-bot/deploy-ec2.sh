@@ -42,6 +42,7 @@ sudo dnf install -y \
     openssl-devel \
     boost-devel \
     libpq-devel \
+    zlib-devel \
     git \
     python3 \
     python3-pip \
@@ -182,15 +183,19 @@ if [ -d "../src" ]; then
     cp ../src/main.cpp src/ 2>/dev/null || true
 fi
 
-# Create build directory
-mkdir -p build
-cd build
-
-# Configure with CMake
-cmake ..
-
-# Build
-make -j$(nproc)
+# Release-Native, tuned for this instance (-march=native, LTO). With
+# PGO_CAPTURES pointing at a --capture directory, profile-guided on top.
+# POLY_ALLOCATOR=mimalloc|jemalloc swaps malloc when the library is installed.
+if [ -n "$POLY_ALLOCATOR" ]; then
+    ALLOCATOR_FLAG="-DPOLY_ALLOCATOR=$POLY_ALLOCATOR"
+fi
+if [ -n "$PGO_CAPTURES" ] && [ -d "$PGO_CAPTURES" ]; then
+    log_info "Profile-guided build, trained on $PGO_CAPTURES..."
+    ./build-pgo.sh "$PGO_CAPTURES" $ALLOCATOR_FLAG
+else
+    cmake --preset release-native $ALLOCATOR_FLAG
+    cmake --build --preset release-native -j$(nproc)
+fi
 
 log_info "✓ C++ bot built successfully"
 
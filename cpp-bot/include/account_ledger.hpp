@@ -0,0 +1,73 @@
+#pragma once
+
+#include "fixed_point.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace poly {
+
+// Cash and risk accounting shared by every engine shard.
+//
+// Amounts are kept in micro-USDC in plain atomics, so shards book trades
+// without taking a lock and readers (status, dashboard) never block
+// them. Bookings take fixed-point amounts (Price), so they add up exactly;
+// reads come back as doubles for display. Entries reserve cash with a CAS loop - two shards can't both
+// spend the last dollar.
+class AccountLedger {
+public:
+    explicit AccountLedger(double cash = 0.0) : cash_(Price::from_double(cash).micros()) {}
+
+    AccountLedger(const AccountLedger&) = delete;
+    AccountLedger& operator=(const AccountLedger&) = delete;
+
+    double cash() const { return from_micros(cash_.load(std::memory_order_relaxed)); }
+    double realized_pnl() const { return from_micros(realized_pnl_.load(std::memory_order_relaxed)); }
+    double open_exposure() const { return from_micros(open_exposure_.load(std::memory_order_relaxed)); }
+    uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+    // Take `amount` out of cash unless that would overdraw it
+    bool try_debit(Price amount) {
+        int64_t delta = amount.micros();
+        int64_t current = cash_.load(std::memory_order_relaxed);
+        do {
+            if (current < delta) {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!cash_.compare_exchange_weak(current, current - delta, std::memory_order_relaxed));
+        return true;
+    }
+
+    void debit(Price amount) { cash_.fetch_sub(amount.micros(), std::memory_order_relaxed); }
+    void credit(Price amount) { cash_.fetch_add(amount.micros(), std::memory_order_relaxed); }
+    void add_realized(Price pnl) { realized_pnl_.fetch_add(pnl.micros(), std::memory_order_relaxed); }
+    void add_exposure(Price cost) { open_exposure_.fetch_add(cost.micros(), std::memory_order_relaxed); }
+
+    // Balance sync / paper reset
+    void set_cash(double amount) { cash_.store(Price::from_double(amount).micros(), std::memory_order_relaxed); }
+    void reset(double cash) {
+        cash_.store(Price::from_double(cash).micros(), std::memory_order_relaxed);
+        realized_pnl_.store(0, std::memory_order_relaxed);
+        open_exposure_.store(0, std::memory_order_relaxed);
+        rejected_.store(0, std::memory_order_relaxed);
+    }
+    // Warm restart: the books as the last run left them
+    void restore(Price cash, Price realized, Price exposure) {
+        cash_.store(cash.micros(), std::memory_order_relaxed);
+        realized_pnl_.store(realized.micros(), std::memory_order_relaxed);
+        open_exposure_.store(exposure.micros(), std::memory_order_relaxed);
+    }
+    int64_t cash_micros() const { return cash_.load(std::memory_order_relaxed); }
+    int64_t realized_micros() const { return realized_pnl_.load(std::memory_order_relaxed); }
+    int64_t exposure_micros() const { return open_exposure_.load(std::memory_order_relaxed); }
+
+private:
+    static double from_micros(int64_t micros) { return Price::from_micros(micros).to_double(); }
+
+    std::atomic<int64_t> cash_;
+    std::atomic<int64_t> realized_pnl_{0};
+    std::atomic<int64_t> open_exposure_{0};  // Cost of open (unhedged) legs
+    std::atomic<uint64_t> rejected_{0};      // Entries refused for lack of cash
+};
+
+} // namespace poly
@@ -2,13 +2,14 @@
 
 #include "trading_engine.hpp"
 #include "database.hpp"
-#include <thread>
-#include <atomic>
+#include "http_server.hpp"
+#include <memory>
 #include <string>
 #include <nlohmann/json.hpp>
 
 namespace poly {
 
+// REST API for the dashboard, served by an HttpServer on the shared IoPool
 class APIServer {
 public:
     APIServer(TradingEngine& engine, Database& db, int port);
@@ -18,14 +19,12 @@ public:
     void stop();
     
 private:
-    void run();
+    void register_routes();
     
     TradingEngine& engine_;
     Database& db_;
     int port_;
-    std::atomic<bool> running_;
-    std::thread server_thread_;
-    int server_socket_;
+    std::unique_ptr<HttpServer> http_;
 };
 
 // Global functions for cross-module communication
@@ -34,6 +33,24 @@ void set_live_prices(double up_price, double down_price);
 void set_market_info(const std::string& slug, const std::string& question);
 void set_engine_ptr(TradingEngine* engine);
 TradingEngine* get_engine_ptr();
+// Trade writer behind /api/db (nullptr: none)
+void set_trade_writer_ptr(class AsyncTradeWriter* writer);
+// Shadow strategies behind /api/shadow (nullptr: none)
+void set_shadow_fleet_ptr(class ShadowFleet* fleet);
+// Market stream whose connects /api/network reports (nullptr: none)
+void set_market_stream_ptr(class WebSocketPriceStream* stream);
+// Tick store behind /api/ticks and /api/equity (nullptr: none)
+void set_tick_recorder_ptr(class TickRecorder* recorder);
+// Warm-restart checkpointer behind /api/snapshot (nullptr: none)
+void set_checkpointer_ptr(class EngineCheckpointer* checkpointer);
 
 std::string get_status_json();
+
+// Dashboard log records newer than `since` (at most `limit`, the newest;
+// 0 = all the ring holds) as {"data": [...], "seq": cursor, "missed": n}.
+// Pass cursor back as since to get only what was logged after.
+nlohmann::json read_logs_json(uint64_t since, size_t limit, uint64_t& cursor);
+
+// Tick-to-trade span percentiles (µs), for /api/latency and the dashboard stream
+nlohmann::json get_latency_json();
 } // namespace poly
@@ -1,36 +1,189 @@
 #pragma once
 
 #include "database.hpp"
-#include <queue>
+#include "mpsc_ring.hpp"
+#include <deque>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
 
 namespace poly {
 
+// A TradeRecord flattened into fixed-size fields, so producers hand it over
+// with plain copies - no allocation until the writer thread unpacks it
+struct PackedTrade {
+    static constexpr size_t kTextMax = 95;
+
+    char id[kTextMax + 1];
+    char market_slug[kTextMax + 1];
+    char side[8];
+    char token_id[kTextMax + 1];
+    int leg;
+    double shares;
+    double price;
+    double cost;
+    double fee;
+    int64_t timestamp;
+    bool truncated;  // Some text field didn't fit
+
+    // Copy text into a field, cut to fit and NUL-terminated
+    template <size_t N>
+    void set_text(char (&field)[N], std::string_view text) {
+        size_t n = text.size() < N - 1 ? text.size() : N - 1;
+        std::memcpy(field, text.data(), n);
+        field[n] = '\0';
+        truncated = truncated || n < text.size();
+    }
+
+    static PackedTrade pack(std::string_view id, std::string_view market_slug, int leg, std::string_view side,
+                            std::string_view token_id, double shares, double price, double cost, double fee,
+                            int64_t timestamp);
+    static PackedTrade pack(const TradeRecord& trade) {
+        return pack(trade.id, trade.market_slug, trade.leg, trade.side, trade.token_id, trade.shares,
+                    trade.price, trade.cost, trade.fee, trade.timestamp);
+    }
+    TradeRecord unpack() const;
+};
+
+// What a producer does when the ring is full
+enum class OverflowPolicy {
+    BLOCK,          // Wait for the writer to make room
+    DROP_OLDEST,    // Evict the oldest queued trade (counted in dropped)
+    SPILL_TO_DISK   // Append to the spill file; the writer reloads it once it catches up
+};
+
+// Drains queued trades into the database in batches.
+//
+// Producers push into a bounded lock-free ring of preallocated PackedTrade
+// slots: one CAS and a copy, and the writer is only woken if it is asleep.
+// When the ring is full the overflow policy decides. Each batch is one
+// pipelined transaction (Database::send_trade_batch); up to max_in_flight
+// batches are sent before the oldest one is read back, so the writer keeps
+// filling the next batch while the server commits the last. A batch that
+// fails is retried row by row, so one bad row only loses itself.
+//
+// Finished cycles and equity snapshots are rare (a few a minute) and go
+// through plain locked queues instead; the writer stores them one by one
+// whenever it runs out of trades to send.
 class AsyncTradeWriter {
 public:
-    explicit AsyncTradeWriter(Database& db);
+    struct Options {
+        size_t capacity = 4096;  // Ring slots (rounded up to a power of two)
+        OverflowPolicy overflow = OverflowPolicy::SPILL_TO_DISK;
+        std::string spill_path = "trade-spill.bin";
+        size_t max_batch = 256;
+        size_t max_in_flight = 4;
+    };
+
+    struct Stats {
+        uint64_t trades_written = 0;
+        uint64_t trades_failed = 0;
+        uint64_t batches = 0;
+        uint64_t batches_failed = 0;
+        size_t last_batch = 0;
+        size_t max_batch = 0;
+        double avg_batch = 0.0;
+        // Send to commit confirmed, per batch
+        uint64_t last_commit_us = 0;
+        uint64_t max_commit_us = 0;
+        double avg_commit_us = 0.0;
+        size_t pending = 0;
+        // Ring overflow
+        uint64_t dropped = 0;
+        uint64_t spilled = 0;
+        uint64_t blocked = 0;    // Pushes that had to wait
+        uint64_t truncated = 0;  // Records with a text field cut to fit
+        // Cycles and equity snapshots
+        uint64_t cycles_written = 0;
+        uint64_t snapshots_written = 0;
+        uint64_t records_failed = 0;
+        uint64_t records_dropped = 0;  // Queue full
+    };
+    static constexpr size_t kMaxQueuedRecords = 10000;
+
+    explicit AsyncTradeWriter(Database& db) : AsyncTradeWriter(db, Options{}) {}
+    AsyncTradeWriter(Database& db, Options options);
     ~AsyncTradeWriter();
-    
-    // Non-blocking: queues trade for async write
-    void queue_trade(const TradeRecord& trade);
-    
+
+    // Any thread. Doesn't block unless the ring is full under BLOCK.
+    void queue_trade(const PackedTrade& trade);
+    void queue_trade(const TradeRecord& trade) { queue_trade(PackedTrade::pack(trade)); }
+    // Any thread; a short lock, never a wait on the database
+    void queue_cycle(const CycleRecord& cycle);
+    void queue_equity(const EquitySnapshotRecord& snapshot);
+
     void start();
     void stop();
-    
+
     size_t pending_count() const;
+    Stats stats() const;
 
 private:
+    struct SentBatch {
+        std::vector<TradeRecord> trades;
+        std::chrono::steady_clock::time_point sent;
+    };
+
     void worker_loop();
+    // Up to max_batch trades from the spill reload, then the ring
+    void take_batch(std::vector<TradeRecord>& batch);
+    // Read back the oldest batch in flight; failures go to retry_
+    void finish_oldest();
+    // Nothing in flight: write failed batches one trade at a time
+    void retry_failed();
+    // Nothing in flight: store the queued cycles and snapshots; false if there were none
+    bool write_records();
+    bool records_pending() const;
     
+    // Overflow paths (producer side)
+    void push_blocking(const PackedTrade& trade);
+    void spill(const PackedTrade& trade);
+    // Writer side: move the spill file's records into reloaded_
+    void reload_spill();
+    void wake_writer();
+
     Database& db_;
-    std::queue<TradeRecord> queue_;
-    mutable std::mutex mutex_;
-    std::condition_variable cv_;
-    std::thread worker_;
+    const Options options_;
+    MpscRing<PackedTrade> ring_;
     std::atomic<bool> running_{false};
+    std::thread worker_;
+    
+    // The writer sleeps on cv_ only after announcing it in sleeping_, so
+    // producers skip the notify (and its lock) while it is busy
+    std::mutex wake_mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> sleeping_{false};
+    
+    // Spill file, appended by producers on overflow
+    std::mutex spill_mutex_;
+    std::FILE* spill_file_ = nullptr;
+    std::atomic<size_t> spill_pending_{0};
+    
+    mutable std::mutex records_mutex_;
+    std::deque<CycleRecord> cycles_;
+    std::deque<EquitySnapshotRecord> snapshots_;
+
+    // Worker thread only
+    std::deque<PackedTrade> reloaded_;
+    std::deque<SentBatch> in_flight_;
+    std::vector<TradeRecord> retry_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> spilled_{0};
+    std::atomic<uint64_t> blocked_{0};
+    std::atomic<uint64_t> truncated_{0};
+
+    mutable std::mutex stats_mutex_;
+    Stats stats_;
+    uint64_t batched_trades_ = 0;  // Sums behind the averages
+    uint64_t commit_us_total_ = 0;
 };
 
 } // namespace poly
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "trading_engine.hpp"
+#include "market_registry.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace poly {
+
+// One captured market window: a slug directory written by FrameRecorder
+struct BacktestWindow {
+    std::string slug;
+    std::string path;
+};
+
+// Every window under a capture root, in slug order
+std::vector<BacktestWindow> find_backtest_windows(const std::string& root);
+
+// A window parsed once and replayed against many configs: per captured
+// frame, the books and deltas the live parser produced from it
+struct LoadedWindow {
+    struct Frame {
+        int64_t wall_ns = 0;
+        std::vector<std::pair<TokenId, OrderbookSnapshot>> books;
+        std::vector<BookDelta> deltas;
+    };
+
+    MarketInfo market;
+    int64_t end_wall_ns = 0;  // Window close: pending legs are abandoned here
+    std::vector<Frame> frames;
+};
+
+// Through the same WebSocketPriceStream parse/dispatch path as live frames.
+// False if the capture is unreadable or has no MARKET record.
+bool load_backtest_window(const BacktestWindow& window, LoadedWindow& out, std::string& error);
+
+// One config over one window
+struct WindowOutcome {
+    double pnl = 0.0;
+    uint64_t orders = 0;
+    uint64_t fills = 0;
+    uint64_t entries = 0;
+    uint64_t cycles_completed = 0;
+    uint64_t cycles_abandoned = 0;
+};
+
+// Runs the real TradingEngine (inline mode, paper orders) on strategy time
+// taken from the capture's wall-clock stamps
+WindowOutcome run_backtest_window(const LoadedWindow& window, const Config& config);
+
+struct BacktestResult {
+    size_t config_index = 0;
+    Config config;
+    uint64_t windows = 0;
+    uint64_t windows_traded = 0;
+    double pnl = 0.0;
+    double worst_window_pnl = 0.0;
+    uint64_t orders = 0;
+    uint64_t fills = 0;
+    uint64_t entries = 0;
+    uint64_t cycles_completed = 0;
+    uint64_t cycles_abandoned = 0;
+
+    double fill_rate() const { return orders ? static_cast<double>(fills) / orders : 0.0; }
+    double hedge_completion() const {
+        uint64_t cycles = cycles_completed + cycles_abandoned;
+        return cycles ? static_cast<double>(cycles_completed) / cycles : 0.0;
+    }
+};
+
+// Parameter sweep: every config against every window, spread over a
+// work-stealing pool. A task is one window and a slice of the grid, so
+// each window is parsed once per slice rather than once per config.
+class Backtester {
+public:
+    struct Stats {
+        uint64_t windows_loaded = 0;
+        uint64_t windows_skipped = 0;
+        uint64_t frames = 0;
+        uint64_t runs = 0;  // (config, window) pairs
+        uint64_t steals = 0;
+        uint64_t elapsed_ms = 0;
+    };
+    // Tasks finished / total; called from the workers, one at a time
+    using Progress = std::function<void(size_t done, size_t total)>;
+
+    Backtester(std::vector<Config> grid, size_t threads = 0, size_t configs_per_task = 16);
+
+    void set_progress(Progress progress) { progress_ = std::move(progress); }
+
+    // One result per config, in grid order
+    std::vector<BacktestResult> run(const std::vector<BacktestWindow>& windows);
+    const Stats& stats() const { return stats_; }
+
+private:
+    std::vector<Config> grid_;
+    size_t threads_;
+    size_t configs_per_task_;
+    Progress progress_;
+    Stats stats_;
+};
+
+} // namespace poly
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "order_book.hpp"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace poly {
+
+// Read-only views over OrderBooks. Views expose the same navigation surface
+// as OrderBook (best_tick / next_tick / size_at) and get the convenience
+// accessors from BookViewBase, so strategy code can take any of them.
+
+template <typename Derived>
+class BookViewBase {
+public:
+    Price best_bid() const {
+        int t = self().best_tick(BookSide::BID);
+        return t == OrderBook::kNoTick ? Price{} : OrderBook::tick_to_price(t);
+    }
+    Price best_ask() const {
+        int t = self().best_tick(BookSide::ASK);
+        return t == OrderBook::kNoTick ? Price::from_units(1) : OrderBook::tick_to_price(t);
+    }
+
+    // Visit up to max_levels levels, best first: f(price, size)
+    template <typename F>
+    void for_each_level(BookSide side, size_t max_levels, F&& f) const {
+        size_t n = 0;
+        for (int t = self().best_tick(side); t != OrderBook::kNoTick && n < max_levels;
+             t = self().next_tick(side, t), ++n) {
+            f(OrderBook::tick_to_price(t), self().size_at(side, t));
+        }
+    }
+
+    void top_levels(BookSide side, size_t n, std::vector<std::pair<double, double>>& out) const {
+        for_each_level(side, n, [&out](Price price, Qty size) {
+            out.emplace_back(price.to_double(), size.to_double());
+        });
+    }
+
+private:
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+};
+
+// One token's book seen as the other outcome's book (binary market:
+// UP + DOWN = 1). Source bids at p are asks at 1 - p and vice versa.
+// Nothing is copied; every lookup is translated on the fly.
+class ComplementBookView : public BookViewBase<ComplementBookView> {
+public:
+    explicit ComplementBookView(const OrderBook& source) : src_(&source) {}
+
+    int best_tick(BookSide side) const {
+        return mirror(skip_edges(opposite(side), src_->best_tick(opposite(side))));
+    }
+    int next_tick(BookSide side, int tick) const {
+        BookSide s = opposite(side);
+        return mirror(skip_edges(s, src_->next_tick(s, OrderBook::kMaxTick - tick)));
+    }
+    Qty size_at(BookSide side, int tick) const {
+        return src_->size_at(opposite(side), OrderBook::kMaxTick - tick);
+    }
+
+private:
+    static BookSide opposite(BookSide side) {
+        return side == BookSide::BID ? BookSide::ASK : BookSide::BID;
+    }
+    static int mirror(int tick) {
+        return tick == OrderBook::kNoTick ? OrderBook::kNoTick : OrderBook::kMaxTick - tick;
+    }
+    // Levels at exactly 0 or 1 have no meaningful complement
+    int skip_edges(BookSide s, int tick) const {
+        while (tick == 0 || tick == OrderBook::kMaxTick) tick = src_->next_tick(s, tick);
+        return tick;
+    }
+
+    const OrderBook* src_;
+};
+
+// A token's native book merged with the synthetic book implied by the other
+// token. Sizes at the same tick add up, and the best level is the better of
+// the two - a tighter effective spread than either book alone.
+class MergedBookView : public BookViewBase<MergedBookView> {
+public:
+    MergedBookView(const OrderBook& native, const OrderBook& other)
+        : native_(&native), synthetic_(other) {}
+
+    int best_tick(BookSide side) const {
+        return better(side, native_->best_tick(side), synthetic_.best_tick(side));
+    }
+    int next_tick(BookSide side, int tick) const {
+        return better(side, native_->next_tick(side, tick), synthetic_.next_tick(side, tick));
+    }
+    Qty size_at(BookSide side, int tick) const {
+        return native_->size_at(side, tick) + synthetic_.size_at(side, tick);
+    }
+
+private:
+    static int better(BookSide side, int a, int b) {
+        if (a == OrderBook::kNoTick) return b;
+        if (b == OrderBook::kNoTick) return a;
+        return side == BookSide::BID ? (a > b ? a : b) : (a < b ? a : b);
+    }
+
+    const OrderBook* native_;
+    ComplementBookView synthetic_;
+};
+
+} // namespace poly
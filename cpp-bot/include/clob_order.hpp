@@ -0,0 +1,76 @@
+#pragma once
+
+#include "crypto.hpp"
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace poly {
+
+// Polymarket CTF Exchange contracts on Polygon
+constexpr int kPolygonChainId = 137;
+constexpr const char* kCtfExchangeAddress = "0x4bFb41d5B3570DeFd03C39a9A4D8dE6Bd8B8982E";
+constexpr const char* kNegRiskCtfExchangeAddress = "0xC5d563A36AE78145C45a50134d48A1215220f80a";
+constexpr const char* kZeroAddress = "0x0000000000000000000000000000000000000000";
+
+// Signed CLOB order, field for field what the exchange contract hashes.
+// Integer fields are decimal strings (uint256 on chain).
+struct ClobOrder {
+    uint64_t salt = 0;
+    std::string maker;
+    std::string signer;
+    std::string taker = kZeroAddress;
+    std::string token_id;
+    std::string maker_amount;
+    std::string taker_amount;
+    std::string expiration = "0";
+    std::string nonce = "0";
+    std::string fee_rate_bps = "0";
+    uint8_t side = 0;            // 0 = BUY, 1 = SELL
+    uint8_t signature_type = 0;  // 0 = EOA
+    std::string signature;       // 0x-prefixed r || s || v
+
+    // The "order" object of a POST /order body
+    nlohmann::json to_json() const;
+};
+
+// Per-token market parameters the order depends on
+struct ClobMarketParams {
+    double tick_size = 0.01;
+    int fee_rate_bps = 0;
+    bool neg_risk = false;
+};
+
+// Builds and signs orders exactly like py-clob-client's OrderBuilder:
+// size rounded down to 0.01 shares, price snapped to the tick, amounts in
+// 6-decimal base units, EIP-712 signature over the Order struct.
+class ClobOrderBuilder {
+public:
+    explicit ClobOrderBuilder(const crypto::Secp256k1Signer& signer, int chain_id = kPolygonChainId);
+
+    // side: "BUY" or "SELL". False (with error set) for invalid size/price.
+    bool build(
+        const std::string& token_id,
+        const std::string& side,
+        double size,
+        double price,
+        const ClobMarketParams& params,
+        ClobOrder& out,
+        std::string& error
+    ) const;
+
+    // What an order's amounts are built from: size in 0.01 shares (rounded
+    // down) and price in ticks (nearest). Orders with equal values sign the
+    // same amounts.
+    static void quantize(double size, double price, double tick_size, int64_t& size_cents, int64_t& price_ticks);
+
+    // EIP-712 digest the signature covers
+    crypto::Hash256 order_digest(const ClobOrder& order, bool neg_risk) const;
+
+private:
+    const crypto::Secp256k1Signer& signer_;
+    crypto::Hash256 domain_separator_;
+    crypto::Hash256 neg_risk_domain_separator_;
+};
+
+} // namespace poly
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace poly {
+namespace crypto {
+
+using Hash256 = std::array<uint8_t, 32>;
+
+// Ethereum Keccak-256 (original Keccak padding, not NIST SHA3-256)
+Hash256 keccak256(const uint8_t* data, size_t len);
+inline Hash256 keccak256(std::string_view s) {
+    return keccak256(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+}
+
+// HMAC-SHA256
+std::array<uint8_t, 32> hmac_sha256(const std::vector<uint8_t>& key, std::string_view message);
+
+// Hex helpers ("0x" prefix optional on input)
+std::string to_hex(const uint8_t* data, size_t len, bool prefix = true);
+bool from_hex(std::string_view hex, std::vector<uint8_t>& out);
+
+// Decimal string -> 32-byte big-endian uint256 (ABI word). False if not a
+// plain non-negative integer or it doesn't fit.
+bool uint256_from_decimal(std::string_view decimal, uint8_t out[32]);
+
+// URL-safe base64 as used by the CLOB API secrets / HMAC signatures.
+// Decoding also accepts the standard alphabet and missing padding.
+std::string base64url_encode(const uint8_t* data, size_t len);
+bool base64url_decode(std::string_view text, std::vector<uint8_t>& out);
+
+// secp256k1 key for Ethereum-style signing.
+//
+// Signatures are deterministic (RFC 6979), low-s normalised, and carry the
+// recovery byte Ethereum expects (v = 27/28) - the same bytes eth_account
+// produces for a given digest.
+class Secp256k1Signer {
+public:
+    Secp256k1Signer();
+    ~Secp256k1Signer();
+
+    Secp256k1Signer(const Secp256k1Signer&) = delete;
+    Secp256k1Signer& operator=(const Secp256k1Signer&) = delete;
+
+    // 32-byte hex private key, "0x" optional. False if malformed / out of range.
+    bool load_private_key(std::string_view hex);
+    bool loaded() const { return loaded_; }
+
+    // Checksummed (EIP-55) address of the key, e.g. "0xAbC..."
+    const std::string& address() const { return address_; }
+
+    // r || s || v over a 32-byte digest
+    bool sign_digest(const Hash256& digest, std::array<uint8_t, 65>& sig_out) const;
+
+private:
+    struct Impl;
+    Impl* impl_;
+    bool loaded_ = false;
+    std::string address_;
+};
+
+// EIP-55 mixed-case checksum for a 20-byte address
+std::string checksum_address(const uint8_t* addr20);
+
+} // namespace crypto
+} // namespace poly
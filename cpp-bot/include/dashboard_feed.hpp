@@ -0,0 +1,44 @@
+#pragma once
+
+#include "trading_engine.hpp"
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string>
+
+namespace poly {
+
+class WSServer;
+
+// What the dashboard shows for the primary market, sampled once per tick
+struct DashboardFrame {
+    std::string market;
+    bool in_trading = false;
+    int time_left = 0;
+    bool ws_connected = false;
+    bool user_ws_connected = false;
+    TradingEngine::BookSnapshot books;
+};
+
+// Turns successive frames into the dashboard status stream:
+//   {"type":"fullStatus","version":v,...}                 whole state
+//   {"type":"statusDelta","version":v,"base":v-1,...}     changed fields only;
+//       book levels come per side sorted best first, size 0 = level removed
+// Each tick is serialized once and shared by every session; sessions that
+// missed a version (new or conflated) get a fullStatus instead.
+// One caller thread.
+class DashboardFeed {
+public:
+    // latency: attached to this tick's frame when set
+    void publish(WSServer& server, const DashboardFrame& frame, const nlohmann::json* latency = nullptr);
+
+    uint64_t version() const { return version_; }
+
+private:
+    std::string full_json() const;
+
+    DashboardFrame last_;
+    nlohmann::json latency_;  // Last percentiles, repeated in full frames
+    uint64_t version_ = 0;
+};
+
+} // namespace poly
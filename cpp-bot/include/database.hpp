@@ -2,8 +2,10 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <memory>
 #include <optional>
+#include <unordered_set>
 #include <libpq-fe.h>
 
 namespace poly {
@@ -28,11 +30,24 @@ struct CycleRecord {
     std::optional<int64_t> ended_at;
     std::optional<std::string> leg1_side;
     std::optional<double> leg1_price;
+    std::optional<double> leg1_shares;
+    std::optional<std::string> leg2_side;
     std::optional<double> leg2_price;
+    std::optional<double> leg2_shares;
+    std::optional<double> total_cost;
     std::optional<double> locked_in_profit;
     std::string status;
 };
 
+// One row of equity_snapshots
+struct EquitySnapshotRecord {
+    int64_t ts_ms;
+    double cash;
+    double equity;
+    double unrealized;
+    double realized;
+};
+
 class Database {
 public:
     explicit Database(const std::string& connection_string);
@@ -47,26 +62,61 @@ public:
     bool connect();
     void disconnect();
     
-    // Market operations (for foreign key)
+    // Market operations (for foreign key). Slugs already upserted on this
+    // Database are skipped without a round trip.
     bool ensure_market_exists(const std::string& slug, const std::string& title = "");
     
     // Trade operations
     bool insert_trade(const TradeRecord& trade);
+    
+    // Batched trade writes: prepared statements in libpq pipeline mode.
+    // send_trade_batch queues one batch - the market upserts it needs, then
+    // the inserts - as a single implicit transaction and returns without
+    // waiting; finish_trade_batch reads back the oldest batch in flight
+    // (false: it was rolled back as a whole, or the connection dropped).
+    // Several batches may be in flight at once. Every other call first
+    // finishes whatever is in flight.
+    bool send_trade_batch(const std::vector<TradeRecord>& trades);
+    bool finish_trade_batch();
+    size_t batches_in_flight() const { return in_flight_.size(); }
+    
+    // send + finish (and anything in flight before it)
+    bool insert_trades(const std::vector<TradeRecord>& trades);
     std::vector<TradeRecord> get_trades(const std::string& market_slug);
     
-    // Cycle operations
+    // Cycle operations. insert_cycle upserts by id, so a retried write is harmless.
     bool insert_cycle(const CycleRecord& cycle);
     bool update_cycle(const CycleRecord& cycle);
     std::optional<CycleRecord> get_active_cycle();
+    // Finished cycles ended at or after since (epoch seconds), oldest first
+    std::vector<CycleRecord> get_cycles(int64_t since);
+    
+    // Equity history; a snapshot already stored for its timestamp is kept
+    bool insert_equity_snapshot(const EquitySnapshotRecord& snapshot);
+    std::vector<EquitySnapshotRecord> get_equity_snapshots(int64_t since);  // Oldest first
     
     // Execute raw query
     bool execute(const std::string& query);
 
 private:
+    struct PendingBatch {
+        size_t statements = 0;
+        std::vector<std::string> new_markets;  // Forgotten again if the batch fails
+    };
+    
     std::string connection_string_;
     PGconn* conn_{nullptr};
+    bool prepared_ = false;
+    bool pipeline_ = false;
+    std::deque<PendingBatch> in_flight_;
+    std::unordered_set<std::string> known_markets_;
     
     bool check_connection();
+    bool prepare_statements();
+    // Finish every batch in flight and return to normal (blocking) mode
+    void leave_pipeline();
+    // Connection lost mid-pipeline: drop it and everything in flight
+    void reset_connection();
 };
 
 } // namespace poly
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "fixed_point.hpp"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace poly {
+
+// DCA (Dollar Cost Averaging) ladder for scaling into an open leg.
+//
+// Built once per cycle when leg 1 fills: the configured levels below the
+// entry price, sorted highest first, each with its share count and a
+// running share total. Levels are taken in order, so "which levels has
+// this ask crossed" is one binary search over the untaken tail, and any
+// number of crossed levels go out as a single order.
+class DCAManager {
+public:
+    static constexpr size_t kMaxLevels = 8;
+
+    struct Level {
+        Price price;
+        Qty shares;
+    };
+
+    // Crossed levels merged into one order: their shares at the ask
+    struct Batch {
+        size_t first = 0;  // Index of its highest level
+        size_t levels = 0;
+        Qty shares;
+        Price limit;
+    };
+
+    DCAManager() = default;  // No levels
+
+    // Level i buys base_shares * multiplier^i (in price order). Levels at
+    // or above `below` (the entry price) are dropped, as are any past
+    // kMaxLevels.
+    DCAManager(const std::vector<double>& levels, Qty base_shares, double multiplier, Price below);
+
+    // Untaken levels at or above `ask`, O(log levels)
+    Batch crossed(Price ask) const;
+    // Mark a batch's levels taken - each level fires once per cycle
+    void take(const Batch& batch);
+    // Undo take() for a batch whose order never went out. A no-op once
+    // later levels have been taken on top of it.
+    void give_back(const Batch& batch);
+
+    size_t size() const { return count_; }
+    size_t taken() const { return next_; }
+    Qty taken_shares() const { return cumulative_[next_]; }
+
+private:
+    std::array<Level, kMaxLevels> levels_{};
+    std::array<Qty, kMaxLevels + 1> cumulative_{};  // Shares of levels [0, i)
+    size_t count_ = 0;
+    size_t next_ = 0;  // First untaken level
+};
+
+} // namespace poly
@@ -1,52 +1,81 @@
 #pragma once
 
+#include "market_data.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <chrono>
-#include <optional>
-#include <string>
 
 namespace poly {
 
-struct PricePoint {
-    double price;
-    std::chrono::system_clock::time_point timestamp;
-};
-
 struct DumpDetection {
-    bool detected;
-    std::string side;  // "UP" or "DOWN"
-    double drop_pct;
-    double from_price;
-    double to_price;
+    bool detected = false;
+    Side side = Side::UP;  // Meaningful when detected
+    double drop_pct = 0.0;
+    Price from_price;
+    Price to_price;
+    int window_sec = 0;  // Window whose high the drop is measured from
 };
 
+// Drop-from-recent-high detector over several windows per side.
+//
+// Each (side, window) keeps a monotonic deque of the window's candidate
+// highs - prices that no later price has matched - in a fixed-capacity
+// ring, so the window high is its front. A ring that fills up drops its
+// newest candidate, so the high always survives until it ages out; the
+// cost is a lower next high once it does. A tick costs amortised O(1) per
+// window and nothing allocates after construction. Timestamps come from
+// the caller (milliseconds on its own clock); a clock that steps back is
+// held at its latest value.
 class DumpDetector {
 public:
-    explicit DumpDetector(size_t max_window_size = 1000);
-    
-    void add_price(const std::string& side, double price);
-    
-    DumpDetection detect_dump(double move_threshold, int window_seconds);
-    
+    static constexpr size_t kMaxWindows = 4;
+    static constexpr size_t kCapacity = 256;  // Candidate highs kept per window
+
+    // Window lengths in seconds; the first kMaxWindows are used
+    explicit DumpDetector(const std::vector<int>& windows_sec = {5, 15, 60});
+
+    void add_price(Side side, Price price, int64_t now_ms);
+
+    // Largest drop of a side's last price below a window high, over every
+    // window and both sides. detected once it reaches move_threshold
+    // (a fraction, 0.15 = 15%).
+    DumpDetection detect_dump(double move_threshold, int64_t now_ms);
+
     void clear();
 
 private:
-    std::vector<PricePoint> up_prices_;
-    std::vector<PricePoint> down_prices_;
-    size_t max_window_size_;
-    
-    // Calculate drop percentage in time window
-    std::optional<double> calc_drop_pct(
-        const std::vector<PricePoint>& prices,
-        int window_seconds
-    ) const;
-    
-    // Prune old data points
-    void prune_old_data(
-        std::vector<PricePoint>& prices,
-        int window_seconds
-    );
+    struct Point {
+        Price price;
+        int64_t ts_ms;
+    };
+
+    // Candidate highs, oldest (the window high) first
+    struct Window {
+        int64_t length_ms = 0;
+        std::array<Point, kCapacity> ring;
+        size_t head = 0;  // Index of the front
+        size_t size = 0;
+
+        const Point& front() const { return ring[head]; }
+        const Point& back() const { return ring[(head + size - 1) % kCapacity]; }
+        void pop_front() { head = (head + 1) % kCapacity; --size; }
+        void pop_back() { --size; }
+        void push_back(const Point& p);
+        void expire(int64_t now_ms);
+    };
+
+    struct SideState {
+        std::array<Window, kMaxWindows> windows;
+        Price last;
+        bool seen = false;
+    };
+
+    int64_t clamp_time(int64_t now_ms);
+
+    SideState sides_[2];
+    size_t window_count_ = 0;
+    int64_t last_ms_ = 0;
 };
 
 } // namespace poly
-
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "fixed_point.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace poly {
+
+// Warm-restart checkpoint of the engine, in one memory-mapped file:
+//
+//   [SnapshotFileHeader][slot 0][slot 1]
+//
+// Each slot is a SnapshotSlotHeader and an opaque payload (the engine's
+// encoding, TradingEngine::checkpoint). Writes alternate slots and stamp
+// the header last, so a crash mid-write leaves the other slot whole; load
+// takes the newest slot whose CRC checks out. The pages are the process's
+// shared mapping, so a killed process loses nothing the kernel already
+// has. A payload that outgrows its slot rewrites the file (tmp + rename)
+// with bigger slots.
+constexpr char kSnapshotMagic[8] = {'P', 'O', 'L', 'Y', 'S', 'N', 'P', '1'};
+
+struct SnapshotFileHeader {
+    char magic[8];
+    uint64_t slot_bytes;  // Slot capacity, header included
+    uint8_t reserved[48];
+};
+static_assert(sizeof(SnapshotFileHeader) == 64, "snapshot file header layout");
+
+struct SnapshotSlotHeader {
+    uint64_t seq;           // 0 = never written; the larger valid one wins
+    int64_t written_ms;
+    uint32_t payload_bytes;
+    uint32_t crc;           // crc32 of the payload
+    uint64_t reserved;
+};
+static_assert(sizeof(SnapshotSlotHeader) == 32, "snapshot slot header layout");
+
+// Little helpers for the payload: fixed-width host-order fields and
+// length-prefixed strings
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void u8(uint8_t v) { out_.push_back(v); }
+    void u32(uint32_t v) { raw(&v, sizeof(v)); }
+    void u64(uint64_t v) { raw(&v, sizeof(v)); }
+    void i64(int64_t v) { raw(&v, sizeof(v)); }
+    void f64(double v) { raw(&v, sizeof(v)); }
+    void boolean(bool v) { u8(v ? 1 : 0); }
+    void price(Price v) { i64(v.micros()); }
+    void qty(Qty v) { i64(v.micros()); }
+    void str(std::string_view v) {
+        u32(static_cast<uint32_t>(v.size()));
+        raw(v.data(), v.size());
+    }
+
+private:
+    void raw(const void* data, size_t n) {
+        const auto* p = static_cast<const uint8_t*>(data);
+        out_.insert(out_.end(), p, p + n);
+    }
+
+    std::vector<uint8_t>& out_;
+};
+
+// Reads what SnapshotWriter wrote. A read past the end returns zero and
+// clears ok() for good, so a decoder can check once at the end.
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    bool ok() const { return ok_; }
+    bool done() const { return pos_ == size_; }
+
+    uint8_t u8() { uint8_t v = 0; raw(&v, sizeof(v)); return v; }
+    uint32_t u32() { uint32_t v = 0; raw(&v, sizeof(v)); return v; }
+    uint64_t u64() { uint64_t v = 0; raw(&v, sizeof(v)); return v; }
+    int64_t i64() { int64_t v = 0; raw(&v, sizeof(v)); return v; }
+    double f64() { double v = 0; raw(&v, sizeof(v)); return v; }
+    bool boolean() { return u8() != 0; }
+    Price price() { return Price::from_micros(i64()); }
+    Qty qty() { return Qty::from_micros(i64()); }
+    std::string str() {
+        uint32_t n = u32();
+        if (!ok_ || n > size_ - pos_) {
+            ok_ = false;
+            return {};
+        }
+        std::string v(reinterpret_cast<const char*>(data_ + pos_), n);
+        pos_ += n;
+        return v;
+    }
+
+private:
+    void raw(void* out, size_t n) {
+        if (!ok_ || n > size_ - pos_) {
+            ok_ = false;
+            return;
+        }
+        std::memcpy(out, data_ + pos_, n);
+        pos_ += n;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+class SnapshotFile {
+public:
+    explicit SnapshotFile(std::string path);
+    ~SnapshotFile();
+
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    // Into the older slot (the file is created or grown as needed)
+    bool write(const std::vector<uint8_t>& payload, int64_t written_ms, std::string& error);
+    // Flush the mapping to disk (power loss, not just a crash)
+    void sync();
+
+    // The newest valid payload in `path`; false if there is none
+    static bool load(const std::string& path, std::vector<uint8_t>& payload, int64_t& written_ms,
+                     std::string& error);
+
+    const std::string& path() const { return path_; }
+
+private:
+    bool map(uint64_t slot_bytes, std::string& error);
+    void unmap();
+    // New file with `slot_bytes` slots holding `payload`, renamed over path_
+    bool rebuild(uint64_t slot_bytes, const std::vector<uint8_t>& payload, int64_t written_ms,
+                 std::string& error);
+
+    const std::string path_;
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t mapped_ = 0;
+    uint64_t slot_bytes_ = 0;
+    uint64_t seq_ = 0;     // Last written
+    size_t current_ = 0;   // Slot holding it
+};
+
+// Checkpoints the engine every interval_ms on a thread of its own. The
+// source encodes the engine's state and returns false when nothing changed
+// since its last call (no write). stop() takes a last checkpoint and syncs
+// the file.
+class EngineCheckpointer {
+public:
+    struct Options {
+        int interval_ms = 1000;
+    };
+
+    struct Stats {
+        uint64_t checkpoints = 0;
+        uint64_t unchanged = 0;     // Intervals with nothing to write
+        uint64_t errors = 0;
+        size_t last_bytes = 0;
+        uint64_t last_us = 0;       // Encode + write
+        uint64_t max_us = 0;
+        int64_t last_ms = 0;        // Wall clock of the last checkpoint
+    };
+
+    using Source = std::function<bool(std::vector<uint8_t>& out)>;
+
+    EngineCheckpointer(std::string path, Source source) : EngineCheckpointer(std::move(path), std::move(source), Options{}) {}
+    EngineCheckpointer(std::string path, Source source, Options options);
+    ~EngineCheckpointer();
+
+    EngineCheckpointer(const EngineCheckpointer&) = delete;
+    EngineCheckpointer& operator=(const EngineCheckpointer&) = delete;
+
+    void start();
+    void stop();
+
+    const std::string& path() const { return file_.path(); }
+    Stats stats() const;
+
+private:
+    void run();
+    void checkpoint();
+
+    SnapshotFile file_;
+    Source source_;
+    const Options options_;
+
+    std::mutex run_mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+    std::thread thread_;
+
+    std::vector<uint8_t> buffer_;  // Checkpoint thread (or stop) only
+
+    mutable std::mutex stats_mutex_;
+    Stats stats_;
+    bool failing_ = false;
+};
+
+} // namespace poly
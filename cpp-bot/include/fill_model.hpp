@@ -0,0 +1,43 @@
+#pragma once
+
+#include "order_book.hpp"
+
+namespace poly {
+
+// What a marketable buy would get from the displayed book
+struct SimulatedFill {
+    Qty shares;
+    Price notional;
+    int levels = 0;  // Price levels touched
+
+    Price vwap() const { return average_price(notional, shares); }
+};
+
+// Walk the asks best first, buying up to `shares` at prices no worse than
+// `limit`; the rest is unfilled (fill-and-kill). queue_ahead is the share of
+// each level's displayed size that someone else takes before our order lands
+// (0 = we get all of it, 1 = none). Works on an OrderBook or any book view
+// and costs O(levels touched).
+template <typename Book>
+SimulatedFill simulate_buy(const Book& book, Qty shares, Price limit, double queue_ahead = 0.0) {
+    SimulatedFill fill;
+    const double available = queue_ahead <= 0.0 ? 1.0 : (queue_ahead >= 1.0 ? 0.0 : 1.0 - queue_ahead);
+    if (!shares.positive() || available <= 0.0) return fill;
+
+    for (int t = book.best_tick(BookSide::ASK); t != OrderBook::kNoTick; t = book.next_tick(BookSide::ASK, t)) {
+        Price price = OrderBook::tick_to_price(t);
+        if (price > limit) break;
+        Qty take = book.size_at(BookSide::ASK, t);
+        if (available < 1.0) take = take.scaled(available);
+        Qty remaining = shares - fill.shares;
+        if (take > remaining) take = remaining;
+        if (!take.positive()) continue;
+        fill.shares += take;
+        fill.notional += notional(price, take);
+        fill.levels++;
+        if (fill.shares >= shares) break;
+    }
+    return fill;
+}
+
+} // namespace poly
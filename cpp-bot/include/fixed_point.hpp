@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+
+namespace poly {
+
+// Exact decimal quantities for the book, the strategy and the ledger.
+//
+// Both types count millionths in an int64: a Price is micro-dollars (per
+// share, or an amount of cash), a Qty is micro-shares. Sums and compares
+// are exact, so a hedge priced at exactly the sum target or a DCA level hit
+// at exactly its price can't be lost to rounding. Doubles stay at the
+// edges - config, exchange orders, trade records, the API.
+template <typename Tag>
+class Fixed {
+public:
+    static constexpr int64_t kScale = 1000000;
+
+    constexpr Fixed() = default;
+
+    static constexpr Fixed from_micros(int64_t micros) {
+        Fixed f;
+        f.micros_ = micros;
+        return f;
+    }
+    static constexpr Fixed from_units(int64_t units) { return from_micros(units * kScale); }
+    // Nearest micro - config values and exchange reports
+    static Fixed from_double(double value) { return from_micros(std::llround(value * kScale)); }
+
+    // Plain decimals ("0.48", "1250", "-3.5"). Digits past the sixth decimal
+    // round half away from zero, like from_double. False for exponents,
+    // empty input, junk or overflow.
+    static constexpr bool parse(std::string_view text, Fixed& out) {
+        size_t i = 0;
+        const size_t n = text.size();
+        bool negative = false;
+        if (i < n && text[i] == '-') {
+            negative = true;
+            ++i;
+        }
+
+        int64_t units = 0;
+        int64_t frac = 0;
+        int int_digits = 0;
+        int frac_digits = 0;
+        bool round_up = false;
+        for (; i < n && text[i] >= '0' && text[i] <= '9'; ++i) {
+            if (++int_digits > kMaxIntDigits) return false;
+            units = units * 10 + (text[i] - '0');
+        }
+        if (i < n && text[i] == '.') {
+            for (++i; i < n && text[i] >= '0' && text[i] <= '9'; ++i) {
+                if (frac_digits < kDecimals) {
+                    frac = frac * 10 + (text[i] - '0');
+                } else if (frac_digits == kDecimals) {
+                    round_up = text[i] >= '5';
+                }
+                ++frac_digits;
+            }
+        }
+        if (i != n || int_digits + frac_digits == 0) return false;
+
+        for (int d = frac_digits; d < kDecimals; ++d) frac *= 10;
+        int64_t micros = units * kScale + frac + (round_up ? 1 : 0);
+        out = from_micros(negative ? -micros : micros);
+        return true;
+    }
+
+    constexpr int64_t micros() const { return micros_; }
+    constexpr double to_double() const { return static_cast<double>(micros_) / kScale; }
+
+    constexpr bool positive() const { return micros_ > 0; }
+
+    constexpr Fixed operator+(Fixed o) const { return from_micros(micros_ + o.micros_); }
+    constexpr Fixed operator-(Fixed o) const { return from_micros(micros_ - o.micros_); }
+    constexpr Fixed operator-() const { return from_micros(-micros_); }
+    constexpr Fixed& operator+=(Fixed o) { micros_ += o.micros_; return *this; }
+    constexpr Fixed& operator-=(Fixed o) { micros_ -= o.micros_; return *this; }
+
+    // Fraction of this (queue share, partial hedges), nearest micro
+    Fixed scaled(double ratio) const { return from_micros(std::llround(static_cast<double>(micros_) * ratio)); }
+
+    constexpr bool operator==(Fixed o) const { return micros_ == o.micros_; }
+    constexpr bool operator!=(Fixed o) const { return micros_ != o.micros_; }
+    constexpr bool operator<(Fixed o) const { return micros_ < o.micros_; }
+    constexpr bool operator<=(Fixed o) const { return micros_ <= o.micros_; }
+    constexpr bool operator>(Fixed o) const { return micros_ > o.micros_; }
+    constexpr bool operator>=(Fixed o) const { return micros_ >= o.micros_; }
+
+private:
+    static constexpr int kDecimals = 6;
+    static constexpr int kMaxIntDigits = 12;  // 10^12 units stay well inside int64 micros
+
+    int64_t micros_ = 0;
+};
+
+struct PriceTag {};
+struct QtyTag {};
+
+using Price = Fixed<PriceTag>;  // Also cash amounts: same micro-dollar scale
+using Qty = Fixed<QtyTag>;
+
+// Cost of `qty` shares at `price`, nearest micro-dollar (half away from zero)
+constexpr Price notional(Price price, Qty qty) {
+    __int128 product = static_cast<__int128>(price.micros()) * qty.micros();
+    __int128 half = Qty::kScale / 2;
+    __int128 micros = (product >= 0 ? product + half : product - half) / Qty::kScale;
+    return Price::from_micros(static_cast<int64_t>(micros));
+}
+
+// Average price of `qty` shares that cost `cost` in total, nearest micro
+// (half away from zero)
+constexpr Price average_price(Price cost, Qty qty) {
+    if (qty.micros() == 0) return Price{};
+    __int128 scaled = static_cast<__int128>(cost.micros()) * Qty::kScale;
+    __int128 half = qty.micros() / 2;
+    __int128 micros = (scaled >= 0 ? scaled + half : scaled - half) / qty.micros();
+    return Price::from_micros(static_cast<int64_t>(micros));
+}
+
+// Exact at compile time too
+static_assert([] { Price p; return Price::parse("0.355", p) && p.micros() == 355000; }());
+static_assert([] { Price p; return Price::parse("-0.0000005", p) && p.micros() == -1; }());
+static_assert(notional(Price::from_micros(355000), Qty::from_units(10)).micros() == 3550000);
+
+} // namespace poly
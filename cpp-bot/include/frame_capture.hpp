@@ -0,0 +1,179 @@
+#pragma once
+
+#include "market_registry.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace poly {
+
+// Raw market-data capture, one append-only log per market slug:
+//
+//   <dir>/<slug>/<slug>.<seq>.cap
+//
+// Each segment starts with the 8-byte magic "POLYCAP1" followed by records
+// of [CaptureRecordHeader][payload]. FRAME payloads are WebSocket text
+// frames exactly as received; MARKET payloads are the market's slug and
+// token ids as JSON, written when it is subscribed, so a replay can set
+// the market up before its first frame. Native byte order.
+enum class CaptureKind : uint16_t {
+    FRAME = 0,
+    MARKET = 1
+};
+
+struct CaptureRecordHeader {
+    uint32_t length;   // Payload bytes
+    uint16_t kind;     // CaptureKind
+    uint16_t reserved;
+    uint64_t mono_ns;  // latency::now_ns() when the read returned
+    int64_t wall_ns;   // system_clock, ns since the epoch
+};
+static_assert(sizeof(CaptureRecordHeader) == 24, "capture header layout");
+
+constexpr char kCaptureMagic[8] = {'P', 'O', 'L', 'Y', 'C', 'A', 'P', '1'};
+
+// The I/O thread only resolves the frame's market and copies it into an
+// in-memory batch; a writer thread swaps the batch out every few ms and
+// writes it with large buffered writes, rolling segments at segment_bytes.
+// If the disk falls behind past max_buffered_bytes frames are dropped
+// (and counted) rather than stalling the feed.
+class FrameRecorder {
+public:
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t dropped = 0;
+        uint64_t segments = 0;
+    };
+
+    explicit FrameRecorder(std::string dir, size_t segment_bytes = 256u << 20,
+                           size_t max_buffered_bytes = 64u << 20);
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    void start();
+    // Writes out everything still buffered
+    void stop();
+
+    // Route the market's tokens to its slug and log the MARKET record
+    void add_market(const MarketInfo& market);
+
+    // Hot path (WebSocket reader thread)
+    void record(std::string_view frame, uint64_t mono_ns);
+
+    Stats stats() const;
+
+private:
+    struct Segment {
+        FILE* file = nullptr;
+        uint32_t seq = 0;
+        size_t bytes = 0;
+        std::vector<char> io_buffer;
+    };
+
+    void append(std::string_view slug, CaptureKind kind, std::string_view payload, uint64_t mono_ns);
+    void writer_loop();
+    void write_batch(const std::vector<char>& batch);
+    Segment& segment_for(const std::string& slug);
+    bool open_segment(const std::string& slug, Segment& segment);
+
+    const std::string dir_;
+    const size_t segment_bytes_;
+    const size_t max_buffered_bytes_;
+
+    std::mutex tokens_mutex_;
+    std::unordered_map<std::string, std::string> slug_by_token_;
+
+    // Batch layout: [uint16 slug length][slug][CaptureRecordHeader][payload]...
+    std::mutex batch_mutex_;
+    std::condition_variable cv_;
+    std::vector<char> batch_;
+    bool running_ = false;
+    std::thread writer_;
+
+    std::unordered_map<std::string, Segment> segments_;  // Writer thread only
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> segment_count_{0};
+};
+
+struct CaptureRecord {
+    std::string_view slug;
+    CaptureKind kind = CaptureKind::FRAME;
+    uint64_t mono_ns = 0;
+    int64_t wall_ns = 0;
+    std::string_view payload;  // Points into the mapping; valid until the next next()
+};
+
+// MARKET payload -> slug and token ids; false if malformed
+bool parse_market_record(std::string_view payload, MarketInfo& out);
+
+// Memory-maps capture segments and walks their records without copying.
+// open() takes a segment file, a slug directory or a whole capture
+// directory; several slugs are merged back into receive order.
+class CaptureReader {
+public:
+    CaptureReader();
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    bool next(CaptureRecord& out);
+
+    size_t segment_count() const;
+
+private:
+    struct Mapping;
+    struct Stream;
+
+    bool peek(Stream& stream);
+
+    std::vector<std::unique_ptr<Stream>> streams_;
+    Stream* last_ = nullptr;  // Returned by the previous next(), not yet advanced
+};
+
+// Feeds a capture back at its original pace (speed 1.0), scaled
+// (2.0 = twice as fast) or as fast as possible (speed <= 0).
+class FrameReplayer {
+public:
+    using FrameSink = std::function<void(std::string_view frame, const CaptureRecord& record)>;
+    using MarketSink = std::function<void(const MarketInfo& market)>;
+
+    struct Result {
+        uint64_t frames = 0;
+        uint64_t markets = 0;
+        uint64_t capture_ns = 0;  // First to last record, as captured
+        uint64_t elapsed_ns = 0;  // Wall time the replay took
+    };
+
+    FrameReplayer(CaptureReader& reader, double speed = 1.0);
+
+    void set_frame_sink(FrameSink sink) { frame_sink_ = std::move(sink); }
+    void set_market_sink(MarketSink sink) { market_sink_ = std::move(sink); }
+
+    // keep_running (optional) is polled between records
+    Result run(const std::atomic<bool>* keep_running = nullptr);
+
+private:
+    CaptureReader& reader_;
+    double speed_;
+    FrameSink frame_sink_;
+    MarketSink market_sink_;
+};
+
+} // namespace poly
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <curl/curl.h>
+
+namespace poly {
+
+// Process-wide pool of keep-alive HTTPS connections (CLOB, Gamma, data API).
+//
+// Easy handles are recycled and share one connection cache, TLS session
+// cache and DNS cache through a CURLSH, so any thread reuses whichever warm
+// connection is free instead of paying a fresh TCP + TLS handshake. HTTP/2
+// is negotiated where the server offers it. A warmer thread touches the
+// registered hosts periodically so the sessions are hot when an order or
+// a market switch needs them.
+//
+// Safe to call from any thread.
+class HttpPool {
+public:
+    struct Response {
+        long status = 0;
+        std::string body;
+        std::string error;    // Transport error, empty on success
+        bool reused = false;  // Served on an already-open connection
+        double total_ms = 0.0;
+    };
+
+    struct HostStats {
+        std::string host;
+        uint64_t requests = 0;
+        uint64_t reused = 0;
+        uint64_t new_connections = 0;
+        uint64_t errors = 0;
+        double last_handshake_ms = 0.0;  // TCP + TLS for the last new connection
+        double max_handshake_ms = 0.0;
+        double total_handshake_ms = 0.0;
+        double total_request_ms = 0.0;
+        long http_version = 0;           // 2 = HTTP/2, 1 = HTTP/1.1
+    };
+
+    struct Stats {
+        std::vector<HostStats> hosts;
+        uint64_t warm_pings = 0;
+        size_t idle_handles = 0;
+    };
+
+    static HttpPool& instance();
+
+    HttpPool(const HttpPool&) = delete;
+    HttpPool& operator=(const HttpPool&) = delete;
+
+    Response request(
+        const std::string& method,
+        const std::string& url,
+        const std::string& body = "",
+        const std::vector<std::string>& headers = {},
+        long timeout_ms = 10000
+    );
+    Response get(const std::string& url, long timeout_ms = 10000) {
+        return request("GET", url, "", {}, timeout_ms);
+    }
+
+    // Keep a connection to this origin warm (e.g. "https://clob.polymarket.com")
+    void add_warm_target(const std::string& origin);
+
+    // Start / stop the warmer thread. stop() also releases idle handles.
+    void start(std::chrono::seconds interval = std::chrono::seconds(20));
+    void stop();
+
+    Stats stats() const;
+
+private:
+    HttpPool();
+    ~HttpPool();
+
+    CURL* acquire();
+    void release(CURL* handle);
+    void record(const std::string& url, CURL* handle, bool ok, Response& response);
+    void warm_loop();
+
+    static void lock_share(CURL*, curl_lock_data data, curl_lock_access, void* user);
+    static void unlock_share(CURL*, curl_lock_data data, void* user);
+
+    CURLSH* share_ = nullptr;
+    std::mutex share_locks_[CURL_LOCK_DATA_LAST];
+
+    mutable std::mutex handles_mutex_;
+    std::vector<CURL*> idle_;
+
+    mutable std::mutex stats_mutex_;
+    std::unordered_map<std::string, HostStats> hosts_;
+    std::atomic<uint64_t> warm_pings_{0};
+
+    std::mutex warm_mutex_;
+    std::condition_variable warm_cv_;
+    std::vector<std::string> warm_targets_;
+    std::chrono::seconds warm_interval_{20};
+    std::thread warmer_;
+    bool running_ = false;
+};
+
+} // namespace poly
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace poly {
+
+struct HttpRequest {
+    std::string method;         // "GET", "POST", ...
+    std::string target;         // Path and query, as sent
+    std::string path;           // Target without the query
+    std::string body;
+    std::string authorization;  // Authorization header ("" if none)
+
+    // Raw query parameter value ("" if absent)
+    std::string query(const std::string& key) const;
+    uint64_t query_uint(const std::string& key, uint64_t fallback) const;
+};
+
+struct HttpResponse {
+    unsigned status = 200;
+    std::string body;
+    std::string content_type = "application/json";
+
+    static HttpResponse json(const nlohmann::json& body, unsigned status = 200) {
+        return HttpResponse{status, body.dump(), "application/json"};
+    }
+};
+
+using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+// Asynchronous HTTP/1.1 server (Boost.Beast) with a route table.
+//
+// Connections are kept alive between requests and read with a full parser,
+// so bodies can be as large as kMaxBody. Each connection lives on its own
+// strand of the shared IoPool; a slow client only delays itself. Handlers
+// run on the I/O thread and must be quick, except routes added with
+// blocking = true: those go to IoPool::blocking(), one at a time (they may
+// call out over the network or change engine settings), and the reply is
+// sent when they return.
+class HttpServer {
+public:
+    static constexpr size_t kMaxBody = 1024 * 1024;
+    static constexpr int kIdleTimeoutSec = 30;  // Keep-alive connections idle this long are closed
+
+    // Serves on IoPool's threads (IoPool::start() must be called too)
+    explicit HttpServer(unsigned short port);
+    ~HttpServer();
+
+    // method "" matches any method. Routes are fixed once start() is called.
+    void route(const std::string& method, const std::string& path, HttpHandler handler, bool blocking = false);
+    // Runs before the route lookup; returning false answers with `denied`
+    // instead (e.g. a 401). OPTIONS preflights never reach it.
+    void set_guard(std::function<bool(const HttpRequest&, HttpResponse& denied)> guard);
+
+    void start();
+    void stop();
+
+    struct State;
+
+private:
+    std::shared_ptr<State> state_;
+};
+
+} // namespace poly
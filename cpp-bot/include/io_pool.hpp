@@ -0,0 +1,44 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace poly {
+
+// The io_context behind the dashboard-facing servers (REST API and the
+// WebSocket feed), run by a few threads.
+//
+// Every connection keeps its state on its own strand, so handlers never
+// race each other; they must not block, since a stalled handler holds up
+// its pool thread.
+class IoPool {
+public:
+    static IoPool& instance();
+
+    boost::asio::io_context& context() { return ioc_; }
+    // One worker for handlers that may block (remote calls, engine
+    // settings); work posted here runs in order, one item at a time
+    boost::asio::thread_pool& blocking() { return blocking_; }
+
+    // threads = 0: min(2, cores). Later calls do nothing.
+    void start(size_t threads = 0);
+    // Pending handlers are dropped; servers must have been stopped first
+    void stop();
+
+    size_t threads() const;
+
+private:
+    IoPool();
+    ~IoPool();
+
+    boost::asio::io_context ioc_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> guard_;
+    boost::asio::thread_pool blocking_{1};
+    mutable std::mutex mutex_;
+    std::vector<std::thread> threads_;
+    bool started_ = false;
+};
+
+} // namespace poly
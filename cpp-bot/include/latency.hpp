@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace poly {
+
+// Tick-to-trade instrumentation.
+//
+// Stages are stamped with the monotonic clock (vDSO, ~20ns) as a frame
+// moves through the bot:
+//
+//   frame read -> parsed -> book applied -> decision -> order submitted -> ack
+//
+// and every stage-to-stage span is recorded into a fixed-size log-linear
+// (HDR-style) histogram. Recording is two relaxed atomic adds and a rare
+// CAS on the max - no locks, no allocation - so it stays on in production.
+namespace latency {
+
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+enum class Span : uint8_t {
+    FRAME_TO_PARSE,      // WebSocket read returned -> message parsed
+    PARSE_TO_BOOK,       // Parsed -> applied to the engine's book (includes the queue hop)
+    BOOK_TO_DECISION,    // Book applied -> strategy evaluated
+    DECISION_TO_SUBMIT,  // Signal -> order handed to the exchange (or paper fill)
+    SUBMIT_TO_ACK,       // Order sent -> exchange response
+    TICK_TO_TRADE,       // Frame read -> order submitted
+    TICK_TO_ACK,         // Frame read -> exchange response
+    CONNECT_TO_BOOK,     // Market stream (re)connect started -> first book on it
+    COUNT
+};
+
+const char* span_name(Span span);
+
+// Stamps of the tick the current thread is evaluating. The engine sets it
+// before running the strategy so the order path can close the spans
+// without threading timestamps through every call.
+struct TickContext {
+    uint64_t frame_ns = 0;     // 0 = unknown (e.g. synchronous test input)
+    uint64_t book_ns = 0;
+    uint64_t decision_ns = 0;
+};
+
+TickContext& current_tick();
+
+} // namespace latency
+
+// Values are nanoseconds. 128 linear sub-buckets per power of two keeps
+// the bucket error under 1% (two significant digits) up to ~68s; beyond
+// that values land in the top bucket.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 7;
+    static constexpr int kMaxBits = 36;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+    static constexpr size_t kBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        double mean_ns = 0.0;
+        uint64_t p50_ns = 0;
+        uint64_t p90_ns = 0;
+        uint64_t p99_ns = 0;
+        uint64_t p999_ns = 0;
+        uint64_t max_ns = 0;
+    };
+
+    void record(uint64_t ns);
+    Snapshot snapshot() const;
+    void reset();
+
+    static size_t bucket_for(uint64_t ns);
+    static uint64_t bucket_upper(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+// One histogram per span, process-wide. Safe to call from any thread.
+class LatencyMonitor {
+public:
+    struct SpanStats {
+        const char* name;
+        LatencyHistogram::Snapshot stats;
+    };
+
+    static LatencyMonitor& instance();
+
+    void record(latency::Span span, uint64_t ns) {
+        histograms_[static_cast<size_t>(span)].record(ns);
+    }
+    // No-op if either stamp is missing or out of order
+    void record(latency::Span span, uint64_t start_ns, uint64_t end_ns) {
+        if (start_ns != 0 && end_ns >= start_ns) record(span, end_ns - start_ns);
+    }
+
+    std::vector<SpanStats> stats() const;
+    void reset();
+
+private:
+    LatencyMonitor() = default;
+
+    std::array<LatencyHistogram, static_cast<size_t>(latency::Span::COUNT)> histograms_;
+};
+
+} // namespace poly
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace poly {
+
+// One dashboard log line, fixed size so it lives in a ring slot
+struct LogRecord {
+    static constexpr size_t kLevelMax = 7;
+    static constexpr size_t kNameMax = 23;
+    static constexpr size_t kMessageMax = 215;
+
+    uint64_t seq;      // 1, 2, 3... across the process
+    int64_t wall_ms;
+    char level[kLevelMax + 1];
+    char name[kNameMax + 1];
+    char message[kMessageMax + 1];
+
+    template <size_t N>
+    static void set_text(char (&field)[N], std::string_view text) {
+        size_t n = text.size() < N - 1 ? text.size() : N - 1;
+        std::memcpy(field, text.data(), n);
+        field[n] = '\0';
+    }
+};
+
+// Overwriting multi-producer ring of log records, read by cursor.
+//
+// Writers take a ticket (one fetch_add) and fill slot ticket & mask; the
+// slot's version is odd while it is written and 2 * seq + 2 once done, so
+// a reader copies a record and keeps it only if the version was the same
+// before and after. Readers never block writers; a reader that falls more
+// than capacity behind misses the overwritten records and is told how many.
+class LogRing {
+public:
+    // Rounded up to a power of two
+    explicit LogRing(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        mask_ = n - 1;
+        slots_.reset(new Slot[n]);
+        for (size_t i = 0; i < n; ++i) slots_[i].version.store(0, std::memory_order_relaxed);
+    }
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    uint64_t push(std::string_view level, std::string_view name, std::string_view message, int64_t wall_ms) {
+        uint64_t seq = next_.fetch_add(1, std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[seq & mask_];
+        slot.version.store(2 * seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.record.seq = seq;
+        slot.record.wall_ms = wall_ms;
+        LogRecord::set_text(slot.record.level, level);
+        LogRecord::set_text(slot.record.name, name);
+        LogRecord::set_text(slot.record.message, message);
+        slot.version.store(2 * seq + 2, std::memory_order_release);
+        return seq;
+    }
+
+    // Latest seq handed out (0: nothing logged yet)
+    uint64_t last_seq() const { return next_.load(std::memory_order_acquire); }
+
+    // Records with seq > since, oldest first, at most `limit` (the newest
+    // ones if there are more; 0 = no limit). cursor is what to pass as since
+    // next time: it stops short of a record still being written, so nothing
+    // is skipped. missed counts records overwritten before they were read.
+    std::vector<LogRecord> read_since(uint64_t since, size_t limit, uint64_t& cursor, uint64_t& missed) const {
+        std::vector<LogRecord> out;
+        cursor = since;
+        missed = 0;
+        uint64_t last = last_seq();
+        if (last <= since) return out;
+
+        uint64_t first = since + 1;
+        uint64_t capacity = mask_ + 1;
+        if (last - first + 1 > capacity) {
+            missed += last - capacity + 1 - first;
+            first = last - capacity + 1;
+        }
+        if (limit > 0 && last - first + 1 > limit) first = last - limit + 1;  // Skipped on purpose, not missed
+
+        out.reserve(last - first + 1);
+        for (uint64_t seq = first; seq <= last; ++seq) {
+            const Slot& slot = slots_[seq & mask_];
+            uint64_t before = slot.version.load(std::memory_order_acquire);
+            if (before < 2 * seq + 2) break;  // Not written yet - pick it up next time
+            LogRecord record = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (before == 2 * seq + 2 && slot.version.load(std::memory_order_relaxed) == before) {
+                out.push_back(record);
+            } else {
+                missed++;  // Lapped by a newer record
+            }
+            cursor = seq;
+        }
+        return out;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> version;
+        LogRecord record;
+    };
+
+    alignas(64) std::atomic<uint64_t> next_{0};
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+};
+
+} // namespace poly
@@ -1,12 +1,22 @@
 #pragma once
 
-#include <string>
-#include <iostream>
-#include <fstream>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <mutex>
-#include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Lowest level compiled in: 0 DEBUG, 1 INFO, 2 WARN, 3 ERROR. Calls below
+// it cost nothing - their arguments aren't even evaluated.
+#ifndef POLY_LOG_MIN_LEVEL
+#define POLY_LOG_MIN_LEVEL 1
+#endif
 
 namespace poly {
 
@@ -15,83 +25,203 @@ enum class LogLevel {
     INFO,
     WARN,
     ERROR,
-    FATAL
+    FATAL,
+    OFF
 };
 
-class Logger {
-public:
-    static Logger& instance() {
-        static Logger logger;
-        return logger;
+// Binary asynchronous logger.
+//
+// A call site is a static Site (level, tag, format string); logging it
+// copies the site's address, a timestamp and the raw argument bytes into
+// the calling thread's own ring - no formatting, no locks, no syscalls. A
+// background thread drains every ring, formats "{}" / "{:.Nf}" placeholders
+// and writes the lines out in batches (INFO and below to stdout, WARN and
+// up to stderr, everything to the file if one is set). A full ring drops
+// the record and counts it; the hot path never waits for output.
+//
+//   POLY_LOG_INFO("ENGINE", "Active market: {} (shard {})", slug, shard);
+//   POLY_LOG_WARN("ENGINE", "Entry refused - ${:.2f} [{}]", cost, slug);
+//
+// Arguments: integers, floating point, bool, char, enums, and text
+// (std::string, std::string_view, C strings - copied, so temporaries are fine).
+namespace log {
+
+using FormatFn = void (*)(std::string_view fmt, const char* args, std::string& out);
+
+struct Site {
+    LogLevel level;
+    const char* tag;
+    const char* fmt;
+};
+
+// Ahead of every record in a thread's ring; the encoded arguments follow
+struct RecordHeader {
+    uint32_t size;  // Header + arguments, padded to 8. 0 = wrap to the start.
+    uint32_t reserved;
+    const Site* site;
+    FormatFn format;
+    int64_t wall_ns;
+};
+
+// Runtime threshold on top of the compile-time one
+inline std::atomic<LogLevel> runtime_level{LogLevel::INFO};
+
+// This thread's ring: space for `size` bytes, nullptr if full (dropped);
+// commit() publishes what was reserved
+char* reserve(size_t size);
+void commit();
+int64_t wall_now_ns();
+
+// Formatting helpers for the background thread
+void append_value(std::string& out, int64_t value, std::string_view spec);
+void append_value(std::string& out, uint64_t value, std::string_view spec);
+void append_value(std::string& out, double value, std::string_view spec);
+void append_value(std::string& out, bool value, std::string_view spec);
+void append_value(std::string& out, char value, std::string_view spec);
+// Copy fmt up to the next placeholder into out and return its spec ("" for
+// "{}", ".2f" for "{:.2f}"); false once fmt has none left
+bool next_placeholder(std::string_view& fmt, std::string& out, std::string_view& spec);
+
+template <typename T, typename = void>
+struct Codec;  // Unsupported argument type
+
+// Numbers, bools, chars and enums travel as raw bytes
+template <typename T>
+struct Codec<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>> {
+    static size_t size(T) { return sizeof(T); }
+    static char* encode(char* p, T value) {
+        std::memcpy(p, &value, sizeof(T));
+        return p + sizeof(T);
     }
-    
-    void set_level(LogLevel level) {
-        level_ = level;
+    static const char* append(const char* p, std::string_view spec, std::string& out) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>) {
+            append_value(out, value, spec);
+        } else if constexpr (std::is_enum_v<T>) {
+            append_value(out, static_cast<int64_t>(value), spec);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            append_value(out, static_cast<double>(value), spec);
+        } else if constexpr (std::is_signed_v<T>) {
+            append_value(out, static_cast<int64_t>(value), spec);
+        } else {
+            append_value(out, static_cast<uint64_t>(value), spec);
+        }
+        return p + sizeof(T);
     }
-    
-    void set_file(const std::string& filename) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        file_.open(filename, std::ios::app);
+};
+
+// Text is copied: 4-byte length, then the bytes
+struct TextCodec {
+    static size_t size(std::string_view text) { return sizeof(uint32_t) + text.size(); }
+    static char* encode(char* p, std::string_view text) {
+        uint32_t n = static_cast<uint32_t>(text.size());
+        std::memcpy(p, &n, sizeof(n));
+        std::memcpy(p + sizeof(n), text.data(), n);
+        return p + sizeof(n) + n;
     }
-    
-    template<typename... Args>
-    void log(LogLevel level, Args&&... args) {
-        if (level < level_) return;
-        
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        
-        std::ostringstream oss;
-        oss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-        oss << " [" << level_to_string(level) << "] ";
-        
-        (oss << ... << args);
-        
-        std::string msg = oss.str();
-        
-        std::cout << msg << std::endl;
-        
-        if (file_.is_open()) {
-            file_ << msg << std::endl;
-            file_.flush();
-        }
+    static const char* append(const char* p, std::string_view, std::string& out) {
+        uint32_t n;
+        std::memcpy(&n, p, sizeof(n));
+        out.append(p + sizeof(n), n);
+        return p + sizeof(n) + n;
     }
-    
-    template<typename... Args>
-    void debug(Args&&... args) { log(LogLevel::DEBUG, std::forward<Args>(args)...); }
-    
-    template<typename... Args>
-    void info(Args&&... args) { log(LogLevel::INFO, std::forward<Args>(args)...); }
-    
-    template<typename... Args>
-    void warn(Args&&... args) { log(LogLevel::WARN, std::forward<Args>(args)...); }
-    
-    template<typename... Args>
-    void error(Args&&... args) { log(LogLevel::ERROR, std::forward<Args>(args)...); }
-    
-    template<typename... Args>
-    void fatal(Args&&... args) { log(LogLevel::FATAL, std::forward<Args>(args)...); }
+};
+template <> struct Codec<std::string> : TextCodec {};
+template <> struct Codec<std::string_view> : TextCodec {};
+template <> struct Codec<const char*> : TextCodec {
+    static size_t size(const char* s) { return TextCodec::size(s ? s : ""); }
+    static char* encode(char* p, const char* s) { return TextCodec::encode(p, s ? s : ""); }
+};
+template <> struct Codec<char*> : Codec<const char*> {};
+
+template <typename T>
+const char* format_arg(std::string_view& fmt, const char* args, std::string& out) {
+    std::string_view spec;
+    if (!next_placeholder(fmt, out, spec)) out.push_back(' ');  // More arguments than placeholders
+    return Codec<T>::append(args, spec, out);
+}
+
+template <typename... Args>
+void format_record(std::string_view fmt, const char* args, std::string& out) {
+    ((args = format_arg<Args>(fmt, args, out)), ...);
+    (void)args;
+    std::string_view spec;
+    while (next_placeholder(fmt, out, spec)) out.append("{}");  // Placeholders left unfilled
+}
+
+template <typename... Args>
+void write(const Site& site, const Args&... args) {
+    if (site.level < runtime_level.load(std::memory_order_relaxed)) return;
+    size_t size = sizeof(RecordHeader) + (size_t{0} + ... + Codec<std::decay_t<Args>>::size(args));
+    size = (size + 7) & ~size_t{7};
+    char* p = reserve(size);
+    if (!p) return;
+    RecordHeader header{static_cast<uint32_t>(size), 0, &site, &format_record<std::decay_t<Args>...>, wall_now_ns()};
+    std::memcpy(p, &header, sizeof(header));
+    char* q = p + sizeof(header);
+    ((q = Codec<std::decay_t<Args>>::encode(q, args)), ...);
+    (void)q;
+    commit();
+}
+
+} // namespace log
+
+// Owns the background thread and the sinks
+class Logger {
+public:
+    static Logger& instance();
+
+    // Runtime threshold (calls compiled in but below it return at once);
+    // OFF silences everything
+    void set_level(LogLevel level) { log::runtime_level.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return log::runtime_level.load(std::memory_order_relaxed); }
+
+    // Also append every line to this file
+    void set_file(const std::string& path);
+    // Console output on (default) or off
+    void set_console(bool enabled) { console_.store(enabled, std::memory_order_relaxed); }
+
+    // Format and write everything logged so far; returns once it's out
+    void flush();
+    void stop();
+
+    // Records lost to full rings
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    struct ThreadBuffer;
+    ThreadBuffer& thread_buffer();
+    void count_drop() { dropped_.fetch_add(1, std::memory_order_relaxed); }
 
 private:
-    Logger() : level_(LogLevel::INFO) {}
-    
-    std::string level_to_string(LogLevel level) {
-        switch (level) {
-            case LogLevel::DEBUG: return "DEBUG";
-            case LogLevel::INFO:  return "INFO";
-            case LogLevel::WARN:  return "WARN";
-            case LogLevel::ERROR: return "ERROR";
-            case LogLevel::FATAL: return "FATAL";
-        }
-        return "UNKNOWN";
-    }
-    
-    LogLevel level_;
-    std::ofstream file_;
-    std::mutex mutex_;
+    Logger();
+    ~Logger();
+
+    void run();
+    void drain();
+
+    std::mutex buffers_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    std::mutex drain_mutex_;  // One drain at a time (background thread or flush)
+    std::FILE* file_ = nullptr;
+    std::atomic<bool> console_{true};
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread thread_;
 };
 
 } // namespace poly
 
+#define POLY_LOG(level, tag, fmt, ...)                                                           \
+    do {                                                                                         \
+        if constexpr (static_cast<int>(level) >= POLY_LOG_MIN_LEVEL) {                           \
+            static constexpr ::poly::log::Site poly_log_site_{level, tag, fmt};                  \
+            ::poly::log::write(poly_log_site_, ##__VA_ARGS__);                                   \
+        }                                                                                        \
+    } while (0)
+
+#define POLY_LOG_DEBUG(tag, fmt, ...) POLY_LOG(::poly::LogLevel::DEBUG, tag, fmt, ##__VA_ARGS__)
+#define POLY_LOG_INFO(tag, fmt, ...) POLY_LOG(::poly::LogLevel::INFO, tag, fmt, ##__VA_ARGS__)
+#define POLY_LOG_WARN(tag, fmt, ...) POLY_LOG(::poly::LogLevel::WARN, tag, fmt, ##__VA_ARGS__)
+#define POLY_LOG_ERROR(tag, fmt, ...) POLY_LOG(::poly::LogLevel::ERROR, tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "fixed_point.hpp"
+#include "token_registry.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace poly {
+
+// Messages produced by the market WebSocket feed. Tokens are interned
+// handles (token_registry.hpp); the parser drops assets nobody registered.
+// Book prices and sizes are fixed-point (fixed_point.hpp), parsed straight
+// from the wire decimals.
+
+enum class BookSide : uint8_t {
+    BID,  // "BUY" levels
+    ASK   // "SELL" levels
+};
+
+// Outcome of a binary market
+enum class Side : uint8_t {
+    UP,
+    DOWN
+};
+
+inline const char* side_name(Side side) { return side == Side::UP ? "UP" : "DOWN"; }
+inline Side opposite(Side side) { return side == Side::UP ? Side::DOWN : Side::UP; }
+
+// Monotonic stamps (latency::now_ns) of the WebSocket frame an update came
+// from; 0 when unknown. Carried through the engine queue for latency spans.
+struct FrameStamp {
+    uint64_t frame_ns = 0;   // Read returned
+    uint64_t parsed_ns = 0;  // Parse finished
+};
+
+struct PriceUpdate {
+    TokenId token = kNoToken;
+    double price = 0.0;
+    double best_bid = 0.0;
+    double best_ask = 0.0;
+    uint64_t timestamp = 0;
+    bool trade = false;  // last_trade_price: price is the latest fill
+};
+
+struct BookLevel {
+    Price price;
+    Qty size;
+};
+
+struct OrderbookUpdate {
+    TokenId token = kNoToken;
+    std::vector<BookLevel> bids;
+    std::vector<BookLevel> asks;
+    uint64_t timestamp = 0;  // Server ms, 0 if not sent
+    FrameStamp stamp;
+};
+
+// Single price-level change from a price_change message.
+// size is the new total at that level (0 removes it), not an increment.
+// has_top: the message also gave the token's best bid / ask after the
+// change (0 = that side empty), which the engine checks its book against.
+struct BookDelta {
+    TokenId token = kNoToken;
+    BookSide side = BookSide::BID;
+    bool has_top = false;
+    Price price;
+    Qty size;
+    Price best_bid;
+    Price best_ask;
+    uint64_t timestamp = 0;  // Server ms, 0 if not sent
+    FrameStamp stamp;
+};
+
+} // namespace poly
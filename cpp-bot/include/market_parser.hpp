@@ -0,0 +1,58 @@
+#pragma once
+
+#include "market_data.hpp"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace poly {
+
+// Schema-specific parser for the Polymarket market channel.
+//
+// Recognises the message shapes we actually receive (book arrays, single
+// book objects, price_changes, event_type: price_change, last_trade_price)
+// and scans them in place - no DOM, no temporary strings. price_change
+// entries also yield BookDelta level updates for the incremental book.
+// Output objects are owned by the parser and reused between messages, so
+// steady-state parsing does not allocate.
+//
+// Anything it is not sure about returns UNRECOGNIZED and nothing is emitted;
+// the caller falls back to nlohmann::json for those frames.
+class MarketMessageParser {
+public:
+    enum class Result {
+        PARSED,        // Fully handled (may have produced zero updates)
+        UNRECOGNIZED   // Unknown shape or unusual encoding - use the fallback
+    };
+
+    Result parse(std::string_view msg);
+
+    // Results of the last successful parse()
+    size_t book_count() const { return book_count_; }
+    const OrderbookUpdate& book(size_t i) const { return books_[i]; }
+    size_t price_count() const { return price_count_; }
+    const PriceUpdate& price(size_t i) const { return prices_[i]; }
+    size_t delta_count() const { return delta_count_; }
+    const BookDelta& delta(size_t i) const { return deltas_[i]; }
+
+    // Tag the last parse's books and deltas with their frame's timing
+    void stamp(const FrameStamp& stamp);
+
+    // Fixed-point decimal parse ("0.48", "1250.5"). Produces the same double
+    // as std::stod for plain decimals; false on anything else.
+    static bool parse_decimal(std::string_view text, double& out);
+
+private:
+    OrderbookUpdate& next_book();
+    PriceUpdate& next_price();
+    BookDelta& next_delta();
+
+    std::vector<OrderbookUpdate> books_;
+    std::vector<PriceUpdate> prices_;
+    std::vector<BookDelta> deltas_;
+    size_t book_count_ = 0;
+    size_t price_count_ = 0;
+    size_t delta_count_ = 0;
+};
+
+} // namespace poly
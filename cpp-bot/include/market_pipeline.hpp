@@ -0,0 +1,183 @@
+#pragma once
+
+#include "market_data.hpp"
+#include "spsc_ring.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace poly {
+
+// Hand-off between the WebSocket reader (producer) and the engine thread
+// (consumer), so a slow strategy - or an order in flight - never stops the
+// socket from being read.
+//
+// - Book snapshots conflate per token: each token owns a triple-buffered
+//   mailbox and only the latest snapshot is kept.
+// - Level deltas go through a lock-free SPSC ring in arrival order. Every
+//   event carries a sequence number; deltas older than the snapshot the
+//   engine last applied for that token are skipped as superseded.
+// - If the ring is full the delta is dropped and counted - the producer
+//   never blocks. The next snapshot for that token repairs the book.
+//
+// The consumer hands deltas to the engine in batches (everything that was
+// queued at the time), so the strategy is evaluated once per batch.
+//
+// Work that must see the books as the consumer does - REST resyncs, book
+// health checks - runs on the consumer thread too, between events: posted
+// from any thread, or on a timer.
+class MarketDataPipeline {
+public:
+    using SnapshotHandler = std::function<void(const OrderbookUpdate&)>;
+    using DeltaBatchHandler = std::function<void(const BookDelta* deltas, size_t count)>;
+    using Task = std::function<void()>;
+
+    static constexpr size_t kRingCapacity = 16384;
+    static constexpr size_t kMaxTokens = 64;  // Several series, each with a staged next market
+
+    struct Stats {
+        size_t queue_depth = 0;
+        size_t max_queue_depth = 0;
+        uint64_t snapshots_published = 0;
+        uint64_t deltas_published = 0;
+        uint64_t snapshots_conflated = 0;  // Overwritten before the engine saw them
+        uint64_t deltas_superseded = 0;    // Skipped - a newer snapshot was applied
+        uint64_t deltas_dropped = 0;       // Ring full
+        uint64_t tokens_dropped = 0;       // No free token slot
+        uint64_t batches = 0;
+    };
+
+    MarketDataPipeline() = default;
+    ~MarketDataPipeline();
+
+    MarketDataPipeline(const MarketDataPipeline&) = delete;
+    MarketDataPipeline& operator=(const MarketDataPipeline&) = delete;
+
+    // Set before start()
+    void set_snapshot_handler(SnapshotHandler handler) { snapshot_handler_ = std::move(handler); }
+    void set_delta_handler(DeltaBatchHandler handler) { delta_handler_ = std::move(handler); }
+    // Set before start(): runs on the consumer thread every `every`, busy or idle
+    void set_periodic(Task task, std::chrono::milliseconds every) {
+        periodic_ = std::move(task);
+        periodic_every_ = every;
+    }
+
+    // Set before start(). name shows up in logs and as the thread name;
+    // cpu >= 0 pins the consumer thread to that core.
+    void set_name(std::string name) { name_ = std::move(name); }
+    void set_cpu(int cpu) { cpu_ = cpu; }
+
+    void start();
+    void stop();
+
+    // Producer side - call from the WebSocket reader thread only
+    void publish_book(const OrderbookUpdate& update);
+    void publish_delta(const BookDelta& delta);
+
+    // Any thread: run `task` on the consumer thread after the events queued
+    // so far. Dropped if the pipeline stops first.
+    void post(Task task);
+
+    Stats stats() const;
+
+private:
+    enum class EventKind : uint8_t { SNAPSHOT, DELTA };
+
+    struct Event {
+        uint64_t seq;
+        Price price;
+        Qty size;
+        EventKind kind;
+        BookSide side;
+        uint8_t slot;
+        bool has_top;      // Deltas only, as BookDelta
+        FrameStamp stamp;  // Deltas only - snapshots carry theirs in the buffer
+        Price best_bid;
+        Price best_ask;
+        uint64_t timestamp;
+    };
+
+    struct SnapshotBuffer {
+        OrderbookUpdate book;
+        uint64_t seq = 0;
+    };
+
+    // Per-token state. Producer writes token/back/last_ring_seq and the
+    // buffer it owns; consumer owns front and applied_seq.
+    struct TokenSlot {
+        static constexpr uint8_t kDirty = 0x4;
+        static constexpr uint8_t kIndexMask = 0x3;
+
+        TokenId token = kNoToken;               // Only rewritten once fully consumed
+        std::array<SnapshotBuffer, 3> buffers;
+        std::atomic<uint8_t> middle{1};         // Buffer index | kDirty
+        uint8_t back = 0;                       // Producer
+        uint8_t front = 2;                      // Consumer
+
+        bool in_use = false;                    // Producer
+        bool notify_owed = false;               // Producer - snapshot event not yet queued
+        uint64_t last_ring_seq = 0;             // Producer - seq of last queued event
+        uint64_t last_used = 0;                 // Producer - LRU stamp
+        std::atomic<uint64_t> consumed_seq{0};  // Consumer - seq of last processed event
+
+        uint64_t applied_seq = 0;               // Consumer - seq of last applied snapshot
+    };
+
+    // Producer helpers
+    int slot_for(TokenId token);
+    bool push_event(TokenSlot& slot, const Event& ev);
+    bool flush_owed_notify(TokenSlot& slot, uint8_t index);
+    void wake_consumer();
+
+    // Consumer helpers
+    void run();
+    void handle_event(const Event& ev);
+    void flush_deltas();
+    void run_tasks();
+
+    SpscRing<Event, kRingCapacity> ring_;
+    std::array<TokenSlot, kMaxTokens> slots_;
+    uint64_t next_seq_ = 0;   // Producer
+    uint64_t use_clock_ = 0;  // Producer
+
+    // Consumer-owned delta batch
+    std::vector<BookDelta> batch_;
+    size_t batch_size_ = 0;
+
+    SnapshotHandler snapshot_handler_;
+    DeltaBatchHandler delta_handler_;
+    Task periodic_;
+    std::chrono::milliseconds periodic_every_{0};
+    std::chrono::steady_clock::time_point periodic_due_;  // Consumer
+
+    std::mutex tasks_mutex_;
+    std::vector<Task> tasks_;                 // Posted, not yet run
+    std::atomic<bool> tasks_pending_{false};
+    std::string name_ = "market-data";
+    int cpu_ = -1;
+
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> consumer_sleeping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    // Counters (single writer each, relaxed)
+    std::atomic<uint64_t> snapshots_published_{0};
+    std::atomic<uint64_t> deltas_published_{0};
+    std::atomic<uint64_t> snapshots_conflated_{0};
+    std::atomic<uint64_t> deltas_superseded_{0};
+    std::atomic<uint64_t> deltas_dropped_{0};
+    std::atomic<uint64_t> tokens_dropped_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<size_t> max_queue_depth_{0};
+};
+
+} // namespace poly
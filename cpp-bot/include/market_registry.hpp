@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace poly {
+
+class TradingEngine;
+class WebSocketPriceStream;
+
+// A rolling up/down series such as "btc-updown-15m": one market per
+// window, slug "<prefix>-<window start unix ts>".
+struct MarketSeries {
+    std::string prefix;
+    int64_t period_sec = 900;
+
+    int64_t window_start(int64_t now_sec) const { return (now_sec / period_sec) * period_sec; }
+    std::string slug_for(int64_t window_start) const { return prefix + "-" + std::to_string(window_start); }
+};
+
+// Period comes from the trailing interval token: "15m", "1h", "4h", "1d"
+bool parse_market_series(const std::string& prefix, MarketSeries& out);
+
+// "btc-updown-15m-1700000000" -> "btc-updown-15m", 1700000000
+bool split_market_slug(const std::string& slug, std::string& series_out, int64_t& window_start_out);
+
+struct MarketInfo {
+    std::string slug;
+    std::string question;
+    std::string up_token;
+    std::string down_token;
+};
+
+// Question and outcome token ids from Gamma (goes through the HTTP pool)
+bool fetch_market_info(const std::string& slug, MarketInfo& out);
+
+// Drives every configured series through its rollovers from one thread,
+// on one shared WebSocket: 20s before a window ends the next market is
+// fetched, subscribed and staged in the engine; at the boundary it is
+// promoted and the expired market's tokens are unsubscribed.
+class MarketRegistry {
+public:
+    using TokenHook = std::function<void(const std::string& token_id)>;
+    using SwitchHook = std::function<void(const MarketInfo& market, bool primary)>;
+    using MarketHook = std::function<void(const MarketInfo& market)>;
+
+    static constexpr int kPrefetchLeadSec = 20;
+
+    MarketRegistry(TradingEngine& engine, WebSocketPriceStream& ws);
+
+    MarketRegistry(const MarketRegistry&) = delete;
+    MarketRegistry& operator=(const MarketRegistry&) = delete;
+
+    // The first series added is the primary one (shown on the dashboard)
+    void add_series(const MarketSeries& series);
+    const MarketSeries& primary_series() const { return series_.front().series; }
+    size_t series_count() const { return series_.size(); }
+
+    // Called for each newly fetched token (e.g. tick size / fee rate warm-up)
+    void set_warm_hook(TokenHook hook) { warm_hook_ = std::move(hook); }
+    // Called after a market went live
+    void set_switch_hook(SwitchHook hook) { switch_hook_ = std::move(hook); }
+    // Called right before a market's tokens are subscribed (staged or live)
+    void set_subscribe_hook(MarketHook hook) { subscribe_hook_ = std::move(hook); }
+
+    // Call from the main loop: runs whatever pre-fetch / switch work is due
+    void tick();
+
+    // Until the nearest window boundary across all series
+    int64_t ms_until_next_switch() const;
+
+    std::vector<MarketInfo> active_markets() const;
+
+private:
+    struct SeriesState {
+        MarketSeries series;
+        int64_t current_window = 0;
+        MarketInfo current;
+        MarketInfo next;
+        bool next_ready = false;
+        int64_t next_retry_ms = 0;
+    };
+
+    void prefetch(SeriesState& state, int64_t window_start, int64_t now_ms);
+    void switch_window(SeriesState& state, int64_t window_start, int64_t now_ms, bool primary);
+
+    TradingEngine& engine_;
+    WebSocketPriceStream& ws_;
+    TokenHook warm_hook_;
+    SwitchHook switch_hook_;
+    MarketHook subscribe_hook_;
+    std::vector<SeriesState> series_;
+    mutable std::mutex mutex_;  // Guards the current markets for active_markets()
+};
+
+} // namespace poly
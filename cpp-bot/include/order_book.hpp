@@ -0,0 +1,97 @@
+#pragma once
+
+#include "market_data.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace poly {
+
+// Incremental L2 book for one token.
+//
+// Polymarket prices live on a 0.01 / 0.001 grid between 0 and 1, so each side
+// is a fixed array indexed by tick plus an occupancy bitmap. Sizes are kept
+// as integer micro-shares (Qty), so a side is one flat int64 array and
+// prices come back on the grid exactly. Snapshots and price_change deltas
+// are applied in place; best bid/ask are cached, and the bitmap makes "next
+// level" lookups a handful of word scans.
+class OrderBook {
+public:
+    static constexpr int kTicksPerUnit = 1000;   // 0.001 grid (0.01 markets fit too)
+    static constexpr int kMaxTick = kTicksPerUnit;
+    static constexpr int kNumLevels = kMaxTick + 1;
+    static constexpr int kNoTick = -1;
+    static constexpr int64_t kMicrosPerTick = Price::kScale / kTicksPerUnit;
+
+    // Nearest tick for a price, kNoTick if outside [0, 1]
+    static int price_to_tick(Price price);
+    static int price_to_tick(double price) {
+        return !(price >= 0.0) || price > 1.0 ? kNoTick : price_to_tick(Price::from_double(price));
+    }
+    static constexpr Price tick_to_price(int tick) { return Price::from_micros(tick * kMicrosPerTick); }
+
+    void clear();
+
+    // Replace the whole book (levels need not be sorted)
+    void apply_snapshot(const std::vector<BookLevel>& bids, const std::vector<BookLevel>& asks);
+
+    // Set one level to its new size (0 removes it). False if the price is off the grid.
+    bool apply_delta(BookSide side, Price price, Qty size);
+    void set_level(BookSide side, int tick, Qty size);
+
+    bool empty() const { return bids_.count == 0 && asks_.count == 0; }
+    size_t depth(BookSide side) const { return book_side(side).count; }
+
+    // Level navigation, best first. kNoTick when exhausted.
+    int best_tick(BookSide side) const { return book_side(side).best; }
+    int next_tick(BookSide side, int tick) const;
+    Qty size_at(BookSide side, int tick) const { return Qty::from_micros(book_side(side).size[tick]); }
+
+    // Best prices with the engine's conventions: no bid = 0, no ask = 1
+    Price best_bid() const {
+        return bids_.best == kNoTick ? Price{} : tick_to_price(bids_.best);
+    }
+    Price best_ask() const {
+        return asks_.best == kNoTick ? Price::from_units(1) : tick_to_price(asks_.best);
+    }
+
+    // Visit up to max_levels levels, best first: f(price, size)
+    template <typename F>
+    void for_each_level(BookSide side, size_t max_levels, F&& f) const {
+        size_t n = 0;
+        for (int t = best_tick(side); t != kNoTick && n < max_levels; t = next_tick(side, t), ++n) {
+            f(tick_to_price(t), size_at(side, t));
+        }
+    }
+
+    // Append up to n levels (best first) as (price, size) pairs, for display
+    void top_levels(BookSide side, size_t n, std::vector<std::pair<double, double>>& out) const;
+
+    // Bumped on every change
+    uint64_t version() const { return version_; }
+
+private:
+    static constexpr int kWords = (kNumLevels + 63) / 64;
+
+    struct Side {
+        std::array<int64_t, kNumLevels> size{};  // Qty micros
+        std::array<uint64_t, kWords> occupied{};
+        int best = kNoTick;
+        uint32_t count = 0;
+    };
+
+    Side& book_side(BookSide side) { return side == BookSide::BID ? bids_ : asks_; }
+    const Side& book_side(BookSide side) const { return side == BookSide::BID ? bids_ : asks_; }
+
+    static void clear_side(Side& s);
+    static int highest_at_or_below(const Side& s, int tick);
+    static int lowest_at_or_above(const Side& s, int tick);
+
+    Side bids_;
+    Side asks_;
+    uint64_t version_ = 0;
+};
+
+} // namespace poly
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "market_data.hpp"
+#include "polymarket_client.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace poly {
+
+enum class OrderState {
+    PENDING_NEW,       // Handed to the manager, not yet answered by the exchange
+    ACKED,             // Accepted, resting
+    PARTIALLY_FILLED,
+    FILLED,
+    CANCELLED,
+    REJECTED
+};
+
+const char* order_state_name(OrderState state);
+inline bool is_terminal(OrderState state) {
+    return state == OrderState::FILLED || state == OrderState::CANCELLED || state == OrderState::REJECTED;
+}
+
+struct OrderRequest {
+    std::string market_slug;
+    Side side = Side::UP;  // Outcome bought
+    TokenId token = kNoToken;
+    int leg = 1;
+    double shares = 0.0;
+    double price = 0.0;    // Limit
+    bool live = false;     // Mode at decision time - paper orders never leave the process
+    uint64_t frame_ns = 0;     // Latency stamps of the tick that triggered it
+    uint64_t decision_ns = 0;
+};
+
+struct ManagedOrder {
+    uint64_t id = 0;           // Ours, assigned at submit
+    std::string exchange_id;   // Known once acked
+    OrderRequest request;
+    OrderState state = OrderState::PENDING_NEW;
+    double filled_shares = 0.0;
+    double avg_fill_price = 0.0;
+    std::string error;
+};
+
+// Owns every order between the strategy deciding on it and the exchange
+// settling it.
+//
+// submit() only queues the order and returns its id - the strategy thread
+// never waits on the network. Worker threads send it through the executor
+// and turn the response into state transitions (PENDING_NEW -> ACKED ->
+// PARTIALLY_FILLED -> FILLED, or CANCELLED / REJECTED). Fills and cancels
+// reported later by the exchange advance the same state machine.
+//
+// The completion callback fires on every transition after PENDING_NEW, on
+// the thread that caused it (a worker, or the caller of on_exchange_*),
+// never under the manager's lock - so it may take the caller's locks and
+// submit follow-up orders. Terminal orders are forgotten after their
+// callback.
+class OrderManager {
+public:
+    // Result status "matched" = filled in full on arrival; "killed" =
+    // fill-and-kill, filled_amount crossed and the rest is cancelled
+    using Executor = std::function<OrderResult(const OrderRequest& request)>;
+    using Canceller = std::function<bool(const ManagedOrder& order)>;
+    using Callback = std::function<void(const ManagedOrder& order)>;
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t acked = 0;
+        uint64_t filled = 0;
+        uint64_t cancelled = 0;
+        uint64_t rejected = 0;
+        size_t in_flight = 0;
+    };
+
+    explicit OrderManager(size_t workers = 4);
+    ~OrderManager();
+
+    OrderManager(const OrderManager&) = delete;
+    OrderManager& operator=(const OrderManager&) = delete;
+
+    // Set before start()
+    void set_executor(Executor executor) { executor_ = std::move(executor); }
+    void set_canceller(Canceller canceller) { canceller_ = std::move(canceller); }
+
+    void start();
+    // Manual mode (backtests): no worker threads - queued work runs on the
+    // caller's thread in run_pending(), in submission order
+    void start_manual();
+    // Queued submissions and cancels are still carried out
+    void stop();
+    
+    // Manual mode: run everything queued, including work queued meanwhile.
+    // Returns the number of jobs run.
+    size_t run_pending();
+
+    // Fire-and-forget. Returns the order id; 0 if the manager isn't running.
+    uint64_t submit(const OrderRequest& request, Callback on_update);
+
+    // Asynchronous; false if the order is unknown or already terminal
+    bool cancel(uint64_t id);
+    
+    // An order still working on the exchange from before a restart: acked
+    // (exchange_id set), perhaps partly filled. It takes a new id and is
+    // reported on like any other. Any time, running or not; 0 if it has no
+    // exchange id or is already terminal.
+    uint64_t adopt(const ManagedOrder& order, Callback on_update);
+
+    // Exchange-side reports, keyed by the exchange's order id.
+    // filled_total is cumulative for the order.
+    void on_exchange_fill(const std::string& exchange_id, double filled_total, double avg_price);
+    void on_exchange_cancel(const std::string& exchange_id);
+    
+    // One execution from the user channel: exact size and price, deduped by
+    // trade id. Trades and cumulative (REST) totals don't add up - the order
+    // is as filled as the larger of the two says. Reports for an exchange id
+    // we haven't been acked with yet are held until the ack lands.
+    void on_exchange_trade(const std::string& exchange_id, const std::string& trade_id,
+                           double shares, double price);
+
+    std::optional<ManagedOrder> find(uint64_t id) const;
+    std::vector<ManagedOrder> open_orders() const;
+    Stats stats() const;
+
+private:
+    enum class JobKind { SUBMIT, CANCEL };
+    struct Job {
+        JobKind kind;
+        uint64_t id;
+    };
+    struct Entry {
+        ManagedOrder order;
+        Callback on_update;
+        bool cancel_requested = false;
+        // Executions seen on the user channel
+        std::unordered_set<std::string> trade_ids;
+        double traded_shares = 0.0;
+        double traded_notional = 0.0;
+    };
+    // Report that raced ahead of the REST ack carrying its exchange id
+    struct EarlyReport {
+        bool cancel = false;
+        std::string trade_id;
+        double shares = 0.0;
+        double price = 0.0;
+        std::chrono::steady_clock::time_point received;
+    };
+
+    void run_worker();
+    void execute(uint64_t id);
+    void execute_cancel(uint64_t id);
+
+    // Apply `mutate` to the order under the lock, then report it. No-op if
+    // the order is gone or already terminal, or if mutate returns false.
+    void transition(uint64_t id, const std::function<bool(ManagedOrder&)>& mutate);
+    
+    // Under mutex_: the order id for an exchange id, or hold `report` for
+    // later and return 0
+    uint64_t resolve_or_hold(const std::string& exchange_id, EarlyReport report);
+
+    size_t worker_count_;
+    Executor executor_;
+    Canceller canceller_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    std::unordered_map<uint64_t, Entry> orders_;
+    std::unordered_map<std::string, uint64_t> by_exchange_id_;
+    std::unordered_map<std::string, std::vector<EarlyReport>> early_reports_;
+    uint64_t next_id_ = 0;
+    bool running_ = false;
+    bool manual_ = false;
+    std::vector<std::thread> workers_;
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> acked_{0};
+    std::atomic<uint64_t> filled_{0};
+    std::atomic<uint64_t> cancelled_{0};
+    std::atomic<uint64_t> rejected_{0};
+};
+
+} // namespace poly
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "fixed_point.hpp"
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace poly {
+
+// Running PnL by market, by cycle and by time bucket.
+//
+// The engine books every fill, realized amount and finished cycle as it
+// happens, and marks equity and unrealized PnL whenever it publishes a
+// status snapshot. Each booking touches the market's totals and the
+// current bucket of each rollup (1m, 15m, 1h, 1d) - O(1), no rescans -
+// so the API reads aggregates straight off. Buckets live in fixed rings;
+// the oldest fall off once a ring is full. Amounts are fixed-point, times
+// wall-clock ms.
+class PnlLedger {
+public:
+    enum class Resolution : uint8_t { MINUTE, QUARTER, HOUR, DAY };
+    static constexpr size_t kResolutions = 4;
+    static constexpr size_t kMaxCycles = 1000;  // Finished cycles kept for /api/cycles
+
+    struct Bucket {
+        int64_t start_ms = 0;
+        Price realized;        // Booked in this bucket
+        Price volume;          // Fill notional
+        uint32_t fills = 0;
+        uint32_t cycles_completed = 0;
+        uint32_t cycles_abandoned = 0;
+        // Marks (equity) and running totals at the bucket's last booking
+        Price equity_open;
+        Price equity_high;
+        Price equity_low;
+        Price equity_close;
+        Price cash;
+        Price unrealized;
+        Price realized_total;
+        bool marked = false;   // Has an equity mark
+    };
+
+    struct MarketPnl {
+        std::string slug;
+        Price realized;
+        Price unrealized;      // Last mark
+        Price volume;
+        uint32_t fills = 0;
+        uint32_t cycles_completed = 0;
+        uint32_t cycles_abandoned = 0;
+        Price best_cycle;
+        Price worst_cycle;
+        int64_t last_ms = 0;
+    };
+
+    struct CyclePnl {
+        std::string id;
+        std::string market_slug;
+        std::string status;    // "complete" or "incomplete"
+        std::string leg1_side;
+        double leg1_price = 0.0;
+        double leg1_shares = 0.0;
+        std::string leg2_side;
+        double leg2_price = 0.0;
+        double leg2_shares = 0.0;
+        Price total_cost;
+        Price pnl;
+        int64_t started_ms = 0;
+        int64_t ended_ms = 0;
+    };
+
+    struct Totals {
+        Price realized;        // Booked since start, plus restored history
+        Price unrealized;
+        Price equity;
+        Price cash;
+        Price volume;
+        uint64_t fills = 0;
+        uint64_t cycles_completed = 0;
+        uint64_t cycles_abandoned = 0;
+        int64_t marked_ms = 0;
+    };
+
+    // An equity point to persist: each minute bucket, once it closes
+    struct EquityPoint {
+        int64_t ts_ms = 0;
+        Price equity;
+        Price cash;
+        Price unrealized;
+        Price realized;
+    };
+
+    PnlLedger();
+
+    PnlLedger(const PnlLedger&) = delete;
+    PnlLedger& operator=(const PnlLedger&) = delete;
+
+    static int64_t width_ms(Resolution resolution);
+    static const char* name(Resolution resolution);  // "1m", "15m", "1h", "1d"
+    static bool parse_resolution(const std::string& text, Resolution& out);
+
+    // Bookings - any thread
+    void add_fill(const std::string& slug, Price cost, int64_t ts_ms);
+    void add_realized(const std::string& slug, Price pnl, int64_t ts_ms);
+    // Counts the cycle; its PnL was booked by add_realized as it filled
+    void add_cycle(const CyclePnl& cycle);
+
+    // Status publisher: the engine's equity now, and each market's
+    // unrealized PnL. Returns the minute buckets closed since the last
+    // mark, oldest first - by this mark or by any booking before it.
+    std::vector<EquityPoint> mark(int64_t ts_ms, Price cash, Price equity, Price unrealized,
+                                  const std::vector<std::pair<std::string, Price>>& markets);
+
+    // History from the database, before trading starts: cycles oldest
+    // first, then the equity points persisted by earlier runs
+    void restore(const std::vector<CyclePnl>& cycles, const std::vector<EquityPoint>& equity);
+
+    void reset();
+
+    // Readers: copies, oldest first; limit 0 = all kept
+    Totals totals() const;
+    std::vector<MarketPnl> markets() const;
+    std::vector<CyclePnl> cycles(size_t limit = 0) const;  // Newest `limit`
+    std::vector<Bucket> rollup(Resolution resolution, size_t limit = 0) const;
+
+private:
+    struct Ring {
+        std::vector<Bucket> buckets;  // Fixed capacity
+        size_t head = 0;              // Current bucket
+        size_t count = 0;
+    };
+
+    // The bucket ts_ms falls in, opened (rolling the ring) if it's new; nullptr if too old.
+    // A marked minute bucket it closes goes to closed_minutes_.
+    Bucket* bucket_at(Ring& ring, Resolution resolution, int64_t ts_ms);
+    MarketPnl& market(const std::string& slug);
+    void add_realized_locked(const std::string& slug, Price pnl, int64_t ts_ms);
+    void mark_bucket(Bucket& bucket, Price equity);
+
+    mutable std::mutex mutex_;
+    Totals totals_;
+    std::array<Ring, kResolutions> rings_;
+    std::unordered_map<std::string, MarketPnl> markets_;
+    std::vector<std::string> open_markets_;  // Nonzero unrealized at the last mark
+    std::deque<CyclePnl> cycles_;
+    std::vector<EquityPoint> closed_minutes_;  // Not yet handed out by mark()
+};
+
+} // namespace poly
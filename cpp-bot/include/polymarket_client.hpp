@@ -1,8 +1,13 @@
 #pragma once
 
+#include "clob_order.hpp"
+#include "http_pool.hpp"
+#include <atomic>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 
 namespace poly {
@@ -27,7 +32,7 @@ struct Orderbook {
     std::string asset_id;
     std::vector<OrderbookLevel> bids;
     std::vector<OrderbookLevel> asks;
-    uint64_t timestamp;
+    uint64_t timestamp = 0;  // Server ms
 };
 
 // ============ LIVE TRADING RESULT TYPES ============
@@ -60,6 +65,12 @@ struct PositionsResult {
     std::string error;
 };
 
+// How live orders are sent
+enum class ExecutorMode {
+    NATIVE,  // In-process EIP-712 signing + direct REST calls to the CLOB
+    PYTHON   // Fork scripts/order_executor.py (py-clob-client) per call
+};
+
 class PolymarketClient {
 public:
     explicit PolymarketClient(
@@ -70,6 +81,12 @@ public:
     // Set path to Python order executor script
     void set_executor_path(const std::string& path);
     
+    void set_executor_mode(ExecutorMode mode);
+    ExecutorMode executor_mode() const { return executor_mode_; }
+    
+    // Fetch tick size / fee rate / neg-risk for a token ahead of the first order
+    void warm_market(const std::string& token_id);
+    
     // ============ MARKET DATA (Read-Only) ============
     
     // Market discovery
@@ -96,12 +113,32 @@ public:
         double size
     );
     
+    // Pre-signed BUY orders (native mode), so a hedge is only picked and
+    // posted. Replaces the token's set with `size` shares at max_price
+    // (snapped down to the tick) and the next steps - 1 ticks below it;
+    // returns how many were signed. A place_order() with the same token,
+    // size and price sends the matching one, once - each carries its own salt.
+    size_t presign_buys(const std::string& token_id, double size, double max_price, int steps);
+    void drop_presigned(const std::string& token_id);
+    
+    struct PresignStats {
+        uint64_t signed_ahead = 0;
+        uint64_t hits = 0;    // Orders sent pre-signed
+        uint64_t misses = 0;  // Token had a set, but not for this size/price
+    };
+    PresignStats presign_stats() const;
+    
     // Cancel an order
     bool cancel_order(const std::string& order_id);
     
     // Cancel all open orders
     bool cancel_all_orders();
     
+    // One order's state on the exchange (native executor): status as the
+    // CLOB reports it (LIVE, MATCHED, CANCELED, ...), filled_amount the
+    // shares matched so far, price its limit
+    OrderResult get_order(const std::string& order_id);
+    
     // ============ ACCOUNT DATA ============
     
     // Get USDC balance
@@ -116,7 +153,9 @@ public:
 private:
     std::string api_url_;
     std::string gamma_url_;
+    std::string data_url_ = "https://data-api.polymarket.com";
     std::string executor_path_ = "scripts/order_executor.py";
+    ExecutorMode executor_mode_ = ExecutorMode::NATIVE;
     
     // HTTP request helpers
     json http_get(const std::string& url);
@@ -124,6 +163,43 @@ private:
     
     // Execute Python script for live trading
     json execute_python(const std::string& args);
+    
+    // ============ NATIVE EXECUTOR ============
+    
+    // CLOB request with L2 (API key HMAC) headers; path includes any query
+    HttpPool::Response clob_request(const std::string& method, const std::string& path, const std::string& body);
+    
+    // Load key + API credentials from the environment (once)
+    bool ensure_native(std::string& error);
+    ClobMarketParams market_params(const std::string& token_id);
+    OrderResult native_order(const std::string& token_id, const std::string& side,
+                             double size, double price, const char* order_type);
+    
+    std::mutex native_mutex_;
+    bool native_loaded_ = false;
+    std::string native_error_;
+    crypto::Secp256k1Signer signer_;
+    ClobOrderBuilder order_builder_{signer_};
+    std::string api_key_;
+    std::vector<uint8_t> api_secret_;
+    std::string api_passphrase_;
+    
+    std::mutex params_mutex_;
+    std::unordered_map<std::string, ClobMarketParams> market_params_;
+    
+    // POST /order bodies, signed ahead of time (GTC BUY), by token
+    struct PresignedSet {
+        int64_t size_cents = 0;
+        double tick_size = 0.01;
+        std::unordered_map<int64_t, std::string> bodies;  // Price ticks -> body
+    };
+    bool take_presigned(const std::string& token_id, double size, double price, std::string& body);
+    
+    std::mutex presign_mutex_;
+    std::unordered_map<std::string, PresignedSet> presigned_;
+    std::atomic<uint64_t> presigned_count_{0};
+    std::atomic<uint64_t> presign_hits_{0};
+    std::atomic<uint64_t> presign_misses_{0};
 };
 
 } // namespace poly
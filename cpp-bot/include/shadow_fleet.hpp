@@ -0,0 +1,111 @@
+#pragma once
+
+#include "trading_engine.hpp"
+#include "work_stealing_pool.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace poly {
+
+// Paper strategies trading alongside the primary engine on its ticks.
+//
+// Each shadow is a TradingEngine of its own - own books, positions and
+// ledger, paper only, run inline (no threads of its own). The primary
+// engine hands every book update it has applied to publish_*, and the
+// markets it registers to the registry calls, from its shard threads and
+// outside its locks. Each event is copied once and queued on every shadow;
+// a shadow's queue drains in order on the fleet's pool, one task per shadow
+// at a time, so shadows run in parallel with each other and the primary
+// never waits on them. A shadow that falls kMaxQueued events behind drops
+// book updates (counted) until it catches up; the next snapshot repairs
+// its books.
+class ShadowFleet {
+public:
+    static constexpr size_t kMaxQueued = 8192;  // Book events per shadow
+
+    struct Summary {
+        std::string name;
+        std::string strategy;
+        std::shared_ptr<const EngineStatus> status;
+        uint64_t events = 0;   // Book updates applied
+        uint64_t dropped = 0;  // Book updates dropped - queue full
+        size_t queued = 0;
+    };
+
+    // 0 threads: one per core
+    explicit ShadowFleet(size_t threads = 1);
+    ~ShadowFleet();
+
+    ShadowFleet(const ShadowFleet&) = delete;
+    ShadowFleet& operator=(const ShadowFleet&) = delete;
+
+    // Before start(). Shadows never trade live; the clock defaults to the
+    // system clock, like the engine's.
+    void add(const std::string& name, const Config& config);
+    void set_clock(TradingEngine::Clock clock) { clock_ = std::move(clock); }
+
+    void start();
+    // Drains what is queued, then stops the shadows. Stop the primary
+    // engine first - nothing may publish after this.
+    void stop();
+    // Until every event queued so far is applied (replays)
+    void wait();
+
+    bool empty() const { return shadows_.empty(); }
+    size_t size() const { return shadows_.size(); }
+
+    // Producer side - the primary engine
+    void publish_snapshot(TokenId token, const std::vector<BookLevel>& bids, const std::vector<BookLevel>& asks,
+                          std::chrono::system_clock::time_point timestamp);
+    void publish_deltas(const BookDelta* deltas, size_t count);
+    void stage_market(const std::string& slug, const std::string& up_token, const std::string& down_token);
+    void activate_market(const std::string& slug);
+    void retire_market(const std::string& slug);
+
+    std::vector<Summary> summaries() const;
+
+private:
+    struct Event {
+        enum class Kind : uint8_t { SNAPSHOT, DELTAS, STAGE, ACTIVATE, RETIRE };
+        Kind kind = Kind::SNAPSHOT;
+        TokenId token = kNoToken;
+        std::shared_ptr<const OrderbookSnapshot> snapshot;
+        std::shared_ptr<const std::vector<BookDelta>> deltas;
+        std::shared_ptr<const std::vector<std::string>> market;  // slug [, up token, down token]
+    };
+
+    struct Shadow {
+        std::string name;
+        std::unique_ptr<TradingEngine> engine;
+
+        mutable std::mutex mutex;  // Guards queue and scheduled
+        std::vector<Event> queue;
+        size_t book_events = 0;    // Book events in queue
+        bool scheduled = false;    // A drain task is queued or running
+
+        std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    void push(const Event& event);
+    void drain(Shadow& shadow);
+    static void apply(Shadow& shadow, const Event& event);
+
+    size_t threads_;
+    TradingEngine::Clock clock_;
+    std::vector<std::unique_ptr<Shadow>> shadows_;  // Fixed once started
+    std::unique_ptr<WorkStealingPool> pool_;
+    std::atomic<bool> running_{false};
+};
+
+// --shadow=NAME:key=value,... on top of `base`. Keys: move, sum, shares,
+// window, dump, dca (on|off), breakeven (on|off). False with `error` set on
+// a bad spec.
+bool parse_shadow_spec(const std::string& spec, const Config& base, std::string& name, Config& out,
+                       std::string& error);
+
+} // namespace poly
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "book_view.hpp"
+#include "dump_detector.hpp"
+#include "fixed_point.hpp"
+#include <memory>
+#include <string>
+
+namespace poly {
+
+struct Config;
+
+// The strategy's per-tick decision core, compile-time composed.
+//
+// StrategyEngine<Entry, Hedge, Execution> turns one market's tick into a
+// Decision. Each policy is a stateless struct of static functions, so an
+// instantiation is straight-line code: no config branches, and thresholds
+// converted to fixed point once, when the strategy is built. TradingEngine
+// holds the instantiation its Config and trading mode select behind the
+// Strategy interface - one virtual call per tick - and swaps it when either
+// changes. evaluate() only reads the tick, so any number of strategies can
+// decide on the same tick side by side.
+
+// Config in strategy units
+struct StrategyParams {
+    Price move;                 // Entry: an ask below this
+    Price sum_target;           // Hedge: leg 1 avg cost + opposite ask
+    double dump_drop = 0.0;     // Entry: drop off a recent high (0 = off)
+    int trade_window_sec = 0;   // Trades only in the window's first seconds
+    Qty shares;                 // Leg 1 size
+    int book_stale_ms = 0;      // Books confirmed within this, else no entries (0 = no limit)
+};
+
+// One market at one tick, as the strategy sees it
+struct MarketTick {
+    const std::string* slug = nullptr;
+    MergedBookView up;
+    MergedBookView down;
+    DumpDetector* dumps = nullptr;  // Fed by the caller before evaluate
+    int64_t now_ms = 0;
+    int secs_into_window = 0;
+    int64_t secs_since_cycle = 0;   // Since the market's last completed cycle
+
+    // Open leg and orders in flight
+    bool has_position = false;
+    Side position_side = Side::UP;
+    Price position_cost{};          // Leg 1 average cost
+    bool position_filled = false;   // false: acked, fill not confirmed yet
+    bool entry_in_flight = false;
+    bool hedge_in_flight = false;
+    bool dca_in_flight = false;
+    bool book_stale = false;        // A book is too old or failed its feed check - no entries or adds
+};
+
+struct Decision {
+    enum class Action : uint8_t {
+        NONE,
+        ENTER,     // Buy `shares` of `side` at `price`
+        HEDGE,     // Buy the open leg's shares of `side` at `price`
+        SCALE_IN   // Take the DCA levels the open leg's ask crossed
+    };
+    Action action = Action::NONE;
+    bool checked = false;  // An entry or hedge check ran (decision latency)
+    Side side = Side::UP;
+    Price price;
+    Qty shares;
+    DumpDetection dump{};  // ENTER on a dump: the drop it fired on (detected set)
+};
+
+// ============ ENTRY POLICIES ============
+
+// Either side's effective ask below `move`
+struct ThresholdEntry {
+    static constexpr const char* kName = "threshold";
+
+    static bool enter(const StrategyParams& params, const MarketTick& tick, Decision& out) {
+        Price up_ask = tick.up.best_ask();
+        if (up_ask < params.move) {
+            out.side = Side::UP;
+            out.price = up_ask;
+            return true;
+        }
+        Price down_ask = tick.down.best_ask();
+        if (down_ask < params.move) {
+            out.side = Side::DOWN;
+            out.price = down_ask;
+            return true;
+        }
+        return false;
+    }
+};
+
+// The threshold, or a fast drop from a recent high over any dump window
+struct DumpEntry {
+    static constexpr const char* kName = "threshold+dump";
+
+    static bool enter(const StrategyParams& params, const MarketTick& tick, Decision& out) {
+        if (ThresholdEntry::enter(params, tick, out)) return true;
+
+        DumpDetection dump = tick.dumps->detect_dump(params.dump_drop, tick.now_ms);
+        if (!dump.detected) return false;
+        out.side = dump.side;
+        out.price = dump.to_price;
+        out.dump = dump;
+        return true;
+    }
+};
+
+// ============ HEDGE POLICIES ============
+
+// Hedge once leg 1 + the opposite ask is within the sum target. BreakEven
+// takes a sum right at the target; strict mode (breakeven_enabled off) needs
+// it below, so a strict shadow never hedges for zero edge. ScaleIn adds
+// to the leg at its DCA levels while it isn't hedgeable.
+template <bool BreakEven, bool ScaleIn>
+struct SumTargetHedge {
+    static constexpr const char* kName = BreakEven ? (ScaleIn ? "breakeven+dca" : "breakeven")
+                                                   : (ScaleIn ? "strict+dca" : "strict");
+    static constexpr bool kScaleIn = ScaleIn;
+
+    static bool hedge(const StrategyParams& params, const MarketTick& tick, Price& price_out) {
+        const auto& opposite_book = tick.position_side == Side::UP ? tick.down : tick.up;
+        Price opposite_ask = opposite_book.best_ask();
+        Price sum = tick.position_cost + opposite_ask;
+        bool ok = BreakEven ? sum <= params.sum_target : sum < params.sum_target;
+        if (ok) price_out = opposite_ask;
+        return ok;
+    }
+};
+
+// ============ EXECUTION POLICIES ============
+
+// Where the strategy's orders go. The choice travels on each OrderRequest
+// (live), so an order queued before a mode switch still goes where it was
+// decided.
+struct PaperExecution {
+    static constexpr const char* kName = "paper";
+    static constexpr bool kLive = false;  // Filled against the book (fill_model.hpp)
+};
+
+struct LiveExecution {
+    static constexpr const char* kName = "live";
+    static constexpr bool kLive = true;   // Polymarket CLOB
+};
+
+// ============ STRATEGY ============
+
+class Strategy {
+public:
+    explicit Strategy(const StrategyParams& params) : params_(params) {}
+    virtual ~Strategy() = default;
+
+    virtual Decision evaluate(const MarketTick& tick) const = 0;
+    virtual bool live() const = 0;
+    virtual std::string name() const = 0;  // "entry/hedge/execution"
+
+    const StrategyParams& params() const { return params_; }
+
+protected:
+    StrategyParams params_;
+};
+
+template <typename Entry, typename Hedge, typename Execution>
+class StrategyEngine final : public Strategy {
+public:
+    using Strategy::Strategy;
+
+    Decision evaluate(const MarketTick& tick) const override {
+        Decision decision;
+
+        // Trade in the FIRST trade_window_sec seconds of the window
+        if (tick.secs_into_window < 0 || tick.secs_into_window > params_.trade_window_sec) return decision;
+
+        if (!tick.has_position) {
+            // No new positions on a stale book or in the last 5 seconds of
+            // the trading window, and at least 5 seconds between cycles.
+            // Hedges still go out on a stale book - they close risk.
+            if (tick.entry_in_flight || tick.book_stale || tick.secs_into_window >= params_.trade_window_sec - 5 ||
+                tick.secs_since_cycle < 5) {
+                return decision;
+            }
+            decision.checked = true;
+            if (Entry::enter(params_, tick, decision)) {
+                decision.action = Decision::Action::ENTER;
+                decision.shares = params_.shares;
+            }
+            return decision;
+        }
+
+        // Only once leg 1 has filled - an acked leg may still end short or
+        // unfilled. A DCA add in flight is waited for, so the hedge covers
+        // all of leg 1.
+        if (!tick.position_filled || tick.hedge_in_flight || tick.dca_in_flight) return decision;
+        decision.checked = true;
+        if (Hedge::hedge(params_, tick, decision.price)) {
+            decision.action = Decision::Action::HEDGE;
+            decision.side = opposite(tick.position_side);
+        } else if (Hedge::kScaleIn && !tick.book_stale) {
+            decision.action = Decision::Action::SCALE_IN;
+            decision.side = tick.position_side;
+            decision.price = tick.position_side == Side::UP ? tick.up.best_ask() : tick.down.best_ask();
+        }
+        return decision;
+    }
+
+    bool live() const override { return Execution::kLive; }
+
+    std::string name() const override {
+        return std::string(Entry::kName) + "/" + Hedge::kName + "/" + Execution::kName;
+    }
+};
+
+// The instantiation a Config selects: dump entries when dump_drop > 0,
+// breakeven_enabled and dca_enabled pick the hedge, `live` the execution
+std::shared_ptr<const Strategy> make_strategy(const Config& config, bool live);
+
+} // namespace poly
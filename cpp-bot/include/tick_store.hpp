@@ -0,0 +1,230 @@
+#pragma once
+
+#include "market_data.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace poly {
+
+// Top-of-book history, one columnar file per market slug:
+//
+//   <dir>/<slug>.ticks      book rows, both tokens of the market
+//   <dir>/_equity.ticks     engine equity rows
+//
+// A file is the 8-byte magic "POLYTCK1", a uint32 length and a JSON header
+// (slug, kind, token ids, column count), then blocks of
+// [TickBlockHeader][payload]. A block holds up to block_rows rows stored
+// column by column; each column is the zigzag varint of every value's
+// difference from the row before, and the whole payload is deflated.
+// Prices, sizes and amounts are fixed-point micros, timestamps wall-clock
+// ms. Append-only; a torn block at the tail (crash mid-write) is ignored.
+constexpr char kTickMagic[8] = {'P', 'O', 'L', 'Y', 'T', 'C', 'K', '1'};
+constexpr size_t kTickDepth = 5;  // Levels kept per book side
+
+struct TickBlockHeader {
+    uint32_t rows;
+    uint16_t columns;
+    uint16_t flags;         // kTickBlockDeflated
+    uint32_t raw_bytes;     // Payload before compression
+    uint32_t stored_bytes;  // Payload as written
+    int64_t first_ms;       // Row timestamps, so a query skips blocks unread
+    int64_t last_ms;
+};
+static_assert(sizeof(TickBlockHeader) == 32, "tick block header layout");
+constexpr uint16_t kTickBlockDeflated = 1;
+
+// One token's book as the strategy saw it (merged views, best level
+// first). Levels past the book's depth have size 0.
+struct TickRow {
+    int64_t ts_ms = 0;
+    Side side = Side::UP;
+    Price last_trade;  // Feed's last trade price; 0 until there is one
+    std::array<BookLevel, kTickDepth> bids{};
+    std::array<BookLevel, kTickDepth> asks{};
+
+    // Engine conventions: no bid = 0, no ask = 1
+    Price best_bid() const { return bids[0].size.positive() ? bids[0].price : Price{}; }
+    Price best_ask() const { return asks[0].size.positive() ? asks[0].price : Price::from_units(1); }
+};
+
+struct EquityRow {
+    int64_t ts_ms = 0;
+    Price equity;
+    Price cash;
+    Price unrealized;
+    Price realized;
+};
+
+// One market's books, as TradingEngine::sample_books copies them
+struct BookSample {
+    std::string slug;
+    std::string up_token_id;
+    std::string down_token_id;
+    TokenId up_token = kNoToken;
+    TokenId down_token = kNoToken;
+    uint64_t version = 0;  // Both books' change counters; equal = unchanged
+    TickRow up;
+    TickRow down;
+};
+
+// "<dir>/<slug>.ticks"
+std::string tick_file_path(const std::string& dir, const std::string& slug);
+// Slugs with a tick file under dir, sorted ("_equity" included)
+std::vector<std::string> list_tick_files(const std::string& dir);
+
+// Samples the engine every interval_ms on a thread of its own, keeps the
+// rows whose book or last trade moved, and writes each file's rows out as
+// a block once block_rows have built up or the oldest is flush_ms old. The
+// engine's shard threads never wait on it: sampling takes each shard's
+// lock for one copy of its top levels, like the dashboard snapshot.
+class TickRecorder {
+public:
+    struct Options {
+        int interval_ms = 100;
+        size_t block_rows = 1024;
+        int flush_ms = 2000;  // Bounds how far readers trail the engine
+    };
+
+    struct Stats {
+        uint64_t rows = 0;
+        uint64_t blocks = 0;
+        uint64_t raw_bytes = 0;     // Encoded columns before deflate
+        uint64_t stored_bytes = 0;  // Block payloads as written
+        uint64_t write_errors = 0;
+        size_t open_files = 0;
+    };
+
+    // Fills `out` with every market's books; called on the recorder thread
+    using BookSource = std::function<void(std::vector<BookSample>& out)>;
+    // Current equity; false = nothing to record
+    using EquitySource = std::function<bool(EquityRow& out)>;
+
+    explicit TickRecorder(std::string dir) : TickRecorder(std::move(dir), Options{}) {}
+    TickRecorder(std::string dir, Options options);
+    ~TickRecorder();
+
+    TickRecorder(const TickRecorder&) = delete;
+    TickRecorder& operator=(const TickRecorder&) = delete;
+
+    // Before start()
+    void set_book_source(BookSource source) { book_source_ = std::move(source); }
+    void set_equity_source(EquitySource source) { equity_source_ = std::move(source); }
+
+    void start();
+    // Takes a last sample and writes out everything pending
+    void stop();
+
+    // A last_trade_price from the feed - any thread
+    void record_trade(TokenId token, Price price);
+
+    const std::string& dir() const { return dir_; }
+    Stats stats() const;
+
+private:
+    struct File;
+    struct LastTrade {
+        Price price;
+        uint64_t seq = 0;  // Bumped per trade, so a repeat at the same price still lands
+    };
+
+    void run();
+    void sample(int64_t now_ms);
+    void flush(int64_t now_ms, bool all);
+    File* file_for(const std::string& name, bool book, const BookSample* market);
+    bool write_block(File& file);
+
+    const std::string dir_;
+    const Options options_;
+    BookSource book_source_;
+    EquitySource equity_source_;
+
+    std::mutex trades_mutex_;
+    std::unordered_map<TokenId, LastTrade> trades_;
+
+    std::mutex run_mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+    std::thread thread_;
+
+    // Recorder thread only
+    std::unordered_map<std::string, std::unique_ptr<File>> files_;
+    std::vector<BookSample> samples_;
+    std::vector<uint8_t> raw_;
+    std::vector<uint8_t> packed_;
+
+    std::atomic<uint64_t> rows_{0};
+    std::atomic<uint64_t> blocks_{0};
+    std::atomic<uint64_t> raw_bytes_{0};
+    std::atomic<uint64_t> stored_bytes_{0};
+    std::atomic<uint64_t> write_errors_{0};
+    std::atomic<size_t> open_files_{0};
+};
+
+// Memory-maps one tick file as it stands at open() and decodes the blocks a
+// query overlaps, skipping the rest by their header. Open again to see
+// blocks written since.
+class TickReader {
+public:
+    enum class Kind { BOOK, EQUITY };
+
+    struct Info {
+        std::string slug;
+        Kind kind = Kind::BOOK;
+        std::string up_token_id;
+        std::string down_token_id;
+        size_t columns = 0;
+        size_t blocks = 0;
+        uint64_t rows = 0;
+        int64_t first_ms = 0;
+        int64_t last_ms = 0;
+        size_t file_bytes = 0;
+    };
+
+    TickReader();
+    ~TickReader();
+
+    TickReader(const TickReader&) = delete;
+    TickReader& operator=(const TickReader&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    const Info& info() const { return info_; }
+
+    // Rows with from_ms <= ts_ms <= to_ms (and of `side`, if given), oldest
+    // first. limit > 0 keeps the newest `limit` of them. False on a corrupt
+    // block or the wrong kind.
+    bool read_book(int64_t from_ms, int64_t to_ms, std::vector<TickRow>& out, size_t limit = 0,
+                   std::optional<Side> side = std::nullopt) const;
+    bool read_equity(int64_t from_ms, int64_t to_ms, std::vector<EquityRow>& out, size_t limit = 0) const;
+
+private:
+    struct Mapping;
+    struct Block {
+        TickBlockHeader header;
+        const uint8_t* payload = nullptr;
+    };
+
+    // Called with a block's decoded columns (column-major: value c of row r
+    // at columns[c * rows + r]) and a row in the time range; the filter
+    // (optional) picks rows, the sink gets the picked ones oldest first
+    using RowFn = std::function<void(const int64_t* columns, size_t rows, size_t row)>;
+    using RowFilter = std::function<bool(const int64_t* columns, size_t rows, size_t row)>;
+    bool scan(int64_t from_ms, int64_t to_ms, size_t limit, const RowFilter& filter, const RowFn& sink) const;
+
+    std::unique_ptr<Mapping> mapping_;
+    Info info_;
+    std::vector<Block> blocks_;
+};
+
+} // namespace poly
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace poly {
+
+// Polymarket token ids are ~77-digit decimal strings. Past the I/O edges
+// (parse, subscribe, orders, persistence) they travel as a TokenId: a
+// handle interned once, when the token is registered or subscribed, so the
+// hot path compares and copies one integer instead.
+using TokenId = uint64_t;
+constexpr TokenId kNoToken = 0;
+
+// Handles are never reused: a market's tokens keep theirs after it retires.
+class TokenRegistry {
+public:
+    static TokenRegistry& instance();
+
+    // Existing handle, or a new one
+    TokenId intern(std::string_view token);
+    // kNoToken if the token was never interned. No allocation - the parser
+    // resolves every message's asset id through this.
+    TokenId find(std::string_view token) const;
+    // "" for kNoToken or an unknown handle
+    std::string name(TokenId id) const;
+
+    size_t size() const;
+
+private:
+    TokenRegistry() = default;
+
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> names_;                      // Handle - 1; stable addresses
+    std::unordered_map<std::string_view, TokenId> ids_;  // Views into names_
+};
+
+} // namespace poly
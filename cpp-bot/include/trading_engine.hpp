@@ -1,22 +1,37 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 #include <optional>
 #include <chrono>
+#include <condition_variable>
+#include <thread>
 #include <unordered_map>
+#include <shared_mutex>
+#include "book_view.hpp"
+#include "account_ledger.hpp"
+#include "dca_manager.hpp"
+#include "dump_detector.hpp"
+#include "market_pipeline.hpp"
+#include "order_manager.hpp"
+#include "pnl_ledger.hpp"
+#include "strategy_engine.hpp"
+#include "tick_store.hpp"
+#include "work_stealing_pool.hpp"
 
 namespace poly {
 
 // Forward declaration
 class PolymarketClient;
+class ShadowFleet;
 
 struct OrderbookSnapshot {
-    std::vector<std::pair<double, double>> bids;  // price, size
-    std::vector<std::pair<double, double>> asks;
+    std::vector<BookLevel> bids;
+    std::vector<BookLevel> asks;
     std::chrono::system_clock::time_point timestamp;
 };
 
@@ -24,7 +39,7 @@ struct Trade {
     std::string id;
     std::string market_slug;
     int leg;
-    std::string side;
+    Side side;
     std::string token_id;
     double shares;
     double price;
@@ -38,6 +53,8 @@ struct Trade {
 struct Config {
     double entry_threshold = 0.35;
     int shares = 10;
+    // Scale into an open leg as its ask falls through these prices; level i
+    // buys shares * dca_multiplier^i (dca_manager.hpp)
     bool dca_enabled = true;
     std::vector<double> dca_levels = {0.30, 0.25, 0.20, 0.15};
     double dca_multiplier = 1.5;
@@ -46,6 +63,27 @@ struct Config {
     double move = 0.36;  // Entry threshold - buy when price drops below this
     int window_min = 15;
     int dump_window_sec = 120;  // Trade in the last 120 seconds (2 minutes) of each 15-min window
+    
+    // Dump entries: also buy a side whose ask fell dump_drop (0.15 = 15%)
+    // below its high over any of dump_windows_sec (0 disables)
+    double dump_drop = 0.15;
+    std::vector<int> dump_windows_sec = {5, 15, 60};
+    
+    // Paper fills: walk the displayed asks for a VWAP and partial fills
+    // (false: fill in full at the limit)
+    bool paper_depth_fill = true;
+    double paper_queue_ahead = 0.0;  // Share of each level taken before our order lands (0-1)
+    int paper_latency_ms = 0;        // Decision to book; the fill uses the book as it is then
+    
+    // Live: once leg 1 fills, sign hedge orders for this many ticks at and
+    // below break-even (sum_target - avg cost), so the hedge is only sent (0 = off)
+    int presign_ticks = 10;
+    
+    // No entries while a book was last confirmed (feed update or REST
+    // snapshot) longer ago than this; live books are refreshed from REST
+    // at half of it. Books failing the feed's top-of-book check wait for
+    // their resync either way. 0 = no age limit.
+    int book_stale_ms = 5000;
 };
 
 enum class TradingMode {
@@ -66,9 +104,25 @@ struct CycleStatus {
     double pnl = 0.0;
 };
 
+// One row per registered market (active or staged)
+struct MarketSummary {
+    std::string slug;
+    bool active = false;  // false = staged, books warming
+    std::string position_side;
+    double position_shares = 0.0;
+    double position_cost = 0.0;
+    std::string cycle_status = "pending";
+    double up_ask = 0.0;
+    double down_ask = 0.0;
+    bool order_in_flight = false;
+    double unrealized_pnl = 0.0;  // Open position marked to the bid
+};
+
 struct EngineStatus {
+    uint64_t version = 0;  // Engine state version this was built from
     bool running;
     std::string mode;  // "PAPER" or "LIVE"
+    std::string strategy;  // Strategy::name() of the running instantiation
     double cash;
     struct {
         double UP;
@@ -77,6 +131,10 @@ struct EngineStatus {
     double realized_pnl;
     double unrealized_pnl;
     double equity;
+    double open_exposure = 0.0;  // Cost of unhedged legs across all markets
+    size_t orders_in_flight = 0;
+    uint64_t cycles_completed = 0;  // Both legs filled
+    uint64_t cycles_abandoned = 0;  // Window ended with leg 1 unhedged
     struct OrderbookData {
         std::vector<std::pair<double, double>> bids;  // price, size
         std::vector<std::pair<double, double>> asks;
@@ -89,6 +147,7 @@ struct EngineStatus {
     std::vector<Trade> recent_trades;
     bool live_trading_available = false;
     CycleStatus current_cycle;
+    std::vector<MarketSummary> markets;
 };
 
 class TradingEngine {
@@ -102,15 +161,127 @@ public:
     TradingEngine(TradingEngine&&) = delete;
     TradingEngine& operator=(TradingEngine&&) = delete;
 
+    // Sharding: call before start(). Series are spread over `count` engine
+    // threads (a series' active and staged markets share one); cpus[i], if
+    // given, pins shard i's thread to that core.
+    void configure_shards(size_t count, const std::vector<int>& cpus = {});
+    size_t shard_count() const { return shards_.size(); }
+    
     void start();
+    // Backtests: no shard or order threads. Books go in synchronously through
+    // on_orderbook_update / on_book_deltas, and orders run when the caller
+    // calls run_pending_orders().
+    void start_inline();
     void stop();
+    size_t run_pending_orders() { return orders_.run_pending(); }
+    
+    // Strategy time (trading window, cooldowns, fill timestamps). Set before
+    // start(); defaults to the system clock. Backtests run it off the capture.
+    using Clock = std::function<std::chrono::system_clock::time_point()>;
+    void set_clock(Clock clock) { clock_ = std::move(clock); }
+    
+    // Market data in - WebSocket reader thread only. Routed by token id to
+    // the owning shard's queue; tokens of unknown markets are dropped.
+    void publish_book(const OrderbookUpdate& update);
+    void publish_delta(const BookDelta& delta);
     
-    // Get current status for API
+    // Summed over all shard queues
+    MarketDataPipeline::Stats pipeline_stats() const;
+    
+    // Book integrity. After each delta batch a token's book is checked
+    // against the best bid / ask the feed reported with its last change; a
+    // mismatch is a gap (a message we never got). A gap, or a book older
+    // than half of book_stale_ms, fetches a REST snapshot on the resync
+    // pool - never on a shard or stream thread. Deltas arriving meanwhile
+    // are applied as usual and kept; the snapshot replaces the book on the
+    // shard thread and the kept deltas newer than it are replayed on top.
+    // Needs a client (set_polymarket_client) and start(); inline engines
+    // only check.
+    struct BookSyncStats {
+        uint64_t gaps = 0;              // Top-of-book mismatches
+        uint64_t refreshes = 0;         // REST fetches for books gone quiet
+        uint64_t resyncs = 0;           // REST snapshots applied
+        uint64_t resync_failures = 0;   // Fetch failed - retried on the next check
+        uint64_t resyncs_superseded = 0;  // A feed snapshot landed first
+        uint64_t deltas_replayed = 0;
+        uint64_t stale_ticks = 0;       // Window ticks with no entry check - book stale or unverified
+    };
+    BookSyncStats book_sync_stats() const;
+    static constexpr int kBookCheckMs = 250;        // Shard thread, each shard
+    static constexpr size_t kResyncThreads = 2;
+    static constexpr size_t kMaxResyncBuffer = 4096;  // Deltas kept per book during a fetch
+    
+    // Build a status now: locks each shard in turn. Backtests and one-off reads.
     EngineStatus get_status() const;
     
+    // Latest published status, for the API and dashboard. Never takes an
+    // engine lock: a publisher thread rebuilds it (get_status) within
+    // kStatusPublishMs of a state change and hands it over by pointer swap,
+    // so a reader keeps a consistent, immutable copy for as long as it
+    // holds it. Inline engines (no threads) rebuild on the reader's call.
+    std::shared_ptr<const EngineStatus> status_snapshot() const;
+    static constexpr int kStatusPublishMs = 20;
+    
+    // The dashboard market's books, for the 50ms feed. Locks only that
+    // market's shard, and copies nothing when `version` (both books' change
+    // counters) says the caller's copy is current; returns whether it copied.
+    struct BookSnapshot {
+        std::string slug;
+        uint64_t version = 0;
+        EngineStatus::OrderbookData up;
+        EngineStatus::OrderbookData down;
+    };
+    bool refresh_primary_books(BookSnapshot& snapshot) const;
+    
+    // Every registered market's top kTickDepth levels, appended to `out`
+    // for the tick store. One shard locked at a time.
+    void sample_books(std::vector<BookSample>& out) const;
+    
+    // Running PnL by market, cycle and 1m/15m/1h/1d bucket. Booked as fills
+    // land and marked by the status publisher; restore() it from the
+    // database before start().
+    const PnlLedger& pnl_ledger() const { return pnl_; }
+    PnlLedger& pnl_ledger() { return pnl_; }
+
+    // Warm restart (engine_snapshot.hpp). checkpoint() encodes the ledger,
+    // the config, the recent trades and every market's position, books and
+    // orders in flight - one shard locked at a time. It returns false (out
+    // untouched) while the state version is still `version`, else moves
+    // `version` on.
+    //
+    // restore() puts a checkpoint back, before the feed starts: markets are
+    // registered again with their positions and last books (kept unsynced,
+    // so entries wait for a fresh book), live orders still working are
+    // adopted by the order manager, and paper or unacked ones are dropped
+    // with their reservation returned. Markets whose window ended meanwhile
+    // are retired straight away. The saved config only applies if this run
+    // was launched with the same one. Nothing changes on a false return.
+    static constexpr uint32_t kSnapshotVersion = 1;
+    struct RestoreReport {
+        int64_t age_ms = 0;          // Checkpoint to restore
+        size_t markets = 0;
+        size_t positions = 0;
+        size_t orders_adopted = 0;
+        size_t orders_dropped = 0;
+        size_t markets_expired = 0;
+        bool config_restored = false;
+    };
+    bool checkpoint(std::vector<uint8_t>& out, uint64_t& version) const;
+    bool restore(const std::vector<uint8_t>& payload, int64_t written_ms, RestoreReport& report,
+                 std::string& error);
+
+    // Ask the exchange how far each working live order got: after a
+    // restore, and whenever the user channel reconnects (what it pushed
+    // meanwhile is lost). One REST call per order, on the calling thread.
+    void reconcile_orders();
+
     // Get current config
     Config get_config() const;
     
+    // The decision core the config and trading mode select
+    // (strategy_engine.hpp), rebuilt whenever either changes
+    std::string strategy_name() const { return strategy()->name(); }
+    
     // Configuration setters
     void set_entry_threshold(double value);
     void set_shares(int value);
@@ -118,24 +289,62 @@ public:
     void set_dca_enabled(bool value);
     void set_trading_window(int seconds);
     
-    // Set active market to watch
+    // Market registry. Any number of markets trade side by side, each with
+    // its own position and cycle; a series (slug minus the window
+    // timestamp) has at most one active and one staged market.
+    //
+    // set_market registers and activates in one step. For a rollover, stage
+    // the next market ahead of time (its books fill from the feed, it never
+    // trades), then activate it at the window boundary: a pointer swap that
+    // retires the series' previous market. False if the slug was never staged.
     void set_market(const std::string& slug, const std::string& up_token, const std::string& down_token);
+    void stage_market(const std::string& slug, const std::string& up_token, const std::string& down_token);
+    bool activate_market(const std::string& slug);
+    
+    // Drop a market; an open position is abandoned as an incomplete cycle
+    void retire_market(const std::string& slug);
     
     // Set async trade writer for database persistence
     void set_async_writer(class AsyncTradeWriter* writer);
     
-    // Called when orderbook updates arrive
-    void on_orderbook_update(const std::string& token_id, OrderbookSnapshot snapshot);
+    // Shadow strategies (shadow_fleet.hpp): set before start(). Every book
+    // update this engine applies and every market it registers is handed on.
+    void set_shadow_fleet(ShadowFleet* fleet) { shadows_ = fleet; }
+    // No trade or market logs - shadows keep the dashboard log to the primary
+    void set_quiet(bool quiet) { quiet_ = quiet; }
+    
+    // Synchronous entry points: apply and evaluate on the calling thread
+    // (the shard threads use the same path). Book snapshot for a token:
+    void on_orderbook_update(TokenId token, const OrderbookSnapshot& snapshot);
+    
+    // A parsed book as is, stamped with the engine clock
+    void on_orderbook_update(const OrderbookUpdate& update);
+    
+    // Called for each price_change level update (applied in place)
+    void on_book_delta(const BookDelta& delta);
+    
+    // Apply a batch of level updates, then evaluate each touched market once
+    void on_book_deltas(const BookDelta* deltas, size_t count);
     
-    // Execute a trade
+    // Execute a trade and wait (up to a few seconds) for it to settle.
+    // The strategy itself never blocks - it submits through the order manager.
     std::optional<Trade> execute_trade(
         const std::string& market_slug,
-        const std::string& side,
-        const std::string& token_id,
+        Side side,
+        TokenId token,
         double shares,
         double price
     );
     
+    OrderManager::Stats order_stats() const { return orders_.stats(); }
+    std::vector<ManagedOrder> open_orders() const { return orders_.open_orders(); }
+    
+    // Exchange-pushed executions and cancels (user channel), by exchange order id
+    void on_exchange_trade(const std::string& exchange_id, const std::string& trade_id, double shares, double price) {
+        orders_.on_exchange_trade(exchange_id, trade_id, shares, price);
+    }
+    void on_exchange_cancel(const std::string& exchange_id) { orders_.on_exchange_cancel(exchange_id); }
+    
     // ============ TRADING MODE CONTROL ============
     
     // Set trading mode (PAPER or LIVE)
@@ -159,80 +368,278 @@ public:
     void reset_paper_trading();
 
 private:
-    Config config_;
-    std::atomic<bool> running_{false};
-    std::chrono::system_clock::time_point start_time_;
-    mutable std::mutex mutex_;  // For thread-safe access
-    
-    // Portfolio state
-    double cash_ = 1000.0;
-    double realized_pnl_ = 0.0;
-    TradingMode trading_mode_ = TradingMode::PAPER;
-    
-    // Polymarket client for live trading
-    std::shared_ptr<PolymarketClient> polymarket_client_;
+    // Position tracking - fixed-point, so the hedge check and the PnL are exact
+    struct Position {
+        std::string market_slug;
+        Side side = Side::UP;
+        Qty shares;
+        Price avg_cost;
+        Price total_cost;
+        std::vector<Trade> trades;
+        uint64_t order_id = 0;  // Leg 1 order
+        bool filled = true;     // false: leg 1 acked but not filled yet - no hedge until it is
+    };
     
     // Market state
     struct MarketState {
         std::string slug;
-        std::string up_token_id;
+        std::string series;         // Slug without the window timestamp
+        int64_t window_start = 0;
+        int64_t period_sec = 900;
+        std::string up_token_id;    // As the exchange knows them
         std::string down_token_id;
-        OrderbookSnapshot up_orderbook;
-        OrderbookSnapshot down_orderbook;
-        std::chrono::system_clock::time_point last_update;
+        TokenId up_token = kNoToken;
+        TokenId down_token = kNoToken;
+        size_t shard = 0;
+        bool primary = false;       // Series shown on the dashboard
+        OrderBook up_book;    // Native books only - the other outcome's
+        OrderBook down_book;  // levels are merged in through the views below
+        
+        // Integrity of one book (book_sync_stats). Shard thread, under the
+        // shard's mutex.
+        struct BookSync {
+            std::chrono::system_clock::time_point confirmed;  // Last feed update or REST snapshot
+            bool synced = false;     // Has had a full book
+            bool gap = false;        // Failed the top-of-book check - resync due
+            bool resyncing = false;  // REST fetch in flight
+            bool overflow = false;   // More than kMaxResyncBuffer deltas meanwhile - fetch again
+            uint64_t epoch = 0;      // Full books applied; a fetch started before the latest is dropped
+            std::vector<BookDelta> buffered;  // Since the fetch went out
+        };
+        BookSync up_sync;
+        BookSync down_sync;
+        
+        // Guarded by the shard's mutex
+        bool active = false;  // Staged and retired markets never trade
+        std::optional<Position> position;
+        CycleStatus last_cycle;
+        std::chrono::system_clock::time_point last_cycle_complete_time;
+        uint64_t entry_order = 0;  // In flight in the order manager (0 = none)
+        uint64_t hedge_order = 0;
+        uint64_t dca_order = 0;
+        DCAManager dca;            // This cycle's ladder, built when leg 1 fills
+        
+        // Effective asks over time - process_market only, on the shard thread
+        mutable DumpDetector dumps;
+        
+        // Paper orders still travelling to the book (paper_latency_ms)
+        struct PaperOrder {
+            std::string exchange_id;
+            bool up = true;
+            Qty shares;
+            Price limit;
+            std::chrono::system_clock::time_point due;
+        };
+        std::vector<PaperOrder> paper_orders;
+        
+        // Effective books: native levels + complement of the other token
+        MergedBookView up_view() const { return MergedBookView(up_book, down_book); }
+        MergedBookView down_view() const { return MergedBookView(down_book, up_book); }
     };
     
-    std::unordered_map<std::string, MarketState> markets_;
-    std::string active_market_slug_;
+    struct TokenRoute {
+        std::shared_ptr<MarketState> market;
+        bool is_up;
+    };
     
-    // Position tracking
-    struct Position {
-        std::string market_slug;
-        std::string side;
-        double shares = 0.0;
-        double avg_cost = 0.0;
-        double total_cost = 0.0;
-        std::vector<Trade> trades;
+    // A slice of the markets with its own lock and its own thread (the
+    // pipeline consumer). Shards never touch each other's markets, so they
+    // only meet on the ledger and the trade history.
+    struct Shard {
+        size_t index = 0;
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<MarketState>> markets;
+        std::unordered_map<TokenId, TokenRoute> token_index;
+        size_t series_count = 0;  // Guarded by the engine mutex_
+        MarketDataPipeline pipeline;
     };
     
-    std::optional<Position> current_position_;
+    // Lock order: mutex_ -> Shard::mutex -> routes_mutex_ / history_mutex_
+    Config config_;
+    const Config launch_config_;  // As constructed - restore() compares against it
+    std::atomic<bool> running_{false};
+    Clock clock_;
+    std::chrono::system_clock::time_point start_time_;
+    mutable std::mutex mutex_;  // Config, client, series placement, primary market
     
-    // Trade history (in-memory)
-    std::vector<Trade> trade_history_;
+    // Decision core: swapped whole under mutex_, read per tick without it
+    std::shared_ptr<const Strategy> strategy_;  // std::atomic_load / atomic_store
+    
+    // Portfolio state - shared by every shard without a lock
+    AccountLedger ledger_{1000.0};
+    std::atomic<TradingMode> trading_mode_{TradingMode::PAPER};
+    
+    // Polymarket client for live trading
+    std::shared_ptr<PolymarketClient> polymarket_client_;
     
-    // Cycle tracking
+    std::vector<std::unique_ptr<Shard>> shards_;  // Fixed once started
+    std::unordered_map<std::string, size_t> series_shard_;
+    std::string primary_series_;      // First series registered - shown on the dashboard
+    std::string active_market_slug_;  // Its current market
+    
+    // Token id -> shard, read by the WebSocket thread on every message
+    mutable std::shared_mutex routes_mutex_;
+    std::unordered_map<TokenId, size_t> token_shard_;
+    
+    // Trade history (in-memory) and the last finished cycle of the primary
+    // series (outlives the market)
+    mutable std::mutex history_mutex_;
+    std::vector<Trade> trade_history_;
     CycleStatus last_completed_cycle_;
-    std::chrono::system_clock::time_point last_cycle_complete_time_;
+    std::atomic<uint64_t> cycles_completed_{0};
+    std::atomic<uint64_t> cycles_abandoned_{0};
+    PnlLedger pnl_;
+    
+    // Published status. state_version_ is bumped on every change the
+    // status shows; the publisher rebuilds when it moves (and once a second
+    // for the uptime).
+    std::atomic<uint64_t> state_version_{1};
+    mutable std::shared_ptr<const EngineStatus> published_status_;  // std::atomic_load / atomic_store
+    mutable std::mutex publish_mutex_;  // One builder at a time
+    std::mutex status_wait_mutex_;
+    std::condition_variable status_cv_;
+    std::thread status_thread_;
+    std::atomic<bool> publishing_{false};  // status_thread_ is running
     
     // Async trade writer
     class AsyncTradeWriter* async_writer_ = nullptr;
     
-    // Trading logic
-    void process_market(const std::string& market_slug);
-    bool should_enter(const MarketState& market, std::string& side_out, double& price_out);
-    bool should_hedge(const Position& pos, const MarketState& market, double& price_out);
+    ShadowFleet* shadows_ = nullptr;
+    bool quiet_ = false;
     
-    // Helper functions
-    double get_best_bid(const OrderbookSnapshot& book) const;
-    double get_best_ask(const OrderbookSnapshot& book) const;
+    // Orders between decision and settlement; its callbacks run on its workers
+    OrderManager orders_;
     
-    // Execute trade via Polymarket API (live mode)
-    std::optional<Trade> execute_live_trade(
-        const std::string& market_slug,
-        const std::string& side,
-        const std::string& token_id,
-        double shares,
-        double price
-    );
+    // Book integrity (book_sync_stats)
+    std::unique_ptr<WorkStealingPool> resync_pool_;  // start() to stop()
+    std::atomic<bool> has_client_{false};
+    std::atomic<uint64_t> book_gaps_{0};
+    std::atomic<uint64_t> book_refreshes_{0};
+    std::atomic<uint64_t> book_resyncs_{0};
+    std::atomic<uint64_t> resync_failures_{0};
+    std::atomic<uint64_t> resyncs_superseded_{0};
+    std::atomic<uint64_t> deltas_replayed_{0};
+    std::atomic<uint64_t> stale_ticks_{0};
+    
+    static std::shared_ptr<MarketState> make_market_state(
+        const std::string& slug, const std::string& up_token, const std::string& down_token);
     
-    // Execute paper trade (simulation)
-    std::optional<Trade> execute_paper_trade(
+    Shard* shard_for_token(TokenId token) const;
+    // Owning shard of a registered market, nullptr if unknown. Takes mutex_
+    // and the shard's mutex.
+    Shard* find_market(const std::string& slug, std::shared_ptr<MarketState>& market_out) const;
+    std::chrono::system_clock::time_point now() const {
+        return clock_ ? clock_() : std::chrono::system_clock::now();
+    }
+    
+    void mark_dirty() { state_version_.fetch_add(1, std::memory_order_release); }
+    
+    std::shared_ptr<const Strategy> strategy() const { return std::atomic_load(&strategy_); }
+    // Caller holds mutex_
+    void rebuild_strategy();
+    void publish_status() const;
+    void run_status_publisher();
+    
+    // Caller holds mutex_ and the shard's mutex
+    void retire_market_locked(Shard& shard, const std::string& slug);
+    // Caller holds the shard's mutex
+    void record_cycle(MarketState& market, const CycleStatus& cycle);
+    // Realized PnL into the account ledger and the PnL ledger
+    void book_realized(const std::string& slug, Price pnl);
+    // The status publisher's equity mark, after each publish
+    void mark_pnl();
+    
+    // Book updates for markets owned by this shard. Levels are read in
+    // place - nothing on the way from the parser to the book copies them.
+    void apply_snapshot(Shard& shard, TokenId token, const std::vector<BookLevel>& bids,
+                        const std::vector<BookLevel>& asks, std::chrono::system_clock::time_point timestamp,
+                        const FrameStamp& stamp);
+    void apply_deltas(Shard& shard, const BookDelta* deltas, size_t count);
+    
+    // Per-thread scratch of the book path: cleared per message but never
+    // shrunk, so steady-state ingest does not allocate
+    struct IngestScratch {
+        std::vector<std::shared_ptr<MarketState>> markets;  // Touched by a delta batch
+        std::vector<TokenId> checked;                       // Top-of-book checked this batch
+    };
+    static IngestScratch& ingest_scratch();
+    
+    // REST resyncs. A job is taken under the shard's mutex (marks the book
+    // resyncing), fetched on resync_pool_ and applied back on the shard
+    // thread through its pipeline.
+    struct ResyncJob {
+        std::shared_ptr<MarketState> market;
+        TokenId token = kNoToken;
+        std::string token_id;
+        bool is_up = true;
+        bool gap = false;  // Else a refresh of a quiet book
+        uint64_t epoch = 0;
+    };
+    bool resync_enabled() const { return resync_pool_ && has_client_.load(std::memory_order_acquire); }
+    // Caller holds the shard's mutex; false if already in flight
+    bool take_resync(const std::shared_ptr<MarketState>& market, bool is_up, bool gap, std::vector<ResyncJob>& jobs);
+    void start_resyncs(Shard& shard, std::vector<ResyncJob>& jobs);
+    void apply_resync(Shard& shard, const ResyncJob& job, bool ok, const std::vector<BookLevel>& bids,
+                      const std::vector<BookLevel>& asks, uint64_t server_ts);
+    // Periodic, on the shard thread: gaps not yet in flight, quiet books
+    void check_books(Shard& shard);
+    
+    // Trading logic
+    void process_market(Shard& shard, const std::shared_ptr<MarketState>& market);
+    
+    // Order flow. submit_order reserves the cost in the ledger (an entry or
+    // add is refused if cash can't cover it), marks the order in flight on
+    // the market and hands it to the order manager; on_order_update books
+    // fills and moves the market's position as the order progresses.
+    enum class OrderIntent : uint8_t {
+        ENTRY,  // Opens leg 1
+        ADD,    // DCA: more of leg 1 at a lower price
+        HEDGE   // Leg 2, closes the cycle
+    };
+    using TradeDone = std::function<void(const std::optional<Trade>&)>;
+    bool submit_order(
+        Shard* shard,
+        const std::shared_ptr<MarketState>& market,
         const std::string& market_slug,
-        const std::string& side,
-        const std::string& token_id,
-        double shares,
-        double price
+        OrderIntent intent,
+        Side side,
+        TokenId token,
+        Qty shares,
+        Price price,
+        const std::optional<Position>& open_position,
+        TradeDone on_done = nullptr
+    );
+    void on_order_update(
+        Shard* shard,
+        const std::shared_ptr<MarketState>& market,
+        OrderIntent intent,
+        const std::optional<Position>& open_position,
+        Price reserved,
+        const TradeDone& on_done,
+        const ManagedOrder& order
     );
+    // Sign the hedge candidates for an open leg (live, native executor)
+    void presign_hedge(const MarketState& market, const Position& position);
+    
+    // Settle a (partial) fill in the ledger and the trade history
+    Trade book_fill(const ManagedOrder& order, const std::optional<Position>& open_position, Price reserved);
+    
+    // Order manager executor: live orders go to Polymarket, paper orders
+    // fill against the market's book (fill_model.hpp)
+    OrderResult send_order(const OrderRequest& request);
+    OrderResult send_live_order(const OrderRequest& request);
+    OrderResult send_paper_order(const OrderRequest& request);
+    
+    // Delayed paper orders whose time has come, filled against the book
+    // now. Collected under the shard's mutex, reported outside it.
+    struct PaperFill {
+        std::string exchange_id;
+        double ordered = 0.0;
+        double shares = 0.0;
+        double price = 0.0;
+    };
+    void collect_paper_fills(MarketState& market, std::vector<PaperFill>& out);
+    void report_paper_fills(const std::vector<PaperFill>& fills);
 };
 
 } // namespace poly
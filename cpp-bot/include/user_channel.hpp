@@ -0,0 +1,64 @@
+#pragma once
+
+#include "websocket_client.hpp"
+#include <functional>
+#include <string>
+
+namespace poly {
+
+// One execution of one of our orders, as reported on the user channel
+struct UserTrade {
+    std::string trade_id;
+    std::string order_id;     // Exchange order id (ours - taker or maker side)
+    std::string asset_id;
+    std::string status;       // MATCHED, MINED, CONFIRMED, RETRYING, FAILED
+    double shares = 0.0;
+    double price = 0.0;
+};
+
+// Order lifecycle event: PLACEMENT, UPDATE (size_matched moved) or CANCELLATION
+struct UserOrderEvent {
+    std::string order_id;
+    std::string asset_id;
+    std::string type;
+    double original_size = 0.0;
+    double size_matched = 0.0;  // Cumulative
+    double price = 0.0;         // Limit
+};
+
+// Authenticated user channel (/ws/user): our own trades and order status
+// pushed by the exchange, on the same reconnect/keepalive machinery as the
+// market stream. Every (re)connect fires the connected callback so the
+// caller can resync whatever it may have missed while the socket was down.
+class UserChannelStream : public WebSocketStream {
+public:
+    using TradeCallback = std::function<void(const UserTrade& trade)>;
+    using OrderCallback = std::function<void(const UserOrderEvent& event)>;
+    using ConnectedCallback = std::function<void()>;
+    
+    UserChannelStream(std::string api_key, std::string api_secret, std::string api_passphrase);
+    ~UserChannelStream() override;
+    
+    // Set before start()
+    void set_trade_callback(TradeCallback cb) { trade_callback_ = std::move(cb); }
+    void set_order_callback(OrderCallback cb) { order_callback_ = std::move(cb); }
+    void set_connected_callback(ConnectedCallback cb) { connected_callback_ = std::move(cb); }
+    
+protected:
+    void on_connected() override;
+    void on_message(std::string_view msg, uint64_t frame_ns) override;
+    
+private:
+    void dispatch_event(const nlohmann::json& j);
+    void dispatch_trade(const nlohmann::json& j);
+    
+    std::string api_key_;
+    std::string api_secret_;
+    std::string api_passphrase_;
+    
+    TradeCallback trade_callback_;
+    OrderCallback order_callback_;
+    ConnectedCallback connected_callback_;
+};
+
+} // namespace poly
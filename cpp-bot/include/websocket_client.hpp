@@ -8,11 +8,17 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl/stream.hpp>
 #include <nlohmann/json.hpp>
+#include "market_parser.hpp"
 #include <string>
+#include <string_view>
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace poly {
 
@@ -26,59 +32,229 @@ using tcp = boost::asio::ip::tcp;
 // Forward declaration from polymarket_client.hpp
 struct OrderbookLevel;
 
-struct PriceUpdate {
-    std::string token_id;
-    double price = 0.0;
-    double best_bid = 0.0;
-    double best_ask = 0.0;
-    uint64_t timestamp = 0;
+// Socket, TLS and read-loop tuning of a stream. The defaults suit a
+// co-located box; everything past them trades CPU for latency.
+struct NetworkOptions {
+    bool tcp_nodelay = true;    // Subscribes and pongs go out as written
+    int busy_poll_us = 0;       // SO_BUSY_POLL (0 = off); above net.core.busy_poll needs CAP_NET_ADMIN
+    int recv_buffer = 0;        // SO_RCVBUF bytes (0 = kernel autotuning), set before connect
+    bool compression = false;   // permessage-deflate: fewer bytes on the wire, inflate on every frame
+    bool tls_resume = true;     // Offer the last TLS session on reconnect - abbreviated handshake
+    int dns_ttl_sec = 300;      // Resolved addresses are reused this long
+    size_t first_address = 0;   // Resolved address tried first (mod count) - spreads redundant feeds
+    bool busy_spin = false;     // Read loop polls the socket instead of sleeping - burns its core
+    int spin_cpu = -1;          // >= 0: pin the reader thread to this core
 };
 
-struct OrderbookUpdate {
-    std::string token_id;
-    std::vector<std::pair<double, double>> bids;  // price, size
-    std::vector<std::pair<double, double>> asks;
+// Connection attempts, and the phases of the latest connect in µs from the
+// start of the attempt
+struct ConnectStats {
+    uint64_t attempts = 0;
+    uint64_t connects = 0;
+    uint64_t dns_lookups = 0;      // Cache misses - the rest reused the addresses
+    uint64_t failovers = 0;        // Addresses that refused before one accepted
+    uint64_t tls_resumed = 0;      // Connects that resumed a session
+    std::string endpoint;          // Address of the latest connect
+    bool resumed = false;
+    uint64_t dns_us = 0;
+    uint64_t tcp_us = 0;
+    uint64_t tls_us = 0;
+    uint64_t ws_us = 0;            // WebSocket upgrade done - subscriptions go out
+    uint64_t first_frame_us = 0;   // 0 until the connection's first frame
+    uint64_t first_book_us = 0;    // Market stream: 0 until its first book
 };
 
-class WebSocketPriceStream {
+// Persistent TLS WebSocket to ws-subscriptions-clob.polymarket.com: one
+// reader thread, reconnect with backoff, ping/pong keepalive. Subclasses
+// pick the channel path, resubscribe in on_connected() and handle frames
+// in on_message(). Both run on the reader thread.
+//
+// Reconnects go to the cached addresses (re-resolved after dns_ttl_sec or
+// when all of them fail), the last one that worked first, and resume the
+// previous TLS session when the server allows it.
+//
+// Subclasses must call stop() in their destructor - the reader thread
+// calls back into them.
+class WebSocketStream {
 public:
-    using PriceCallback = std::function<void(const PriceUpdate& update)>;
-    using OrderbookCallback = std::function<void(const OrderbookUpdate& update)>;
+    WebSocketStream(std::string tag, std::string target, std::string description);
+    virtual ~WebSocketStream();
     
-    WebSocketPriceStream();
-    ~WebSocketPriceStream();
+    WebSocketStream(const WebSocketStream&) = delete;
+    WebSocketStream& operator=(const WebSocketStream&) = delete;
     
-    void set_callback(PriceCallback cb);
-    void set_orderbook_callback(OrderbookCallback cb);
-    void subscribe(const std::string& token_id);
-    void unsubscribe(const std::string& token_id);
-    void clear_subscriptions();
-    void start();
-    void stop();
-    bool is_connected() const { return connected_.load(); }
+    // Before start()
+    void set_network_options(const NetworkOptions& options) { options_ = options; }
+    const NetworkOptions& network_options() const { return options_; }
+    
+    virtual void start();
+    virtual void stop();
+    virtual bool is_connected() const { return connected_.load(); }
     
     // Reconnect to WebSocket (disconnect and connect again)
     void reconnect();
     
+    ConnectStats connect_stats() const;
+    
+protected:
+    // Right after the handshake (also after every reconnect)
+    virtual void on_connected() = 0;
+    // One text frame; frame_ns is latency::now_ns() when the read returned
+    virtual void on_message(std::string_view msg, uint64_t frame_ns) = 0;
+    
+    // Write a text frame on the live connection; false if not connected
+    bool send_text(const std::string& text);
+    
+    // Time (re)connects to the first frame carrying a book; set in the
+    // subclass constructor
+    void set_book_timing(bool enabled) { book_timing_ = enabled; }
+    
+    const std::string tag_;  // Log prefix, e.g. "WS"
+    std::atomic<bool> connected_{false};
+    
 private:
+    struct SessionFree {
+        void operator()(SSL_SESSION* session) const { SSL_SESSION_free(session); }
+    };
+    
     void run();
     void connect();
+    void tune_socket(tcp::socket& socket);
     void read_loop();
-    void send_subscribe(const std::string& token_id);
-    void send_unsubscribe(const std::string& token_id);
+    void read_frame(beast::flat_buffer& buffer);
+    void record_first_book();
+    // OpenSSL hands over each session the server issues; we keep the latest
+    static int on_new_session(SSL* ssl, SSL_SESSION* session);
+    
+    const std::string target_;
+    const std::string description_;
+    NetworkOptions options_;
     
     net::io_context ioc_;
     ssl::context ctx_{ssl::context::tlsv12_client};
     std::unique_ptr<websocket::stream<beast::ssl_stream<tcp::socket>>> ws_;
+    std::mutex write_mutex_;
+    
+    // Reader thread only
+    std::vector<tcp::endpoint> endpoints_;
+    size_t preferred_endpoint_ = 0;
+    std::chrono::steady_clock::time_point resolved_at_;
+    std::unique_ptr<SSL_SESSION, SessionFree> tls_session_;
+    uint64_t connect_start_ns_ = 0;
+    bool book_timing_ = false;
+    bool awaiting_frame_ = false;
+    bool awaiting_book_ = false;
+    
+    mutable std::mutex stats_mutex_;
+    ConnectStats stats_;
     
     std::atomic<bool> running_{false};
-    std::atomic<bool> connected_{false};
     std::thread worker_thread_;
+};
+
+// Market channel: book snapshots, level deltas and prices for subscribed tokens.
+//
+// With set_feed_count(n > 1) the stream keeps n connections with the same
+// subscriptions, each spread to a different resolved address where there
+// are several. Every frame goes through one arbitration point, so a stall
+// or reconnect on one connection leaves no gap. Arbitration is per update,
+// not per frame - the feeds may batch the same updates differently: for
+// each asset it forwards only updates newer than the last one forwarded
+// (server timestamp), and at an equal timestamp only ones whose content it
+// hasn't forwarded yet. A late copy would put an old absolute level size
+// back over a newer one. The winning reader thread dispatches under the
+// arbitration lock: callbacks still see one thread at a time.
+class WebSocketPriceStream : public WebSocketStream {
+public:
+    using PriceCallback = std::function<void(const PriceUpdate& update)>;
+    using OrderbookCallback = std::function<void(const OrderbookUpdate& update)>;
+    using BookDeltaCallback = std::function<void(const BookDelta& delta)>;
+    using FrameTap = std::function<void(std::string_view frame, uint64_t frame_ns)>;
+    
+    static constexpr size_t kDedupSlots = 4096;  // Untimed frames and updates remembered
+    
+    struct FeedStats {
+        bool connected = false;
+        uint64_t forwarded = 0;   // Updates this connection delivered first
+        uint64_t duplicates = 0;  // Copies dropped - another connection was first
+        ConnectStats connect;
+    };
+    
+    WebSocketPriceStream();
+    ~WebSocketPriceStream() override;
+    
+    void set_callback(PriceCallback cb);
+    void set_orderbook_callback(OrderbookCallback cb);
+    void set_book_delta_callback(BookDeltaCallback cb);
+    // Sees every raw frame before it is parsed (capture); set before start().
+    // With redundant feeds, only the copy that is forwarded.
+    void set_frame_tap(FrameTap tap) { frame_tap_ = std::move(tap); }
+    // Connections to keep, including this one (default 1); before start().
+    // The others copy this stream's network options.
+    void set_feed_count(size_t count);
+    void subscribe(const std::string& token_id);
+    void unsubscribe(const std::string& token_id);
+    void clear_subscriptions();
+    
+    void start() override;
+    void stop() override;
+    // Any connection up
+    bool is_connected() const override;
+    
+    // One entry per connection, this one first
+    std::vector<FeedStats> feed_stats() const;
+    
+    // Replay: run a recorded frame through the same parse/dispatch path as
+    // a live one. Only while the stream is not started, from one thread.
+    void inject(std::string_view msg, uint64_t frame_ns);
+    
+    // Identity of a frame the fast parser doesn't know: the asset ids,
+    // timestamp and book hashes when it has a hash, else all of its bytes.
+    // Never 0.
+    static uint64_t frame_key(std::string_view msg);
+    
+protected:
+    void on_connected() override;
+    void on_message(std::string_view msg, uint64_t frame_ns) override;
+    
+private:
+    class Mirror;
+    
+    // Every connection's frames, redundant mode; feed 0 is this one
+    void arbitrate(size_t feed, std::string_view msg, uint64_t frame_ns);
+    // Caller holds arb_mutex_: whether an update of `token` stamped `ts`
+    // (0 = untimed) with content `key` is new
+    bool admit(TokenId token, uint64_t ts, uint64_t key);
+    void dispatch_message(std::string_view msg);
+    // The last parse's updates; keep_* (nullptr = all) picks which
+    void dispatch_parsed(const uint8_t* keep_books, const uint8_t* keep_deltas, const uint8_t* keep_prices);
+    void dispatch_json(const nlohmann::json& j);
+    void send_subscribe(const std::string& token_id);
+    void send_unsubscribe(const std::string& token_id);
     
     PriceCallback callback_;
     OrderbookCallback orderbook_callback_;
+    BookDeltaCallback delta_callback_;
+    FrameTap frame_tap_;
+    MarketMessageParser parser_;  // Reader thread - or whoever holds arb_mutex_
+    FrameStamp stamp_;            // Frame being dispatched (same)
     std::vector<std::string> subscribed_tokens_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;    // Guards subscribed_tokens_
+    
+    std::vector<std::unique_ptr<Mirror>> mirrors_;  // Fixed once started
+    std::mutex arb_mutex_;        // Guards the rest of this block, parser_, stamp_ (redundant mode)
+    std::vector<uint64_t> seen_;  // Direct-mapped keys of untimed frames and updates
+    struct AssetClock {
+        uint64_t ts = 0;              // Newest server timestamp forwarded
+        std::vector<uint64_t> keys;   // Updates forwarded at it
+    };
+    std::unordered_map<TokenId, AssetClock> clocks_;
+    std::vector<uint8_t> keep_;   // Per-update verdicts of the frame in hand
+    struct FeedCounters {
+        std::atomic<uint64_t> forwarded{0};
+        std::atomic<uint64_t> duplicates{0};
+    };
+    std::unique_ptr<FeedCounters[]> feed_counters_;
 };
 
 } // namespace poly
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace poly {
+
+// Fixed set of worker threads, one task deque each. A worker takes from the
+// back of its own deque (what it queued last, still warm in cache) and, when
+// that runs dry, steals from the front of the others'. Uneven tasks - a busy
+// market window next to a quiet one - so no core idles while work is left.
+//
+// Deques are mutex-guarded: tasks here run for milliseconds, so the lock
+// is never the bottleneck and the pool stays simple.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // 0 = one thread per core
+    explicit WorkStealingPool(size_t threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // From outside: spread round-robin. From a task: onto that worker's deque.
+    void submit(Task task);
+
+    // Until every task submitted so far (and anything they submit) is done
+    void wait();
+
+    size_t thread_count() const { return threads_.size(); }
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(size_t self);
+    bool take(size_t self, Task& out);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    size_t pending_ = 0;     // Submitted, not yet finished
+    bool stopping_ = false;
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<uint64_t> steals_{0};
+};
+
+} // namespace poly
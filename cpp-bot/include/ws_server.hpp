@@ -2,10 +2,10 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/asio.hpp>
+#include <deque>
 #include <memory>
 #include <set>
 #include <mutex>
-#include <thread>
 #include <atomic>
 #include <string>
 #include <functional>
@@ -18,35 +18,66 @@ using tcp = net::ip::tcp;
 namespace poly {
 
 class WSSession : public std::enable_shared_from_this<WSSession> {
+    struct Outbound {
+        std::shared_ptr<const std::string> data;
+        bool status;  // Dashboard status frame (may be conflated)
+    };
+    
     websocket::stream<tcp::socket> ws_;
     beast::flat_buffer buffer_;
     std::function<void(std::shared_ptr<WSSession>)> on_close_;
+    // Frames waiting to go out, front first; io strand only, one write at a time
+    std::deque<Outbound> queue_;
+    size_t status_queued_ = 0;
+    bool open_ = false;     // Handshake done
+    bool writing_ = false;  // queue_.front() is being written
+    
+    uint64_t synced_version_ = 0;        // Status version queued so far (broadcaster thread)
+    std::atomic<bool> resync_{false};    // A status frame was dropped - next one must be full
     
 public:
+    // A client this far behind loses frames rather than growing the queue
+    static constexpr size_t kMaxQueued = 256;
+    // Status frames waiting before a slow client is conflated: the waiting
+    // ones are dropped and it gets a full snapshot on the next tick
+    static constexpr size_t kMaxStatusQueued = 4;
+    
     explicit WSSession(tcp::socket socket, std::function<void(std::shared_ptr<WSSession>)> on_close);
     void run();
-    void send(const std::string& msg);
+    // Any thread
+    void send(std::shared_ptr<const std::string> msg);
+    void send_status(std::shared_ptr<const std::string> msg, bool full);
+    
+    // Broadcaster thread
+    uint64_t synced_version() const { return synced_version_; }
+    void set_synced_version(uint64_t version) { synced_version_ = version; }
+    bool take_resync() { return resync_.exchange(false); }
     
 private:
-    void on_accept(beast::error_code ec);
+    void enqueue(Outbound frame);
     void do_read();
-    void on_read(beast::error_code ec, std::size_t bytes);
+    void do_write();
 };
 
+// Dashboard feed; runs on the shared IoPool, each session on its own strand
 class WSServer {
-    net::io_context ioc_;
     tcp::acceptor acceptor_;
     std::set<std::shared_ptr<WSSession>> sessions_;
     std::mutex sessions_mutex_;
-    std::thread worker_;
     std::atomic<bool> running_{false};
     
 public:
-    WSServer(unsigned short port);
+    explicit WSServer(unsigned short port);
     ~WSServer();
     void start();
     void stop();
     void broadcast(const std::string& msg);
+    // One tick of the status stream. Sessions holding version - 1 get
+    // `delta`; new, conflated or otherwise stale ones get make_full(),
+    // built at most once. delta == nullptr: nothing changed, so only stale
+    // sessions are sent anything.
+    void broadcast_status(uint64_t version, const std::shared_ptr<const std::string>& delta,
+                          const std::function<std::shared_ptr<const std::string>()>& make_full);
     
 private:
     void do_accept();
@@ -56,6 +87,7 @@ private:
 // Global instance
 extern std::unique_ptr<WSServer> g_ws_server;
 void start_ws_server(unsigned short port);
+void stop_ws_server();
 void broadcast_status(const std::string& json);
 
 } // namespace poly
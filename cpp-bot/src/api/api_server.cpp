@@ -1,23 +1,32 @@
 #include "api_server.hpp"
+#include "async_writer.hpp"
+#include "engine_snapshot.hpp"
+#include "http_pool.hpp"
+#include "io_pool.hpp"
+#include "latency.hpp"
+#include "log_ring.hpp"
+#include "shadow_fleet.hpp"
+#include "tick_store.hpp"
+#include "websocket_client.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
 #include <cstring>
 #include <cstdlib>
 #include <mutex>
 #include <vector>
-#include <deque>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
+#include <ctime>
 
 namespace poly {
 
-static std::mutex g_log_mutex;
-static std::deque<nlohmann::json> g_logs;
-static const size_t MAX_LOGS = 200;
+// Dashboard log lines: lock-free, so the engine never waits on a poll
+static LogRing g_logs(1024);
+static const size_t MAX_LOGS = 200;  // /api/logs without a cursor
 
 static std::mutex g_price_mutex;
 static double g_up_price = 0.0;
@@ -27,6 +36,11 @@ static std::string g_market_question;
 
 static std::atomic<bool> g_auto_enabled{false};
 static TradingEngine* g_engine_ptr = nullptr;
+static std::atomic<AsyncTradeWriter*> g_trade_writer{nullptr};
+static std::atomic<ShadowFleet*> g_shadow_fleet{nullptr};
+static std::atomic<WebSocketPriceStream*> g_market_stream{nullptr};
+static std::atomic<TickRecorder*> g_tick_recorder{nullptr};
+static std::atomic<EngineCheckpointer*> g_checkpointer{nullptr};
 
 // Current cycle tracking
 struct CurrentCycle {
@@ -54,25 +68,97 @@ TradingEngine* get_engine_ptr() {
     return g_engine_ptr;
 }
 
-void add_log(const std::string& level, const std::string& name, const std::string& message) {
-    std::lock_guard<std::mutex> lock(g_log_mutex);
+void set_trade_writer_ptr(AsyncTradeWriter* writer) {
+    g_trade_writer = writer;
+}
+
+void set_shadow_fleet_ptr(ShadowFleet* fleet) {
+    g_shadow_fleet = fleet;
+}
+
+void set_market_stream_ptr(WebSocketPriceStream* stream) {
+    g_market_stream = stream;
+}
+
+void set_tick_recorder_ptr(TickRecorder* recorder) {
+    g_tick_recorder = recorder;
+}
+
+void set_checkpointer_ptr(EngineCheckpointer* checkpointer) {
+    g_checkpointer = checkpointer;
+}
+
+namespace {
+    // One strategy's results, primary or shadow
+    nlohmann::json strategy_json(const std::string& strategy, const EngineStatus& status) {
+        const auto& cfg = status.config;
+        return {
+            {"strategy", strategy},
+            {"config", {
+                {"entryThreshold", cfg.move},
+                {"sumTarget", cfg.sum_target},
+                {"shares", cfg.shares},
+                {"dcaEnabled", cfg.dca_enabled},
+                {"breakevenEnabled", cfg.breakeven_enabled},
+                {"dumpDrop", cfg.dump_drop},
+                {"tradingWindowSec", cfg.dump_window_sec}
+            }},
+            {"cash", status.cash},
+            {"realizedPnl", status.realized_pnl},
+            {"equity", status.equity},
+            {"openExposure", status.open_exposure},
+            {"cyclesCompleted", status.cycles_completed},
+            {"cyclesAbandoned", status.cycles_abandoned}
+        };
+    }
     
+    // One PnL ledger bucket's marks, in the equity curve's shape
+    nlohmann::json equity_bucket_json(const PnlLedger::Bucket& bucket) {
+        return {
+            {"timestamp", bucket.start_ms},
+            {"equity", bucket.equity_close.to_double()},
+            {"open", bucket.equity_open.to_double()},
+            {"high", bucket.equity_high.to_double()},
+            {"low", bucket.equity_low.to_double()},
+            {"cash", bucket.cash.to_double()},
+            {"unrealized", bucket.unrealized.to_double()},
+            {"realized", bucket.realized_total.to_double()}
+        };
+    }
+}
+
+void add_log(const std::string& level, const std::string& name, const std::string& message) {
     auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%SZ");
-    
-    nlohmann::json log_entry = {
-        {"timestamp", ss.str()},
-        {"level", level},
-        {"name", name},
-        {"message", message}
-    };
+    int64_t wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    g_logs.push(level, name, message, wall_ms);
+}
+
+nlohmann::json read_logs_json(uint64_t since, size_t limit, uint64_t& cursor) {
+    uint64_t missed = 0;
+    auto records = g_logs.read_since(since, limit, cursor, missed);
     
-    g_logs.push_back(log_entry);
-    if (g_logs.size() > MAX_LOGS) {
-        g_logs.pop_front();
+    nlohmann::json data = nlohmann::json::array();
+    for (const auto& record : records) {
+        time_t seconds = static_cast<time_t>(record.wall_ms / 1000);
+        std::tm tm_buf;
+        gmtime_r(&seconds, &tm_buf);
+        char timestamp[32];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &tm_buf);
+        data.push_back({
+            {"seq", record.seq},
+            {"timestamp", timestamp},
+            {"level", record.level},
+            {"name", record.name},
+            {"message", record.message}
+        });
     }
+    
+    nlohmann::json response = {
+        {"data", std::move(data)},
+        {"seq", cursor}
+    };
+    if (missed > 0 && since > 0) response["missed"] = missed;  // A fresh read missed nothing
+    return response;
 }
 
 void set_live_prices(double up_price, double down_price) {
@@ -129,7 +215,8 @@ void clear_cycle() {
 }
 
 APIServer::APIServer(TradingEngine& engine, Database& db, int port)
-    : engine_(engine), db_(db), port_(port), running_(false), server_socket_(-1) {
+    : engine_(engine), db_(db), port_(port), http_(std::make_unique<HttpServer>(static_cast<unsigned short>(port))) {
+    register_routes();
     std::cout << "[API] Server initialized" << std::endl;
     add_log("info", "API", "Server initialized");
 }
@@ -139,20 +226,14 @@ APIServer::~APIServer() {
 }
 
 void APIServer::start() {
-    running_ = true;
-    server_thread_ = std::thread(&APIServer::run, this);
-    add_log("info", "API", "Server starting on port " + std::to_string(port_));
+    IoPool::instance().start();
+    http_->start();
+    std::cout << "[API] Server listening on port " << port_ << std::endl;
+    add_log("info", "API", "Server listening on port " + std::to_string(port_));
 }
 
 void APIServer::stop() {
-    running_ = false;
-    if (server_socket_ >= 0) {
-        close(server_socket_);
-        server_socket_ = -1;
-    }
-    if (server_thread_.joinable()) {
-        server_thread_.join();
-    }
+    http_->stop();
 }
 
 std::string base64_decode(const std::string& encoded) {
@@ -174,45 +255,21 @@ std::string base64_decode(const std::string& encoded) {
     return decoded;
 }
 
-bool check_auth(const std::string& request) {
+bool check_auth(const std::string& authorization) {
+    auto credentials = [&](const char* scheme) -> std::string {
+        size_t n = std::strlen(scheme);
+        if (authorization.size() <= n || authorization.compare(0, n, scheme) != 0) return "";
+        std::string value = authorization.substr(n);
+        while (!value.empty() && value.back() == ' ') value.pop_back();
+        return value;
+    };
+    
     // Accept Bearer token
-    size_t bearer_pos = request.find("Authorization: Bearer ");
-    if (bearer_pos == std::string::npos) {
-        bearer_pos = request.find("authorization: Bearer ");
-    }
-    if (bearer_pos != std::string::npos) {
-        size_t start = bearer_pos + 22;
-        size_t end = request.find("\r\n", start);
-        if (end == std::string::npos) end = request.find("\n", start);
-        if (end == std::string::npos) end = request.length();
-        
-        std::string token = request.substr(start, end - start);
-        while (!token.empty() && (token.back() == ' ' || token.back() == '\r' || token.back() == '\n')) {
-            token.pop_back();
-        }
-        
-        if (token == "polytrader-secret") return true;
-    }
+    if (credentials("Bearer ") == "polytrader-secret") return true;
     
     // Accept Basic auth
-    size_t auth_pos = request.find("Authorization: Basic ");
-    if (auth_pos == std::string::npos) {
-        auth_pos = request.find("authorization: Basic ");
-    }
-    if (auth_pos != std::string::npos) {
-        size_t start = auth_pos + 21;
-        size_t end = request.find("\r\n", start);
-        if (end == std::string::npos) end = request.find("\n", start);
-        if (end == std::string::npos) return false;
-        
-        std::string encoded = request.substr(start, end - start);
-        while (!encoded.empty() && (encoded.back() == ' ' || encoded.back() == '\r' || encoded.back() == '\n')) {
-            encoded.pop_back();
-        }
-        
-        std::string decoded = base64_decode(encoded);
-        if (decoded == "admin:sexmachine666") return true;
-    }
+    std::string encoded = credentials("Basic ");
+    if (!encoded.empty() && base64_decode(encoded) == "admin:sexmachine666") return true;
     
     // For development: allow unauthenticated access to read-only endpoints
     return true;
@@ -234,27 +291,34 @@ std::string get_status_json() {
     double sum_target = 0.99;
     bool dca_enabled = true;
     int trading_window = 120;
+    std::string strategy;
     double cash = 1000.0;
     double realized_pnl = 0.0;
     double equity = 1000.0;
+    double open_exposure = 0.0;
+    size_t orders_in_flight = 0;
     int up_pos = 0, down_pos = 0;
     int64_t uptime = 0;
     
-    if (g_engine_ptr) {
-        auto cfg = g_engine_ptr->get_config();
+    // One snapshot for the whole response - consistent, and no engine lock
+    auto engine_status = g_engine_ptr ? g_engine_ptr->status_snapshot() : nullptr;
+    if (engine_status) {
+        const auto& cfg = engine_status->config;
         entry_threshold = cfg.move;
         shares = cfg.shares;
         sum_target = cfg.sum_target;
         dca_enabled = cfg.dca_enabled;
         trading_window = cfg.dump_window_sec;
+        strategy = engine_status->strategy;
         
-        auto engine_status = g_engine_ptr->get_status();
-        cash = engine_status.cash;
-        realized_pnl = engine_status.realized_pnl;
-        equity = engine_status.equity;
-        up_pos = static_cast<int>(engine_status.positions.UP);
-        down_pos = static_cast<int>(engine_status.positions.DOWN);
-        uptime = engine_status.uptime_seconds;
+        cash = engine_status->cash;
+        realized_pnl = engine_status->realized_pnl;
+        equity = engine_status->equity;
+        open_exposure = engine_status->open_exposure;
+        orders_in_flight = engine_status->orders_in_flight;
+        up_pos = static_cast<int>(engine_status->positions.UP);
+        down_pos = static_cast<int>(engine_status->positions.DOWN);
+        uptime = engine_status->uptime_seconds;
     }
     
     // Build orderbooks from REAL engine data
@@ -270,8 +334,8 @@ std::string get_status_json() {
     };
     
     // Use REAL orderbook from engine
-    if (g_engine_ptr) {
-        auto status = g_engine_ptr->get_status();
+    if (engine_status) {
+        const auto& status = *engine_status;
         
         // UP orderbook
         for (const auto& [price, size] : status.up_orderbook.asks) {
@@ -302,6 +366,23 @@ std::string get_status_json() {
         }
     }
     
+    // Every registered market (multi-series mode), staged ones included
+    nlohmann::json markets = nlohmann::json::array();
+    if (engine_status) {
+        for (const auto& m : engine_status->markets) {
+            markets.push_back({
+                {"slug", m.slug},
+                {"active", m.active},
+                {"upAsk", m.up_ask},
+                {"downAsk", m.down_ask},
+                {"positionSide", m.position_side},
+                {"positionShares", m.position_shares},
+                {"positionCost", m.position_cost},
+                {"cycleStatus", m.cycle_status}
+            });
+        }
+    }
+    
     // Build current cycle info from positions
     nlohmann::json currentCycle = nullptr;
     
@@ -344,10 +425,9 @@ std::string get_status_json() {
     // Get trading mode from engine
     std::string trading_mode = "PAPER";
     bool live_available = false;
-    if (g_engine_ptr) {
-        auto engine_status = g_engine_ptr->get_status();
-        trading_mode = engine_status.mode;
-        live_available = engine_status.live_trading_available;
+    if (engine_status) {
+        trading_mode = engine_status->mode;
+        live_available = engine_status->live_trading_available;
     }
     
     nlohmann::json status = {
@@ -364,7 +444,8 @@ std::string get_status_json() {
                     {"shares", shares},
                     {"sumTarget", sum_target},
                     {"dcaEnabled", dca_enabled},
-                    {"tradingWindowSec", trading_window}
+                    {"tradingWindowSec", trading_window},
+                    {"strategy", strategy}
                 }}
             }},
             {"portfolio", {
@@ -372,7 +453,9 @@ std::string get_status_json() {
                 {"positions", {{"UP", up_pos}, {"DOWN", down_pos}}},
                 {"unrealizedPnL", 0.0},
                 {"realizedPnL", realized_pnl},
-                {"equity", equity}
+                {"equity", equity},
+                {"openExposure", open_exposure},
+                {"ordersInFlight", orders_in_flight}
             }},
             {"currentMarket", {
                 {"slug", g_market_slug},
@@ -383,6 +466,7 @@ std::string get_status_json() {
                 {"inTradingWindow", in_trading}
             }},
             {"orderbooks", orderbooks},
+            {"markets", markets},
             {"currentCycle", currentCycle},
             {"uptime", uptime}
         }}
@@ -391,18 +475,29 @@ std::string get_status_json() {
     return status.dump();
 }
 
-std::string get_logs_json() {
-    std::lock_guard<std::mutex> lock(g_log_mutex);
-    
-    nlohmann::json response = {
-        {"success", true},
-        {"data", nlohmann::json::array()}
-    };
-    
-    for (const auto& log : g_logs) {
-        response["data"].push_back(log);
+nlohmann::json get_latency_json() {
+    auto us = [](double ns) { return std::round(ns / 10.0) / 100.0; };
+    nlohmann::json spans = nlohmann::json::array();
+    for (const auto& span : LatencyMonitor::instance().stats()) {
+        const auto& h = span.stats;
+        spans.push_back({
+            {"span", span.name},
+            {"count", h.count},
+            {"meanUs", us(h.mean_ns)},
+            {"p50Us", us(static_cast<double>(h.p50_ns))},
+            {"p90Us", us(static_cast<double>(h.p90_ns))},
+            {"p99Us", us(static_cast<double>(h.p99_ns))},
+            {"p999Us", us(static_cast<double>(h.p999_ns))},
+            {"maxUs", us(static_cast<double>(h.max_ns))}
+        });
     }
-    
+    return spans;
+}
+
+std::string get_logs_json(uint64_t since, size_t limit) {
+    uint64_t cursor = 0;
+    nlohmann::json response = read_logs_json(since, limit, cursor);
+    response["success"] = true;
     return response.dump();
 }
 
@@ -443,7 +538,8 @@ std::string process_command(const std::string& cmd) {
         double cash = 1000.0;
         double realized_pnl = 0.0;
         if (g_engine_ptr) {
-            auto status = g_engine_ptr->get_status();
+            auto snapshot = g_engine_ptr->status_snapshot();
+            const auto& status = *snapshot;
             cash = status.cash;
             realized_pnl = status.realized_pnl;
         }
@@ -648,318 +744,582 @@ std::string process_command(const std::string& cmd) {
     return "❌ Unknown command. Type 'help' for available commands.";
 }
 
-void APIServer::run() {
-    std::cout << "[API] Starting server on port " << port_ << std::endl;
-    
-    server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_socket_ < 0) {
-        std::cerr << "[API] Failed to create socket" << std::endl;
-        return;
-    }
-    
-    int opt = 1;
-    setsockopt(server_socket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port_);
-    
-    if (bind(server_socket_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        std::cerr << "[API] Failed to bind to port " << port_ << std::endl;
-        return;
-    }
-    
-    if (listen(server_socket_, 10) < 0) {
-        std::cerr << "[API] Failed to listen" << std::endl;
-        return;
-    }
-    
-    std::cout << "[API] Server listening on port " << port_ << std::endl;
-    add_log("info", "API", "Server listening on port " + std::to_string(port_));
-    
-    while (running_) {
-        struct sockaddr_in client_addr;
-        socklen_t client_len = sizeof(client_addr);
-        
-        int client = accept(server_socket_, (struct sockaddr*)&client_addr, &client_len);
-        if (client < 0) continue;
-        
-        struct timeval tv;
-        tv.tv_sec = 5;
-        tv.tv_usec = 0;
-        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        
-        char buffer[4096] = {0};
-        ssize_t bytes = recv(client, buffer, sizeof(buffer) - 1, 0);
-        
-        if (bytes > 0) {
-            std::string request(buffer, bytes);
-            std::string response;
-            
-            std::string method, path;
-            std::istringstream req_stream(request);
-            req_stream >> method >> path;
-            
-            std::string base_path = path;
-            size_t qpos = path.find('?');
-            if (qpos != std::string::npos) {
-                base_path = path.substr(0, qpos);
-            }
-            
-            std::string cors = "Access-Control-Allow-Origin: *\r\n"
-                             "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-                             "Access-Control-Allow-Headers: Authorization, Content-Type\r\n";
-            
-            if (method == "OPTIONS") {
-                response = "HTTP/1.1 204 No Content\r\n" + cors + "\r\n";
-            }
-            else if (base_path == "/health") {
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n"
-                          "{\"status\":\"ok\"}";
-            }
-            else if (!check_auth(request)) {
-                response = "HTTP/1.1 401 Unauthorized\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n"
-                          "{\"error\":\"Unauthorized\",\"success\":false}";
-            }
-            else if (base_path == "/api/status") {
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" +
-                          get_status_json();
-            }
-            else if (base_path == "/api/logs") {
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" +
-                          get_logs_json();
+void APIServer::register_routes() {
+    HttpServer& http = *http_;
+
+    http.set_guard([](const HttpRequest& req, HttpResponse& denied) {
+        if (req.path == "/health" || check_auth(req.authorization)) return true;
+        denied = HttpResponse::json({{"error", "Unauthorized"}, {"success", false}}, 401);
+        return false;
+    });
+
+    http.route("", "/health", [](const HttpRequest&) {
+        return HttpResponse{200, "{\"status\":\"ok\"}", "application/json"};
+    });
+
+    http.route("", "/api/status", [](const HttpRequest&) {
+        return HttpResponse{200, get_status_json(), "application/json"};
+    });
+
+    http.route("", "/api/logs", [](const HttpRequest& req) {
+        return HttpResponse{200, get_logs_json(req.query_uint("since", 0), req.query_uint("limit", MAX_LOGS)),
+                            "application/json"};
+    });
+
+    http.route("", "/api/config", [](const HttpRequest&) {
+        nlohmann::json cfg = {
+            {"success", true},
+            {"data", {
+                {"entryThreshold", 0.36},
+                {"shares", 10},
+                {"sumTarget", 0.99},
+                {"dcaEnabled", true},
+                {"tradingWindowSec", 120}
+            }}
+        };
+        return HttpResponse::json(cfg);
+    });
+
+    http.route("", "/api/trades", [](const HttpRequest&) {
+        nlohmann::json trades_data = nlohmann::json::array();
+
+        if (g_engine_ptr) {
+            auto snapshot = g_engine_ptr->status_snapshot();
+            const auto& status = *snapshot;
+            for (const auto& trade : status.recent_trades) {
+                nlohmann::json t;
+                t["id"] = trade.id;
+                t["market_slug"] = trade.market_slug;
+                t["leg"] = trade.leg;
+                t["side"] = side_name(trade.side);
+                t["token_id"] = trade.token_id;
+                t["shares"] = trade.shares;
+                t["price"] = trade.price;
+                t["cost"] = trade.cost;
+                t["fee"] = trade.fee;
+                t["pnl"] = trade.pnl;
+                t["is_live"] = trade.is_live;
+                t["timestamp"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    trade.timestamp.time_since_epoch()).count();
+                trades_data.push_back(t);
             }
-            else if (base_path == "/api/config") {
-                nlohmann::json cfg = {
-                    {"success", true},
-                    {"data", {
-                        {"entryThreshold", 0.36},
-                        {"shares", 10},
-                        {"sumTarget", 0.99},
-                        {"dcaEnabled", true},
-                        {"tradingWindowSec", 120}
-                    }}
-                };
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" + cfg.dump();
+        }
+
+        return HttpResponse::json({{"success", true}, {"data", trades_data}});
+    });
+
+    http.route("", "/api/cycles", [](const HttpRequest& req) {
+        // Finished cycles from the PnL ledger (restored from the database at
+        // startup), oldest first; ?limit=N keeps the newest N
+        nlohmann::json cycles_data = nlohmann::json::array();
+
+        if (g_engine_ptr) {
+            for (const auto& cycle : g_engine_ptr->pnl_ledger().cycles(req.query_uint("limit", 0))) {
+                nlohmann::json c;
+                c["id"] = cycle.id;
+                c["market_slug"] = cycle.market_slug;
+                c["status"] = cycle.status;
+                c["leg1_side"] = cycle.leg1_side;
+                c["leg1_price"] = cycle.leg1_price;
+                c["leg1_shares"] = cycle.leg1_shares;
+                c["leg2_side"] = cycle.leg2_side;
+                c["leg2_price"] = cycle.leg2_price;
+                c["leg2_shares"] = cycle.leg2_shares;
+                c["sum"] = cycle.leg1_price + cycle.leg2_price;
+                c["total_cost"] = cycle.total_cost.to_double();
+                c["pnl"] = cycle.pnl.to_double();
+                c["started"] = cycle.started_ms;
+                c["timestamp"] = cycle.ended_ms;
+                cycles_data.push_back(c);
             }
-            else if (base_path == "/api/trades") {
-                nlohmann::json trades_data = nlohmann::json::array();
-                
-                if (g_engine_ptr) {
-                    auto status = g_engine_ptr->get_status();
-                    for (const auto& trade : status.recent_trades) {
-                        nlohmann::json t;
-                        t["id"] = trade.id;
-                        t["market_slug"] = trade.market_slug;
-                        t["leg"] = trade.leg;
-                        t["side"] = trade.side;
-                        t["token_id"] = trade.token_id;
-                        t["shares"] = trade.shares;
-                        t["price"] = trade.price;
-                        t["cost"] = trade.cost;
-                        t["fee"] = trade.fee;
-                        t["pnl"] = trade.pnl;
-                        t["is_live"] = trade.is_live;
-                        t["timestamp"] = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            trade.timestamp.time_since_epoch()).count();
-                        trades_data.push_back(t);
-                    }
+        }
+
+        return HttpResponse::json({{"success", true}, {"data", cycles_data}});
+    });
+
+    http.route("", "/api/wallet", [](const HttpRequest&) {
+        // Check if we have a wallet configured
+        bool has_wallet = false;
+        std::string wallet_address = "";
+        double usdc_balance = 0.0;
+        double matic_balance = 0.0;
+        bool live_available = false;
+        std::string trading_mode = "PAPER";
+
+        if (g_engine_ptr) {
+            auto snapshot = g_engine_ptr->status_snapshot();
+            const auto& status = *snapshot;
+            usdc_balance = status.cash;
+            live_available = status.live_trading_available;
+            trading_mode = status.mode;
+
+            // Check environment for wallet
+            const char* pk = std::getenv("POLYMARKET_PRIVATE_KEY");
+            if (pk && strlen(pk) > 0) {
+                has_wallet = true;
+                // Show partial address (first 6 + last 4 chars of key)
+                std::string pk_str(pk);
+                if (pk_str.length() > 10) {
+                    wallet_address = "0x" + pk_str.substr(0, 4) + "..." + pk_str.substr(pk_str.length() - 4);
+                } else {
+                    wallet_address = "0x...configured";
                 }
-                
-                nlohmann::json trades = {{"success", true}, {"data", trades_data}};
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" + trades.dump();
             }
-            else if (base_path == "/api/cycles") {
-                nlohmann::json cycles_data = nlohmann::json::array();
-                
-                if (g_engine_ptr) {
-                    auto status = g_engine_ptr->get_status();
-                    // Return completed cycles (derived from trade pairs)
-                    // Group trades by cycle: every 2 trades = 1 cycle
-                    for (size_t i = 0; i + 1 < status.recent_trades.size(); i += 2) {
-                        const auto& leg1 = status.recent_trades[i];
-                        const auto& leg2 = status.recent_trades[i + 1];
-                        
-                        nlohmann::json c;
-                        c["market_slug"] = leg1.market_slug;
-                        c["leg1_side"] = leg1.side;
-                        c["leg1_price"] = leg1.price;
-                        c["leg1_shares"] = leg1.shares;
-                        c["leg2_side"] = leg2.side;
-                        c["leg2_price"] = leg2.price;
-                        c["leg2_shares"] = leg2.shares;
-                        c["sum"] = leg1.price + leg2.price;
-                        c["pnl"] = (1.0 - (leg1.price + leg2.price)) * leg1.shares;
-                        c["timestamp"] = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            leg2.timestamp.time_since_epoch()).count();
-                        cycles_data.push_back(c);
+        }
+
+        nlohmann::json wallet = {
+            {"success", true},
+            {"data", {
+                {"hasWallet", has_wallet},
+                {"address", has_wallet ? wallet_address : nullptr},
+                {"balance", {{"usdc", usdc_balance}, {"matic", matic_balance}}},
+                {"liveAvailable", live_available},
+                {"tradingMode", trading_mode},
+                {"canTradeLive", has_wallet && live_available}
+            }}
+        };
+        return HttpResponse::json(wallet);
+    });
+
+    http.route("GET", "/api/wallet/private-key", [](const HttpRequest&) {
+        // Return private key (with auth check already done by the guard)
+        const char* pk = std::getenv("POLYMARKET_PRIVATE_KEY");
+        nlohmann::json resp;
+        if (pk && strlen(pk) > 0) {
+            resp = {{"success", true}, {"data", {{"privateKey", std::string(pk)}}}};
+        } else {
+            resp = {{"success", false}, {"error", "No wallet configured"}};
+        }
+        return HttpResponse::json(resp);
+    });
+
+    http.route("POST", "/api/wallet/generate", [](const HttpRequest&) {
+        // Generate new wallet - for now just return info about manual setup
+        return HttpResponse::json({
+            {"success", false},
+            {"error", "Wallet generation must be done manually. Set POLYMARKET_PRIVATE_KEY in .env file."}
+        });
+    });
+
+    http.route("POST", "/api/wallet/withdraw", [](const HttpRequest&) {
+        // Withdrawal not yet implemented
+        return HttpResponse::json({
+            {"success", false},
+            {"error", "Withdrawal not implemented. Use Polymarket UI to withdraw funds."}
+        });
+    });
+
+    // Switching to LIVE syncs the balance over REST - off the I/O threads
+    http.route("POST", "/api/trading-mode", [](const HttpRequest& req) {
+        try {
+            auto j = nlohmann::json::parse(req.body);
+            std::string mode = j.value("mode", "PAPER");
+
+            nlohmann::json resp;
+            if (mode == "LIVE") {
+                // Check if live trading is available
+                const char* pk = std::getenv("POLYMARKET_PRIVATE_KEY");
+                if (pk && strlen(pk) > 0) {
+                    if (g_engine_ptr) {
+                        g_engine_ptr->set_trading_mode(TradingMode::LIVE);
                     }
+                    add_log("warn", "MODE", "⚠️ LIVE TRADING ENABLED - Real money trades!");
+                    resp = {{"success", true}, {"data", {{"mode", "LIVE"}, {"message", "Live trading enabled!"}}}};
+                } else {
+                    resp = {{"success", false}, {"error", "Cannot enable live trading: No private key configured"}};
                 }
-                
-                nlohmann::json cycles = {{"success", true}, {"data", cycles_data}};
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" + cycles.dump();
-            }
-            else if (base_path == "/api/wallet") {
-                // Check if we have a wallet configured
-                bool has_wallet = false;
-                std::string wallet_address = "";
-                double usdc_balance = 0.0;
-                double matic_balance = 0.0;
-                bool live_available = false;
-                std::string trading_mode = "PAPER";
-                
+            } else {
                 if (g_engine_ptr) {
-                    auto status = g_engine_ptr->get_status();
-                    usdc_balance = status.cash;
-                    live_available = status.live_trading_available;
-                    trading_mode = status.mode;
-                    
-                    // Check environment for wallet
-                    const char* pk = std::getenv("POLYMARKET_PRIVATE_KEY");
-                    if (pk && strlen(pk) > 0) {
-                        has_wallet = true;
-                        // Show partial address (first 6 + last 4 chars of key)
-                        std::string pk_str(pk);
-                        if (pk_str.length() > 10) {
-                            wallet_address = "0x" + pk_str.substr(0, 4) + "..." + pk_str.substr(pk_str.length() - 4);
-                        } else {
-                            wallet_address = "0x...configured";
-                        }
-                    }
+                    g_engine_ptr->set_trading_mode(TradingMode::PAPER);
                 }
-                
-                nlohmann::json wallet = {
-                    {"success", true},
-                    {"data", {
-                        {"hasWallet", has_wallet},
-                        {"address", has_wallet ? wallet_address : nullptr},
-                        {"balance", {{"usdc", usdc_balance}, {"matic", matic_balance}}},
-                        {"liveAvailable", live_available},
-                        {"tradingMode", trading_mode},
-                        {"canTradeLive", has_wallet && live_available}
-                    }}
-                };
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" + wallet.dump();
+                add_log("info", "MODE", "Paper trading mode");
+                resp = {{"success", true}, {"data", {{"mode", "PAPER"}, {"message", "Paper trading mode enabled"}}}};
             }
-            else if (base_path == "/api/wallet/private-key" && method == "GET") {
-                // Return private key (with auth check already done above)
-                const char* pk = std::getenv("POLYMARKET_PRIVATE_KEY");
-                nlohmann::json resp;
-                if (pk && strlen(pk) > 0) {
-                    resp = {{"success", true}, {"data", {{"privateKey", std::string(pk)}}}};
-                } else {
-                    resp = {{"success", false}, {"error", "No wallet configured"}};
-                }
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" + resp.dump();
+            return HttpResponse::json(resp);
+        } catch (...) {
+            return HttpResponse::json({{"error", "Invalid JSON"}, {"success", false}}, 400);
+        }
+    }, true);
+
+    http.route("", "/api/network", [](const HttpRequest&) {
+        // REST connection pool: reuse ratio and handshake cost per host
+        auto pool = HttpPool::instance().stats();
+        nlohmann::json hosts = nlohmann::json::array();
+        for (const auto& h : pool.hosts) {
+            uint64_t ok = h.requests - h.errors;
+            hosts.push_back({
+                {"host", h.host},
+                {"requests", h.requests},
+                {"reused", h.reused},
+                {"newConnections", h.new_connections},
+                {"errors", h.errors},
+                {"reuseRatio", ok > 0 ? static_cast<double>(h.reused) / ok : 0.0},
+                {"lastHandshakeMs", h.last_handshake_ms},
+                {"maxHandshakeMs", h.max_handshake_ms},
+                {"avgHandshakeMs", h.new_connections > 0 ? h.total_handshake_ms / h.new_connections : 0.0},
+                {"avgRequestMs", h.requests > 0 ? h.total_request_ms / h.requests : 0.0},
+                {"httpVersion", h.http_version}
+            });
+        }
+        nlohmann::json net = {
+            {"success", true},
+            {"data", {
+                {"hosts", hosts},
+                {"warmPings", pool.warm_pings},
+                {"idleHandles", pool.idle_handles}
+            }}
+        };
+        
+        // Market WebSocket: phases of the latest connect, in ms from its start
+        if (WebSocketPriceStream* stream = g_market_stream.load()) {
+            auto ws = stream->connect_stats();
+            net["data"]["marketStream"] = {
+                {"connected", stream->is_connected()},
+                {"attempts", ws.attempts},
+                {"connects", ws.connects},
+                {"dnsLookups", ws.dns_lookups},
+                {"failovers", ws.failovers},
+                {"tlsResumed", ws.tls_resumed},
+                {"endpoint", ws.endpoint},
+                {"resumed", ws.resumed},
+                {"dnsMs", ws.dns_us / 1000.0},
+                {"tcpMs", ws.tcp_us / 1000.0},
+                {"tlsMs", ws.tls_us / 1000.0},
+                {"wsMs", ws.ws_us / 1000.0},
+                {"firstFrameMs", ws.first_frame_us / 1000.0},
+                {"firstBookMs", ws.first_book_us / 1000.0}
+            };
+            // Redundant feeds: who delivered each update first
+            nlohmann::json feeds = nlohmann::json::array();
+            for (const auto& feed : stream->feed_stats()) {
+                feeds.push_back({
+                    {"connected", feed.connected},
+                    {"endpoint", feed.connect.endpoint},
+                    {"connects", feed.connect.connects},
+                    {"forwarded", feed.forwarded},
+                    {"duplicates", feed.duplicates},
+                    {"firstBookMs", feed.connect.first_book_us / 1000.0}
+                });
             }
-            else if (base_path == "/api/wallet/generate" && method == "POST") {
-                // Generate new wallet - for now just return info about manual setup
-                nlohmann::json resp = {
-                    {"success", false},
-                    {"error", "Wallet generation must be done manually. Set POLYMARKET_PRIVATE_KEY in .env file."}
-                };
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" + resp.dump();
+            net["data"]["marketStream"]["feeds"] = feeds;
+        }
+        
+        // Book integrity: feed gaps and REST resyncs
+        if (g_engine_ptr) {
+            auto books = g_engine_ptr->book_sync_stats();
+            net["data"]["bookSync"] = {
+                {"gaps", books.gaps},
+                {"refreshes", books.refreshes},
+                {"resyncs", books.resyncs},
+                {"resyncFailures", books.resync_failures},
+                {"resyncsSuperseded", books.resyncs_superseded},
+                {"deltasReplayed", books.deltas_replayed},
+                {"staleTicks", books.stale_ticks}
+            };
+        }
+        return HttpResponse::json(net);
+    });
+
+    http.route("", "/api/orders", [](const HttpRequest&) {
+        // Orders between decision and settlement
+        nlohmann::json open = nlohmann::json::array();
+        nlohmann::json counts = nlohmann::json::object();
+        if (g_engine_ptr) {
+            for (const auto& o : g_engine_ptr->open_orders()) {
+                open.push_back({
+                    {"id", o.id},
+                    {"exchangeId", o.exchange_id},
+                    {"market", o.request.market_slug},
+                    {"leg", o.request.leg},
+                    {"side", side_name(o.request.side)},
+                    {"shares", o.request.shares},
+                    {"price", o.request.price},
+                    {"state", order_state_name(o.state)},
+                    {"filled", o.filled_shares},
+                    {"live", o.request.live}
+                });
             }
-            else if (base_path == "/api/wallet/withdraw" && method == "POST") {
-                // Withdrawal not yet implemented
-                nlohmann::json resp = {
-                    {"success", false},
-                    {"error", "Withdrawal not implemented. Use Polymarket UI to withdraw funds."}
-                };
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" + resp.dump();
+            auto st = g_engine_ptr->order_stats();
+            counts = {
+                {"submitted", st.submitted},
+                {"acked", st.acked},
+                {"filled", st.filled},
+                {"cancelled", st.cancelled},
+                {"rejected", st.rejected}
+            };
+        }
+        return HttpResponse::json({{"success", true}, {"data", {{"open", open}, {"counts", counts}}}});
+    });
+
+    http.route("", "/api/db", [](const HttpRequest&) {
+        // Trade writer: batch sizes and send-to-commit latency
+        nlohmann::json data = {{"connected", false}};
+        if (AsyncTradeWriter* writer = g_trade_writer.load()) {
+            auto st = writer->stats();
+            data = {
+                {"connected", true},
+                {"tradesWritten", st.trades_written},
+                {"tradesFailed", st.trades_failed},
+                {"batches", st.batches},
+                {"batchesFailed", st.batches_failed},
+                {"pending", st.pending},
+                {"dropped", st.dropped},
+                {"spilled", st.spilled},
+                {"blocked", st.blocked},
+                {"cyclesWritten", st.cycles_written},
+                {"snapshotsWritten", st.snapshots_written},
+                {"recordsFailed", st.records_failed},
+                {"batchSize", {{"last", st.last_batch}, {"max", st.max_batch}, {"avg", st.avg_batch}}},
+                {"commitUs", {{"last", st.last_commit_us}, {"max", st.max_commit_us}, {"avg", st.avg_commit_us}}}
+            };
+        }
+        return HttpResponse::json({{"success", true}, {"data", data}});
+    });
+
+    http.route("", "/api/shadow", [](const HttpRequest&) {
+        // Paper strategies on the live ticks, next to the primary's results
+        nlohmann::json primary = nullptr;
+        if (g_engine_ptr) {
+            auto status = g_engine_ptr->status_snapshot();
+            primary = strategy_json(status->strategy, *status);
+            primary["mode"] = status->mode;
+        }
+        nlohmann::json shadows = nlohmann::json::array();
+        if (ShadowFleet* fleet = g_shadow_fleet.load()) {
+            for (const auto& shadow : fleet->summaries()) {
+                auto entry = strategy_json(shadow.strategy, *shadow.status);
+                entry["name"] = shadow.name;
+                entry["events"] = shadow.events;
+                entry["dropped"] = shadow.dropped;
+                entry["queued"] = shadow.queued;
+                shadows.push_back(std::move(entry));
             }
-            else if (base_path == "/api/trading-mode" && method == "POST") {
-                size_t body_start = request.find("\r\n\r\n");
-                if (body_start != std::string::npos) {
-                    std::string body = request.substr(body_start + 4);
-                    try {
-                        auto j = nlohmann::json::parse(body);
-                        std::string mode = j.value("mode", "PAPER");
-                        
-                        nlohmann::json resp;
-                        if (mode == "LIVE") {
-                            // Check if live trading is available
-                            const char* pk = std::getenv("POLYMARKET_PRIVATE_KEY");
-                            if (pk && strlen(pk) > 0) {
-                                if (g_engine_ptr) {
-                                    g_engine_ptr->set_trading_mode(TradingMode::LIVE);
-                                }
-                                add_log("warn", "MODE", "⚠️ LIVE TRADING ENABLED - Real money trades!");
-                                resp = {{"success", true}, {"data", {{"mode", "LIVE"}, {"message", "Live trading enabled!"}}}};
-                            } else {
-                                resp = {{"success", false}, {"error", "Cannot enable live trading: No private key configured"}};
-                            }
-                        } else {
-                            if (g_engine_ptr) {
-                                g_engine_ptr->set_trading_mode(TradingMode::PAPER);
-                            }
-                            add_log("info", "MODE", "Paper trading mode");
-                            resp = {{"success", true}, {"data", {{"mode", "PAPER"}, {"message", "Paper trading mode enabled"}}}};
-                        }
-                        response = "HTTP/1.1 200 OK\r\n" + cors +
-                                  "Content-Type: application/json\r\n\r\n" + resp.dump();
-                    } catch (...) {
-                        response = "HTTP/1.1 400 Bad Request\r\n" + cors +
-                                  "Content-Type: application/json\r\n\r\n"
-                                  "{\"error\":\"Invalid JSON\",\"success\":false}";
-                    }
-                } else {
-                    response = "HTTP/1.1 400 Bad Request\r\n" + cors + "\r\n";
+        }
+        return HttpResponse::json({{"success", true}, {"data", {{"primary", primary}, {"shadows", shadows}}}});
+    });
+
+    http.route("", "/api/latency", [](const HttpRequest&) {
+        // Stage-to-stage spans since start (or the last reset)
+        return HttpResponse::json({{"success", true}, {"data", {{"spans", get_latency_json()}}}});
+    });
+
+    http.route("POST", "/api/latency/reset", [](const HttpRequest&) {
+        LatencyMonitor::instance().reset();
+        add_log("info", "LATENCY", "Latency histograms reset");
+        return HttpResponse{200, "{\"success\":true}", "application/json"};
+    });
+
+    // Equity curve, oldest first. Default: the PnL ledger's buckets at
+    // ?resolution=1m|15m|1h|1d (closing marks). ?source=ticks reads the
+    // tick store's raw samples instead (empty without --ticks).
+    http.route("", "/api/equity", [](const HttpRequest& req) {
+        nlohmann::json data = nlohmann::json::array();
+        const size_t limit = req.query_uint("limit", 1000);
+        if (req.query("source") == "ticks") {
+            TickRecorder* recorder = g_tick_recorder.load();
+            TickReader reader;
+            std::string error;
+            if (recorder && reader.open(tick_file_path(recorder->dir(), "_equity"), error)) {
+                std::vector<EquityRow> rows;
+                reader.read_equity(0, INT64_MAX, rows, limit);
+                for (const auto& row : rows) {
+                    data.push_back({
+                        {"timestamp", row.ts_ms},
+                        {"equity", row.equity.to_double()},
+                        {"cash", row.cash.to_double()},
+                        {"unrealized", row.unrealized.to_double()},
+                        {"realized", row.realized.to_double()}
+                    });
                 }
             }
-            else if (base_path == "/api/equity") {
-                // Return equity history (empty for now, just return current equity)
-                nlohmann::json equity = {
-                    {"success", true},
-                    {"data", nlohmann::json::array()}
-                };
-                response = "HTTP/1.1 200 OK\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n" + equity.dump();
+            return HttpResponse::json({{"success", true}, {"data", data}});
+        }
+
+        PnlLedger::Resolution resolution = PnlLedger::Resolution::MINUTE;
+        const std::string res_text = req.query("resolution");
+        if (!res_text.empty() && !PnlLedger::parse_resolution(res_text, resolution)) {
+            return HttpResponse::json({{"success", false}, {"error", "resolution: 1m, 15m, 1h or 1d"}}, 400);
+        }
+        if (g_engine_ptr) {
+            for (const auto& bucket : g_engine_ptr->pnl_ledger().rollup(resolution, limit)) {
+                if (!bucket.marked) continue;
+                data.push_back(equity_bucket_json(bucket));
             }
-            else if (base_path == "/api/command" && method == "POST") {
-                size_t body_start = request.find("\r\n\r\n");
-                if (body_start != std::string::npos) {
-                    std::string body = request.substr(body_start + 4);
-                    try {
-                        auto j = nlohmann::json::parse(body);
-                        std::string cmd = j.value("command", "");
-                        std::string result = process_command(cmd);
-                        nlohmann::json resp = {{"success", true}, {"data", result}};
-                        response = "HTTP/1.1 200 OK\r\n" + cors +
-                                  "Content-Type: application/json\r\n\r\n" + resp.dump();
-                    } catch (...) {
-                        response = "HTTP/1.1 400 Bad Request\r\n" + cors +
-                                  "Content-Type: application/json\r\n\r\n"
-                                  "{\"error\":\"Invalid JSON\",\"success\":false}";
-                    }
-                } else {
-                    response = "HTTP/1.1 400 Bad Request\r\n" + cors + "\r\n";
-                }
+        }
+        return HttpResponse::json({{"success", true}, {"data", data}});
+    }, true);
+
+    // PnL ledger: running totals, per market, and ?resolution= buckets
+    // (default 15m, newest ?limit=N, default 96)
+    http.route("", "/api/pnl", [](const HttpRequest& req) {
+        if (!g_engine_ptr) {
+            return HttpResponse::json({{"success", false}, {"error", "Engine not running"}}, 503);
+        }
+        PnlLedger::Resolution resolution = PnlLedger::Resolution::QUARTER;
+        const std::string res_text = req.query("resolution");
+        if (!res_text.empty() && !PnlLedger::parse_resolution(res_text, resolution)) {
+            return HttpResponse::json({{"success", false}, {"error", "resolution: 1m, 15m, 1h or 1d"}}, 400);
+        }
+        const PnlLedger& ledger = g_engine_ptr->pnl_ledger();
+        const auto totals = ledger.totals();
+
+        nlohmann::json markets = nlohmann::json::array();
+        for (const auto& m : ledger.markets()) {
+            markets.push_back({
+                {"slug", m.slug},
+                {"realized", m.realized.to_double()},
+                {"unrealized", m.unrealized.to_double()},
+                {"volume", m.volume.to_double()},
+                {"fills", m.fills},
+                {"cyclesCompleted", m.cycles_completed},
+                {"cyclesAbandoned", m.cycles_abandoned},
+                {"bestCycle", m.best_cycle.to_double()},
+                {"worstCycle", m.worst_cycle.to_double()},
+                {"lastMs", m.last_ms}
+            });
+        }
+        nlohmann::json buckets = nlohmann::json::array();
+        for (const auto& bucket : ledger.rollup(resolution, req.query_uint("limit", 96))) {
+            auto b = equity_bucket_json(bucket);
+            b["pnl"] = bucket.realized.to_double();
+            b["volume"] = bucket.volume.to_double();
+            b["fills"] = bucket.fills;
+            b["cyclesCompleted"] = bucket.cycles_completed;
+            b["cyclesAbandoned"] = bucket.cycles_abandoned;
+            b["marked"] = bucket.marked;
+            buckets.push_back(std::move(b));
+        }
+
+        return HttpResponse::json({{"success", true}, {"data", {
+            {"totals", {
+                {"realized", totals.realized.to_double()},
+                {"unrealized", totals.unrealized.to_double()},
+                {"equity", totals.equity.to_double()},
+                {"cash", totals.cash.to_double()},
+                {"volume", totals.volume.to_double()},
+                {"fills", totals.fills},
+                {"cyclesCompleted", totals.cycles_completed},
+                {"cyclesAbandoned", totals.cycles_abandoned},
+                {"markedMs", totals.marked_ms}
+            }},
+            {"markets", markets},
+            {"resolution", PnlLedger::name(resolution)},
+            {"buckets", buckets}
+        }}});
+    });
+
+    // Warm-restart checkpoints: where they go and how long they take
+    http.route("", "/api/snapshot", [](const HttpRequest&) {
+        EngineCheckpointer* checkpointer = g_checkpointer.load();
+        if (!checkpointer) {
+            return HttpResponse::json({{"success", false}, {"error", "Snapshots off (--snapshot=)"}}, 404);
+        }
+        auto st = checkpointer->stats();
+        return HttpResponse::json({{"success", true}, {"data", {
+            {"path", checkpointer->path()},
+            {"checkpoints", st.checkpoints},
+            {"unchanged", st.unchanged},
+            {"errors", st.errors},
+            {"lastBytes", st.last_bytes},
+            {"lastUs", st.last_us},
+            {"maxUs", st.max_us},
+            {"lastMs", st.last_ms}
+        }}});
+    });
+
+    // Tick store. No slug: the files and the recorder's counters. With
+    // ?slug=S[&side=up|down][&from=MS][&to=MS][&limit=N]: that market's
+    // rows in the range, newest `limit` (default 1000), oldest first.
+    http.route("", "/api/ticks", [](const HttpRequest& req) {
+        TickRecorder* recorder = g_tick_recorder.load();
+        if (!recorder) {
+            return HttpResponse::json({{"success", false}, {"error", "Tick store off (--ticks=DIR)"}}, 404);
+        }
+        const auto slugs = list_tick_files(recorder->dir());
+        const std::string slug = req.query("slug");
+        if (slug.empty()) {
+            auto st = recorder->stats();
+            nlohmann::json files = nlohmann::json::array();
+            for (const auto& name : slugs) {
+                TickReader reader;
+                std::string error;
+                if (!reader.open(tick_file_path(recorder->dir(), name), error)) continue;
+                const auto& info = reader.info();
+                files.push_back({
+                    {"slug", name},
+                    {"kind", info.kind == TickReader::Kind::EQUITY ? "equity" : "book"},
+                    {"rows", info.rows},
+                    {"blocks", info.blocks},
+                    {"bytes", info.file_bytes},
+                    {"firstMs", info.first_ms},
+                    {"lastMs", info.last_ms}
+                });
             }
-            else {
-                response = "HTTP/1.1 404 Not Found\r\n" + cors +
-                          "Content-Type: application/json\r\n\r\n"
-                          "{\"error\":\"Not Found\",\"success\":false}";
+            return HttpResponse::json({{"success", true}, {"data", {
+                {"dir", recorder->dir()},
+                {"files", files},
+                {"recorder", {
+                    {"rows", st.rows},
+                    {"blocks", st.blocks},
+                    {"encodedBytes", st.raw_bytes},
+                    {"storedBytes", st.stored_bytes},
+                    {"writeErrors", st.write_errors},
+                    {"openFiles", st.open_files}
+                }}
+            }}});
+        }
+
+        // Only names the store wrote - the slug never reaches the filesystem raw
+        if (std::find(slugs.begin(), slugs.end(), slug) == slugs.end()) {
+            return HttpResponse::json({{"success", false}, {"error", "No ticks for " + slug}}, 404);
+        }
+        TickReader reader;
+        std::string error;
+        std::vector<TickRow> rows;
+        const std::string side_name = req.query("side");
+        std::optional<Side> side;
+        if (side_name == "up") side = Side::UP;
+        if (side_name == "down") side = Side::DOWN;
+        const int64_t from = static_cast<int64_t>(req.query_uint("from", 0));
+        const int64_t to = static_cast<int64_t>(std::min<uint64_t>(req.query_uint("to", INT64_MAX), INT64_MAX));
+        if (!reader.open(tick_file_path(recorder->dir(), slug), error) ||
+            !reader.read_book(from, to, rows, req.query_uint("limit", 1000), side)) {
+            return HttpResponse::json({{"success", false}, {"error", error.empty() ? "Unreadable ticks" : error}}, 500);
+        }
+        auto levels_json = [](const std::array<BookLevel, kTickDepth>& levels) {
+            nlohmann::json out = nlohmann::json::array();
+            for (const auto& level : levels) {
+                if (!level.size.positive()) break;
+                out.push_back({level.price.to_double(), level.size.to_double()});
             }
-            
-            send(client, response.c_str(), response.size(), 0);
+            return out;
+        };
+        nlohmann::json data = nlohmann::json::array();
+        for (const auto& row : rows) {
+            data.push_back({
+                {"t", row.ts_ms},
+                {"side", row.side == Side::UP ? "up" : "down"},
+                {"bid", row.best_bid().to_double()},
+                {"ask", row.best_ask().to_double()},
+                {"last", row.last_trade.to_double()},
+                {"bids", levels_json(row.bids)},
+                {"asks", levels_json(row.asks)}
+            });
         }
-        
-        close(client);
-    }
+        return HttpResponse::json({{"success", true}, {"data", data}});
+    }, true);
+
+    // Commands change engine settings - one at a time, off the I/O threads
+    http.route("POST", "/api/command", [](const HttpRequest& req) {
+        try {
+            auto j = nlohmann::json::parse(req.body);
+            std::string cmd = j.value("command", "");
+            std::string result = process_command(cmd);
+            return HttpResponse::json({{"success", true}, {"data", result}});
+        } catch (...) {
+            return HttpResponse::json({{"error", "Invalid JSON"}, {"success", false}}, 400);
+        }
+    }, true);
 }
 
 } // namespace poly
@@ -0,0 +1,112 @@
+#include "dashboard_feed.hpp"
+#include "order_book.hpp"
+#include "ws_server.hpp"
+
+namespace poly {
+
+namespace {
+
+using Levels = std::vector<std::pair<double, double>>;
+
+nlohmann::json levels_json(const Levels& levels) {
+    nlohmann::json out = nlohmann::json::array();
+    for (const auto& [price, size] : levels) {
+        out.push_back({{"price", price}, {"size", size}});
+    }
+    return out;
+}
+
+nlohmann::json book_json(const EngineStatus::OrderbookData& book) {
+    return {{"asks", levels_json(book.asks)}, {"bids", levels_json(book.bids)}};
+}
+
+// Levels in `now` that differ from `before`, plus removed ones with size 0.
+// Both lists are sorted best first: asks ascending, bids descending.
+nlohmann::json diff_levels(const Levels& before, const Levels& now, bool ascending) {
+    nlohmann::json out = nlohmann::json::array();
+    auto ahead = [ascending](int a, int b) { return ascending ? a < b : a > b; };
+    size_t i = 0, j = 0;
+    while (i < before.size() || j < now.size()) {
+        int old_tick = i < before.size() ? OrderBook::price_to_tick(before[i].first) : 0;
+        int new_tick = j < now.size() ? OrderBook::price_to_tick(now[j].first) : 0;
+        if (j == now.size() || (i < before.size() && ahead(old_tick, new_tick))) {
+            out.push_back({{"price", before[i].first}, {"size", 0.0}});
+            ++i;
+        } else if (i == before.size() || ahead(new_tick, old_tick)) {
+            out.push_back({{"price", now[j].first}, {"size", now[j].second}});
+            ++j;
+        } else {
+            if (before[i].second != now[j].second) {
+                out.push_back({{"price", now[j].first}, {"size", now[j].second}});
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return out;
+}
+
+void diff_book(const char* name, const EngineStatus::OrderbookData& before,
+               const EngineStatus::OrderbookData& now, nlohmann::json& books) {
+    nlohmann::json asks = diff_levels(before.asks, now.asks, true);
+    nlohmann::json bids = diff_levels(before.bids, now.bids, false);
+    if (asks.empty() && bids.empty()) return;
+    nlohmann::json& side = books[name];
+    if (!asks.empty()) side["asks"] = std::move(asks);
+    if (!bids.empty()) side["bids"] = std::move(bids);
+}
+
+} // namespace
+
+std::string DashboardFeed::full_json() const {
+    nlohmann::json msg;
+    msg["type"] = "fullStatus";
+    msg["version"] = version_;
+    msg["market"] = last_.market;
+    msg["inTrading"] = last_.in_trading;
+    msg["timeLeft"] = last_.time_left;
+    msg["wsConnected"] = last_.ws_connected;
+    msg["userWsConnected"] = last_.user_ws_connected;
+    msg["orderbooks"] = {{"UP", book_json(last_.books.up)}, {"DOWN", book_json(last_.books.down)}};
+    if (!latency_.is_null()) msg["latency"] = latency_;
+    return msg.dump();
+}
+
+void DashboardFeed::publish(WSServer& server, const DashboardFrame& frame, const nlohmann::json* latency) {
+    nlohmann::json delta = nlohmann::json::object();
+    if (frame.market != last_.market) delta["market"] = frame.market;
+    if (frame.in_trading != last_.in_trading) delta["inTrading"] = frame.in_trading;
+    if (frame.time_left != last_.time_left) delta["timeLeft"] = frame.time_left;
+    if (frame.ws_connected != last_.ws_connected) delta["wsConnected"] = frame.ws_connected;
+    if (frame.user_ws_connected != last_.user_ws_connected) delta["userWsConnected"] = frame.user_ws_connected;
+
+    // The snapshot version only moves when a book does - skip the level walk otherwise
+    if (frame.books.slug != last_.books.slug || frame.books.version != last_.books.version) {
+        nlohmann::json books = nlohmann::json::object();
+        diff_book("UP", last_.books.up, frame.books.up, books);
+        diff_book("DOWN", last_.books.down, frame.books.down, books);
+        if (!books.empty()) delta["orderbooks"] = std::move(books);
+    }
+    if (latency) {
+        latency_ = *latency;
+        delta["latency"] = latency_;
+    }
+
+    std::shared_ptr<const std::string> delta_msg;
+    if (!delta.empty()) {
+        last_ = frame;
+        ++version_;
+        delta["type"] = "statusDelta";
+        delta["version"] = version_;
+        delta["base"] = version_ - 1;
+        delta_msg = std::make_shared<const std::string>(delta.dump());
+    }
+    if (version_ == 0) return;  // Nothing to show yet
+
+    // Still called when nothing changed: new and conflated sessions need their full frame
+    server.broadcast_status(version_, delta_msg, [this] {
+        return std::make_shared<const std::string>(full_json());
+    });
+}
+
+} // namespace poly
@@ -0,0 +1,227 @@
+#include "http_server.hpp"
+#include "io_pool.hpp"
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace poly {
+
+namespace {
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+struct Route {
+    std::string method;  // "" = any
+    HttpHandler handler;
+    bool blocking;
+};
+
+HttpResponse run_handler(const HttpHandler& handler, const HttpRequest& request) {
+    try {
+        return handler(request);
+    } catch (const std::exception& e) {
+        return HttpResponse::json({{"success", false}, {"error", e.what()}}, 500);
+    }
+}
+} // namespace
+
+std::string HttpRequest::query(const std::string& key) const {
+    size_t qpos = target.find('?');
+    while (qpos != std::string::npos) {
+        size_t start = qpos + 1;
+        size_t end = target.find('&', start);
+        std::string pair = target.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (pair.size() > key.size() && pair.compare(0, key.size(), key) == 0 && pair[key.size()] == '=') {
+            return pair.substr(key.size() + 1);
+        }
+        qpos = end;
+    }
+    return "";
+}
+
+uint64_t HttpRequest::query_uint(const std::string& key, uint64_t fallback) const {
+    std::string value = query(key);
+    if (value.empty()) return fallback;
+    try {
+        return std::stoull(value);
+    } catch (...) {
+        return fallback;
+    }
+}
+
+struct HttpServer::State : std::enable_shared_from_this<State> {
+    unsigned short port;
+    tcp::acceptor acceptor;
+    std::unordered_map<std::string, std::vector<Route>> routes;
+    std::function<bool(const HttpRequest&, HttpResponse&)> guard;
+    std::atomic<bool> running{false};
+
+    explicit State(unsigned short p)
+        : port(p), acceptor(net::make_strand(IoPool::instance().context())) {}
+
+    const Route* find(const HttpRequest& request) const {
+        auto it = routes.find(request.path);
+        if (it == routes.end()) return nullptr;
+        for (const auto& route : it->second) {
+            if (route.method.empty() || route.method == request.method) return &route;
+        }
+        return nullptr;
+    }
+
+    void do_accept();
+};
+
+namespace {
+
+// One client connection: read a request, answer it, repeat while the client
+// keeps the connection alive
+class HttpSession : public std::enable_shared_from_this<HttpSession> {
+public:
+    HttpSession(tcp::socket socket, std::shared_ptr<HttpServer::State> state)
+        : stream_(std::move(socket)), state_(std::move(state)) {}
+
+    void run() {
+        net::dispatch(stream_.get_executor(), [self = shared_from_this()] { self->do_read(); });
+    }
+
+private:
+    void do_read() {
+        parser_.emplace();
+        parser_->body_limit(HttpServer::kMaxBody);
+        stream_.expires_after(std::chrono::seconds(HttpServer::kIdleTimeoutSec));
+        http::async_read(stream_, buffer_, *parser_, [self = shared_from_this()](beast::error_code ec, std::size_t) {
+            self->on_read(ec);
+        });
+    }
+
+    void on_read(beast::error_code ec) {
+        if (ec == http::error::end_of_stream) return close();
+        if (ec == http::error::body_limit) {
+            keep_alive_ = false;
+            return reply(HttpResponse::json({{"success", false}, {"error", "Request body too large"}}, 413));
+        }
+        if (ec) return;  // Idle timeout or reset: just drop the connection
+
+        http::request<http::string_body> req = parser_->release();
+        keep_alive_ = req.keep_alive();
+        version_ = req.version();
+
+        HttpRequest request;
+        request.method = std::string(req.method_string());
+        request.target = std::string(req.target());
+        request.path = request.target.substr(0, request.target.find('?'));
+        request.authorization = std::string(req[http::field::authorization]);
+        request.body = std::move(req.body());
+
+        if (req.method() == http::verb::options) return reply(HttpResponse{204, "", ""});
+
+        HttpResponse denied;
+        if (state_->guard && !state_->guard(request, denied)) return reply(std::move(denied));
+
+        const Route* route = state_->find(request);
+        if (!route) return reply(HttpResponse::json({{"error", "Not Found"}, {"success", false}}, 404));
+
+        if (!route->blocking) return reply(run_handler(route->handler, request));
+
+        net::post(IoPool::instance().blocking(), [self = shared_from_this(), route, request = std::move(request)] {
+            HttpResponse response = run_handler(route->handler, request);
+            net::post(self->stream_.get_executor(), [self, response = std::move(response)]() mutable {
+                self->reply(std::move(response));
+            });
+        });
+    }
+
+    void reply(HttpResponse response) {
+        response_ = {};
+        response_.version(version_);
+        response_.result(response.status);
+        response_.set(http::field::server, "PolyTrader/1.0");
+        response_.set(http::field::access_control_allow_origin, "*");
+        response_.set(http::field::access_control_allow_methods, "GET, POST, OPTIONS");
+        response_.set(http::field::access_control_allow_headers, "Authorization, Content-Type");
+        if (!response.content_type.empty()) response_.set(http::field::content_type, response.content_type);
+        response_.keep_alive(keep_alive_);
+        response_.body() = std::move(response.body);
+        response_.prepare_payload();
+
+        stream_.expires_after(std::chrono::seconds(HttpServer::kIdleTimeoutSec));
+        http::async_write(stream_, response_, [self = shared_from_this()](beast::error_code ec, std::size_t) {
+            if (ec) return;
+            if (!self->keep_alive_) return self->close();
+            self->do_read();
+        });
+    }
+
+    void close() {
+        beast::error_code ec;
+        stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+    }
+
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    std::optional<http::request_parser<http::string_body>> parser_;
+    http::response<http::string_body> response_;
+    std::shared_ptr<HttpServer::State> state_;
+    bool keep_alive_ = false;
+    unsigned version_ = 11;
+};
+
+} // namespace
+
+void HttpServer::State::do_accept() {
+    acceptor.async_accept(net::make_strand(IoPool::instance().context()),
+                          [self = shared_from_this()](beast::error_code ec, tcp::socket socket) {
+        if (!self->running) return;
+        if (!ec) std::make_shared<HttpSession>(std::move(socket), self)->run();
+        self->do_accept();
+    });
+}
+
+HttpServer::HttpServer(unsigned short port) : state_(std::make_shared<State>(port)) {}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+void HttpServer::route(const std::string& method, const std::string& path, HttpHandler handler, bool blocking) {
+    state_->routes[path].push_back(Route{method, std::move(handler), blocking});
+}
+
+void HttpServer::set_guard(std::function<bool(const HttpRequest&, HttpResponse&)> guard) {
+    state_->guard = std::move(guard);
+}
+
+void HttpServer::start() {
+    if (state_->running) return;
+
+    beast::error_code ec;
+    tcp::endpoint endpoint(tcp::v4(), state_->port);
+    state_->acceptor.open(endpoint.protocol(), ec);
+    if (!ec) state_->acceptor.set_option(net::socket_base::reuse_address(true), ec);
+    if (!ec) state_->acceptor.bind(endpoint, ec);
+    if (!ec) state_->acceptor.listen(net::socket_base::max_listen_connections, ec);
+    if (ec) {
+        std::cerr << "[API] Failed to listen on port " << state_->port << ": " << ec.message() << std::endl;
+        return;
+    }
+
+    state_->running = true;
+    net::post(state_->acceptor.get_executor(), [state = state_] { state->do_accept(); });
+}
+
+void HttpServer::stop() {
+    if (!state_->running.exchange(false)) return;
+    net::post(state_->acceptor.get_executor(), [state = state_] {
+        beast::error_code ec;
+        state->acceptor.close(ec);
+    });
+}
+
+} // namespace poly
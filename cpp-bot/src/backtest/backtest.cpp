@@ -0,0 +1,219 @@
+#include "backtest.hpp"
+#include "frame_capture.hpp"
+#include "websocket_client.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+
+namespace poly {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::chrono::system_clock::time_point from_wall_ns(int64_t wall_ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(wall_ns)));
+}
+
+} // namespace
+
+std::vector<BacktestWindow> find_backtest_windows(const std::string& root) {
+    std::vector<BacktestWindow> windows;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(root, ec)) {
+        if (!entry.is_directory()) continue;
+        std::string slug = entry.path().filename().string();
+        if (slug.empty() || slug[0] == '_') continue;  // _unrouted
+        windows.push_back({slug, entry.path().string()});
+    }
+    std::sort(windows.begin(), windows.end(),
+              [](const BacktestWindow& a, const BacktestWindow& b) { return a.slug < b.slug; });
+    return windows;
+}
+
+bool load_backtest_window(const BacktestWindow& window, LoadedWindow& out, std::string& error) {
+    CaptureReader reader;
+    if (!reader.open(window.path, error)) return false;
+
+    out = LoadedWindow{};
+    LoadedWindow::Frame* frame = nullptr;
+
+    // Never started - frames are injected on this thread
+    WebSocketPriceStream stream;
+    stream.set_orderbook_callback([&](const OrderbookUpdate& update) {
+        if (!frame) return;
+        OrderbookSnapshot snapshot;
+        snapshot.bids = update.bids;
+        snapshot.asks = update.asks;
+        snapshot.timestamp = from_wall_ns(frame->wall_ns);
+        frame->books.emplace_back(update.token, std::move(snapshot));
+    });
+    stream.set_book_delta_callback([&](const BookDelta& delta) {
+        if (frame) frame->deltas.push_back(delta);
+    });
+
+    CaptureRecord record;
+    while (reader.next(record)) {
+        if (record.kind == CaptureKind::MARKET) {
+            if (out.market.slug.empty() && !parse_market_record(record.payload, out.market)) {
+                error = "Bad market record in " + window.path;
+                return false;
+            }
+            // The parser only resolves registered tokens
+            TokenRegistry::instance().intern(out.market.up_token);
+            TokenRegistry::instance().intern(out.market.down_token);
+            continue;
+        }
+        out.frames.emplace_back();
+        frame = &out.frames.back();
+        frame->wall_ns = record.wall_ns;
+        stream.inject(record.payload, 0);
+        if (frame->books.empty() && frame->deltas.empty()) {
+            out.frames.pop_back();  // Prices only, or nothing we use
+        }
+        frame = nullptr;
+    }
+
+    if (out.market.slug.empty()) {
+        error = "No market record in " + window.path;
+        return false;
+    }
+
+    // Close of the market's window, from its slug; else the last frame
+    std::string series_name;
+    int64_t window_start = 0;
+    MarketSeries series;
+    if (split_market_slug(out.market.slug, series_name, window_start) &&
+        parse_market_series(series_name, series)) {
+        out.end_wall_ns = (window_start + series.period_sec) * int64_t{1000000000};
+    } else if (!out.frames.empty()) {
+        out.end_wall_ns = out.frames.back().wall_ns;
+    }
+    return true;
+}
+
+WindowOutcome run_backtest_window(const LoadedWindow& window, const Config& config) {
+    auto sim_now = window.frames.empty() ? from_wall_ns(window.end_wall_ns) : from_wall_ns(window.frames.front().wall_ns);
+
+    TradingEngine engine(config);
+    engine.set_clock([&sim_now] { return sim_now; });
+    engine.start_inline();
+    engine.set_market(window.market.slug, window.market.up_token, window.market.down_token);
+
+    for (const auto& frame : window.frames) {
+        sim_now = from_wall_ns(frame.wall_ns);
+        for (const auto& [token, snapshot] : frame.books) {
+            engine.on_orderbook_update(token, snapshot);
+        }
+        if (!frame.deltas.empty()) engine.on_book_deltas(frame.deltas.data(), frame.deltas.size());
+        // Orders placed on this frame settle before the next one
+        engine.run_pending_orders();
+    }
+
+    // The window closes: whatever is still unhedged is abandoned
+    sim_now = std::max(sim_now, from_wall_ns(window.end_wall_ns));
+    engine.retire_market(window.market.slug);
+    engine.run_pending_orders();
+
+    auto status = engine.get_status();
+    auto orders = engine.order_stats();
+    engine.stop();
+
+    WindowOutcome outcome;
+    outcome.pnl = status.realized_pnl;
+    outcome.orders = orders.submitted;
+    outcome.fills = orders.filled;
+    outcome.cycles_completed = status.cycles_completed;
+    outcome.cycles_abandoned = status.cycles_abandoned;
+    for (const auto& trade : status.recent_trades) {
+        if (trade.leg == 1) outcome.entries++;
+    }
+    return outcome;
+}
+
+Backtester::Backtester(std::vector<Config> grid, size_t threads, size_t configs_per_task)
+    : grid_(std::move(grid))
+    , threads_(threads)
+    , configs_per_task_(std::max<size_t>(1, configs_per_task)) {
+}
+
+std::vector<BacktestResult> Backtester::run(const std::vector<BacktestWindow>& windows) {
+    auto started = std::chrono::steady_clock::now();
+    stats_ = Stats{};
+
+    std::vector<BacktestResult> results(grid_.size());
+    for (size_t i = 0; i < grid_.size(); ++i) {
+        results[i].config_index = i;
+        results[i].config = grid_[i];
+    }
+    if (grid_.empty() || windows.empty()) return results;
+
+    // Per-task outcomes are folded in under one lock (progress is reported
+    // under it too) - a task is a whole window, so the lock is taken a few
+    // thousand times per sweep
+    std::mutex results_mutex;
+    size_t done = 0;
+    const size_t slices = (grid_.size() + configs_per_task_ - 1) / configs_per_task_;
+    const size_t total = windows.size() * slices;
+
+    WorkStealingPool pool(threads_);
+    for (const auto& window : windows) {
+        for (size_t slice = 0; slice < slices; ++slice) {
+            pool.submit([&, slice, window_ptr = &window] {
+                LoadedWindow loaded;
+                std::string error;
+                bool ok = load_backtest_window(*window_ptr, loaded, error);
+
+                std::vector<WindowOutcome> outcomes;
+                size_t first = slice * configs_per_task_;
+                size_t last = std::min(grid_.size(), first + configs_per_task_);
+                if (ok) {
+                    for (size_t c = first; c < last; ++c) {
+                        outcomes.push_back(run_backtest_window(loaded, grid_[c]));
+                    }
+                } else if (slice == 0) {
+                    std::cerr << "[BACKTEST] Skipping " << window_ptr->slug << ": " << error << std::endl;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(results_mutex);
+                    if (slice == 0) {
+                        if (ok) {
+                            stats_.windows_loaded++;
+                            stats_.frames += loaded.frames.size();
+                        } else {
+                            stats_.windows_skipped++;
+                        }
+                    }
+                    for (size_t k = 0; k < outcomes.size(); ++k) {
+                        const WindowOutcome& o = outcomes[k];
+                        BacktestResult& r = results[first + k];
+                        r.windows++;
+                        if (o.orders > 0) r.windows_traded++;
+                        r.pnl += o.pnl;
+                        r.worst_window_pnl = std::min(r.worst_window_pnl, o.pnl);
+                        r.orders += o.orders;
+                        r.fills += o.fills;
+                        r.entries += o.entries;
+                        r.cycles_completed += o.cycles_completed;
+                        r.cycles_abandoned += o.cycles_abandoned;
+                        stats_.runs++;
+                    }
+                    if (progress_) progress_(++done, total);
+                }
+            });
+        }
+    }
+    pool.wait();
+
+    stats_.steals = pool.steals();
+    stats_.elapsed_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count());
+    return results;
+}
+
+} // namespace poly
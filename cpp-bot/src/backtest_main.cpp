@@ -0,0 +1,218 @@
+#include "backtest.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// poly-backtest: sweep strategy parameters over captured market windows.
+//
+//   poly-backtest --data=captures --move=0.30:0.40:0.02 --sum-target=0.95,0.98,1.0
+//
+// Each grid axis takes a list ("a,b,c") or a range ("from:to:step").
+// Every combination runs against every window under --data. Paper orders
+// walk the captured book (--queue-ahead, --latency-ms); --fill=limit fills
+// them in full at the limit instead.
+
+namespace {
+
+    bool parse_axis(const std::string& spec, std::vector<double>& out) {
+        out.clear();
+        try {
+            if (spec.find(':') != std::string::npos) {
+                std::stringstream ss(spec);
+                std::string from, to, step;
+                std::getline(ss, from, ':');
+                std::getline(ss, to, ':');
+                std::getline(ss, step, ':');
+                double a = std::stod(from), b = std::stod(to), d = step.empty() ? 0.01 : std::stod(step);
+                if (d <= 0 || b < a) return false;
+                // Index-based so rounding never drops the last point
+                size_t n = static_cast<size_t>((b - a) / d + 1e-9) + 1;
+                for (size_t i = 0; i < n; ++i) out.push_back(a + d * static_cast<double>(i));
+            } else {
+                std::stringstream ss(spec);
+                std::string item;
+                while (std::getline(ss, item, ',')) {
+                    if (!item.empty()) out.push_back(std::stod(item));
+                }
+            }
+        } catch (...) {
+            return false;
+        }
+        return !out.empty();
+    }
+
+    void print_usage() {
+        std::cerr << "Usage: poly-backtest --data=DIR [--move=LIST] [--sum-target=LIST] [--window=LIST]\n"
+                  << "                     [--shares=LIST] [--dump-drop=LIST] [--threads=N] [--top=N] [--csv=FILE]\n"
+                  << "                     [--fill=depth|limit] [--queue-ahead=X] [--latency-ms=N] [--dca=on|off]\n"
+                  << "  LIST is a,b,c or from:to:step" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string data_dir;
+    std::string csv_path;
+    size_t threads = 0;
+    size_t top = 20;
+    std::vector<double> moves = {0.36};
+    std::vector<double> sum_targets = {1.00};
+    std::vector<double> windows_sec = {120};
+    std::vector<double> shares = {10};
+    std::vector<double> dump_drops = {poly::Config{}.dump_drop};
+    bool depth_fill = true;
+    bool dca = poly::Config{}.dca_enabled;
+    double queue_ahead = 0.0;
+    int latency_ms = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg.rfind("--data=", 0) == 0) {
+            data_dir = arg.substr(7);
+        } else if (arg.rfind("--move=", 0) == 0) {
+            ok = parse_axis(arg.substr(7), moves);
+        } else if (arg.rfind("--sum-target=", 0) == 0) {
+            ok = parse_axis(arg.substr(13), sum_targets);
+        } else if (arg.rfind("--window=", 0) == 0) {
+            ok = parse_axis(arg.substr(9), windows_sec);
+        } else if (arg.rfind("--shares=", 0) == 0) {
+            ok = parse_axis(arg.substr(9), shares);
+        } else if (arg.rfind("--dump-drop=", 0) == 0) {
+            ok = parse_axis(arg.substr(12), dump_drops);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            threads = std::strtoul(arg.c_str() + 10, nullptr, 10);
+        } else if (arg.rfind("--top=", 0) == 0) {
+            top = std::strtoul(arg.c_str() + 6, nullptr, 10);
+        } else if (arg.rfind("--csv=", 0) == 0) {
+            csv_path = arg.substr(6);
+        } else if (arg == "--dca=on" || arg == "--dca=off") {
+            dca = arg == "--dca=on";
+        } else if (arg == "--fill=depth" || arg == "--fill=limit") {
+            depth_fill = arg == "--fill=depth";
+        } else if (arg.rfind("--queue-ahead=", 0) == 0) {
+            queue_ahead = std::strtod(arg.c_str() + 14, nullptr);
+            ok = queue_ahead >= 0.0 && queue_ahead <= 1.0;
+        } else if (arg.rfind("--latency-ms=", 0) == 0) {
+            latency_ms = std::atoi(arg.c_str() + 13);
+            ok = latency_ms >= 0;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "[CONFIG] Bad argument: " << arg << std::endl;
+            print_usage();
+            return 1;
+        }
+    }
+    if (data_dir.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    auto windows = poly::find_backtest_windows(data_dir);
+    if (windows.empty()) {
+        std::cerr << "[BACKTEST] No captured windows under " << data_dir << std::endl;
+        return 1;
+    }
+
+    std::vector<poly::Config> grid;
+    for (double move : moves) {
+        for (double sum_target : sum_targets) {
+            for (double window : windows_sec) {
+                for (double share_count : shares) {
+                    for (double dump_drop : dump_drops) {
+                        poly::Config config;
+                        config.move = move;
+                        config.entry_threshold = move;
+                        config.sum_target = sum_target;
+                        config.dump_window_sec = static_cast<int>(window);
+                        config.shares = static_cast<int>(share_count);
+                        config.dump_drop = dump_drop;
+                        config.dca_enabled = dca;
+                        config.paper_depth_fill = depth_fill;
+                        config.paper_queue_ahead = queue_ahead;
+                        config.paper_latency_ms = latency_ms;
+                        grid.push_back(config);
+                    }
+                }
+            }
+        }
+    }
+
+    // The engine narrates every market and fill on stdout (and refused or
+    // killed orders on stderr) - thousands of engines at once would drown
+    // the report, so it goes to a private stream
+    poly::Logger::instance().set_level(poly::LogLevel::OFF);
+    std::ostream out(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);
+    std::cerr.rdbuf(nullptr);
+
+    out << "[BACKTEST] " << windows.size() << " windows x " << grid.size() << " configs, ";
+    if (depth_fill) {
+        out << "depth fills (queue ahead " << queue_ahead << ", latency " << latency_ms << "ms)" << std::endl;
+    } else {
+        out << "fills at the limit" << std::endl;
+    }
+
+    poly::Backtester backtester(grid, threads);
+    size_t last_pct = 0;
+    backtester.set_progress([&out, &last_pct](size_t done, size_t total) {
+        size_t pct = done * 100 / total;
+        if (pct >= last_pct + 10) {
+            last_pct = pct;
+            out << "[BACKTEST] " << pct << "%" << std::endl;
+        }
+    });
+    auto results = backtester.run(windows);
+    const auto& stats = backtester.stats();
+
+    out << "[BACKTEST] " << stats.runs << " runs over " << stats.windows_loaded << " windows ("
+        << stats.windows_skipped << " skipped, " << stats.frames << " frames) in " << stats.elapsed_ms
+        << "ms, " << stats.steals << " steals" << std::endl;
+
+    std::vector<const poly::BacktestResult*> ranked;
+    for (const auto& r : results) ranked.push_back(&r);
+    std::sort(ranked.begin(), ranked.end(), [](const poly::BacktestResult* a, const poly::BacktestResult* b) {
+        return a->pnl != b->pnl ? a->pnl > b->pnl : a->config_index < b->config_index;
+    });
+
+    out << "\n  move   sum   win  dump  shares |      pnl   worst  traded  entries  fill%  hedge%\n"
+        << "  --------------------------------+------------------------------------------------\n";
+    for (size_t i = 0; i < ranked.size() && i < top; ++i) {
+        const auto& r = *ranked[i];
+        out << std::fixed
+            << "  " << std::setprecision(3) << r.config.move
+            << " " << std::setprecision(3) << r.config.sum_target
+            << " " << std::setw(5) << r.config.dump_window_sec
+            << " " << std::setprecision(2) << std::setw(5) << r.config.dump_drop
+            << " " << std::setw(7) << r.config.shares << " |"
+            << std::setprecision(2) << std::setw(9) << r.pnl
+            << std::setw(8) << r.worst_window_pnl
+            << std::setw(8) << r.windows_traded
+            << std::setw(9) << r.entries
+            << std::setprecision(1) << std::setw(7) << r.fill_rate() * 100
+            << std::setw(8) << r.hedge_completion() * 100 << "\n";
+    }
+    out << std::endl;
+
+    if (!csv_path.empty()) {
+        std::ofstream csv(csv_path);
+        csv << "move,sum_target,dump_window_sec,dump_drop,shares,windows,windows_traded,pnl,worst_window_pnl,"
+               "orders,fills,entries,cycles_completed,cycles_abandoned,fill_rate,hedge_completion\n";
+        for (const auto& r : results) {
+            csv << r.config.move << "," << r.config.sum_target << "," << r.config.dump_window_sec << ","
+                << r.config.dump_drop << "," << r.config.shares << "," << r.windows << "," << r.windows_traded << "," << r.pnl << ","
+                << r.worst_window_pnl << "," << r.orders << "," << r.fills << "," << r.entries << ","
+                << r.cycles_completed << "," << r.cycles_abandoned << "," << r.fill_rate() << ","
+                << r.hedge_completion() << "\n";
+        }
+        out << "[BACKTEST] Wrote " << results.size() << " rows to " << csv_path << std::endl;
+    }
+    return 0;
+}
@@ -1,74 +1,344 @@
 #include "async_writer.hpp"
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
 
 namespace poly {
 
-AsyncTradeWriter::AsyncTradeWriter(Database& db) : db_(db) {}
+PackedTrade PackedTrade::pack(std::string_view id, std::string_view market_slug, int leg, std::string_view side,
+                              std::string_view token_id, double shares, double price, double cost, double fee,
+                              int64_t timestamp) {
+    PackedTrade packed;
+    packed.truncated = false;
+    packed.set_text(packed.id, id);
+    packed.set_text(packed.market_slug, market_slug);
+    packed.set_text(packed.side, side);
+    packed.set_text(packed.token_id, token_id);
+    packed.leg = leg;
+    packed.shares = shares;
+    packed.price = price;
+    packed.cost = cost;
+    packed.fee = fee;
+    packed.timestamp = timestamp;
+    return packed;
+}
+
+TradeRecord PackedTrade::unpack() const {
+    return TradeRecord{
+        .id = id,
+        .market_slug = market_slug,
+        .leg = leg,
+        .side = side,
+        .token_id = token_id,
+        .shares = shares,
+        .price = price,
+        .cost = cost,
+        .fee = fee,
+        .timestamp = timestamp
+    };
+}
+
+AsyncTradeWriter::AsyncTradeWriter(Database& db, Options options)
+    : db_(db)
+    , options_(std::move(options))
+    , ring_(std::max<size_t>(2, options_.capacity)) {}
 
 AsyncTradeWriter::~AsyncTradeWriter() {
     stop();
+    if (spill_file_) std::fclose(spill_file_);
 }
 
 void AsyncTradeWriter::start() {
     if (running_.exchange(true)) return;
+    
+    // Left over from a run that overflowed and never caught up
+    std::error_code ec;
+    auto leftover = std::filesystem::file_size(options_.spill_path, ec);
+    if (!ec && leftover >= sizeof(PackedTrade)) {
+        spill_pending_ = leftover / sizeof(PackedTrade);
+        std::cout << "[ASYNC] " << spill_pending_ << " spilled trades from a previous run will be written" << std::endl;
+    }
+    
     worker_ = std::thread(&AsyncTradeWriter::worker_loop, this);
-    std::cout << "[ASYNC] Trade writer started" << std::endl;
+    std::cout << "[ASYNC] Trade writer started (ring " << ring_.capacity() << ", batches of up to "
+              << options_.max_batch << ", " << options_.max_in_flight << " in flight)" << std::endl;
 }
 
 void AsyncTradeWriter::stop() {
     if (!running_.exchange(false)) return;
-    cv_.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        cv_.notify_all();
+    }
     if (worker_.joinable()) {
         worker_.join();
     }
-    std::cout << "[ASYNC] Trade writer stopped" << std::endl;
+    auto s = stats();
+    std::cout << "[ASYNC] Trade writer stopped (" << s.trades_written << " trades in " << s.batches
+              << " batches, " << s.trades_failed << " failed, " << s.dropped << " dropped; " << s.cycles_written
+              << " cycles, " << s.snapshots_written << " equity snapshots)" << std::endl;
+}
+
+void AsyncTradeWriter::queue_trade(const PackedTrade& trade) {
+    if (trade.truncated) truncated_.fetch_add(1, std::memory_order_relaxed);
+    if (!ring_.try_push(trade)) {
+        switch (options_.overflow) {
+            case OverflowPolicy::BLOCK:
+                push_blocking(trade);
+                break;
+            case OverflowPolicy::DROP_OLDEST: {
+                PackedTrade evicted;
+                while (!ring_.try_push(trade)) {
+                    if (ring_.try_pop(evicted)) dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+            case OverflowPolicy::SPILL_TO_DISK:
+                spill(trade);
+                break;
+        }
+    }
+    wake_writer();
+}
+
+void AsyncTradeWriter::queue_cycle(const CycleRecord& cycle) {
+    {
+        std::lock_guard<std::mutex> lock(records_mutex_);
+        if (cycles_.size() >= kMaxQueuedRecords) {
+            cycles_.pop_front();
+            std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+            stats_.records_dropped++;
+        }
+        cycles_.push_back(cycle);
+    }
+    wake_writer();
 }
 
-void AsyncTradeWriter::queue_trade(const TradeRecord& trade) {
+void AsyncTradeWriter::queue_equity(const EquitySnapshotRecord& snapshot) {
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        queue_.push(trade);
+        std::lock_guard<std::mutex> lock(records_mutex_);
+        if (snapshots_.size() >= kMaxQueuedRecords) {
+            snapshots_.pop_front();
+            std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+            stats_.records_dropped++;
+        }
+        snapshots_.push_back(snapshot);
+    }
+    wake_writer();
+}
+
+bool AsyncTradeWriter::records_pending() const {
+    std::lock_guard<std::mutex> lock(records_mutex_);
+    return !cycles_.empty() || !snapshots_.empty();
+}
+
+bool AsyncTradeWriter::write_records() {
+    std::deque<CycleRecord> cycles;
+    std::deque<EquitySnapshotRecord> snapshots;
+    {
+        std::lock_guard<std::mutex> lock(records_mutex_);
+        cycles.swap(cycles_);
+        snapshots.swap(snapshots_);
+    }
+    if (cycles.empty() && snapshots.empty()) return false;
+    
+    for (const auto& cycle : cycles) {
+        bool ok = db_.ensure_market_exists(cycle.market_slug) && db_.insert_cycle(cycle);
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        (ok ? stats_.cycles_written : stats_.records_failed)++;
+        if (!ok) std::cerr << "[ASYNC] ✗ Failed to save cycle to DB: " << cycle.id << std::endl;
+    }
+    for (const auto& snapshot : snapshots) {
+        bool ok = db_.insert_equity_snapshot(snapshot);
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        (ok ? stats_.snapshots_written : stats_.records_failed)++;
+    }
+    return true;
+}
+
+void AsyncTradeWriter::wake_writer() {
+    // Pairs with the fence the writer issues before its last look at the ring
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        cv_.notify_one();
+    }
+}
+
+void AsyncTradeWriter::push_blocking(const PackedTrade& trade) {
+    blocked_.fetch_add(1, std::memory_order_relaxed);
+    while (!ring_.try_push(trade)) {
+        if (!running_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);  // Nobody left to drain it
+            return;
+        }
+        wake_writer();
+        std::this_thread::yield();
     }
-    cv_.notify_one();
-    std::cout << "[ASYNC] Trade queued for DB write (pending: " << pending_count() << ")" << std::endl;
+}
+
+void AsyncTradeWriter::spill(const PackedTrade& trade) {
+    {
+        std::lock_guard<std::mutex> lock(spill_mutex_);
+        if (!spill_file_) spill_file_ = std::fopen(options_.spill_path.c_str(), "ab");
+        if (spill_file_ && std::fwrite(&trade, sizeof(trade), 1, spill_file_) == 1 &&
+            std::fflush(spill_file_) == 0) {
+            spill_pending_.fetch_add(1, std::memory_order_release);
+            spilled_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    std::cerr << "[ASYNC] ✗ Can't spill to " << options_.spill_path << " - waiting for room" << std::endl;
+    push_blocking(trade);
+}
+
+void AsyncTradeWriter::reload_spill() {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (spill_file_) {
+        std::fclose(spill_file_);
+        spill_file_ = nullptr;
+    }
+    size_t loaded = 0;
+    if (std::FILE* in = std::fopen(options_.spill_path.c_str(), "rb")) {
+        PackedTrade trade;
+        while (std::fread(&trade, sizeof(trade), 1, in) == 1) {
+            reloaded_.push_back(trade);
+            loaded++;
+        }
+        std::fclose(in);
+    }
+    // Everything spilled so far is in memory now
+    if (std::FILE* out = std::fopen(options_.spill_path.c_str(), "wb")) std::fclose(out);
+    spill_pending_.store(0, std::memory_order_relaxed);
+    std::cout << "[ASYNC] Reloaded " << loaded << " spilled trades" << std::endl;
 }
 
 size_t AsyncTradeWriter::pending_count() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    return ring_.size() + spill_pending_.load(std::memory_order_relaxed);
+}
+
+AsyncTradeWriter::Stats AsyncTradeWriter::stats() const {
+    Stats s;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        s = stats_;
+        if (s.batches > 0) {
+            s.avg_batch = static_cast<double>(batched_trades_) / s.batches;
+            s.avg_commit_us = static_cast<double>(commit_us_total_) / s.batches;
+        }
+    }
+    s.pending = pending_count();
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.spilled = spilled_.load(std::memory_order_relaxed);
+    s.blocked = blocked_.load(std::memory_order_relaxed);
+    s.truncated = truncated_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void AsyncTradeWriter::take_batch(std::vector<TradeRecord>& batch) {
+    // Spilled trades are reloaded once the ring has room to spare again
+    if (reloaded_.empty() && spill_pending_.load(std::memory_order_acquire) > 0 &&
+        ring_.size() < ring_.capacity() / 2) {
+        reload_spill();
+    }
+    while (batch.size() < options_.max_batch && !reloaded_.empty()) {
+        batch.push_back(reloaded_.front().unpack());
+        reloaded_.pop_front();
+    }
+    PackedTrade packed;
+    while (batch.size() < options_.max_batch && ring_.try_pop(packed)) {
+        batch.push_back(packed.unpack());
+    }
 }
 
 void AsyncTradeWriter::worker_loop() {
-    while (running_) {
-        TradeRecord trade;
+    while (true) {
+        std::vector<TradeRecord> batch;
+        take_batch(batch);
         
-        {
-            std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait(lock, [this] { return !queue_.empty() || !running_; });
-            
-            if (!running_ && queue_.empty()) break;
-            if (queue_.empty()) continue;
-            
-            trade = queue_.front();
-            queue_.pop();
+        if (batch.empty() && in_flight_.empty()) {
+            if (!retry_.empty()) {
+                retry_failed();
+                continue;
+            }
+            if (write_records()) continue;
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            sleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool idle = ring_.empty() && spill_pending_.load(std::memory_order_relaxed) == 0 && !records_pending();
+            if (idle && !running_) break;  // Stopped and drained
+            // The timeout only covers a wakeup lost to a producer that
+            // raced the flag
+            if (idle) cv_.wait_for(lock, std::chrono::milliseconds(100));
+            sleeping_.store(false, std::memory_order_relaxed);
+            continue;
         }
         
-        // Write to database (this is the slow part, but we're in background thread)
-        if (db_.insert_trade(trade)) {
-            std::cout << "[ASYNC] ✓ Trade saved to DB: " << trade.side << " x" << trade.shares 
-                      << " @ $" << trade.price << std::endl;
+        if (!batch.empty()) {
+            auto sent = std::chrono::steady_clock::now();
+            if (db_.send_trade_batch(batch)) {
+                in_flight_.push_back({std::move(batch), sent});
+            } else {
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                stats_.batches_failed++;
+                retry_.insert(retry_.end(), batch.begin(), batch.end());
+            }
+        }
+        
+        // Keep the pipeline full while there is more to send
+        bool more_queued = !ring_.empty() || !reloaded_.empty();
+        if (!in_flight_.empty() && (in_flight_.size() >= options_.max_in_flight || !more_queued)) {
+            finish_oldest();
+        }
+        if (in_flight_.empty() && !retry_.empty()) retry_failed();
+    }
+    if (!retry_.empty()) retry_failed();
+}
+
+void AsyncTradeWriter::finish_oldest() {
+    SentBatch batch = std::move(in_flight_.front());
+    in_flight_.pop_front();
+    
+    bool ok = db_.finish_trade_batch();
+    uint64_t commit_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - batch.sent).count());
+    size_t n = batch.trades.size();
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.batches++;
+        stats_.last_batch = n;
+        stats_.max_batch = std::max(stats_.max_batch, n);
+        stats_.last_commit_us = commit_us;
+        stats_.max_commit_us = std::max(stats_.max_commit_us, commit_us);
+        batched_trades_ += n;
+        commit_us_total_ += commit_us;
+        if (ok) {
+            stats_.trades_written += n;
         } else {
-            std::cerr << "[ASYNC] ✗ Failed to save trade to DB" << std::endl;
+            stats_.batches_failed++;
         }
     }
     
-    // Drain remaining trades on shutdown
-    std::lock_guard<std::mutex> lock(mutex_);
-    while (!queue_.empty()) {
-        auto trade = queue_.front();
-        queue_.pop();
-        db_.insert_trade(trade);
+    if (ok) {
+        std::cout << "[ASYNC] ✓ " << n << (n == 1 ? " trade" : " trades") << " saved to DB ("
+                  << commit_us << "µs)" << std::endl;
+    } else {
+        retry_.insert(retry_.end(), std::make_move_iterator(batch.trades.begin()),
+                      std::make_move_iterator(batch.trades.end()));
+    }
+}
+
+void AsyncTradeWriter::retry_failed() {
+    std::cerr << "[ASYNC] Retrying " << retry_.size() << " trades one by one" << std::endl;
+    for (const auto& trade : retry_) {
+        bool ok = db_.insert_trade(trade);
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            (ok ? stats_.trades_written : stats_.trades_failed)++;
+        }
+        if (!ok) std::cerr << "[ASYNC] ✗ Failed to save trade to DB: " << trade.id << std::endl;
     }
+    retry_.clear();
 }
 
 } // namespace poly
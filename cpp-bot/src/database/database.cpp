@@ -1,9 +1,21 @@
 #include "database.hpp"
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 
 namespace poly {
 
+namespace {
+    constexpr const char* kInsertTrade = "poly_insert_trade";
+    constexpr const char* kEnsureMarket = "poly_ensure_market";
+
+    std::string format_number(double value) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.12g", value);
+        return buf;
+    }
+}
+
 Database::Database(const std::string& connection_string)
     : connection_string_(connection_string) {
 }
@@ -14,8 +26,14 @@ Database::~Database() {
 
 Database::Database(Database&& other) noexcept
     : connection_string_(std::move(other.connection_string_))
-    , conn_(other.conn_) {
+    , conn_(other.conn_)
+    , prepared_(other.prepared_)
+    , pipeline_(other.pipeline_)
+    , in_flight_(std::move(other.in_flight_))
+    , known_markets_(std::move(other.known_markets_)) {
     other.conn_ = nullptr;
+    other.prepared_ = false;
+    other.pipeline_ = false;
 }
 
 Database& Database::operator=(Database&& other) noexcept {
@@ -23,12 +41,19 @@ Database& Database::operator=(Database&& other) noexcept {
         disconnect();
         connection_string_ = std::move(other.connection_string_);
         conn_ = other.conn_;
+        prepared_ = other.prepared_;
+        pipeline_ = other.pipeline_;
+        in_flight_ = std::move(other.in_flight_);
+        known_markets_ = std::move(other.known_markets_);
         other.conn_ = nullptr;
+        other.prepared_ = false;
+        other.pipeline_ = false;
     }
     return *this;
 }
 
 bool Database::connect() {
+    reset_connection();  // Prepared statements belong to the session
     conn_ = PQconnectdb(connection_string_.c_str());
     
     if (PQstatus(conn_) != CONNECTION_OK) {
@@ -43,6 +68,7 @@ bool Database::connect() {
 }
 
 void Database::disconnect() {
+    leave_pipeline();
     if (conn_) {
         PQfinish(conn_);
         conn_ = nullptr;
@@ -52,55 +78,180 @@ void Database::disconnect() {
 
 bool Database::check_connection() {
     if (!conn_ || PQstatus(conn_) != CONNECTION_OK) {
+        reset_connection();
         return connect();
     }
     return true;
 }
 
-bool Database::ensure_market_exists(const std::string& slug, const std::string& title) {
-    if (!check_connection()) return false;
+bool Database::prepare_statements() {
+    if (prepared_) return true;
     
-    // Use INSERT ... ON CONFLICT DO NOTHING (upsert)
-    std::ostringstream query;
-    query << "INSERT INTO markets (id, slug, question, status, created_at, updated_at) "
-          << "VALUES ("
-          << "'" << slug << "', "  // Use slug as id
-          << "'" << slug << "', "
-          << "'" << (title.empty() ? slug : title) << "', "
-          << "'live', "
-          << "NOW(), NOW()) "
-          << "ON CONFLICT (slug) DO NOTHING";
+    PGresult* res = PQprepare(conn_, kInsertTrade,
+        "INSERT INTO trades (id, market_slug, leg, side, token_id, shares, price, cost, fee, cash_after, ts) "
+        "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, 0, to_timestamp($10::double precision))",
+        10, nullptr);
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    if (ok) {
+        // Use slug as id
+        res = PQprepare(conn_, kEnsureMarket,
+            "INSERT INTO markets (id, slug, question, status, created_at, updated_at) "
+            "VALUES ($1, $1, $2, 'live', NOW(), NOW()) ON CONFLICT (slug) DO NOTHING",
+            2, nullptr);
+        ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+    }
+    if (!ok) {
+        std::cerr << "[DB] Prepare failed: " << PQerrorMessage(conn_) << std::endl;
+        return false;
+    }
+    prepared_ = true;
+    return true;
+}
+
+bool Database::ensure_market_exists(const std::string& slug, const std::string& title) {
+    if (known_markets_.count(slug)) return true;
+    leave_pipeline();
+    if (!check_connection() || !prepare_statements()) return false;
     
-    return execute(query.str());
+    const std::string& question = title.empty() ? slug : title;
+    const char* params[2] = {slug.c_str(), question.c_str()};
+    PGresult* res = PQexecPrepared(conn_, kEnsureMarket, 2, params, nullptr, nullptr, 0);
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (success) {
+        known_markets_.insert(slug);
+    } else {
+        std::cerr << "[DB] Market upsert failed: " << PQerrorMessage(conn_) << std::endl;
+    }
+    PQclear(res);
+    return success;
 }
 
 bool Database::insert_trade(const TradeRecord& trade) {
-    if (!check_connection()) return false;
+    return insert_trades({trade});
+}
+
+bool Database::insert_trades(const std::vector<TradeRecord>& trades) {
+    if (!send_trade_batch(trades)) return false;
+    bool ok = true;
+    while (!in_flight_.empty()) ok = finish_trade_batch();  // Ours is the last
+    return ok;
+}
+
+bool Database::send_trade_batch(const std::vector<TradeRecord>& trades) {
+    if (trades.empty()) return true;
+    if (!pipeline_) {
+        if (!check_connection() || !prepare_statements()) return false;
+        if (PQenterPipelineMode(conn_) != 1) {
+            std::cerr << "[DB] Pipeline mode unavailable: " << PQerrorMessage(conn_) << std::endl;
+            return false;
+        }
+        pipeline_ = true;
+    }
     
-    // Ensure market exists first (for foreign key)
-    ensure_market_exists(trade.market_slug);
+    PendingBatch batch;
+    bool sent = true;
     
-    std::ostringstream query;
-    query << "INSERT INTO trades (id, market_slug, leg, side, token_id, shares, price, cost, fee, cash_after, ts) "
-          << "VALUES ("
-          << "'" << trade.id << "', "
-          << "'" << trade.market_slug << "', "
-          << trade.leg << ", "
-          << "'" << trade.side << "', "
-          << "'" << trade.token_id << "', "
-          << trade.shares << ", "
-          << trade.price << ", "
-          << trade.cost << ", "
-          << trade.fee << ", "
-          << "0, "  // cash_after placeholder
-          << "to_timestamp(" << trade.timestamp << "))";
+    // Markets first, for the foreign key - once per slug per connection
+    for (const auto& trade : trades) {
+        if (!sent) break;
+        if (!known_markets_.insert(trade.market_slug).second) continue;
+        batch.new_markets.push_back(trade.market_slug);
+        const char* params[2] = {trade.market_slug.c_str(), trade.market_slug.c_str()};
+        sent = PQsendQueryPrepared(conn_, kEnsureMarket, 2, params, nullptr, nullptr, 0) == 1;
+        batch.statements++;
+    }
     
-    return execute(query.str());
+    for (const auto& trade : trades) {
+        if (!sent) break;
+        std::string leg = std::to_string(trade.leg);
+        std::string shares = format_number(trade.shares);
+        std::string price = format_number(trade.price);
+        std::string cost = format_number(trade.cost);
+        std::string fee = format_number(trade.fee);
+        std::string ts = std::to_string(trade.timestamp);
+        const char* params[10] = {
+            trade.id.c_str(), trade.market_slug.c_str(), leg.c_str(), trade.side.c_str(),
+            trade.token_id.c_str(), shares.c_str(), price.c_str(), cost.c_str(), fee.c_str(), ts.c_str()
+        };
+        sent = PQsendQueryPrepared(conn_, kInsertTrade, 10, params, nullptr, nullptr, 0) == 1;
+        batch.statements++;
+    }
+    
+    // The sync closes the batch's implicit transaction and flushes it out
+    sent = sent && PQpipelineSync(conn_) == 1;
+    if (!sent) {
+        std::cerr << "[DB] Batch send failed: " << PQerrorMessage(conn_) << std::endl;
+        for (const auto& slug : batch.new_markets) known_markets_.erase(slug);
+        reset_connection();
+        return false;
+    }
+    in_flight_.push_back(std::move(batch));
+    return true;
+}
+
+bool Database::finish_trade_batch() {
+    if (in_flight_.empty()) return false;
+    PendingBatch batch = std::move(in_flight_.front());
+    in_flight_.pop_front();
+    
+    // One result per statement (then NULL), then the sync. After the first
+    // failure the rest of the batch comes back PGRES_PIPELINE_ABORTED.
+    bool ok = true;
+    std::string error;
+    for (size_t i = 0; i < batch.statements && PQstatus(conn_) == CONNECTION_OK; ++i) {
+        PGresult* res = PQgetResult(conn_);
+        if (!res) break;
+        ExecStatusType status = PQresultStatus(res);
+        if (status != PGRES_COMMAND_OK) {
+            if (ok && status != PGRES_PIPELINE_ABORTED) error = PQresultErrorMessage(res);
+            ok = false;
+        }
+        PQclear(res);
+        while ((res = PQgetResult(conn_)) != nullptr) PQclear(res);
+    }
+    
+    PGresult* sync = PQstatus(conn_) == CONNECTION_OK ? PQgetResult(conn_) : nullptr;
+    bool synced = sync && PQresultStatus(sync) == PGRES_PIPELINE_SYNC;
+    PQclear(sync);
+    
+    if (!synced) {
+        std::cerr << "[DB] Connection lost with a batch in flight: " << PQerrorMessage(conn_) << std::endl;
+        for (const auto& slug : batch.new_markets) known_markets_.erase(slug);
+        reset_connection();
+        return false;
+    }
+    if (!ok) {
+        std::cerr << "[DB] Trade batch rolled back: " << error << std::endl;
+        for (const auto& slug : batch.new_markets) known_markets_.erase(slug);
+    }
+    return ok;
+}
+
+void Database::leave_pipeline() {
+    while (!in_flight_.empty()) finish_trade_batch();
+    if (pipeline_ && conn_) PQexitPipelineMode(conn_);
+    pipeline_ = false;
+}
+
+void Database::reset_connection() {
+    for (const auto& batch : in_flight_) {
+        for (const auto& slug : batch.new_markets) known_markets_.erase(slug);
+    }
+    in_flight_.clear();
+    pipeline_ = false;
+    prepared_ = false;
+    if (conn_) {
+        PQfinish(conn_);
+        conn_ = nullptr;
+    }
 }
 
 std::vector<TradeRecord> Database::get_trades(const std::string& market_slug) {
     std::vector<TradeRecord> trades;
     
+    leave_pipeline();
     if (!check_connection()) return trades;
     
     std::ostringstream query;
@@ -136,17 +287,44 @@ std::vector<TradeRecord> Database::get_trades(const std::string& market_slug) {
 }
 
 bool Database::insert_cycle(const CycleRecord& cycle) {
+    leave_pipeline();
     if (!check_connection()) return false;
     
-    std::ostringstream query;
-    query << "INSERT INTO cycles (id, market_slug, started_at, status) "
-          << "VALUES ("
-          << "'" << cycle.id << "', "
-          << "'" << cycle.market_slug << "', "
-          << "to_timestamp(" << cycle.started_at << "), "
-          << "'" << cycle.status << "')";
-    
-    return execute(query.str());
+    // NULL for a field the cycle never reached
+    auto number = [](const std::optional<double>& value) {
+        return value ? format_number(*value) : std::string();
+    };
+    std::string started = std::to_string(cycle.started_at);
+    std::string ended = cycle.ended_at ? std::to_string(*cycle.ended_at) : std::string();
+    std::string leg1_price = number(cycle.leg1_price);
+    std::string leg1_shares = number(cycle.leg1_shares);
+    std::string leg2_price = number(cycle.leg2_price);
+    std::string leg2_shares = number(cycle.leg2_shares);
+    std::string total_cost = number(cycle.total_cost);
+    std::string profit = number(cycle.locked_in_profit);
+    auto param = [](const std::string& value, bool present) { return present ? value.c_str() : nullptr; };
+    const char* params[13] = {
+        cycle.id.c_str(), cycle.market_slug.c_str(), started.c_str(), param(ended, cycle.ended_at.has_value()),
+        cycle.leg1_side ? cycle.leg1_side->c_str() : nullptr, param(leg1_price, cycle.leg1_price.has_value()),
+        param(leg1_shares, cycle.leg1_shares.has_value()), cycle.leg2_side ? cycle.leg2_side->c_str() : nullptr,
+        param(leg2_price, cycle.leg2_price.has_value()), param(leg2_shares, cycle.leg2_shares.has_value()),
+        param(total_cost, cycle.total_cost.has_value()), param(profit, cycle.locked_in_profit.has_value()),
+        cycle.status.c_str()
+    };
+    // locked_in_profit carries the cycle's PnL
+    PGresult* res = PQexecParams(conn_,
+        "INSERT INTO cycles (id, market_slug, started_at, ended_at, leg1_side, leg1_price, leg1_shares, "
+        "leg2_side, leg2_price, leg2_shares, total_cost, locked_in_profit, status) "
+        "VALUES ($1, $2, to_timestamp($3::double precision), to_timestamp($4::double precision), $5, $6, $7, "
+        "$8, $9, $10, $11, $12, $13) "
+        "ON CONFLICT (id) DO UPDATE SET ended_at = EXCLUDED.ended_at, leg2_side = EXCLUDED.leg2_side, "
+        "leg2_price = EXCLUDED.leg2_price, leg2_shares = EXCLUDED.leg2_shares, total_cost = EXCLUDED.total_cost, "
+        "locked_in_profit = EXCLUDED.locked_in_profit, status = EXCLUDED.status",
+        13, nullptr, params, nullptr, nullptr, 0);
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!success) std::cerr << "[DB] Cycle insert failed: " << PQerrorMessage(conn_) << std::endl;
+    PQclear(res);
+    return success;
 }
 
 bool Database::update_cycle(const CycleRecord& cycle) {
@@ -176,7 +354,112 @@ bool Database::update_cycle(const CycleRecord& cycle) {
     return execute(query.str());
 }
 
+std::vector<CycleRecord> Database::get_cycles(int64_t since) {
+    std::vector<CycleRecord> cycles;
+    leave_pipeline();
+    if (!check_connection()) return cycles;
+    
+    std::string since_param = std::to_string(since);
+    const char* params[1] = {since_param.c_str()};
+    PGresult* res = PQexecParams(conn_,
+        "SELECT id, market_slug, EXTRACT(EPOCH FROM started_at)::bigint, EXTRACT(EPOCH FROM ended_at)::bigint, "
+        "leg1_side, leg1_price, leg1_shares, leg2_side, leg2_price, leg2_shares, total_cost, locked_in_profit, "
+        "status FROM cycles WHERE ended_at >= to_timestamp($1::double precision) ORDER BY ended_at",
+        1, nullptr, params, nullptr, nullptr, 0);
+    
+    if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+        auto text = [res](int row, int col) -> std::optional<std::string> {
+            if (PQgetisnull(res, row, col)) return std::nullopt;
+            return std::string(PQgetvalue(res, row, col));
+        };
+        auto number = [res](int row, int col) -> std::optional<double> {
+            if (PQgetisnull(res, row, col)) return std::nullopt;
+            return std::stod(PQgetvalue(res, row, col));
+        };
+        int rows = PQntuples(res);
+        cycles.reserve(rows);
+        for (int i = 0; i < rows; i++) {
+            CycleRecord cycle;
+            cycle.id = PQgetvalue(res, i, 0);
+            cycle.market_slug = PQgetvalue(res, i, 1);
+            cycle.started_at = std::stoll(PQgetvalue(res, i, 2));
+            cycle.ended_at = std::stoll(PQgetvalue(res, i, 3));
+            cycle.leg1_side = text(i, 4);
+            cycle.leg1_price = number(i, 5);
+            cycle.leg1_shares = number(i, 6);
+            cycle.leg2_side = text(i, 7);
+            cycle.leg2_price = number(i, 8);
+            cycle.leg2_shares = number(i, 9);
+            cycle.total_cost = number(i, 10);
+            cycle.locked_in_profit = number(i, 11);
+            cycle.status = PQgetvalue(res, i, 12);
+            cycles.push_back(std::move(cycle));
+        }
+    } else {
+        std::cerr << "[DB] Cycle query failed: " << PQerrorMessage(conn_) << std::endl;
+    }
+    
+    PQclear(res);
+    return cycles;
+}
+
+bool Database::insert_equity_snapshot(const EquitySnapshotRecord& snapshot) {
+    leave_pipeline();
+    if (!check_connection()) return false;
+    
+    // Keyed by timestamp, so a retry can't store the same minute twice
+    std::string id = "eq_" + std::to_string(snapshot.ts_ms);
+    std::string ts = format_number(static_cast<double>(snapshot.ts_ms) / 1000.0);
+    std::string cash = format_number(snapshot.cash);
+    std::string equity = format_number(snapshot.equity);
+    std::string unrealized = format_number(snapshot.unrealized);
+    std::string realized = format_number(snapshot.realized);
+    const char* params[6] = {id.c_str(), ts.c_str(), cash.c_str(), equity.c_str(), unrealized.c_str(),
+                             realized.c_str()};
+    PGresult* res = PQexecParams(conn_,
+        "INSERT INTO equity_snapshots (id, ts, cash, equity, unrealized, realized) "
+        "VALUES ($1, to_timestamp($2::double precision), $3, $4, $5, $6) ON CONFLICT (id) DO NOTHING",
+        6, nullptr, params, nullptr, nullptr, 0);
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!success) std::cerr << "[DB] Equity snapshot insert failed: " << PQerrorMessage(conn_) << std::endl;
+    PQclear(res);
+    return success;
+}
+
+std::vector<EquitySnapshotRecord> Database::get_equity_snapshots(int64_t since) {
+    std::vector<EquitySnapshotRecord> snapshots;
+    leave_pipeline();
+    if (!check_connection()) return snapshots;
+    
+    std::string since_param = std::to_string(since);
+    const char* params[1] = {since_param.c_str()};
+    PGresult* res = PQexecParams(conn_,
+        "SELECT (EXTRACT(EPOCH FROM ts) * 1000)::bigint, cash, equity, unrealized, realized "
+        "FROM equity_snapshots WHERE ts >= to_timestamp($1::double precision) ORDER BY ts",
+        1, nullptr, params, nullptr, nullptr, 0);
+    
+    if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+        int rows = PQntuples(res);
+        snapshots.reserve(rows);
+        for (int i = 0; i < rows; i++) {
+            snapshots.push_back(EquitySnapshotRecord{
+                .ts_ms = std::stoll(PQgetvalue(res, i, 0)),
+                .cash = std::stod(PQgetvalue(res, i, 1)),
+                .equity = std::stod(PQgetvalue(res, i, 2)),
+                .unrealized = std::stod(PQgetvalue(res, i, 3)),
+                .realized = std::stod(PQgetvalue(res, i, 4))
+            });
+        }
+    } else {
+        std::cerr << "[DB] Equity query failed: " << PQerrorMessage(conn_) << std::endl;
+    }
+    
+    PQclear(res);
+    return snapshots;
+}
+
 bool Database::execute(const std::string& query) {
+    leave_pipeline();
     if (!check_connection()) return false;
     
     PGresult* res = PQexec(conn_, query.c_str());
@@ -1,91 +1,46 @@
-#include <vector>
-#include <string>
+#include "dca_manager.hpp"
+#include <algorithm>
 
 namespace poly {
 
-// DCA (Dollar Cost Averaging) Manager
-// Handles multiple entry levels for scaling into positions
-
-class DCAManager {
-public:
-    struct Level {
-        double price;
-        double shares;
-        bool executed;
-    };
-    
-    explicit DCAManager(const std::vector<double>& levels, double base_shares, double multiplier)
-        : base_shares_(base_shares)
-        , multiplier_(multiplier) {
-        
-        for (double price : levels) {
-            levels_.push_back({price, 0.0, false});
-        }
-        
-        calculate_shares();
-    }
-    
-    // Check if we should execute a DCA level
-    bool should_execute(double current_price, Level& level_out) {
-        for (auto& level : levels_) {
-            if (!level.executed && current_price <= level.price) {
-                level_out = level;
-                return true;
-            }
-        }
-        return false;
-    }
-    
-    // Mark a level as executed
-    void mark_executed(double price) {
-        for (auto& level : levels_) {
-            if (level.price == price) {
-                level.executed = true;
-                break;
-            }
-        }
-    }
-    
-    // Get total shares across all levels
-    double total_shares() const {
-        double total = 0.0;
-        for (const auto& level : levels_) {
-            if (level.executed) {
-                total += level.shares;
-            }
-        }
-        return total;
-    }
-    
-    // Get average entry price
-    double average_price() const {
-        double total_cost = 0.0;
-        double total_shares = 0.0;
-        
-        for (const auto& level : levels_) {
-            if (level.executed) {
-                total_cost += level.price * level.shares;
-                total_shares += level.shares;
-            }
-        }
-        
-        return total_shares > 0.0 ? total_cost / total_shares : 0.0;
+DCAManager::DCAManager(const std::vector<double>& levels, Qty base_shares, double multiplier, Price below) {
+    std::vector<Price> prices;
+    for (double level : levels) {
+        Price price = Price::from_double(level);
+        if (price.positive() && price < below) prices.push_back(price);
     }
+    std::sort(prices.begin(), prices.end(), [](Price a, Price b) { return a > b; });
+    prices.erase(std::unique(prices.begin(), prices.end()), prices.end());
 
-private:
-    std::vector<Level> levels_;
-    double base_shares_;
-    double multiplier_;
-    
-    void calculate_shares() {
-        double current_shares = base_shares_;
-        
-        for (auto& level : levels_) {
-            level.shares = current_shares;
-            current_shares *= multiplier_;
-        }
+    count_ = std::min(prices.size(), kMaxLevels);
+    double factor = 1.0;
+    for (size_t i = 0; i < count_; ++i) {
+        levels_[i] = Level{prices[i], base_shares.scaled(factor)};
+        cumulative_[i + 1] = cumulative_[i] + levels_[i].shares;
+        factor *= multiplier;
     }
-};
+}
 
-} // namespace poly
+DCAManager::Batch DCAManager::crossed(Price ask) const {
+    // Highest first: the crossed levels are a prefix of the untaken ones
+    auto first = levels_.begin() + next_;
+    auto end = std::partition_point(first, levels_.begin() + count_,
+                                    [ask](const Level& level) { return level.price >= ask; });
+    Batch batch;
+    batch.first = next_;
+    batch.levels = static_cast<size_t>(end - first);
+    if (batch.levels == 0) return batch;
+    batch.shares = cumulative_[next_ + batch.levels] - cumulative_[next_];
+    batch.limit = ask;
+    return batch;
+}
+
+void DCAManager::take(const Batch& batch) {
+    next_ = std::min(count_, next_ + batch.levels);
+}
 
+void DCAManager::give_back(const Batch& batch) {
+    if (batch.levels > 0 && next_ == batch.first + batch.levels) next_ = batch.first;
+}
+
+} // namespace poly
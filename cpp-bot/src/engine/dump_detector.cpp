@@ -1,118 +1,89 @@
 #include "dump_detector.hpp"
 #include <algorithm>
-#include <cmath>
 
 namespace poly {
 
-DumpDetector::DumpDetector(size_t max_window_size)
-    : max_window_size_(max_window_size) {
+void DumpDetector::Window::push_back(const Point& p) {
+    // Full of strictly falling prices: give up the newest candidate, not
+    // the front - that is the window high, whatever its age
+    if (size == kCapacity) pop_back();
+    ring[(head + size) % kCapacity] = p;
+    ++size;
 }
 
-void DumpDetector::add_price(const std::string& side, double price) {
-    auto now = std::chrono::system_clock::now();
-    
-    if (side == "UP") {
-        up_prices_.push_back({price, now});
-        if (up_prices_.size() > max_window_size_) {
-            up_prices_.erase(up_prices_.begin());
-        }
-    } else if (side == "DOWN") {
-        down_prices_.push_back({price, now});
-        if (down_prices_.size() > max_window_size_) {
-            down_prices_.erase(down_prices_.begin());
-        }
-    }
+void DumpDetector::Window::expire(int64_t now_ms) {
+    const int64_t cutoff = now_ms - length_ms;
+    while (size > 0 && front().ts_ms < cutoff) pop_front();
 }
 
-DumpDetection DumpDetector::detect_dump(double move_threshold, int window_seconds) {
-    // Prune old data
-    prune_old_data(up_prices_, window_seconds);
-    prune_old_data(down_prices_, window_seconds);
-    
-    // Calculate drops for both sides
-    auto up_drop = calc_drop_pct(up_prices_, window_seconds);
-    auto down_drop = calc_drop_pct(down_prices_, window_seconds);
-    
-    // Find which side dropped more
-    std::string detected_side;
-    double max_drop = 0.0;
-    double from_price = 0.0;
-    double to_price = 0.0;
-    
-    if (up_drop && *up_drop > max_drop) {
-        max_drop = *up_drop;
-        detected_side = "UP";
-        if (!up_prices_.empty()) {
-            to_price = up_prices_.back().price;
-            from_price = to_price / (1.0 - max_drop);
-        }
-    }
-    
-    if (down_drop && *down_drop > max_drop) {
-        max_drop = *down_drop;
-        detected_side = "DOWN";
-        if (!down_prices_.empty()) {
-            to_price = down_prices_.back().price;
-            from_price = to_price / (1.0 - max_drop);
+DumpDetector::DumpDetector(const std::vector<int>& windows_sec)
+    : window_count_(std::min(windows_sec.size(), kMaxWindows)) {
+    for (auto& side : sides_) {
+        for (size_t w = 0; w < window_count_; ++w) {
+            side.windows[w].length_ms = static_cast<int64_t>(windows_sec[w]) * 1000;
         }
     }
-    
-    bool detected = max_drop >= move_threshold;
-    
-    return DumpDetection{
-        .detected = detected,
-        .side = detected_side,
-        .drop_pct = max_drop,
-        .from_price = from_price,
-        .to_price = to_price
-    };
 }
 
-void DumpDetector::clear() {
-    up_prices_.clear();
-    down_prices_.clear();
+int64_t DumpDetector::clamp_time(int64_t now_ms) {
+    last_ms_ = std::max(last_ms_, now_ms);
+    return last_ms_;
 }
 
-std::optional<double> DumpDetector::calc_drop_pct(
-    const std::vector<PricePoint>& prices,
-    int window_seconds
-) const {
-    if (prices.empty()) return std::nullopt;
-    
-    auto now = std::chrono::system_clock::now();
-    auto cutoff = now - std::chrono::seconds(window_seconds);
-    
-    // Find max price in window
-    double max_price = 0.0;
-    double current_price = prices.back().price;
-    
-    for (auto it = prices.rbegin(); it != prices.rend(); ++it) {
-        if (it->timestamp < cutoff) break;
-        max_price = std::max(max_price, it->price);
+void DumpDetector::add_price(Side side, Price price, int64_t now_ms) {
+    now_ms = clamp_time(now_ms);
+    SideState& s = sides_[static_cast<size_t>(side)];
+    s.last = price;
+    s.seen = true;
+
+    for (size_t w = 0; w < window_count_; ++w) {
+        Window& window = s.windows[w];
+        // A price at or above an older one makes it useless as a high
+        while (window.size > 0 && window.back().price <= price) window.pop_back();
+        window.push_back(Point{price, now_ms});
+        window.expire(now_ms);
     }
-    
-    if (max_price <= 0.0) return std::nullopt;
-    
-    // Calculate percentage drop
-    double drop_pct = (max_price - current_price) / max_price;
-    
-    return drop_pct > 0.0 ? std::optional<double>(drop_pct) : std::nullopt;
 }
 
-void DumpDetector::prune_old_data(
-    std::vector<PricePoint>& prices,
-    int window_seconds
-) {
-    auto now = std::chrono::system_clock::now();
-    auto cutoff = now - std::chrono::seconds(window_seconds * 2); // Keep 2x window
-    
-    auto it = std::find_if(prices.begin(), prices.end(),
-        [cutoff](const PricePoint& p) { return p.timestamp >= cutoff; });
-    
-    if (it != prices.begin()) {
-        prices.erase(prices.begin(), it);
+DumpDetection DumpDetector::detect_dump(double move_threshold, int64_t now_ms) {
+    now_ms = clamp_time(now_ms);
+    DumpDetection best{false, Side::UP, 0.0, Price{}, Price{}, 0};
+
+    for (Side side : {Side::UP, Side::DOWN}) {
+        SideState& s = sides_[static_cast<size_t>(side)];
+        if (!s.seen) continue;
+        for (size_t w = 0; w < window_count_; ++w) {
+            Window& window = s.windows[w];
+            window.expire(now_ms);
+            if (window.size == 0) continue;
+
+            const Price high = window.front().price;
+            if (!high.positive() || s.last >= high) continue;
+            double drop = static_cast<double>((high - s.last).micros()) / static_cast<double>(high.micros());
+            if (drop > best.drop_pct) {
+                best.side = side;
+                best.drop_pct = drop;
+                best.from_price = high;
+                best.to_price = s.last;
+                best.window_sec = static_cast<int>(window.length_ms / 1000);
+            }
+        }
     }
+
+    best.detected = best.drop_pct > 0.0 && best.drop_pct >= move_threshold;
+    return best;
 }
 
-} // namespace poly
+void DumpDetector::clear() {
+    for (auto& side : sides_) {
+        for (auto& window : side.windows) {
+            window.head = 0;
+            window.size = 0;
+        }
+        side.last = Price{};
+        side.seen = false;
+    }
+    last_ms_ = 0;
+}
 
+} // namespace poly
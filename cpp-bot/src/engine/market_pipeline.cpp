@@ -0,0 +1,287 @@
+#include "market_pipeline.hpp"
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+
+namespace poly {
+
+namespace {
+    constexpr size_t kMaxBatch = 1024;
+    constexpr auto kIdleWait = std::chrono::milliseconds(5);
+
+    void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+MarketDataPipeline::~MarketDataPipeline() {
+    stop();
+}
+
+void MarketDataPipeline::start() {
+    if (running_.exchange(true)) return;
+    batch_.resize(kMaxBatch);
+    worker_ = std::thread(&MarketDataPipeline::run, this);
+
+    // Linux limits thread names to 15 characters
+    pthread_setname_np(worker_.native_handle(), name_.substr(0, 15).c_str());
+
+    std::cout << "[PIPELINE] " << name_ << " thread started";
+    if (cpu_ >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu_, &cpus);
+        int rc = pthread_setaffinity_np(worker_.native_handle(), sizeof(cpus), &cpus);
+        if (rc == 0) {
+            std::cout << " (pinned to cpu " << cpu_ << ")";
+        } else {
+            std::cout << " (pin to cpu " << cpu_ << " failed: " << rc << ")";
+        }
+    }
+    std::cout << std::endl;
+}
+
+void MarketDataPipeline::stop() {
+    if (!running_.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+    if (worker_.joinable()) worker_.join();
+    std::cout << "[PIPELINE] " << name_ << " thread stopped" << std::endl;
+}
+
+// ============ PRODUCER (WebSocket reader thread) ============
+
+int MarketDataPipeline::slot_for(TokenId token) {
+    int free_slot = -1;
+    for (size_t i = 0; i < kMaxTokens; ++i) {
+        TokenSlot& slot = slots_[i];
+        if (!slot.in_use) {
+            if (free_slot < 0) free_slot = static_cast<int>(i);
+        } else if (slot.token == token) {
+            slot.last_used = ++use_clock_;
+            return static_cast<int>(i);
+        }
+    }
+
+    // New token: take a free slot, else the least recently used slot the
+    // consumer has completely finished with
+    if (free_slot < 0) {
+        uint64_t oldest = UINT64_MAX;
+        for (size_t i = 0; i < kMaxTokens; ++i) {
+            TokenSlot& slot = slots_[i];
+            bool drained = !slot.notify_owed &&
+                slot.consumed_seq.load(std::memory_order_acquire) == slot.last_ring_seq &&
+                !(slot.middle.load(std::memory_order_acquire) & TokenSlot::kDirty);
+            if (drained && slot.last_used < oldest) {
+                oldest = slot.last_used;
+                free_slot = static_cast<int>(i);
+            }
+        }
+        if (free_slot < 0) return -1;
+    }
+
+    TokenSlot& slot = slots_[free_slot];
+    slot.token = token;
+    slot.in_use = true;
+    slot.last_used = ++use_clock_;
+    return free_slot;
+}
+
+bool MarketDataPipeline::flush_owed_notify(TokenSlot& slot, uint8_t index) {
+    if (!slot.notify_owed) return true;
+    Event ev{++next_seq_, Price{}, Qty{}, EventKind::SNAPSHOT, BookSide::BID, index, false, {}, Price{}, Price{}, 0};
+    if (!ring_.try_push(ev)) return false;
+    slot.last_ring_seq = ev.seq;
+    slot.notify_owed = false;
+    return true;
+}
+
+bool MarketDataPipeline::push_event(TokenSlot& slot, const Event& ev) {
+    // A snapshot notification that could not be queued must go first,
+    // otherwise the consumer could apply this event before that snapshot
+    if (!flush_owed_notify(slot, ev.slot)) return false;
+    if (!ring_.try_push(ev)) return false;
+    slot.last_ring_seq = ev.seq;
+    return true;
+}
+
+void MarketDataPipeline::wake_consumer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_sleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+void MarketDataPipeline::publish_book(const OrderbookUpdate& update) {
+    int index = slot_for(update.token);
+    if (index < 0) {
+        bump(tokens_dropped_);
+        return;
+    }
+    TokenSlot& slot = slots_[index];
+
+    // Fill the producer's buffer in place (vectors keep their capacity)
+    SnapshotBuffer& buf = slot.buffers[slot.back];
+    buf.book.token = update.token;
+    buf.book.bids = update.bids;
+    buf.book.asks = update.asks;
+    buf.book.stamp = update.stamp;
+    buf.seq = ++next_seq_;
+
+    uint8_t prev = slot.middle.exchange(slot.back | TokenSlot::kDirty, std::memory_order_acq_rel);
+    slot.back = prev & TokenSlot::kIndexMask;
+    bump(snapshots_published_);
+
+    if (prev & TokenSlot::kDirty) {
+        // Engine hasn't taken the previous one yet - it will get this one instead
+        bump(snapshots_conflated_);
+        flush_owed_notify(slot, static_cast<uint8_t>(index));
+    } else {
+        Event ev{buf.seq, Price{}, Qty{}, EventKind::SNAPSHOT, BookSide::BID, static_cast<uint8_t>(index), false, {},
+                 Price{}, Price{}, 0};
+        if (!push_event(slot, ev)) slot.notify_owed = true;
+    }
+    wake_consumer();
+}
+
+void MarketDataPipeline::publish_delta(const BookDelta& delta) {
+    int index = slot_for(delta.token);
+    if (index < 0) {
+        bump(tokens_dropped_);
+        return;
+    }
+    TokenSlot& slot = slots_[index];
+
+    Event ev{++next_seq_, delta.price, delta.size, EventKind::DELTA, delta.side, static_cast<uint8_t>(index),
+             delta.has_top, delta.stamp, delta.best_bid, delta.best_ask, delta.timestamp};
+    if (!push_event(slot, ev)) {
+        bump(deltas_dropped_);
+        return;
+    }
+    bump(deltas_published_);
+    wake_consumer();
+}
+
+void MarketDataPipeline::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    tasks_pending_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    wake_cv_.notify_one();
+}
+
+// ============ CONSUMER (engine thread) ============
+
+void MarketDataPipeline::run_tasks() {
+    if (tasks_pending_.exchange(false, std::memory_order_acq_rel)) {
+        std::vector<Task> tasks;
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex_);
+            tasks.swap(tasks_);
+        }
+        for (auto& task : tasks) task();
+    }
+    if (periodic_) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= periodic_due_) {
+            periodic_due_ = now + periodic_every_;
+            periodic_();
+        }
+    }
+}
+
+void MarketDataPipeline::handle_event(const Event& ev) {
+    TokenSlot& slot = slots_[ev.slot];
+
+    if (ev.kind == EventKind::SNAPSHOT) {
+        // Everything queued before the snapshot goes to the engine first
+        flush_deltas();
+        if (slot.middle.load(std::memory_order_acquire) & TokenSlot::kDirty) {
+            uint8_t prev = slot.middle.exchange(slot.front, std::memory_order_acq_rel);
+            slot.front = prev & TokenSlot::kIndexMask;
+            const SnapshotBuffer& buf = slot.buffers[slot.front];
+            slot.applied_seq = buf.seq;
+            if (snapshot_handler_) snapshot_handler_(buf.book);
+        }
+    } else if (ev.seq <= slot.applied_seq) {
+        bump(deltas_superseded_);
+    } else {
+        BookDelta& delta = batch_[batch_size_++];
+        delta.token = slot.token;
+        delta.side = ev.side;
+        delta.price = ev.price;
+        delta.size = ev.size;
+        delta.has_top = ev.has_top;
+        delta.best_bid = ev.best_bid;
+        delta.best_ask = ev.best_ask;
+        delta.timestamp = ev.timestamp;
+        delta.stamp = ev.stamp;
+        if (batch_size_ == batch_.size()) flush_deltas();
+    }
+
+    slot.consumed_seq.store(ev.seq, std::memory_order_release);
+}
+
+void MarketDataPipeline::flush_deltas() {
+    if (batch_size_ == 0) return;
+    if (delta_handler_) delta_handler_(batch_.data(), batch_size_);
+    batch_size_ = 0;
+    bump(batches_);
+}
+
+void MarketDataPipeline::run() {
+    Event ev;
+    while (running_) {
+        size_t depth = ring_.size();
+        if (depth > max_queue_depth_.load(std::memory_order_relaxed)) {
+            max_queue_depth_.store(depth, std::memory_order_relaxed);
+        }
+
+        while (ring_.try_pop(ev)) handle_event(ev);
+        flush_deltas();
+
+        // Snapshots whose notification could not be queued (ring was full)
+        for (auto& slot : slots_) {
+            if (!(slot.middle.load(std::memory_order_acquire) & TokenSlot::kDirty)) continue;
+            uint8_t prev = slot.middle.exchange(slot.front, std::memory_order_acq_rel);
+            slot.front = prev & TokenSlot::kIndexMask;
+            const SnapshotBuffer& buf = slot.buffers[slot.front];
+            slot.applied_seq = buf.seq;
+            if (snapshot_handler_) snapshot_handler_(buf.book);
+        }
+
+        run_tasks();
+
+        // Idle: sleep until the producer pushes something
+        consumer_sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, kIdleWait, [this] {
+                return !ring_.empty() || !running_ || tasks_pending_.load(std::memory_order_acquire);
+            });
+        }
+        consumer_sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+MarketDataPipeline::Stats MarketDataPipeline::stats() const {
+    Stats s;
+    s.queue_depth = ring_.size();
+    s.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+    s.snapshots_published = snapshots_published_.load(std::memory_order_relaxed);
+    s.deltas_published = deltas_published_.load(std::memory_order_relaxed);
+    s.snapshots_conflated = snapshots_conflated_.load(std::memory_order_relaxed);
+    s.deltas_superseded = deltas_superseded_.load(std::memory_order_relaxed);
+    s.deltas_dropped = deltas_dropped_.load(std::memory_order_relaxed);
+    s.tokens_dropped = tokens_dropped_.load(std::memory_order_relaxed);
+    s.batches = batches_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace poly
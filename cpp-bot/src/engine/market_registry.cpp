@@ -0,0 +1,253 @@
+#include "market_registry.hpp"
+#include "trading_engine.hpp"
+#include "websocket_client.hpp"
+#include "http_pool.hpp"
+#include "api_server.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+namespace poly {
+
+namespace {
+    int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+bool parse_market_series(const std::string& prefix, MarketSeries& out) {
+    size_t dash = prefix.rfind('-');
+    if (dash == std::string::npos || dash + 2 > prefix.size()) return false;
+
+    std::string interval = prefix.substr(dash + 1);
+    char unit = interval.back();
+    int64_t count = 0;
+    try {
+        count = std::stoll(interval.substr(0, interval.size() - 1));
+    } catch (...) {
+        return false;
+    }
+    if (count <= 0) return false;
+
+    switch (unit) {
+        case 'm': out.period_sec = count * 60; break;
+        case 'h': out.period_sec = count * 3600; break;
+        case 'd': out.period_sec = count * 86400; break;
+        default: return false;
+    }
+    out.prefix = prefix;
+    return true;
+}
+
+bool split_market_slug(const std::string& slug, std::string& series_out, int64_t& window_start_out) {
+    size_t dash = slug.rfind('-');
+    if (dash == std::string::npos) return false;
+    try {
+        window_start_out = std::stoll(slug.substr(dash + 1));
+    } catch (...) {
+        return false;
+    }
+    series_out = slug.substr(0, dash);
+    return true;
+}
+
+bool fetch_market_info(const std::string& slug, MarketInfo& out) {
+    auto fetched = HttpPool::instance().get("https://gamma-api.polymarket.com/markets/slug/" + slug);
+    if (!fetched.error.empty()) {
+        std::cerr << "[FETCH] " << fetched.error << std::endl;
+        return false;
+    }
+
+    try {
+        auto j = nlohmann::json::parse(fetched.body);
+        std::string tokens_str = j.value("clobTokenIds", "");
+        if (tokens_str.empty()) return false;
+
+        auto tokens = nlohmann::json::parse(tokens_str);
+        if (!tokens.is_array() || tokens.size() < 2) return false;
+
+        out.slug = slug;
+        out.question = j.value("question", "");
+        out.up_token = tokens[0].get<std::string>();
+        out.down_token = tokens[1].get<std::string>();
+        return true;
+    } catch (...) {}
+
+    return false;
+}
+
+MarketRegistry::MarketRegistry(TradingEngine& engine, WebSocketPriceStream& ws)
+    : engine_(engine)
+    , ws_(ws) {
+}
+
+void MarketRegistry::add_series(const MarketSeries& series) {
+    SeriesState state;
+    state.series = series;
+    series_.push_back(std::move(state));
+    std::cout << "[MARKETS] Series: " << series.prefix << " (" << series.period_sec << "s windows)" << std::endl;
+}
+
+int64_t MarketRegistry::ms_until_next_switch() const {
+    int64_t now = now_ms();
+    int64_t soonest = INT64_MAX;
+    for (const auto& state : series_) {
+        int64_t period_ms = state.series.period_sec * 1000;
+        soonest = std::min(soonest, period_ms - now % period_ms);
+    }
+    return soonest;
+}
+
+std::vector<MarketInfo> MarketRegistry::active_markets() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<MarketInfo> out;
+    for (const auto& state : series_) {
+        if (!state.current.slug.empty()) out.push_back(state.current);
+    }
+    return out;
+}
+
+void MarketRegistry::tick() {
+    int64_t now = now_ms();
+    for (size_t i = 0; i < series_.size(); ++i) {
+        SeriesState& state = series_[i];
+        int64_t window_start = state.series.window_start(now / 1000);
+        int64_t time_left = window_start + state.series.period_sec - now / 1000;
+
+        if (time_left <= kPrefetchLeadSec && time_left > 0 && !state.next_ready && now >= state.next_retry_ms) {
+            prefetch(state, window_start, now);
+        }
+        if (window_start != state.current_window) {
+            switch_window(state, window_start, now, i == 0);
+        }
+    }
+}
+
+void MarketRegistry::prefetch(SeriesState& state, int64_t window_start, int64_t now) {
+    std::string next_slug = state.series.slug_for(window_start + state.series.period_sec);
+
+    std::cout << "[PRE-FETCH] Fetching next market: " << next_slug << std::endl;
+    add_log("info", "PRE-FETCH", "Fetching next market: " + next_slug);
+
+    MarketInfo next;
+    if (!fetch_market_info(next_slug, next)) {
+        std::cerr << "[PRE-FETCH] Failed to fetch next market: " << next_slug << std::endl;
+        state.next_retry_ms = now + 1000;
+        return;
+    }
+
+    std::cout << "[PRE-FETCH] ✓ Ready: " << next.question << std::endl;
+    add_log("info", "PRE-FETCH", "✓ Next market tokens ready: " + next_slug);
+
+    if (warm_hook_) {
+        warm_hook_(next.up_token);
+        warm_hook_(next.down_token);
+    }
+
+    // Stage before subscribing so the first snapshots have a home.
+    // The engine routes by token id and never trades a staged market.
+    engine_.stage_market(next.slug, next.up_token, next.down_token);
+    if (subscribe_hook_) subscribe_hook_(next);
+    ws_.subscribe(next.up_token);
+    ws_.subscribe(next.down_token);
+    std::cout << "[PRE-FETCH] Pre-subscribed (books warming in staging)" << std::endl;
+
+    state.next = std::move(next);
+    state.next_ready = true;
+}
+
+void MarketRegistry::switch_window(SeriesState& state, int64_t window_start, int64_t now, bool primary) {
+    state.current_window = window_start;
+    std::string slug = state.series.slug_for(window_start);
+
+    auto switch_start = std::chrono::high_resolution_clock::now();
+
+    // How late we are (ms after the exact window start)
+    int64_t latency_ms = now - window_start * 1000;
+
+    // Joining with less than two minutes left is too late to trade - skip
+    // the window entirely and wait for the next one
+    int64_t secs_into_market = latency_ms / 1000;
+    bool market_too_old = secs_into_market > state.series.period_sec - 120;
+
+    std::cout << "\n[MARKET] ═══════════════════════════════════════" << std::endl;
+    std::cout << "[MARKET] ⚡ SWITCH DETECTED (latency: " << latency_ms << "ms)" << std::endl;
+    std::cout << "[MARKET] New market: " << slug << std::endl;
+
+    if (market_too_old) {
+        std::cout << "[MARKET] ⚠️  STALE MARKET - Skipping (joined " << secs_into_market << "s late)" << std::endl;
+        add_log("warn", "MARKET", "⚠️ STALE - Skipping " + slug + " joined " + std::to_string(secs_into_market) + "s late");
+        std::cout << "[MARKET] ═══════════════════════════════════════\n" << std::endl;
+        return;
+    }
+
+    add_log("info", "MARKET", "⚡ SWITCH (latency: " + std::to_string(latency_ms) + "ms) " + slug);
+
+    MarketInfo old_market;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        old_market = state.current;
+    }
+    MarketInfo new_market;
+    bool hot_swapped = false;
+
+    // Pre-subscribed market: books are already warm, promotion is a pointer swap
+    if (state.next_ready && state.next.slug == slug && engine_.activate_market(slug)) {
+        new_market = state.next;
+        hot_swapped = true;
+        std::cout << "[MARKET] ✓ Hot-swapped to pre-warmed market" << std::endl;
+    } else {
+        // Fallback: fetch tokens now and subscribe from scratch. The socket
+        // is shared with the other series, so only this series' tokens move.
+        std::cout << "[MARKET] ⚠️  No pre-fetch, fetching now..." << std::endl;
+        if (state.next_ready) {
+            engine_.retire_market(state.next.slug);
+            ws_.unsubscribe(state.next.up_token);
+            ws_.unsubscribe(state.next.down_token);
+        }
+
+        if (fetch_market_info(slug, new_market)) {
+            engine_.set_market(new_market.slug, new_market.up_token, new_market.down_token);
+            if (subscribe_hook_) subscribe_hook_(new_market);
+            ws_.subscribe(new_market.up_token);
+            ws_.subscribe(new_market.down_token);
+            std::cout << "[WS] ⚡ Instant subscription switch (no reconnect)" << std::endl;
+        } else {
+            // Nothing to roll onto - stop evaluating the expired market
+            if (!old_market.slug.empty()) engine_.retire_market(old_market.slug);
+            add_log("error", "MARKET", "Failed to load market " + slug);
+            std::cerr << "[MARKET] Failed to load market " << slug << std::endl;
+        }
+    }
+
+    state.next_ready = false;
+    state.next = MarketInfo{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state.current = new_market;
+    }
+    if (!new_market.slug.empty() && switch_hook_) switch_hook_(new_market, primary);
+
+    auto switch_end = std::chrono::high_resolution_clock::now();
+    auto switch_us = std::chrono::duration_cast<std::chrono::microseconds>(switch_end - switch_start).count();
+
+    // Drop the expired market's feed once the new one is live
+    if (!old_market.slug.empty() && old_market.slug != new_market.slug) {
+        ws_.unsubscribe(old_market.up_token);
+        ws_.unsubscribe(old_market.down_token);
+    }
+    if (!new_market.slug.empty()) {
+        std::cout << "[TOKENS] UP:   " << new_market.up_token.substr(0,24) << "..." << std::endl;
+        std::cout << "[TOKENS] DOWN: " << new_market.down_token.substr(0,24) << "..." << std::endl;
+    }
+
+    std::cout << "[MARKET] Switch completed in " << switch_us << "µs"
+              << (hot_swapped ? " (pre-warmed)" : "") << std::endl;
+    add_log("info", "MARKET", "Switch completed in " + std::to_string(switch_us) + "µs" +
+            (hot_swapped ? " (pre-warmed)" : ""));
+    std::cout << "[MARKET] ═══════════════════════════════════════\n" << std::endl;
+}
+
+} // namespace poly
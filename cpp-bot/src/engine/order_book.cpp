@@ -0,0 +1,111 @@
+#include "order_book.hpp"
+
+namespace poly {
+
+int OrderBook::price_to_tick(Price price) {
+    if (price < Price{} || price > Price::from_units(1)) return kNoTick;
+    return static_cast<int>((price.micros() + kMicrosPerTick / 2) / kMicrosPerTick);
+}
+
+void OrderBook::clear_side(Side& s) {
+    // Only touch occupied levels - cheaper than wiping the arrays
+    for (int w = 0; w < kWords; ++w) {
+        uint64_t bits = s.occupied[w];
+        while (bits) {
+            int t = w * 64 + __builtin_ctzll(bits);
+            s.size[t] = 0;
+            bits &= bits - 1;
+        }
+        s.occupied[w] = 0;
+    }
+    s.best = kNoTick;
+    s.count = 0;
+}
+
+void OrderBook::clear() {
+    clear_side(bids_);
+    clear_side(asks_);
+    ++version_;
+}
+
+int OrderBook::highest_at_or_below(const Side& s, int tick) {
+    if (tick < 0) return kNoTick;
+    int w = tick / 64;
+    uint64_t bits = s.occupied[w] & (~0ULL >> (63 - (tick % 64)));
+    while (true) {
+        if (bits) return w * 64 + 63 - __builtin_clzll(bits);
+        if (--w < 0) return kNoTick;
+        bits = s.occupied[w];
+    }
+}
+
+int OrderBook::lowest_at_or_above(const Side& s, int tick) {
+    if (tick > kMaxTick) return kNoTick;
+    int w = tick / 64;
+    uint64_t bits = s.occupied[w] & (~0ULL << (tick % 64));
+    while (true) {
+        if (bits) return w * 64 + __builtin_ctzll(bits);
+        if (++w >= kWords) return kNoTick;
+        bits = s.occupied[w];
+    }
+}
+
+int OrderBook::next_tick(BookSide side, int tick) const {
+    if (side == BookSide::BID) return highest_at_or_below(bids_, tick - 1);
+    return lowest_at_or_above(asks_, tick + 1);
+}
+
+void OrderBook::set_level(BookSide side, int tick, Qty size) {
+    Side& s = book_side(side);
+    const uint64_t mask = 1ULL << (tick % 64);
+    uint64_t& word = s.occupied[tick / 64];
+    const bool was_set = (word & mask) != 0;
+
+    if (size.positive()) {
+        s.size[tick] = size.micros();
+        if (!was_set) {
+            word |= mask;
+            ++s.count;
+            if (s.best == kNoTick ||
+                (side == BookSide::BID ? tick > s.best : tick < s.best)) {
+                s.best = tick;
+            }
+        }
+    } else if (was_set) {
+        s.size[tick] = 0;
+        word &= ~mask;
+        --s.count;
+        if (tick == s.best) {
+            s.best = (side == BookSide::BID) ? highest_at_or_below(s, tick - 1)
+                                             : lowest_at_or_above(s, tick + 1);
+        }
+    }
+    ++version_;
+}
+
+bool OrderBook::apply_delta(BookSide side, Price price, Qty size) {
+    int tick = price_to_tick(price);
+    if (tick == kNoTick) return false;
+    set_level(side, tick, size);
+    return true;
+}
+
+void OrderBook::apply_snapshot(const std::vector<BookLevel>& bids, const std::vector<BookLevel>& asks) {
+    clear();
+    for (const auto& level : bids) {
+        int tick = price_to_tick(level.price);
+        if (tick != kNoTick) set_level(BookSide::BID, tick, level.size);
+    }
+    for (const auto& level : asks) {
+        int tick = price_to_tick(level.price);
+        if (tick != kNoTick) set_level(BookSide::ASK, tick, level.size);
+    }
+}
+
+void OrderBook::top_levels(BookSide side, size_t n, std::vector<std::pair<double, double>>& out) const {
+    for_each_level(side, n, [&out](Price price, Qty size) {
+        out.emplace_back(price.to_double(), size.to_double());
+    });
+}
+
+} // namespace poly
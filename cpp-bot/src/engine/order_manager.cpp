@@ -0,0 +1,426 @@
+#include "order_manager.hpp"
+#include "logger.hpp"
+#include <algorithm>
+
+namespace poly {
+
+namespace {
+    constexpr double kFillEpsilon = 1e-9;
+    // Early reports for ids that never get acked (other clients on the same
+    // key, orders we already forgot) are dropped after this
+    constexpr auto kEarlyReportTtl = std::chrono::seconds(60);
+    constexpr size_t kMaxEarlyReports = 1024;
+}
+
+const char* order_state_name(OrderState state) {
+    switch (state) {
+        case OrderState::PENDING_NEW: return "PENDING_NEW";
+        case OrderState::ACKED: return "ACKED";
+        case OrderState::PARTIALLY_FILLED: return "PARTIALLY_FILLED";
+        case OrderState::FILLED: return "FILLED";
+        case OrderState::CANCELLED: return "CANCELLED";
+        case OrderState::REJECTED: return "REJECTED";
+    }
+    return "UNKNOWN";
+}
+
+OrderManager::OrderManager(size_t workers)
+    : worker_count_(std::max<size_t>(1, workers)) {
+}
+
+OrderManager::~OrderManager() {
+    stop();
+}
+
+void OrderManager::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    for (size_t i = 0; i < worker_count_; ++i) {
+        workers_.emplace_back(&OrderManager::run_worker, this);
+    }
+    POLY_LOG_INFO("ORDERS", "Order manager started ({} workers)", worker_count_);
+}
+
+void OrderManager::start_manual() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    manual_ = true;
+}
+
+void OrderManager::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    if (manual_) {
+        run_pending();
+        manual_ = false;
+        return;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+    POLY_LOG_INFO("ORDERS", "Order manager stopped");
+}
+
+uint64_t OrderManager::submit(const OrderRequest& request, Callback on_update) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return 0;
+        id = ++next_id_;
+        Entry& entry = orders_[id];
+        entry.order.id = id;
+        entry.order.request = request;
+        entry.on_update = std::move(on_update);
+        jobs_.push_back({JobKind::SUBMIT, id});
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    cv_.notify_one();
+    return id;
+}
+
+bool OrderManager::cancel(uint64_t id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = orders_.find(id);
+        if (it == orders_.end() || is_terminal(it->second.order.state)) return false;
+        it->second.cancel_requested = true;
+        // Not answered yet: execute() cancels once it knows the exchange id
+        if (it->second.order.state == OrderState::PENDING_NEW) return true;
+        jobs_.push_back({JobKind::CANCEL, id});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+uint64_t OrderManager::adopt(const ManagedOrder& order, Callback on_update) {
+    if (order.exchange_id.empty() || is_terminal(order.state) || order.state == OrderState::PENDING_NEW) return 0;
+    uint64_t id;
+    std::vector<EarlyReport> replay;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (by_exchange_id_.count(order.exchange_id)) return 0;
+        id = ++next_id_;
+        Entry& entry = orders_[id];
+        entry.order = order;
+        entry.order.id = id;
+        entry.on_update = std::move(on_update);
+        // Executions from here on add to what was filled before
+        entry.traded_shares = order.filled_shares;
+        entry.traded_notional = order.filled_shares * order.avg_fill_price;
+        by_exchange_id_.emplace(order.exchange_id, id);
+        auto early = early_reports_.find(order.exchange_id);
+        if (early != early_reports_.end()) {
+            replay = std::move(early->second);
+            early_reports_.erase(early);
+        }
+    }
+    for (const auto& report : replay) {
+        if (report.cancel) {
+            on_exchange_cancel(order.exchange_id);
+        } else {
+            on_exchange_trade(order.exchange_id, report.trade_id, report.shares, report.price);
+        }
+    }
+    return id;
+}
+
+size_t OrderManager::run_pending() {
+    size_t ran = 0;
+    while (true) {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (jobs_.empty()) return ran;
+            job = jobs_.front();
+            jobs_.pop_front();
+        }
+        if (job.kind == JobKind::SUBMIT) {
+            execute(job.id);
+        } else {
+            execute_cancel(job.id);
+        }
+        ran++;
+    }
+}
+
+void OrderManager::run_worker() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return !running_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;  // Stopped and drained
+            job = jobs_.front();
+            jobs_.pop_front();
+        }
+        if (job.kind == JobKind::SUBMIT) {
+            execute(job.id);
+        } else {
+            execute_cancel(job.id);
+        }
+    }
+}
+
+void OrderManager::execute(uint64_t id) {
+    OrderRequest request;
+    bool cancelled_early = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = orders_.find(id);
+        if (it == orders_.end()) return;
+        request = it->second.order.request;
+        cancelled_early = it->second.cancel_requested;
+    }
+    if (cancelled_early) {
+        // Cancelled before it left - nothing to tell the exchange
+        transition(id, [](ManagedOrder& o) {
+            o.state = OrderState::CANCELLED;
+            o.error = "Cancelled before send";
+            return true;
+        });
+        return;
+    }
+
+    OrderResult result;
+    if (executor_) {
+        try {
+            result = executor_(request);
+        } catch (const std::exception& e) {
+            result.error = std::string("Executor threw: ") + e.what();
+        }
+    } else {
+        result.error = "No order executor configured";
+    }
+
+    if (!result.success) {
+        std::string error = result.error.empty() ? "Rejected" : result.error;
+        transition(id, [&](ManagedOrder& o) {
+            o.state = OrderState::REJECTED;
+            o.error = error;
+            return true;
+        });
+        return;
+    }
+
+    transition(id, [&](ManagedOrder& o) {
+        o.state = OrderState::ACKED;
+        o.exchange_id = result.order_id;
+        return true;
+    });
+
+    // "matched" means the marketable part crossed in full on arrival
+    double filled = result.status == "matched" ? request.shares : std::min(result.filled_amount, request.shares);
+    double fill_price = result.price > 0 ? result.price : request.price;
+    if (filled > kFillEpsilon) {
+        transition(id, [&](ManagedOrder& o) {
+            if (filled <= o.filled_shares + kFillEpsilon) return false;  // Exchange reported it first
+            o.filled_shares = filled;
+            o.avg_fill_price = fill_price;
+            o.state = filled >= o.request.shares - kFillEpsilon ? OrderState::FILLED : OrderState::PARTIALLY_FILLED;
+            return true;
+        });
+    }
+
+    // "killed": fill-and-kill, the unfilled rest never rested
+    if (result.status == "killed") {
+        transition(id, [](ManagedOrder& o) {
+            o.state = OrderState::CANCELLED;
+            if (o.filled_shares <= kFillEpsilon) o.error = "No liquidity at limit";
+            return true;
+        });
+        return;
+    }
+
+    // A cancel that arrived while we were waiting on the exchange
+    bool cancel_owed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = orders_.find(id);
+        cancel_owed = it != orders_.end() && it->second.cancel_requested;
+    }
+    if (cancel_owed) execute_cancel(id);
+}
+
+void OrderManager::execute_cancel(uint64_t id) {
+    ManagedOrder order;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = orders_.find(id);
+        if (it == orders_.end() || is_terminal(it->second.order.state)) return;
+        order = it->second.order;
+    }
+    if (canceller_ && !canceller_(order)) {
+        POLY_LOG_ERROR("ORDERS", "Cancel failed for order {} ({})", id, order.exchange_id);
+        return;
+    }
+    transition(id, [](ManagedOrder& o) { o.state = OrderState::CANCELLED; return true; });
+}
+
+void OrderManager::on_exchange_fill(const std::string& exchange_id, double filled_total, double avg_price) {
+    uint64_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = by_exchange_id_.find(exchange_id);
+        if (it == by_exchange_id_.end()) return;
+        id = it->second;
+    }
+    transition(id, [&](ManagedOrder& o) {
+        double total = std::min(filled_total, o.request.shares);
+        if (total <= o.filled_shares + kFillEpsilon) return false;  // Stale or duplicate report
+        o.filled_shares = total;
+        o.avg_fill_price = avg_price > 0 ? avg_price : o.request.price;
+        o.state = total >= o.request.shares - kFillEpsilon ? OrderState::FILLED : OrderState::PARTIALLY_FILLED;
+        return true;
+    });
+}
+
+void OrderManager::on_exchange_cancel(const std::string& exchange_id) {
+    uint64_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        EarlyReport report;
+        report.cancel = true;
+        id = resolve_or_hold(exchange_id, std::move(report));
+    }
+    if (id == 0) return;
+    transition(id, [](ManagedOrder& o) {
+        o.state = OrderState::CANCELLED;
+        if (o.error.empty()) o.error = "Cancelled by exchange";
+        return true;
+    });
+}
+
+void OrderManager::on_exchange_trade(const std::string& exchange_id, const std::string& trade_id,
+                                     double shares, double price) {
+    if (shares <= kFillEpsilon) return;
+    uint64_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        EarlyReport report;
+        report.trade_id = trade_id;
+        report.shares = shares;
+        report.price = price;
+        id = resolve_or_hold(exchange_id, std::move(report));
+    }
+    if (id == 0) return;
+    transition(id, [&](ManagedOrder& o) {
+        // transition() holds mutex_ while mutating
+        Entry& entry = orders_.at(o.id);
+        if (!trade_id.empty() && !entry.trade_ids.insert(trade_id).second) return false;  // Replayed
+        entry.traded_shares += shares;
+        entry.traded_notional += shares * (price > 0 ? price : o.request.price);
+        
+        double total = std::min(entry.traded_shares, o.request.shares);
+        if (total <= o.filled_shares + kFillEpsilon) return false;  // REST already covered it
+        o.filled_shares = total;
+        o.avg_fill_price = entry.traded_notional / entry.traded_shares;
+        o.state = total >= o.request.shares - kFillEpsilon ? OrderState::FILLED : OrderState::PARTIALLY_FILLED;
+        return true;
+    });
+}
+
+uint64_t OrderManager::resolve_or_hold(const std::string& exchange_id, EarlyReport report) {
+    auto it = by_exchange_id_.find(exchange_id);
+    if (it != by_exchange_id_.end()) return it->second;
+    if (exchange_id.empty()) return 0;
+    
+    auto now = std::chrono::steady_clock::now();
+    if (early_reports_.size() >= kMaxEarlyReports) {
+        for (auto e = early_reports_.begin(); e != early_reports_.end();) {
+            bool stale = now - e->second.back().received > kEarlyReportTtl;
+            e = stale ? early_reports_.erase(e) : std::next(e);
+        }
+        if (early_reports_.size() >= kMaxEarlyReports) return 0;
+    }
+    report.received = now;
+    early_reports_[exchange_id].push_back(std::move(report));
+    return 0;
+}
+
+void OrderManager::transition(uint64_t id, const std::function<bool(ManagedOrder&)>& mutate) {
+    ManagedOrder snapshot;
+    Callback on_update;
+    std::vector<EarlyReport> replay;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = orders_.find(id);
+        if (it == orders_.end() || is_terminal(it->second.order.state)) return;
+
+        ManagedOrder& order = it->second.order;
+        OrderState before = order.state;
+        if (!mutate(order)) return;
+
+        if (!order.exchange_id.empty() && by_exchange_id_.emplace(order.exchange_id, id).second) {
+            auto early = early_reports_.find(order.exchange_id);
+            if (early != early_reports_.end()) {
+                replay = std::move(early->second);
+                early_reports_.erase(early);
+            }
+        }
+        if (order.state != before) {
+            switch (order.state) {
+                case OrderState::ACKED: acked_.fetch_add(1, std::memory_order_relaxed); break;
+                case OrderState::FILLED: filled_.fetch_add(1, std::memory_order_relaxed); break;
+                case OrderState::CANCELLED: cancelled_.fetch_add(1, std::memory_order_relaxed); break;
+                case OrderState::REJECTED: rejected_.fetch_add(1, std::memory_order_relaxed); break;
+                default: break;
+            }
+        }
+
+        snapshot = order;
+        if (is_terminal(order.state)) {
+            on_update = std::move(it->second.on_update);
+            if (!order.exchange_id.empty()) by_exchange_id_.erase(order.exchange_id);
+            orders_.erase(it);
+        } else {
+            on_update = it->second.on_update;
+        }
+    }
+    if (on_update) on_update(snapshot);
+    
+    // The user channel beat the ack - apply what it told us, in order
+    for (const auto& report : replay) {
+        if (report.cancel) {
+            on_exchange_cancel(snapshot.exchange_id);
+        } else {
+            on_exchange_trade(snapshot.exchange_id, report.trade_id, report.shares, report.price);
+        }
+    }
+}
+
+std::optional<ManagedOrder> OrderManager::find(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = orders_.find(id);
+    if (it == orders_.end()) return std::nullopt;
+    return it->second.order;
+}
+
+std::vector<ManagedOrder> OrderManager::open_orders() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ManagedOrder> out;
+    out.reserve(orders_.size());
+    for (const auto& [id, entry] : orders_) out.push_back(entry.order);
+    std::sort(out.begin(), out.end(), [](const ManagedOrder& a, const ManagedOrder& b) { return a.id < b.id; });
+    return out;
+}
+
+OrderManager::Stats OrderManager::stats() const {
+    Stats s;
+    s.submitted = submitted_.load(std::memory_order_relaxed);
+    s.acked = acked_.load(std::memory_order_relaxed);
+    s.filled = filled_.load(std::memory_order_relaxed);
+    s.cancelled = cancelled_.load(std::memory_order_relaxed);
+    s.rejected = rejected_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    s.in_flight = orders_.size();
+    return s;
+}
+
+} // namespace poly
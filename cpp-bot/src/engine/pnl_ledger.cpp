@@ -0,0 +1,277 @@
+#include "pnl_ledger.hpp"
+#include <algorithm>
+
+namespace poly {
+
+namespace {
+
+struct ResolutionSpec {
+    const char* name;
+    int64_t width_ms;
+    size_t buckets;  // Ring capacity
+};
+
+// A day of minutes, a week of quarters, a month of hours, a year of days
+constexpr ResolutionSpec kSpecs[PnlLedger::kResolutions] = {
+    {"1m", 60 * 1000LL, 1440},
+    {"15m", 15 * 60 * 1000LL, 672},
+    {"1h", 60 * 60 * 1000LL, 720},
+    {"1d", 24 * 60 * 60 * 1000LL, 400},
+};
+
+const ResolutionSpec& spec(PnlLedger::Resolution resolution) {
+    return kSpecs[static_cast<size_t>(resolution)];
+}
+
+} // namespace
+
+PnlLedger::PnlLedger() {
+    for (size_t r = 0; r < kResolutions; ++r) {
+        rings_[r].buckets.resize(kSpecs[r].buckets);
+    }
+}
+
+int64_t PnlLedger::width_ms(Resolution resolution) {
+    return spec(resolution).width_ms;
+}
+
+const char* PnlLedger::name(Resolution resolution) {
+    return spec(resolution).name;
+}
+
+bool PnlLedger::parse_resolution(const std::string& text, Resolution& out) {
+    for (size_t r = 0; r < kResolutions; ++r) {
+        if (text == kSpecs[r].name) {
+            out = static_cast<Resolution>(r);
+            return true;
+        }
+    }
+    return false;
+}
+
+PnlLedger::Bucket* PnlLedger::bucket_at(Ring& ring, Resolution resolution, int64_t ts_ms) {
+    const int64_t width = width_ms(resolution);
+    const int64_t start = ts_ms - ((ts_ms % width) + width) % width;
+    const size_t capacity = ring.buckets.size();
+
+    if (ring.count == 0) {
+        ring.head = 0;
+        ring.count = 1;
+        ring.buckets[0] = Bucket{};
+        ring.buckets[0].start_ms = start;
+        ring.buckets[0].realized_total = totals_.realized;
+        return &ring.buckets[0];
+    }
+
+    Bucket& current = ring.buckets[ring.head];
+    if (start == current.start_ms) return &current;
+
+    if (start > current.start_ms) {
+        if (resolution == Resolution::MINUTE && current.marked) {
+            // Nobody marking (inline engines): keep no more than the ring does
+            if (closed_minutes_.size() >= capacity) closed_minutes_.erase(closed_minutes_.begin());
+            closed_minutes_.push_back(EquityPoint{current.start_ms, current.equity_close, current.cash,
+                                                  current.unrealized, current.realized_total});
+        }
+        // The new bucket opens where the last one closed
+        Bucket next;
+        next.start_ms = start;
+        next.marked = current.marked;
+        next.equity_open = next.equity_high = next.equity_low = next.equity_close = current.equity_close;
+        next.cash = current.cash;
+        next.unrealized = current.unrealized;
+        next.realized_total = current.realized_total;
+        ring.head = (ring.head + 1) % capacity;
+        ring.count = std::min(ring.count + 1, capacity);
+        ring.buckets[ring.head] = next;
+        return &ring.buckets[ring.head];
+    }
+
+    // Late booking (clock stepped back): an earlier bucket still in the ring
+    for (size_t i = 1; i < ring.count; ++i) {
+        Bucket& bucket = ring.buckets[(ring.head + capacity - i) % capacity];
+        if (bucket.start_ms == start) return &bucket;
+        if (bucket.start_ms < start) break;
+    }
+    return nullptr;
+}
+
+PnlLedger::MarketPnl& PnlLedger::market(const std::string& slug) {
+    auto it = markets_.find(slug);
+    if (it == markets_.end()) {
+        it = markets_.emplace(slug, MarketPnl{}).first;
+        it->second.slug = slug;
+    }
+    return it->second;
+}
+
+void PnlLedger::add_fill(const std::string& slug, Price cost, int64_t ts_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    totals_.volume += cost;
+    totals_.fills++;
+    MarketPnl& m = market(slug);
+    m.volume += cost;
+    m.fills++;
+    m.last_ms = ts_ms;
+    for (size_t r = 0; r < kResolutions; ++r) {
+        if (Bucket* b = bucket_at(rings_[r], static_cast<Resolution>(r), ts_ms)) {
+            b->volume += cost;
+            b->fills++;
+        }
+    }
+}
+
+void PnlLedger::add_realized(const std::string& slug, Price pnl, int64_t ts_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    add_realized_locked(slug, pnl, ts_ms);
+}
+
+void PnlLedger::add_realized_locked(const std::string& slug, Price pnl, int64_t ts_ms) {
+    totals_.realized += pnl;
+    MarketPnl& m = market(slug);
+    m.realized += pnl;
+    m.last_ms = ts_ms;
+    for (size_t r = 0; r < kResolutions; ++r) {
+        if (Bucket* b = bucket_at(rings_[r], static_cast<Resolution>(r), ts_ms)) {
+            b->realized += pnl;
+            b->realized_total = totals_.realized;
+        }
+    }
+}
+
+void PnlLedger::add_cycle(const CyclePnl& cycle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool complete = cycle.status == "complete";
+    (complete ? totals_.cycles_completed : totals_.cycles_abandoned)++;
+    MarketPnl& m = market(cycle.market_slug);
+    const bool first = m.cycles_completed + m.cycles_abandoned == 0;
+    (complete ? m.cycles_completed : m.cycles_abandoned)++;
+    if (first || cycle.pnl > m.best_cycle) m.best_cycle = cycle.pnl;
+    if (first || cycle.pnl < m.worst_cycle) m.worst_cycle = cycle.pnl;
+    m.last_ms = cycle.ended_ms;
+    for (size_t r = 0; r < kResolutions; ++r) {
+        if (Bucket* b = bucket_at(rings_[r], static_cast<Resolution>(r), cycle.ended_ms)) {
+            (complete ? b->cycles_completed : b->cycles_abandoned)++;
+        }
+    }
+    cycles_.push_back(cycle);
+    if (cycles_.size() > kMaxCycles) cycles_.pop_front();
+}
+
+void PnlLedger::mark_bucket(Bucket& bucket, Price equity) {
+    if (!bucket.marked) {
+        bucket.equity_open = bucket.equity_high = bucket.equity_low = equity;
+        bucket.marked = true;
+    }
+    bucket.equity_high = std::max(bucket.equity_high, equity);
+    bucket.equity_low = std::min(bucket.equity_low, equity);
+    bucket.equity_close = equity;
+}
+
+std::vector<PnlLedger::EquityPoint> PnlLedger::mark(int64_t ts_ms, Price cash, Price equity, Price unrealized,
+                                                    const std::vector<std::pair<std::string, Price>>& markets) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    totals_.equity = equity;
+    totals_.cash = cash;
+    totals_.unrealized = unrealized;
+    totals_.marked_ms = ts_ms;
+    // Markets missing from this mark have nothing open
+    for (const auto& slug : open_markets_) market(slug).unrealized = Price{};
+    open_markets_.clear();
+    for (const auto& [slug, value] : markets) {
+        if (value == Price{}) continue;
+        market(slug).unrealized = value;
+        open_markets_.push_back(slug);
+    }
+
+    for (size_t r = 0; r < kResolutions; ++r) {
+        Bucket* b = bucket_at(rings_[r], static_cast<Resolution>(r), ts_ms);
+        if (!b) continue;
+        mark_bucket(*b, equity);
+        b->cash = cash;
+        b->unrealized = unrealized;
+        b->realized_total = totals_.realized;
+    }
+    std::vector<EquityPoint> closed;
+    closed.swap(closed_minutes_);
+    return closed;
+}
+
+void PnlLedger::restore(const std::vector<CyclePnl>& cycles, const std::vector<EquityPoint>& equity) {
+    // Merged in time order, so the rings only ever move forward
+    size_t c = 0;
+    size_t e = 0;
+    while (c < cycles.size() || e < equity.size()) {
+        if (e == equity.size() || (c < cycles.size() && cycles[c].ended_ms <= equity[e].ts_ms)) {
+            const CyclePnl& cycle = cycles[c++];
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                add_realized_locked(cycle.market_slug, cycle.pnl, cycle.ended_ms);
+            }
+            add_cycle(cycle);
+        } else {
+            const EquityPoint& point = equity[e++];
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t r = 0; r < kResolutions; ++r) {
+                Bucket* b = bucket_at(rings_[r], static_cast<Resolution>(r), point.ts_ms);
+                if (!b) continue;
+                mark_bucket(*b, point.equity);
+                b->cash = point.cash;
+                b->unrealized = point.unrealized;
+            }
+        }
+    }
+    // Those minutes were persisted by the runs that marked them
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_minutes_.clear();
+}
+
+void PnlLedger::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    totals_ = Totals{};
+    for (auto& ring : rings_) {
+        ring.head = 0;
+        ring.count = 0;
+    }
+    markets_.clear();
+    open_markets_.clear();
+    cycles_.clear();
+    closed_minutes_.clear();
+}
+
+PnlLedger::Totals PnlLedger::totals() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totals_;
+}
+
+std::vector<PnlLedger::MarketPnl> PnlLedger::markets() const {
+    std::vector<MarketPnl> out;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.reserve(markets_.size());
+        for (const auto& [slug, m] : markets_) out.push_back(m);
+    }
+    std::sort(out.begin(), out.end(), [](const MarketPnl& a, const MarketPnl& b) { return a.slug < b.slug; });
+    return out;
+}
+
+std::vector<PnlLedger::CyclePnl> PnlLedger::cycles(size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = limit == 0 ? cycles_.size() : std::min(limit, cycles_.size());
+    return std::vector<CyclePnl>(cycles_.end() - static_cast<std::ptrdiff_t>(n), cycles_.end());
+}
+
+std::vector<PnlLedger::Bucket> PnlLedger::rollup(Resolution resolution, size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Ring& ring = rings_[static_cast<size_t>(resolution)];
+    const size_t capacity = ring.buckets.size();
+    size_t n = limit == 0 ? ring.count : std::min(limit, ring.count);
+    std::vector<Bucket> out;
+    out.reserve(n);
+    for (size_t i = n; i-- > 0;) {
+        out.push_back(ring.buckets[(ring.head + capacity - i) % capacity]);
+    }
+    return out;
+}
+
+} // namespace poly
@@ -0,0 +1,236 @@
+#include "shadow_fleet.hpp"
+#include "logger.hpp"
+#include <sstream>
+
+namespace poly {
+
+ShadowFleet::ShadowFleet(size_t threads) : threads_(threads) {}
+
+ShadowFleet::~ShadowFleet() {
+    stop();
+}
+
+void ShadowFleet::add(const std::string& name, const Config& config) {
+    if (running_) return;
+    auto shadow = std::make_unique<Shadow>();
+    shadow->name = name;
+    shadow->engine = std::make_unique<TradingEngine>(config);
+    shadows_.push_back(std::move(shadow));
+}
+
+void ShadowFleet::start() {
+    if (shadows_.empty() || running_.exchange(true)) return;
+    for (auto& shadow : shadows_) {
+        shadow->engine->set_quiet(true);
+        if (clock_) shadow->engine->set_clock(clock_);
+        shadow->engine->start_inline();
+    }
+    pool_ = std::make_unique<WorkStealingPool>(threads_);
+    POLY_LOG_INFO("SHADOW", "{} shadow engine(s) on {} thread(s)", shadows_.size(), pool_->thread_count());
+    for (const auto& shadow : shadows_) {
+        POLY_LOG_INFO("SHADOW", "  {}: {}", shadow->name, shadow->engine->strategy_name());
+    }
+}
+
+void ShadowFleet::stop() {
+    if (!running_.exchange(false)) return;
+    pool_->wait();
+    pool_.reset();
+    for (auto& shadow : shadows_) shadow->engine->stop();
+}
+
+void ShadowFleet::wait() {
+    if (pool_) pool_->wait();
+}
+
+void ShadowFleet::publish_snapshot(TokenId token, const std::vector<BookLevel>& bids,
+                                   const std::vector<BookLevel>& asks,
+                                   std::chrono::system_clock::time_point timestamp) {
+    if (!running_) return;
+    Event event;
+    event.kind = Event::Kind::SNAPSHOT;
+    event.token = token;
+    event.snapshot = std::make_shared<const OrderbookSnapshot>(OrderbookSnapshot{bids, asks, timestamp});
+    push(event);
+}
+
+void ShadowFleet::publish_deltas(const BookDelta* deltas, size_t count) {
+    if (!running_ || count == 0) return;
+    Event event;
+    event.kind = Event::Kind::DELTAS;
+    event.deltas = std::make_shared<const std::vector<BookDelta>>(deltas, deltas + count);
+    push(event);
+}
+
+void ShadowFleet::stage_market(const std::string& slug, const std::string& up_token, const std::string& down_token) {
+    if (!running_) return;
+    Event event;
+    event.kind = Event::Kind::STAGE;
+    event.market = std::make_shared<const std::vector<std::string>>(std::vector<std::string>{slug, up_token, down_token});
+    push(event);
+}
+
+void ShadowFleet::activate_market(const std::string& slug) {
+    if (!running_) return;
+    Event event;
+    event.kind = Event::Kind::ACTIVATE;
+    event.market = std::make_shared<const std::vector<std::string>>(std::vector<std::string>{slug});
+    push(event);
+}
+
+void ShadowFleet::retire_market(const std::string& slug) {
+    if (!running_) return;
+    Event event;
+    event.kind = Event::Kind::RETIRE;
+    event.market = std::make_shared<const std::vector<std::string>>(std::vector<std::string>{slug});
+    push(event);
+}
+
+void ShadowFleet::push(const Event& event) {
+    const bool book = event.kind == Event::Kind::SNAPSHOT || event.kind == Event::Kind::DELTAS;
+    for (auto& shadow_ptr : shadows_) {
+        Shadow& shadow = *shadow_ptr;
+        bool schedule = false;
+        {
+            std::lock_guard<std::mutex> lock(shadow.mutex);
+            // Registry events always go in - a shadow must not trade a
+            // market the primary has retired
+            if (book && shadow.book_events >= kMaxQueued) {
+                shadow.dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            shadow.queue.push_back(event);
+            if (book) shadow.book_events++;
+            schedule = !shadow.scheduled;
+            shadow.scheduled = true;
+        }
+        if (schedule) pool_->submit([this, &shadow] { drain(shadow); });
+    }
+}
+
+void ShadowFleet::drain(Shadow& shadow) {
+    std::vector<Event> batch;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(shadow.mutex);
+            if (shadow.queue.empty()) {
+                shadow.scheduled = false;
+                return;
+            }
+            batch.swap(shadow.queue);
+            shadow.book_events = 0;
+        }
+        for (const auto& event : batch) apply(shadow, event);
+        batch.clear();
+    }
+}
+
+void ShadowFleet::apply(Shadow& shadow, const Event& event) {
+    TradingEngine& engine = *shadow.engine;
+    switch (event.kind) {
+        case Event::Kind::SNAPSHOT:
+            engine.on_orderbook_update(event.token, *event.snapshot);
+            shadow.events.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case Event::Kind::DELTAS:
+            engine.on_book_deltas(event.deltas->data(), event.deltas->size());
+            shadow.events.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case Event::Kind::STAGE:
+            engine.stage_market((*event.market)[0], (*event.market)[1], (*event.market)[2]);
+            break;
+        case Event::Kind::ACTIVATE:
+            engine.activate_market((*event.market)[0]);
+            break;
+        case Event::Kind::RETIRE:
+            engine.retire_market((*event.market)[0]);
+            break;
+    }
+    // Orders placed on this event settle before the next one
+    engine.run_pending_orders();
+}
+
+std::vector<ShadowFleet::Summary> ShadowFleet::summaries() const {
+    std::vector<Summary> out;
+    out.reserve(shadows_.size());
+    for (const auto& shadow : shadows_) {
+        Summary summary;
+        summary.name = shadow->name;
+        summary.strategy = shadow->engine->strategy_name();
+        summary.status = shadow->engine->status_snapshot();
+        summary.events = shadow->events.load(std::memory_order_relaxed);
+        summary.dropped = shadow->dropped.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(shadow->mutex);
+            summary.queued = shadow->queue.size();
+        }
+        out.push_back(std::move(summary));
+    }
+    return out;
+}
+
+namespace {
+    bool parse_switch(const std::string& value, bool& out) {
+        if (value == "on" || value == "true" || value == "1") {
+            out = true;
+            return true;
+        }
+        if (value == "off" || value == "false" || value == "0") {
+            out = false;
+            return true;
+        }
+        return false;
+    }
+}
+
+bool parse_shadow_spec(const std::string& spec, const Config& base, std::string& name, Config& out,
+                       std::string& error) {
+    size_t colon = spec.find(':');
+    name = spec.substr(0, colon);
+    out = base;
+    if (name.empty()) {
+        error = "shadow needs a name (NAME:key=value,...)";
+        return false;
+    }
+    if (colon == std::string::npos) return true;
+
+    std::stringstream ss(spec.substr(colon + 1));
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            error = "expected key=value: " + item;
+            return false;
+        }
+        const std::string key = item.substr(0, eq);
+        const std::string value = item.substr(eq + 1);
+        try {
+            if (key == "move") {
+                out.move = std::stod(value);
+                out.entry_threshold = out.move;
+            } else if (key == "sum") {
+                out.sum_target = std::stod(value);
+            } else if (key == "shares") {
+                out.shares = std::stoi(value);
+            } else if (key == "window") {
+                out.dump_window_sec = std::stoi(value);
+            } else if (key == "dump") {
+                out.dump_drop = std::stod(value);
+            } else if (key == "dca") {
+                if (!parse_switch(value, out.dca_enabled)) throw std::invalid_argument(value);
+            } else if (key == "breakeven") {
+                if (!parse_switch(value, out.breakeven_enabled)) throw std::invalid_argument(value);
+            } else {
+                error = "unknown key: " + key;
+                return false;
+            }
+        } catch (const std::exception&) {
+            error = "bad value for " + key + ": " + value;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace poly
@@ -0,0 +1,37 @@
+#include "strategy_engine.hpp"
+#include "trading_engine.hpp"
+
+namespace poly {
+
+namespace {
+    template <typename Entry, typename Hedge>
+    std::shared_ptr<const Strategy> with_execution(const StrategyParams& params, bool live) {
+        if (live) return std::make_shared<StrategyEngine<Entry, Hedge, LiveExecution>>(params);
+        return std::make_shared<StrategyEngine<Entry, Hedge, PaperExecution>>(params);
+    }
+
+    template <typename Entry>
+    std::shared_ptr<const Strategy> with_hedge(const StrategyParams& params, const Config& config, bool live) {
+        if (config.breakeven_enabled) {
+            return config.dca_enabled ? with_execution<Entry, SumTargetHedge<true, true>>(params, live)
+                                      : with_execution<Entry, SumTargetHedge<true, false>>(params, live);
+        }
+        return config.dca_enabled ? with_execution<Entry, SumTargetHedge<false, true>>(params, live)
+                                  : with_execution<Entry, SumTargetHedge<false, false>>(params, live);
+    }
+}
+
+std::shared_ptr<const Strategy> make_strategy(const Config& config, bool live) {
+    StrategyParams params;
+    params.move = Price::from_double(config.move);
+    params.sum_target = Price::from_double(config.sum_target);
+    params.dump_drop = config.dump_drop;
+    params.trade_window_sec = config.dump_window_sec;
+    params.shares = Qty::from_units(config.shares);
+    params.book_stale_ms = config.book_stale_ms;
+
+    if (config.dump_drop > 0.0) return with_hedge<DumpEntry>(params, config, live);
+    return with_hedge<ThresholdEntry>(params, config, live);
+}
+
+} // namespace poly
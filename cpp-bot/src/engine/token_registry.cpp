@@ -0,0 +1,41 @@
+#include "token_registry.hpp"
+#include <mutex>
+
+namespace poly {
+
+TokenRegistry& TokenRegistry::instance() {
+    static TokenRegistry registry;
+    return registry;
+}
+
+TokenId TokenRegistry::intern(std::string_view token) {
+    if (token.empty()) return kNoToken;
+    if (TokenId id = find(token)) return id;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(token);
+    if (it != ids_.end()) return it->second;  // Interned meanwhile
+    names_.emplace_back(token);
+    TokenId id = names_.size();
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+TokenId TokenRegistry::find(std::string_view token) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(token);
+    return it == ids_.end() ? kNoToken : it->second;
+}
+
+std::string TokenRegistry::name(TokenId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (id == kNoToken || id > names_.size()) return "";
+    return names_[id - 1];
+}
+
+size_t TokenRegistry::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_.size();
+}
+
+} // namespace poly
@@ -2,98 +2,747 @@
 #include "polymarket_client.hpp"
 #include "async_writer.hpp"
 #include "api_server.hpp"
-#include <iostream>
+#include "market_registry.hpp"
+#include "latency.hpp"
+#include "fill_model.hpp"
+#include "logger.hpp"
+#include "token_registry.hpp"
+#include "shadow_fleet.hpp"
+#include "engine_snapshot.hpp"
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <future>
 
 namespace poly {
 using ::poly::add_log;
 
+namespace {
+    int64_t epoch_ms(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+    }
+    
+    // Strategy evaluated for the tick this thread is on
+    void mark_decision() {
+        auto& tick = latency::current_tick();
+        tick.decision_ns = latency::now_ns();
+        LatencyMonitor::instance().record(latency::Span::BOOK_TO_DECISION, tick.book_ns, tick.decision_ns);
+    }
+    
+    // Order about to leave: closes the decision and tick-to-trade spans
+    // (the decision span includes the hop to the order worker)
+    uint64_t stamp_submit(const OrderRequest& request) {
+        uint64_t submit_ns = latency::now_ns();
+        auto& monitor = LatencyMonitor::instance();
+        monitor.record(latency::Span::DECISION_TO_SUBMIT, request.decision_ns, submit_ns);
+        monitor.record(latency::Span::TICK_TO_TRADE, request.frame_ns, submit_ns);
+        return submit_ns;
+    }
+    
+    // Our best level on `side` is the one the feed reported (0 or 1: empty)
+    bool top_agrees(const OrderBook& book, BookSide side, Price reported) {
+        const bool reported_empty = !reported.positive() || reported >= Price::from_units(1);
+        const int tick = book.best_tick(side);
+        if (tick == OrderBook::kNoTick) return reported_empty;
+        return !reported_empty && OrderBook::tick_to_price(tick) == reported;
+    }
+    
+    template <typename BookSync>
+    bool book_fresh(const BookSync& sync, std::chrono::system_clock::time_point now, int stale_ms) {
+        if (!sync.synced || sync.gap) return false;
+        return stale_ms <= 0 || now - sync.confirmed <= std::chrono::milliseconds(stale_ms);
+    }
+    
+    // label: "ENTRY", or "DCA" for an add to the open leg
+    void log_entry(const Trade& trade, const char* label, double cash) {
+        std::ostringstream oss1;
+        oss1 << std::fixed << std::setprecision(4);
+        oss1 << "LEG 1 " << label << ": " << side_name(trade.side) << " x" << (int)trade.shares << " @ $" << trade.price;
+        add_log("trade", "ENGINE", oss1.str() + " [" + trade.market_slug + "]");
+        
+        POLY_LOG_INFO("ENGINE", "🟢 LEG 1 {} {} x{} @ ${:.4f} cost ${:.2f} cash ${:.2f} [{}]",
+                      label, side_name(trade.side), trade.shares, trade.price, trade.cost, cash, trade.market_slug);
+    }
+    
+    void log_hedge(const Trade& trade, Side leg1_side, double leg1_price,
+                   double total_pnl, double cash) {
+        double sum = leg1_price + trade.price;
+        
+        std::ostringstream oss2;
+        oss2 << std::fixed << std::setprecision(4);
+        oss2 << "LEG 2 HEDGE: " << side_name(trade.side) << " @ $" << trade.price << " | Sum: $" << sum;
+        add_log("trade", "ENGINE", oss2.str() + " [" + trade.market_slug + "]");
+        
+        POLY_LOG_INFO("ENGINE", "{} LEG 2 HEDGE {} @ ${:.4f} after {} @ ${:.4f} sum ${:.4f} pnl {:.2f} "
+                      "total {:.2f} cash ${:.2f} [{}]",
+                      trade.pnl >= 0 ? "💰" : "💸", side_name(trade.side), trade.price, side_name(leg1_side), leg1_price, sum,
+                      trade.pnl, total_pnl, cash, trade.market_slug);
+    }
+
+    // Warm-restart encoding (checkpoint / restore)
+    constexpr size_t kSnapshotTrades = 100;  // Recent trades kept for the dashboard
+    
+    std::chrono::system_clock::time_point from_epoch_ms(int64_t ms) {
+        return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+    }
+    
+    void encode_config(SnapshotWriter& w, const Config& c) {
+        w.f64(c.entry_threshold);
+        w.i64(c.shares);
+        w.boolean(c.dca_enabled);
+        w.u32(static_cast<uint32_t>(c.dca_levels.size()));
+        for (double level : c.dca_levels) w.f64(level);
+        w.f64(c.dca_multiplier);
+        w.f64(c.sum_target);
+        w.boolean(c.breakeven_enabled);
+        w.f64(c.move);
+        w.i64(c.window_min);
+        w.i64(c.dump_window_sec);
+        w.f64(c.dump_drop);
+        w.u32(static_cast<uint32_t>(c.dump_windows_sec.size()));
+        for (int window : c.dump_windows_sec) w.i64(window);
+        w.boolean(c.paper_depth_fill);
+        w.f64(c.paper_queue_ahead);
+        w.i64(c.paper_latency_ms);
+        w.i64(c.presign_ticks);
+        w.i64(c.book_stale_ms);
+    }
+    
+    Config decode_config(SnapshotReader& r) {
+        Config c;
+        c.entry_threshold = r.f64();
+        c.shares = static_cast<int>(r.i64());
+        c.dca_enabled = r.boolean();
+        c.dca_levels.assign(std::min<uint32_t>(r.u32(), 64), 0.0);
+        for (double& level : c.dca_levels) level = r.f64();
+        c.dca_multiplier = r.f64();
+        c.sum_target = r.f64();
+        c.breakeven_enabled = r.boolean();
+        c.move = r.f64();
+        c.window_min = static_cast<int>(r.i64());
+        c.dump_window_sec = static_cast<int>(r.i64());
+        c.dump_drop = r.f64();
+        c.dump_windows_sec.assign(std::min<uint32_t>(r.u32(), 64), 0);
+        for (int& window : c.dump_windows_sec) window = static_cast<int>(r.i64());
+        c.paper_depth_fill = r.boolean();
+        c.paper_queue_ahead = r.f64();
+        c.paper_latency_ms = static_cast<int>(r.i64());
+        c.presign_ticks = static_cast<int>(r.i64());
+        c.book_stale_ms = static_cast<int>(r.i64());
+        return c;
+    }
+    
+    // Nested, so a restore can compare two configs as bytes
+    std::string config_bytes(const Config& c) {
+        std::vector<uint8_t> out;
+        SnapshotWriter w(out);
+        encode_config(w, c);
+        return std::string(out.begin(), out.end());
+    }
+    
+    void encode_cycle(SnapshotWriter& w, const CycleStatus& c) {
+        w.boolean(c.active);
+        w.str(c.status);
+        w.str(c.leg1_side);
+        w.f64(c.leg1_price);
+        w.f64(c.leg1_shares);
+        w.str(c.leg2_side);
+        w.f64(c.leg2_price);
+        w.f64(c.leg2_shares);
+        w.f64(c.total_cost);
+        w.f64(c.pnl);
+    }
+    
+    CycleStatus decode_cycle(SnapshotReader& r) {
+        CycleStatus c;
+        c.active = r.boolean();
+        c.status = r.str();
+        c.leg1_side = r.str();
+        c.leg1_price = r.f64();
+        c.leg1_shares = r.f64();
+        c.leg2_side = r.str();
+        c.leg2_price = r.f64();
+        c.leg2_shares = r.f64();
+        c.total_cost = r.f64();
+        c.pnl = r.f64();
+        return c;
+    }
+    
+    void encode_trade(SnapshotWriter& w, const Trade& t) {
+        w.str(t.id);
+        w.str(t.market_slug);
+        w.i64(t.leg);
+        w.u8(static_cast<uint8_t>(t.side));
+        w.str(t.token_id);
+        w.f64(t.shares);
+        w.f64(t.price);
+        w.f64(t.cost);
+        w.f64(t.fee);
+        w.f64(t.pnl);
+        w.boolean(t.is_live);
+        w.i64(epoch_ms(t.timestamp));
+    }
+    
+    Trade decode_trade(SnapshotReader& r) {
+        Trade t;
+        t.id = r.str();
+        t.market_slug = r.str();
+        t.leg = static_cast<int>(r.i64());
+        t.side = r.u8() == static_cast<uint8_t>(Side::DOWN) ? Side::DOWN : Side::UP;
+        t.token_id = r.str();
+        t.shares = r.f64();
+        t.price = r.f64();
+        t.cost = r.f64();
+        t.fee = r.f64();
+        t.pnl = r.f64();
+        t.is_live = r.boolean();
+        t.timestamp = from_epoch_ms(r.i64());
+        return t;
+    }
+    
+    void encode_levels(SnapshotWriter& w, const OrderBook& book, BookSide side) {
+        w.u32(static_cast<uint32_t>(book.depth(side)));
+        book.for_each_level(side, book.depth(side), [&](Price price, Qty size) {
+            w.price(price);
+            w.qty(size);
+        });
+    }
+    
+    std::vector<BookLevel> decode_levels(SnapshotReader& r) {
+        std::vector<BookLevel> levels(std::min<uint32_t>(r.u32(), OrderBook::kNumLevels));
+        for (auto& level : levels) {
+            level.price = r.price();
+            level.size = r.qty();
+        }
+        return levels;
+    }
+}
+
 
 TradingEngine::TradingEngine(Config config)
     : config_(std::move(config))
+    , launch_config_(config_)
     , start_time_(std::chrono::system_clock::now()) {
+    rebuild_strategy();
+    configure_shards(1);
+    orders_.set_executor([this](const OrderRequest& request) { return send_order(request); });
+    orders_.set_canceller([this](const ManagedOrder& order) {
+        if (!order.request.live) return true;
+        auto client = polymarket_client_;
+        return client && !order.exchange_id.empty() && client->cancel_order(order.exchange_id);
+    });
 }
 
 TradingEngine::~TradingEngine() {
     stop();
 }
 
+void TradingEngine::configure_shards(size_t count, const std::vector<int>& cpus) {
+    if (running_) {
+        POLY_LOG_WARN("ENGINE", "Shards can only be configured before start()");
+        return;
+    }
+    count = std::max<size_t>(1, count);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    shards_.clear();
+    series_shard_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        auto shard = std::make_unique<Shard>();
+        Shard* raw = shard.get();
+        raw->index = i;
+        raw->pipeline.set_name("engine-" + std::to_string(i));
+        if (i < cpus.size()) raw->pipeline.set_cpu(cpus[i]);
+        
+        raw->pipeline.set_snapshot_handler([this, raw](const OrderbookUpdate& update) {
+            apply_snapshot(*raw, update.token, update.bids, update.asks, now(), update.stamp);
+        });
+        raw->pipeline.set_delta_handler([this, raw](const BookDelta* deltas, size_t n) {
+            apply_deltas(*raw, deltas, n);
+        });
+        raw->pipeline.set_periodic([this, raw] { check_books(*raw); }, std::chrono::milliseconds(kBookCheckMs));
+        shards_.push_back(std::move(shard));
+    }
+    if (count > 1) POLY_LOG_INFO("ENGINE", "{} engine shards", count);
+}
+
 void TradingEngine::start() {
     if (running_.exchange(true)) {
         return; // Already running
     }
     start_time_ = std::chrono::system_clock::now();
-    std::cout << "[ENGINE] Trading engine started" << std::endl;
+    orders_.start();
+    resync_pool_ = std::make_unique<WorkStealingPool>(kResyncThreads);
+    for (auto& shard : shards_) shard->pipeline.start();
+    publishing_ = true;
+    status_thread_ = std::thread([this] { run_status_publisher(); });
+    POLY_LOG_INFO("ENGINE", "Trading engine started");
+}
+
+void TradingEngine::start_inline() {
+    if (running_.exchange(true)) return;
+    start_time_ = std::chrono::system_clock::now();
+    orders_.start_manual();
 }
 
 void TradingEngine::stop() {
     if (!running_.exchange(false)) {
         return; // Already stopped
     }
+    for (auto& shard : shards_) shard->pipeline.stop();
+    resync_pool_.reset();  // Fetches in flight finish; their results are dropped
+    orders_.stop();  // Lets queued orders finish and settle
+    status_cv_.notify_all();
+    if (status_thread_.joinable()) status_thread_.join();
+    publishing_ = false;
+    mark_dirty();  // Readers after this see the final state
     
-    std::cout << "[ENGINE] Trading engine stopped" << std::endl;
+    POLY_LOG_INFO("ENGINE", "Trading engine stopped");
+}
+
+TradingEngine::Shard* TradingEngine::shard_for_token(TokenId token) const {
+    std::shared_lock<std::shared_mutex> lock(routes_mutex_);
+    auto it = token_shard_.find(token);
+    return it == token_shard_.end() ? nullptr : shards_[it->second].get();
+}
+
+TradingEngine::Shard* TradingEngine::find_market(const std::string& slug,
+                                                 std::shared_ptr<MarketState>& market_out) const {
+    std::string series;
+    int64_t window_start = 0;
+    if (!split_market_slug(slug, series, window_start)) series = slug;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto placed = series_shard_.find(series);
+    if (placed == series_shard_.end()) return nullptr;
+    Shard* shard = shards_[placed->second].get();
+    std::lock_guard<std::mutex> shard_lock(shard->mutex);
+    auto it = shard->markets.find(slug);
+    if (it == shard->markets.end()) return nullptr;
+    market_out = it->second;
+    return shard;
+}
+
+void TradingEngine::publish_book(const OrderbookUpdate& update) {
+    if (Shard* shard = shard_for_token(update.token)) shard->pipeline.publish_book(update);
+}
+
+void TradingEngine::publish_delta(const BookDelta& delta) {
+    if (Shard* shard = shard_for_token(delta.token)) shard->pipeline.publish_delta(delta);
+}
+
+MarketDataPipeline::Stats TradingEngine::pipeline_stats() const {
+    MarketDataPipeline::Stats total;
+    for (const auto& shard : shards_) {
+        auto s = shard->pipeline.stats();
+        total.queue_depth += s.queue_depth;
+        total.max_queue_depth = std::max(total.max_queue_depth, s.max_queue_depth);
+        total.snapshots_published += s.snapshots_published;
+        total.deltas_published += s.deltas_published;
+        total.snapshots_conflated += s.snapshots_conflated;
+        total.deltas_superseded += s.deltas_superseded;
+        total.deltas_dropped += s.deltas_dropped;
+        total.tokens_dropped += s.tokens_dropped;
+        total.batches += s.batches;
+    }
+    return total;
+}
+
+TradingEngine::BookSyncStats TradingEngine::book_sync_stats() const {
+    BookSyncStats stats;
+    stats.gaps = book_gaps_.load(std::memory_order_relaxed);
+    stats.refreshes = book_refreshes_.load(std::memory_order_relaxed);
+    stats.resyncs = book_resyncs_.load(std::memory_order_relaxed);
+    stats.resync_failures = resync_failures_.load(std::memory_order_relaxed);
+    stats.resyncs_superseded = resyncs_superseded_.load(std::memory_order_relaxed);
+    stats.deltas_replayed = deltas_replayed_.load(std::memory_order_relaxed);
+    stats.stale_ticks = stale_ticks_.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void TradingEngine::set_market(const std::string& slug, const std::string& up_token, const std::string& down_token) {
+    stage_market(slug, up_token, down_token);
+    activate_market(slug);
+}
+
+void TradingEngine::stage_market(const std::string& slug, const std::string& up_token, const std::string& down_token) {
+    // Shadows first, so they have the market before its first update reaches them
+    if (shadows_) shadows_->stage_market(slug, up_token, down_token);
+    
     std::lock_guard<std::mutex> lock(mutex_);
+    auto market = make_market_state(slug, up_token, down_token);
+    market->dumps = DumpDetector(config_.dump_windows_sec);
+    market->up_sync.confirmed = market->down_sync.confirmed = now();
     
-    // Clear all old markets when switching to a new one
-    if (active_market_slug_ != slug) {
-        markets_.clear();
+    // A series lives on one shard for good - place new ones on the least loaded
+    auto placed = series_shard_.find(market->series);
+    if (placed == series_shard_.end()) {
+        size_t best = 0;
+        for (size_t i = 1; i < shards_.size(); ++i) {
+            if (shards_[i]->series_count < shards_[best]->series_count) best = i;
+        }
+        shards_[best]->series_count++;
+        placed = series_shard_.emplace(market->series, best).first;
+    }
+    Shard& shard = *shards_[placed->second];
+    market->shard = shard.index;
+    
+    if (primary_series_.empty()) primary_series_ = market->series;
+    market->primary = market->series == primary_series_;
+    
+    {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        if (shard.markets.count(slug)) return;
         
-        // Abandon any incomplete cycle from previous market
-        if (current_position_) {
-            std::cout << "[ENGINE] ⚠️  Abandoning incomplete cycle from: " << current_position_->market_slug << std::endl;
-            add_log("warn", "ENGINE", "Abandoning incomplete cycle - market window ended");
-            
-            // Record as incomplete cycle
-            last_completed_cycle_.active = false;
-            last_completed_cycle_.status = "incomplete";
-            last_completed_cycle_.leg1_side = current_position_->side;
-            last_completed_cycle_.leg1_price = current_position_->avg_cost;
-            last_completed_cycle_.leg1_shares = current_position_->shares;
-            last_completed_cycle_.total_cost = current_position_->total_cost;
-            last_completed_cycle_.pnl = -(current_position_->total_cost); // Loss = cost of position
-            
-            // Update realized PnL (lost the cost of the position)
-            realized_pnl_ -= current_position_->total_cost;
-            
-            current_position_.reset();
+        // Only one market per series is staged at a time
+        std::vector<std::string> superseded;
+        for (const auto& [other_slug, other] : shard.markets) {
+            if (!other->active && other->series == market->series) superseded.push_back(other_slug);
         }
+        for (const auto& other_slug : superseded) retire_market_locked(shard, other_slug);
+        
+        shard.markets[slug] = market;
+        shard.token_index[market->up_token] = TokenRoute{market, true};
+        shard.token_index[market->down_token] = TokenRoute{market, false};
         
-        std::cout << "[ENGINE] Cleared old markets, switching to: " << slug << std::endl;
+        std::unique_lock<std::shared_mutex> routes_lock(routes_mutex_);
+        token_shard_[market->up_token] = shard.index;
+        token_shard_[market->down_token] = shard.index;
     }
+    mark_dirty();
+    
+    if (!quiet_) POLY_LOG_INFO("ENGINE", "Staged next market: {} on shard {} (books warming)", slug, shard.index);
+}
+
+bool TradingEngine::activate_market(const std::string& slug) {
+    std::string series;
+    int64_t window_start = 0;
+    if (!split_market_slug(slug, series, window_start)) series = slug;
+    if (shadows_) shadows_->activate_market(slug);
     
-    active_market_slug_ = slug;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto placed = series_shard_.find(series);
+    if (placed == series_shard_.end()) return false;
+    Shard& shard = *shards_[placed->second];
     
-    // Initialize market state
-    markets_[slug] = MarketState{
-        .slug = slug,
-        .up_token_id = up_token,
-        .down_token_id = down_token,
-        .up_orderbook = {},
-        .down_orderbook = {},
-        .last_update = std::chrono::system_clock::now()
-    };
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    auto it = shard.markets.find(slug);
+    if (it == shard.markets.end()) return false;
+    std::shared_ptr<MarketState> market = it->second;
+    if (market->active) return true;
     
-    std::cout << "[ENGINE] Active market: " << slug << std::endl;
+    // The series' previous market is over
+    std::vector<std::string> expired;
+    for (const auto& [other_slug, other] : shard.markets) {
+        if (other_slug != slug && other->series == market->series) expired.push_back(other_slug);
+    }
+    for (const auto& other_slug : expired) retire_market_locked(shard, other_slug);
+    
+    market->active = true;
+    if (market->primary) active_market_slug_ = slug;
+    mark_dirty();
+    
+    size_t active_count = 0;
+    for (const auto& [other_slug, other] : shard.markets) active_count += other->active ? 1 : 0;
+    if (!quiet_) POLY_LOG_INFO("ENGINE", "Active market: {} (shard {}: {} active)", slug, shard.index, active_count);
+    return true;
 }
 
-EngineStatus TradingEngine::get_status() const {
+void TradingEngine::retire_market(const std::string& slug) {
+    std::string series;
+    int64_t window_start = 0;
+    if (!split_market_slug(slug, series, window_start)) series = slug;
+    if (shadows_) shadows_->retire_market(slug);
+    
     std::lock_guard<std::mutex> lock(mutex_);
+    auto placed = series_shard_.find(series);
+    if (placed == series_shard_.end()) return;
+    Shard& shard = *shards_[placed->second];
+    
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    retire_market_locked(shard, slug);
+}
+
+void TradingEngine::retire_market_locked(Shard& shard, const std::string& slug) {
+    auto it = shard.markets.find(slug);
+    if (it == shard.markets.end()) return;
+    std::shared_ptr<MarketState> market = it->second;
+    
+    // Orders still working on an expired market are pulled; whatever filled
+    // meanwhile is booked by on_order_update
+    for (uint64_t id : {market->entry_order, market->hedge_order, market->dca_order}) {
+        if (id != 0) orders_.cancel(id);
+    }
+    market->paper_orders.clear();  // Cancelled above
+    if (market->position && !market->position->filled) {
+        // Leg 1 was acked but never filled - nothing was spent yet
+        market->position.reset();
+    }
+    
+    // Abandon any incomplete cycle - the market window ended
+    if (market->position) {
+        const Position& pos = *market->position;
+        POLY_LOG_WARN("ENGINE", "⚠️  Abandoning incomplete cycle from: {}", slug);
+        add_log("warn", "ENGINE", "Abandoning incomplete cycle - market window ended: " + slug);
+        
+        CycleStatus cycle;
+        cycle.active = false;
+        cycle.status = "incomplete";
+        cycle.leg1_side = side_name(pos.side);
+        cycle.leg1_price = pos.avg_cost.to_double();
+        cycle.leg1_shares = pos.shares.to_double();
+        cycle.total_cost = pos.total_cost.to_double();
+        cycle.pnl = -pos.total_cost.to_double();  // Loss = cost of position
+        record_cycle(*market, cycle);
+        
+        // Update realized PnL (lost the cost of the position)
+        book_realized(slug, -pos.total_cost);
+        ledger_.add_exposure(-pos.total_cost);
+        market->position.reset();
+    }
+    
+    // A process_market already running on it sees !active and stops
+    market->active = false;
+    {
+        std::unique_lock<std::shared_mutex> routes_lock(routes_mutex_);
+        for (TokenId token : {market->up_token, market->down_token}) {
+            auto route = shard.token_index.find(token);
+            if (route != shard.token_index.end() && route->second.market == market) {
+                shard.token_index.erase(route);
+                token_shard_.erase(token);
+            }
+        }
+    }
+    shard.markets.erase(it);
+    if (active_market_slug_ == slug) active_market_slug_.clear();
+    mark_dirty();
+    
+    POLY_LOG_INFO("ENGINE", "Retired market: {}", slug);
+}
+
+void TradingEngine::record_cycle(MarketState& market, const CycleStatus& cycle) {
+    market.last_cycle = cycle;
+    (cycle.status == "complete" ? cycles_completed_ : cycles_abandoned_).fetch_add(1, std::memory_order_relaxed);
+    if (market.primary) {
+        std::lock_guard<std::mutex> lock(history_mutex_);
+        last_completed_cycle_ = cycle;
+    }
+    
+    // The cycle's PnL is already booked (book_realized); this counts it
+    PnlLedger::CyclePnl entry;
+    entry.ended_ms = epoch_ms(now());
+    entry.started_ms = market.position && !market.position->trades.empty()
+        ? epoch_ms(market.position->trades.front().timestamp) : entry.ended_ms;
+    entry.id = "cyc_" + market.slug + "_" + std::to_string(entry.ended_ms);
+    entry.market_slug = market.slug;
+    entry.status = cycle.status;
+    entry.leg1_side = cycle.leg1_side;
+    entry.leg1_price = cycle.leg1_price;
+    entry.leg1_shares = cycle.leg1_shares;
+    entry.leg2_side = cycle.leg2_side;
+    entry.leg2_price = cycle.leg2_price;
+    entry.leg2_shares = cycle.leg2_shares;
+    entry.total_cost = Price::from_double(cycle.total_cost);
+    entry.pnl = Price::from_double(cycle.pnl);
+    pnl_.add_cycle(entry);
+    
+    if (async_writer_) {
+        CycleRecord record;
+        record.id = entry.id;
+        record.market_slug = entry.market_slug;
+        record.started_at = entry.started_ms / 1000;
+        record.ended_at = entry.ended_ms / 1000;
+        record.leg1_side = entry.leg1_side;
+        record.leg1_price = entry.leg1_price;
+        record.leg1_shares = entry.leg1_shares;
+        if (!entry.leg2_side.empty()) {
+            record.leg2_side = entry.leg2_side;
+            record.leg2_price = entry.leg2_price;
+            record.leg2_shares = entry.leg2_shares;
+        }
+        record.total_cost = cycle.total_cost;
+        record.locked_in_profit = cycle.pnl;
+        record.status = entry.status;
+        async_writer_->queue_cycle(record);
+    }
+}
+
+void TradingEngine::book_realized(const std::string& slug, Price pnl) {
+    ledger_.add_realized(pnl);
+    pnl_.add_realized(slug, pnl, epoch_ms(now()));
+}
+
+std::shared_ptr<TradingEngine::MarketState> TradingEngine::make_market_state(
+    const std::string& slug,
+    const std::string& up_token,
+    const std::string& down_token
+) {
+    auto market = std::make_shared<MarketState>();
+    market->slug = slug;
+    market->up_token_id = up_token;
+    market->down_token_id = down_token;
+    market->up_token = TokenRegistry::instance().intern(up_token);
+    market->down_token = TokenRegistry::instance().intern(down_token);
+    
+    // "btc-updown-15m-<ts>": series and window from the slug
+    if (!split_market_slug(slug, market->series, market->window_start)) {
+        market->series = slug;
+    }
+    MarketSeries series;
+    if (parse_market_series(market->series, series)) market->period_sec = series.period_sec;
+    return market;
+}
+
+bool TradingEngine::refresh_primary_books(BookSnapshot& snapshot) const {
+    std::string slug;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slug = active_market_slug_;
+    }
+    
+    std::shared_ptr<MarketState> market;
+    Shard* shard = slug.empty() ? nullptr : find_market(slug, market);
+    if (!shard) {
+        if (snapshot.slug.empty() && snapshot.version == 0) return false;
+        snapshot = BookSnapshot{};
+        return true;
+    }
     
+    std::lock_guard<std::mutex> shard_lock(shard->mutex);
+    // Both counters only grow, so their sum moves whenever either book does;
+    // +1 keeps it clear of the cleared snapshot's 0
+    uint64_t version = market->up_book.version() + market->down_book.version() + 1;
+    if (slug == snapshot.slug && version == snapshot.version) return false;
+    
+    snapshot.slug = slug;
+    snapshot.version = version;
+    for (auto* levels : {&snapshot.up.asks, &snapshot.up.bids, &snapshot.down.asks, &snapshot.down.bids}) {
+        levels->clear();  // Capacity is kept from tick to tick
+    }
+    auto up_view = market->up_view();
+    auto down_view = market->down_view();
+    up_view.top_levels(BookSide::ASK, OrderBook::kNumLevels, snapshot.up.asks);
+    up_view.top_levels(BookSide::BID, OrderBook::kNumLevels, snapshot.up.bids);
+    down_view.top_levels(BookSide::ASK, OrderBook::kNumLevels, snapshot.down.asks);
+    down_view.top_levels(BookSide::BID, OrderBook::kNumLevels, snapshot.down.bids);
+    return true;
+}
+
+void TradingEngine::sample_books(std::vector<BookSample>& out) const {
+    auto copy_levels = [](const MergedBookView& view, BookSide side, std::array<BookLevel, kTickDepth>& levels) {
+        size_t n = 0;
+        view.for_each_level(side, kTickDepth, [&](Price price, Qty size) { levels[n++] = BookLevel{price, size}; });
+        for (; n < kTickDepth; ++n) levels[n] = BookLevel{};
+    };
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
+        for (const auto& [slug, market] : shard->markets) {
+            BookSample& sample = out.emplace_back();
+            sample.slug = slug;
+            sample.up_token_id = market->up_token_id;
+            sample.down_token_id = market->down_token_id;
+            sample.up_token = market->up_token;
+            sample.down_token = market->down_token;
+            // The tick store skips the book row while this is unchanged
+            sample.version = market->up_book.version() + market->down_book.version();
+            sample.up.side = Side::UP;
+            sample.down.side = Side::DOWN;
+            auto up_view = market->up_view();
+            auto down_view = market->down_view();
+            copy_levels(up_view, BookSide::BID, sample.up.bids);
+            copy_levels(up_view, BookSide::ASK, sample.up.asks);
+            copy_levels(down_view, BookSide::BID, sample.down.bids);
+            copy_levels(down_view, BookSide::ASK, sample.down.asks);
+        }
+    }
+}
+
+std::shared_ptr<const EngineStatus> TradingEngine::status_snapshot() const {
+    auto snapshot = std::atomic_load(&published_status_);
+    // Nothing published yet, or no publisher thread (inline or stopped
+    // engine): build on demand
+    if (!snapshot || (!publishing_ && snapshot->version != state_version_.load(std::memory_order_acquire))) {
+        publish_status();
+        snapshot = std::atomic_load(&published_status_);
+    }
+    return snapshot;
+}
+
+void TradingEngine::publish_status() const {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    // Read the version first: a change racing with the build bumps it again
+    // and is picked up by the next round
+    uint64_t version = state_version_.load(std::memory_order_acquire);
+    auto status = std::make_shared<EngineStatus>(get_status());
+    status->version = version;
+    std::atomic_store(&published_status_, std::shared_ptr<const EngineStatus>(std::move(status)));
+}
+
+void TradingEngine::run_status_publisher() {
+    auto last_publish = std::chrono::steady_clock::time_point{};
+    uint64_t published = 0;
+    std::unique_lock<std::mutex> lock(status_wait_mutex_);
+    while (running_) {
+        auto now = std::chrono::steady_clock::now();
+        uint64_t version = state_version_.load(std::memory_order_acquire);
+        // Uptime moves even when nothing else does
+        if (version != published || now - last_publish >= std::chrono::seconds(1)) {
+            lock.unlock();
+            publish_status();
+            mark_pnl();
+            lock.lock();
+            published = version;
+            last_publish = now;
+        }
+        status_cv_.wait_for(lock, std::chrono::milliseconds(kStatusPublishMs), [this] { return !running_; });
+    }
+}
+
+void TradingEngine::mark_pnl() {
+    auto status = std::atomic_load(&published_status_);
+    if (!status) return;
+    std::vector<std::pair<std::string, Price>> markets;
+    markets.reserve(status->markets.size());
+    for (const auto& summary : status->markets) {
+        if (summary.unrealized_pnl != 0.0) markets.emplace_back(summary.slug, Price::from_double(summary.unrealized_pnl));
+    }
+    auto closed = pnl_.mark(epoch_ms(now()), Price::from_double(status->cash), Price::from_double(status->equity),
+                            Price::from_double(status->unrealized_pnl), markets);
+    // Each minute's closing equity goes to the database
+    if (!async_writer_) return;
+    for (const auto& point : closed) {
+        async_writer_->queue_equity(EquitySnapshotRecord{
+            .ts_ms = point.ts_ms,
+            .cash = point.cash.to_double(),
+            .equity = point.equity.to_double(),
+            .unrealized = point.unrealized.to_double(),
+            .realized = point.realized.to_double()
+        });
+    }
+}
+
+EngineStatus TradingEngine::get_status() const {
     EngineStatus status;
+    std::string primary_slug;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        status.config = config_;
+        primary_slug = active_market_slug_;
+    }
+    
     status.running = running_;
     status.mode = (trading_mode_ == TradingMode::LIVE) ? "LIVE" : "PAPER";
-    status.cash = cash_;
-    status.realized_pnl = realized_pnl_;
-    status.config = config_;
-    status.market_slug = active_market_slug_;
+    status.strategy = strategy()->name();
+    status.cash = ledger_.cash();
+    status.realized_pnl = ledger_.realized_pnl();
+    status.open_exposure = ledger_.open_exposure();
+    status.orders_in_flight = orders_.stats().in_flight;
+    status.cycles_completed = cycles_completed_.load(std::memory_order_relaxed);
+    status.cycles_abandoned = cycles_abandoned_.load(std::memory_order_relaxed);
+    status.market_slug = primary_slug;
     
     // Check if live trading is available (private key configured)
     const char* pk = std::getenv("POLYMARKET_PRIVATE_KEY");
@@ -103,62 +752,72 @@ EngineStatus TradingEngine::get_status() const {
     auto now = std::chrono::system_clock::now();
     status.uptime_seconds = std::chrono::duration_cast<std::chrono::seconds>(now - start_time_).count();
     
-    // Get positions from current position
+    // Positions and books are those of the primary (dashboard) market
     status.positions.UP = 0;
     status.positions.DOWN = 0;
-    
-    if (current_position_) {
-        if (current_position_->side == "UP") {
-            status.positions.UP = current_position_->shares;
-        } else {
-            status.positions.DOWN = current_position_->shares;
-        }
-    }
-    
-    // Calculate unrealized PnL and equity
     status.unrealized_pnl = 0.0;
+    double position_value = 0.0;
+    std::optional<Position> primary_position;
     
-    // Get orderbook data for active market
-    auto it = markets_.find(active_market_slug_);
-    if (it != markets_.end()) {
-        const auto& market = it->second;
-        
-        // Copy UP orderbook
-        for (const auto& [price, size] : market.up_orderbook.asks) {
-            status.up_orderbook.asks.push_back({price, size});
-        }
-        for (const auto& [price, size] : market.up_orderbook.bids) {
-            status.up_orderbook.bids.push_back({price, size});
-        }
-        
-        // Copy DOWN orderbook
-        for (const auto& [price, size] : market.down_orderbook.asks) {
-            status.down_orderbook.asks.push_back({price, size});
-        }
-        for (const auto& [price, size] : market.down_orderbook.bids) {
-            status.down_orderbook.bids.push_back({price, size});
-        }
+    // One shard locked at a time - the others keep trading
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
         
-        // Calculate unrealized PnL if we have a position
-        if (current_position_) {
-            double current_bid = 0.0;
-            if (current_position_->side == "UP" && !market.up_orderbook.bids.empty()) {
-                current_bid = market.up_orderbook.bids[0].first;
-            } else if (current_position_->side == "DOWN" && !market.down_orderbook.bids.empty()) {
-                current_bid = market.down_orderbook.bids[0].first;
+        for (const auto& [slug, market] : shard->markets) {
+            if (slug == primary_slug) {
+                auto up_view = market->up_view();
+                auto down_view = market->down_view();
+                
+                // Copy UP orderbook (best levels first)
+                up_view.top_levels(BookSide::ASK, OrderBook::kNumLevels, status.up_orderbook.asks);
+                up_view.top_levels(BookSide::BID, OrderBook::kNumLevels, status.up_orderbook.bids);
+                
+                // Copy DOWN orderbook
+                down_view.top_levels(BookSide::ASK, OrderBook::kNumLevels, status.down_orderbook.asks);
+                down_view.top_levels(BookSide::BID, OrderBook::kNumLevels, status.down_orderbook.bids);
+                
+                primary_position = market->position;
+                if (market->position) {
+                    if (market->position->side == Side::UP) {
+                        status.positions.UP = market->position->shares.to_double();
+                    } else {
+                        status.positions.DOWN = market->position->shares.to_double();
+                    }
+                }
             }
-            status.unrealized_pnl = (current_bid - current_position_->avg_cost) * current_position_->shares;
+            
+            // Unrealized PnL and equity cover every market's open position
+            MarketSummary summary;
+            summary.slug = slug;
+            summary.active = market->active;
+            summary.up_ask = market->up_view().best_ask().to_double();
+            summary.down_ask = market->down_view().best_ask().to_double();
+            summary.order_in_flight = market->entry_order != 0 || market->hedge_order != 0 || market->dca_order != 0;
+            if (!market->last_cycle.leg1_side.empty()) summary.cycle_status = market->last_cycle.status;
+            
+            if (market->position) {
+                const Position& pos = *market->position;
+                Price current_bid = pos.side == Side::UP ?
+                    market->up_view().best_bid() : market->down_view().best_bid();
+                summary.unrealized_pnl = notional(current_bid - pos.avg_cost, pos.shares).to_double();
+                status.unrealized_pnl += summary.unrealized_pnl;
+                position_value += notional(pos.avg_cost, pos.shares).to_double();
+                
+                summary.position_side = side_name(pos.side);
+                summary.position_shares = pos.shares.to_double();
+                summary.position_cost = pos.total_cost.to_double();
+                summary.cycle_status = "leg1_done";
+            }
+            status.markets.push_back(std::move(summary));
         }
     }
+    std::sort(status.markets.begin(), status.markets.end(),
+              [](const MarketSummary& a, const MarketSummary& b) { return a.slug < b.slug; });
     
-    // Calculate equity
-    double position_value = 0.0;
-    if (current_position_) {
-        // Use current position value estimate
-        position_value = current_position_->shares * current_position_->avg_cost;
-    }
     status.equity = status.cash + position_value + status.unrealized_pnl;
     
+    std::lock_guard<std::mutex> history_lock(history_mutex_);
+    
     // Copy recent trades (last 100)
     size_t start_idx = trade_history_.size() > 100 ? trade_history_.size() - 100 : 0;
     for (size_t i = start_idx; i < trade_history_.size(); ++i) {
@@ -167,13 +826,13 @@ EngineStatus TradingEngine::get_status() const {
     
     
     // Populate current cycle
-    if (current_position_) {
+    if (primary_position) {
         status.current_cycle.active = true;
         status.current_cycle.status = "leg1_done";
-        status.current_cycle.leg1_side = current_position_->side;
-        status.current_cycle.leg1_price = current_position_->avg_cost;
-        status.current_cycle.leg1_shares = current_position_->shares;
-        status.current_cycle.total_cost = current_position_->total_cost;
+        status.current_cycle.leg1_side = side_name(primary_position->side);
+        status.current_cycle.leg1_price = primary_position->avg_cost.to_double();
+        status.current_cycle.leg1_shares = primary_position->shares.to_double();
+        status.current_cycle.total_cost = primary_position->total_cost.to_double();
     } else {
         status.current_cycle.active = false;
         status.current_cycle.status = "pending";
@@ -187,430 +846,907 @@ EngineStatus TradingEngine::get_status() const {
 }
 
 void TradingEngine::on_orderbook_update(
-    const std::string& token_id,
-    OrderbookSnapshot snapshot
+    TokenId token,
+    const OrderbookSnapshot& snapshot
 ) {
+    if (Shard* shard = shard_for_token(token)) {
+        apply_snapshot(*shard, token, snapshot.bids, snapshot.asks, snapshot.timestamp, FrameStamp{});
+    }
+}
+
+void TradingEngine::on_orderbook_update(const OrderbookUpdate& update) {
+    if (Shard* shard = shard_for_token(update.token)) {
+        apply_snapshot(*shard, update.token, update.bids, update.asks, now(), update.stamp);
+    }
+}
+
+void TradingEngine::on_book_delta(const BookDelta& delta) {
+    on_book_deltas(&delta, 1);
+}
+
+void TradingEngine::on_book_deltas(const BookDelta* deltas, size_t count) {
+    // Hand each run of same-shard deltas over in one piece
+    size_t run_start = 0;
+    Shard* run_shard = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        Shard* shard = shard_for_token(deltas[i].token);
+        if (shard != run_shard) {
+            if (run_shard) apply_deltas(*run_shard, deltas + run_start, i - run_start);
+            run_shard = shard;
+            run_start = i;
+        }
+    }
+    if (run_shard) apply_deltas(*run_shard, deltas + run_start, count - run_start);
+}
+
+TradingEngine::IngestScratch& TradingEngine::ingest_scratch() {
+    thread_local IngestScratch scratch;
+    return scratch;
+}
+
+void TradingEngine::apply_snapshot(Shard& shard, TokenId token, const std::vector<BookLevel>& bids,
+                                   const std::vector<BookLevel>& asks,
+                                   std::chrono::system_clock::time_point timestamp, const FrameStamp& stamp) {
     if (!running_) return;
     
-    std::string market_to_process;
+    std::shared_ptr<MarketState> market;
+    std::vector<PaperFill> paper_fills;
     
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<std::mutex> lock(shard.mutex);
         
-        // Find which market this token belongs to
-        for (auto& [slug, market] : markets_) {
-            if (market.up_token_id == token_id) {
-                market.up_orderbook = snapshot;  // Copy, don't move - we need it for derivation
-                market.last_update = std::chrono::system_clock::now();
-                market_to_process = slug;
-                
-                // SORT UP orderbook: Asks ascending (best first), Bids descending (best first)
-                std::sort(market.up_orderbook.asks.begin(), market.up_orderbook.asks.end(),
-                    [](const auto& a, const auto& b) { return a.first < b.first; });
-                std::sort(market.up_orderbook.bids.begin(), market.up_orderbook.bids.end(),
-                    [](const auto& a, const auto& b) { return a.first > b.first; });
-                
-                // DERIVE DOWN orderbook from UP orderbook (binary market: UP + DOWN = 1.0)
-                // UP bids → DOWN asks (inverted price)
-                // UP asks → DOWN bids (inverted price)
-                market.down_orderbook.asks.clear();
-                market.down_orderbook.bids.clear();
-                
-                for (const auto& [price, size] : snapshot.bids) {
-                    double down_ask_price = 1.0 - price;  // UP bid of 0.30 = DOWN ask of 0.70
-                    if (down_ask_price > 0.0 && down_ask_price < 1.0) {
-                        market.down_orderbook.asks.push_back({down_ask_price, size});
-                    }
+        // Staged markets are routed too - their books warm up before promotion
+        auto it = shard.token_index.find(token);
+        if (it == shard.token_index.end()) return;
+        market = it->second.market;
+        
+        // The other outcome's side of this book is not materialised -
+        // MergedBookView reads it through ComplementBookView (UP bid p = DOWN ask 1 - p)
+        OrderBook& book = it->second.is_up ? market->up_book : market->down_book;
+        book.apply_snapshot(bids, asks);
+        
+        // A full book settles any gap; a REST fetch in flight is now stale
+        MarketState::BookSync& sync = it->second.is_up ? market->up_sync : market->down_sync;
+        sync.confirmed = timestamp;
+        sync.synced = true;
+        sync.gap = false;
+        sync.epoch++;
+        sync.buffered.clear();
+        mark_dirty();
+        collect_paper_fills(*market, paper_fills);
+    }
+    report_paper_fills(paper_fills);
+    
+    uint64_t book_ns = latency::now_ns();
+    LatencyMonitor::instance().record(latency::Span::PARSE_TO_BOOK, stamp.parsed_ns, book_ns);
+    latency::current_tick() = {stamp.frame_ns, book_ns, 0};
+    
+    process_market(shard, market);
+    
+    // Shadows get the update once the primary has acted on it
+    if (shadows_) shadows_->publish_snapshot(token, bids, asks, timestamp);
+}
+
+void TradingEngine::apply_deltas(Shard& shard, const BookDelta* deltas, size_t count) {
+    if (!running_) return;
+    
+    // The markets stay referenced until the batch is evaluated, in case
+    // one is retired meanwhile; released below
+    auto& markets_to_process = ingest_scratch().markets;
+    auto& checked = ingest_scratch().checked;
+    markets_to_process.clear();
+    checked.clear();
+    std::vector<PaperFill> paper_fills;
+    std::vector<ResyncJob> resyncs;
+    
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto now = this->now();
+        
+        // Batches are usually runs of the same token - skip the re-hash
+        TokenId last_token = kNoToken;
+        const TokenRoute* route = nullptr;
+        
+        for (size_t i = 0; i < count; ++i) {
+            const BookDelta& delta = deltas[i];
+            if (last_token == kNoToken || last_token != delta.token) {
+                auto it = shard.token_index.find(delta.token);
+                route = it == shard.token_index.end() ? nullptr : &it->second;
+                last_token = delta.token;
+            }
+            if (!route) continue;
+            
+            MarketState& market = *route->market;
+            OrderBook& book = route->is_up ? market.up_book : market.down_book;
+            MarketState::BookSync& sync = route->is_up ? market.up_sync : market.down_sync;
+            sync.confirmed = now;
+            if (sync.resyncing && !sync.overflow) {
+                if (sync.buffered.size() < kMaxResyncBuffer) {
+                    sync.buffered.push_back(delta);
+                } else {
+                    sync.overflow = true;
+                    sync.buffered.clear();
                 }
-                for (const auto& [price, size] : snapshot.asks) {
-                    double down_bid_price = 1.0 - price;  // UP ask of 0.70 = DOWN bid of 0.30
-                    if (down_bid_price > 0.0 && down_bid_price < 1.0) {
-                        market.down_orderbook.bids.push_back({down_bid_price, size});
-                    }
+            }
+            if (book.apply_delta(delta.side, delta.price, delta.size)) {
+                if (std::find(markets_to_process.begin(), markets_to_process.end(), route->market) ==
+                    markets_to_process.end()) {
+                    markets_to_process.push_back(route->market);
+                }
+            }
+        }
+        
+        // Each book against the top the feed reported with its last change
+        // in the batch - the earlier ones describe books since moved on
+        for (size_t i = count; i-- > 0;) {
+            const BookDelta& delta = deltas[i];
+            if (!delta.has_top || std::find(checked.begin(), checked.end(), delta.token) != checked.end()) continue;
+            checked.push_back(delta.token);
+            auto it = shard.token_index.find(delta.token);
+            if (it == shard.token_index.end()) continue;
+            MarketState& market = *it->second.market;
+            const OrderBook& book = it->second.is_up ? market.up_book : market.down_book;
+            MarketState::BookSync& sync = it->second.is_up ? market.up_sync : market.down_sync;
+            if (top_agrees(book, BookSide::BID, delta.best_bid) && top_agrees(book, BookSide::ASK, delta.best_ask)) {
+                continue;
+            }
+            if (!sync.gap) {
+                book_gaps_.fetch_add(1, std::memory_order_relaxed);
+                POLY_LOG_DEBUG("BOOK", "{} book off the feed's top (bid {:.3f} ask {:.3f}, feed {:.3f} / {:.3f}) [{}]",
+                              it->second.is_up ? "UP" : "DOWN", book.best_bid().to_double(),
+                              book.best_ask().to_double(), delta.best_bid.to_double(), delta.best_ask.to_double(),
+                              market.slug);
+            }
+            sync.gap = true;
+            if (resync_enabled() && take_resync(it->second.market, it->second.is_up, true, resyncs)) {
+                // This batch's changes may be newer than the snapshot the fetch gets
+                for (size_t j = 0; j < count; ++j) {
+                    if (deltas[j].token == delta.token) sync.buffered.push_back(deltas[j]);
                 }
-                
-                // SORT: Asks ascending (best/lowest first), Bids descending (best/highest first)
-                std::sort(market.down_orderbook.asks.begin(), market.down_orderbook.asks.end(),
-                    [](const auto& a, const auto& b) { return a.first < b.first; });
-                std::sort(market.down_orderbook.bids.begin(), market.down_orderbook.bids.end(),
-                    [](const auto& a, const auto& b) { return a.first > b.first; });
-                
-                market.down_orderbook.timestamp = snapshot.timestamp;
-                
-                break;
-            } else if (market.down_token_id == token_id) {
-                market.down_orderbook = snapshot;  // Direct update if DOWN book comes in
-                market.last_update = std::chrono::system_clock::now();
-                market_to_process = slug;
-                break;
             }
         }
+        for (const auto& market : markets_to_process) collect_paper_fills(*market, paper_fills);
+    }
+    if (!resyncs.empty()) start_resyncs(shard, resyncs);
+    report_paper_fills(paper_fills);
+    
+    if (markets_to_process.empty()) return;
+    mark_dirty();
+    
+    // The strategy sees the batch as a whole - time it from the newest frame
+    uint64_t book_ns = latency::now_ns();
+    uint64_t newest_frame_ns = 0;
+    auto& monitor = LatencyMonitor::instance();
+    for (size_t i = 0; i < count; ++i) {
+        monitor.record(latency::Span::PARSE_TO_BOOK, deltas[i].stamp.parsed_ns, book_ns);
+        newest_frame_ns = std::max(newest_frame_ns, deltas[i].stamp.frame_ns);
     }
+    latency::current_tick() = {newest_frame_ns, book_ns, 0};
     
-    if (!market_to_process.empty()) {
-        process_market(market_to_process);
+    for (const auto& market : markets_to_process) {
+        process_market(shard, market);
+    }
+    markets_to_process.clear();
+    
+    if (shadows_) shadows_->publish_deltas(deltas, count);
+}
+
+bool TradingEngine::take_resync(const std::shared_ptr<MarketState>& market_ptr, bool is_up, bool gap,
+                                std::vector<ResyncJob>& jobs) {
+    MarketState& market = *market_ptr;
+    MarketState::BookSync& sync = is_up ? market.up_sync : market.down_sync;
+    if (sync.resyncing) return false;
+    sync.resyncing = true;
+    sync.overflow = false;
+    sync.buffered.clear();
+    
+    ResyncJob job;
+    job.market = market_ptr;
+    job.token = is_up ? market.up_token : market.down_token;
+    job.token_id = is_up ? market.up_token_id : market.down_token_id;
+    job.is_up = is_up;
+    job.gap = gap;
+    job.epoch = sync.epoch;
+    jobs.push_back(std::move(job));
+    return true;
+}
+
+void TradingEngine::start_resyncs(Shard& shard, std::vector<ResyncJob>& jobs) {
+    for (auto& job : jobs) {
+        resync_pool_->submit([this, &shard, job = std::move(job)] {
+            std::shared_ptr<PolymarketClient> client;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                client = polymarket_client_;
+            }
+            bool ok = false;
+            std::vector<BookLevel> bids;
+            std::vector<BookLevel> asks;
+            uint64_t server_ts = 0;
+            try {
+                if (client) {
+                    Orderbook book = client->get_orderbook(job.token_id);
+                    for (const auto& level : book.bids) {
+                        bids.push_back(BookLevel{Price::from_double(level.price), Qty::from_double(level.size)});
+                    }
+                    for (const auto& level : book.asks) {
+                        asks.push_back(BookLevel{Price::from_double(level.price), Qty::from_double(level.size)});
+                    }
+                    server_ts = book.timestamp;
+                    ok = true;
+                }
+            } catch (const std::exception& e) {
+                POLY_LOG_WARN("BOOK", "REST book fetch failed: {} [{}]", e.what(), job.market->slug);
+            }
+            shard.pipeline.post([this, &shard, job, ok, bids = std::move(bids), asks = std::move(asks), server_ts] {
+                apply_resync(shard, job, ok, bids, asks, server_ts);
+            });
+        });
     }
+    jobs.clear();
 }
 
-void TradingEngine::process_market(const std::string& market_slug) {
-    auto it = markets_.find(market_slug);
-    if (it == markets_.end()) return;
+void TradingEngine::apply_resync(Shard& shard, const ResyncJob& job, bool ok, const std::vector<BookLevel>& bids,
+                                 const std::vector<BookLevel>& asks, uint64_t server_ts) {
+    if (!running_) return;
+    
+    std::vector<BookDelta> replayed;
+    std::vector<PaperFill> paper_fills;
+    auto now = this->now();
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.token_index.find(job.token);
+        if (it == shard.token_index.end() || it->second.market != job.market) return;  // Retired meanwhile
+        MarketState& market = *job.market;
+        MarketState::BookSync& sync = job.is_up ? market.up_sync : market.down_sync;
+        sync.resyncing = false;
+        
+        // A gap stays flagged, so the next check fetches again
+        if (!ok) {
+            resync_failures_.fetch_add(1, std::memory_order_relaxed);
+            sync.buffered.clear();
+            return;
+        }
+        if (sync.epoch != job.epoch) {
+            resyncs_superseded_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (sync.overflow) {
+            sync.gap = true;
+            return;
+        }
+        
+        // The deltas the snapshot already contains are older than it
+        OrderBook& book = job.is_up ? market.up_book : market.down_book;
+        book.apply_snapshot(bids, asks);
+        for (const BookDelta& delta : sync.buffered) {
+            if (delta.timestamp != 0 && delta.timestamp < server_ts) continue;
+            book.apply_delta(delta.side, delta.price, delta.size);
+            replayed.push_back(delta);
+        }
+        sync.buffered.clear();
+        sync.confirmed = now;
+        sync.synced = true;
+        sync.gap = false;
+        sync.epoch++;
+        
+        book_resyncs_.fetch_add(1, std::memory_order_relaxed);
+        deltas_replayed_.fetch_add(replayed.size(), std::memory_order_relaxed);
+        mark_dirty();
+        collect_paper_fills(market, paper_fills);
+    }
+    report_paper_fills(paper_fills);
+    if (job.gap) {
+        POLY_LOG_INFO("BOOK", "{} book resynced from REST, {} deltas replayed [{}]", job.is_up ? "UP" : "DOWN",
+                      replayed.size(), job.market->slug);
+    }
     
-    const auto& market = it->second;
+    process_market(shard, job.market);
     
-    // Extract START timestamp from market slug
-    int64_t market_start_time = 0;
-    size_t last_dash = market_slug.rfind('-');
-    if (last_dash != std::string::npos) {
-        try { market_start_time = std::stoll(market_slug.substr(last_dash + 1)); } catch (...) {}
+    if (shadows_) {
+        shadows_->publish_snapshot(job.token, bids, asks, now);
+        shadows_->publish_deltas(replayed.data(), replayed.size());
     }
-    auto now = std::chrono::system_clock::now();
+}
+
+void TradingEngine::check_books(Shard& shard) {
+    if (!running_ || !resync_enabled()) return;
+    const int stale_ms = strategy()->params().book_stale_ms;
+    const auto refresh_after = std::chrono::milliseconds(stale_ms / 2);
+    
+    std::vector<ResyncJob> jobs;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto now = this->now();
+        for (const auto& [slug, market] : shard.markets) {
+            for (bool is_up : {true, false}) {
+                const MarketState::BookSync& sync = is_up ? market->up_sync : market->down_sync;
+                const bool quiet = stale_ms > 0 && now - sync.confirmed >= refresh_after;
+                if (!sync.gap && !quiet) continue;
+                if (take_resync(market, is_up, sync.gap, jobs) && !sync.gap) {
+                    book_refreshes_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+    if (!jobs.empty()) start_resyncs(shard, jobs);
+}
+
+void TradingEngine::process_market(Shard& shard, const std::shared_ptr<MarketState>& market_ptr) {
+    // The shared_ptr keeps the state alive if it is retired meanwhile.
+    // Books are only mutated on this shard's thread.
+    const MarketState& market = *market_ptr;
+    const std::string& market_slug = market.slug;
+    
+    auto now = this->now();
     auto now_sec = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-    int secs_into_window = static_cast<int>(now_sec - market_start_time);
-    int time_left = 900 - secs_into_window;
+    MarketTick tick{
+        .slug = &market_slug,
+        .up = market.up_view(),
+        .down = market.down_view(),
+        .dumps = &market.dumps,
+        .now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count(),
+        .secs_into_window = static_cast<int>(now_sec - market.window_start)
+    };
     
-    // Trade in the FIRST X seconds of the window (when secs_into_window <= window)
-    if (secs_into_window < 0 || secs_into_window > config_.dump_window_sec) {
-        return;  // Not in trading window (either too early or past the first 120s)
+    // Every tick feeds the dump windows, in the trading window or not.
+    // An empty side reads as an ask of 1 - not a price to measure from.
+    if (tick.up.best_tick(BookSide::ASK) != OrderBook::kNoTick) {
+        market.dumps.add_price(Side::UP, tick.up.best_ask(), tick.now_ms);
+    }
+    if (tick.down.best_tick(BookSide::ASK) != OrderBook::kNoTick) {
+        market.dumps.add_price(Side::DOWN, tick.down.best_ask(), tick.now_ms);
     }
     
-    // Don't start NEW positions in last 5 seconds of trading window
-    bool can_enter_new = (secs_into_window < config_.dump_window_sec - 5);
-    bool has_position = (current_position_.has_value());
+    const auto strategy = this->strategy();
+    if (tick.secs_into_window < 0 || tick.secs_into_window > strategy->params().trade_window_sec) {
+        return;  // Not in trading window - skip the lock
+    }
     
-    // Check if we should enter a position (only if not in last 5 seconds)
-    if (!current_position_ && can_enter_new) {
-        // Check cooldown - wait at least 5 seconds between cycles
-        auto now_time = std::chrono::system_clock::now();
-        auto since_last = std::chrono::duration_cast<std::chrono::seconds>(now_time - last_cycle_complete_time_).count();
-        if (since_last < 5) {
-            return; // Still in cooldown
+    // This market's open leg and orders in flight. Only the scalars are
+    // read per tick; the position itself is copied when a hedge goes out.
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!market.active) return;  // Staged markets never trade
+        if (market.position) {
+            tick.has_position = true;
+            tick.position_side = market.position->side;
+            tick.position_cost = market.position->avg_cost;
+            tick.position_filled = market.position->filled;
         }
-        std::string side;
-        double price;
+        tick.book_stale = !book_fresh(market.up_sync, now, strategy->params().book_stale_ms) ||
+                          !book_fresh(market.down_sync, now, strategy->params().book_stale_ms);
+        if (tick.book_stale && !market.position) stale_ticks_.fetch_add(1, std::memory_order_relaxed);
+        tick.entry_in_flight = market.entry_order != 0;
+        tick.hedge_in_flight = market.hedge_order != 0;
+        tick.dca_in_flight = market.dca_order != 0;
+        tick.secs_since_cycle =
+            std::chrono::duration_cast<std::chrono::seconds>(now - market.last_cycle_complete_time).count();
+    }
+    
+    Decision decision = strategy->evaluate(tick);
+    if (decision.checked) mark_decision();
+    
+    switch (decision.action) {
+        case Decision::Action::NONE:
+            return;
         
-        if (should_enter(market, side, price)) {
-            
-            // Execute entry trade
-            auto trade = execute_trade(
+        case Decision::Action::ENTER: {
+            // Fire and forget - the position appears once the exchange acks
+            const bool sent = submit_order(
+                &shard,
+                market_ptr,
                 market_slug,
-                side,
-                side == "UP" ? market.up_token_id : market.down_token_id,
-                config_.shares,
-                price
+                OrderIntent::ENTRY,
+                decision.side,
+                decision.side == Side::UP ? market.up_token : market.down_token,
+                decision.shares,
+                decision.price,
+                std::nullopt
             );
-            
-            if (trade) {
-                current_position_ = Position{
-                    .market_slug = market_slug,
-                    .side = side,
-                    .shares = trade->shares,
-                    .avg_cost = trade->price,
-                    .total_cost = trade->cost,
-                    .trades = {*trade}
-                };
-                
-                std::cout << "\n╔══════════════════════════════════════════════════════════╗" << std::endl;
-std::ostringstream oss1;
-                oss1 << std::fixed << std::setprecision(4);
-                oss1 << "LEG 1 ENTRY: " << side << " x" << (int)trade->shares << " @ $" << trade->price;
-                std::string leg1_msg = oss1.str();
-                add_log("trade", "ENGINE", leg1_msg);
-                std::cout << "║  🟢 LEG 1 ENTRY                                           ║" << std::endl;
-                std::cout << "╠══════════════════════════════════════════════════════════╣" << std::endl;
-                std::cout << "║  Side:      " << side << std::string(45 - side.length(), ' ') << "║" << std::endl;
-                std::cout << "║  Shares:    " << trade->shares << std::string(45 - std::to_string((int)trade->shares).length(), ' ') << "║" << std::endl;
-                std::cout << "║  Price:     $" << std::fixed << std::setprecision(4) << trade->price << std::string(43, ' ') << "║" << std::endl;
-                std::cout << "║  Cost:      $" << std::fixed << std::setprecision(2) << trade->cost << std::string(43, ' ') << "║" << std::endl;
-                std::cout << "║  Cash:      $" << std::fixed << std::setprecision(2) << cash_ << std::string(43, ' ') << "║" << std::endl;
-                std::cout << "╚══════════════════════════════════════════════════════════╝\n" << std::endl;
+            const DumpDetection& dump = decision.dump;
+            if (sent && dump.detected && !quiet_) {
+                POLY_LOG_INFO("ENGINE", "📉 {} dumped {:.1f}% in {}s ({} -> {}) [{}]", side_name(dump.side),
+                              dump.drop_pct * 100, dump.window_sec, dump.from_price.to_double(),
+                              dump.to_price.to_double(), market_slug);
             }
+            return;
         }
-    }
-    // Check if we should hedge
-    else if (current_position_->market_slug == market_slug) {
-        double hedge_price;
         
-        if (should_hedge(*current_position_, market, hedge_price)) {
-            std::string opposite_side = current_position_->side == "UP" ? "DOWN" : "UP";
-            
-            
-            // Execute hedge trade
-            auto trade = execute_trade(
+        case Decision::Action::HEDGE: {
+            std::optional<Position> position;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                position = market.position;
+            }
+            if (!position || !position->filled) return;  // Settled meanwhile
+            submit_order(
+                &shard,
+                market_ptr,
                 market_slug,
-                opposite_side,
-                opposite_side == "UP" ? market.up_token_id : market.down_token_id,
-                current_position_->shares,
-                hedge_price
+                OrderIntent::HEDGE,
+                decision.side,
+                decision.side == Side::UP ? market.up_token : market.down_token,
+                position->shares,
+                decision.price,
+                position
             );
-            
-            if (trade) {
-                double profit = (1.0 - current_position_->avg_cost - hedge_price) * 
-                               current_position_->shares;
-                double sum = current_position_->avg_cost + hedge_price;
-                
-                std::cout << "\n╔══════════════════════════════════════════════════════════╗" << std::endl;
-std::ostringstream oss2;
-                oss2 << std::fixed << std::setprecision(4);
-                oss2 << "LEG 2 HEDGE: " << opposite_side << " @ $" << hedge_price << " | Sum: $" << sum;
-                std::string leg2_msg = oss2.str();
-                add_log("trade", "ENGINE", leg2_msg);
-                std::cout << "║  🔴 LEG 2 HEDGE - CYCLE COMPLETE                          ║" << std::endl;
-                std::cout << "╠══════════════════════════════════════════════════════════╣" << std::endl;
-                std::cout << "║  Leg 1:     " << current_position_->side << " @ $" << std::fixed << std::setprecision(4) << current_position_->avg_cost << std::string(32, ' ') << "║" << std::endl;
-                std::cout << "║  Leg 2:     " << opposite_side << " @ $" << std::fixed << std::setprecision(4) << hedge_price << std::string(32, ' ') << "║" << std::endl;
-                std::cout << "║  Sum:       $" << std::fixed << std::setprecision(4) << sum << std::string(43, ' ') << "║" << std::endl;
-                std::cout << "╠══════════════════════════════════════════════════════════╣" << std::endl;
-                if (profit >= 0) {
-                    std::cout << "║  💰 PROFIT: +$" << std::fixed << std::setprecision(2) << profit << std::string(41, ' ') << "║" << std::endl;
-                } else {
-                    std::cout << "║  💸 LOSS:   -$" << std::fixed << std::setprecision(2) << (-profit) << std::string(41, ' ') << "║" << std::endl;
-                }
-                std::cout << "║  Total P&L: $" << std::fixed << std::setprecision(2) << realized_pnl_ << std::string(43, ' ') << "║" << std::endl;
-                std::cout << "║  Cash:      $" << std::fixed << std::setprecision(2) << cash_ << std::string(43, ' ') << "║" << std::endl;
-                std::cout << "╚══════════════════════════════════════════════════════════╝\n" << std::endl;
-                
-                // Clear position
-                // Save completed cycle for display
-                last_completed_cycle_.active = false;
-                last_completed_cycle_.status = "complete";
-                last_completed_cycle_.leg1_side = current_position_->side;
-                last_completed_cycle_.leg1_price = current_position_->avg_cost;
-                last_completed_cycle_.leg1_shares = current_position_->shares;
-                last_completed_cycle_.leg2_side = opposite_side;
-                last_completed_cycle_.leg2_price = hedge_price;
-                last_completed_cycle_.leg2_shares = current_position_->shares;
-                last_completed_cycle_.total_cost = current_position_->total_cost + trade->cost;
-                last_completed_cycle_.pnl = profit;
-                current_position_.reset();
-                last_cycle_complete_time_ = std::chrono::system_clock::now();
+            return;
+        }
+        
+        case Decision::Action::SCALE_IN: {
+            // Not hedgeable yet: scale in at every DCA level the ask fell through
+            DCAManager::Batch batch;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                if (!market.position || !market.position->filled) return;
+                batch = market_ptr->dca.crossed(decision.price);
+                market_ptr->dca.take(batch);
             }
+            if (batch.levels == 0) return;
+            if (!submit_order(
+                    &shard,
+                    market_ptr,
+                    market_slug,
+                    OrderIntent::ADD,
+                    decision.side,
+                    decision.side == Side::UP ? market.up_token : market.down_token,
+                    batch.shares,
+                    batch.limit,
+                    std::nullopt)) {
+                // Busy or short of cash: the levels stay up for a later tick
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                market_ptr->dca.give_back(batch);
+            }
+            return;
         }
     }
 }
 
-bool TradingEngine::should_enter(
-    const MarketState& market,
-    std::string& side_out,
-    double& price_out
+std::optional<Trade> TradingEngine::execute_trade(
+    const std::string& market_slug,
+    Side side,
+    TokenId token,
+    double shares,
+    double price
 ) {
-    double up_ask = get_best_ask(market.up_orderbook);
-    double down_ask = get_best_ask(market.down_orderbook);
-    
-    // Check if either side dropped below threshold (0.36)
-    if (up_ask < config_.move) {
-        side_out = "UP";
-        price_out = up_ask;
-        return true;
+    // An open leg on this market makes this trade the hedge
+    std::shared_ptr<MarketState> market;
+    std::optional<Position> open_position;
+    Shard* shard = find_market(market_slug, market);
+    if (shard) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
+        open_position = market->position;
     }
     
-    if (down_ask < config_.move) {
-        side_out = "DOWN";
-        price_out = down_ask;
-        return true;
-    }
+    auto done = std::make_shared<std::promise<std::optional<Trade>>>();
+    auto settled = done->get_future();
+    bool submitted = submit_order(
+        shard, market, market_slug, open_position ? OrderIntent::HEDGE : OrderIntent::ENTRY, side, token, Qty::from_double(shares), Price::from_double(price), open_position,
+        [done](const std::optional<Trade>& trade) { done->set_value(trade); }
+    );
+    if (!submitted) return std::nullopt;
     
-    return false;
+    // A resting order keeps working in the order manager after we give up
+    if (settled.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+        POLY_LOG_ERROR("ENGINE", "Order not settled after 10s [{}]", market_slug);
+        return std::nullopt;
+    }
+    return settled.get();
 }
 
-bool TradingEngine::should_hedge(
-    const Position& pos,
-    const MarketState& market,
-    double& price_out
+bool TradingEngine::submit_order(
+    Shard* shard,
+    const std::shared_ptr<MarketState>& market,
+    const std::string& market_slug,
+    OrderIntent intent,
+    Side side,
+    TokenId token,
+    Qty shares,
+    Price price,
+    const std::optional<Position>& open_position,
+    TradeDone on_done
 ) {
-    // Get opposite side ask
-    const auto& opposite_book = pos.side == "UP" ? 
-        market.down_orderbook : market.up_orderbook;
+    const bool hedge = intent == OrderIntent::HEDGE;
     
-    double opposite_ask = get_best_ask(opposite_book);
+    OrderRequest request;
+    request.market_slug = market_slug;
+    request.side = side;
+    request.token = token;
+    request.leg = hedge ? 2 : 1;
+    request.shares = shares.to_double();
+    request.price = price.to_double();
+    request.live = strategy()->live() && polymarket_client_;
+    request.frame_ns = latency::current_tick().frame_ns;
+    request.decision_ns = latency::current_tick().decision_ns;
     
-    // Check if we can hedge profitably
-    double sum = pos.avg_cost + opposite_ask;
+    // Held across submit so the first callback sees the order marked in flight
+    std::unique_lock<std::mutex> lock;
+    if (shard && market) {
+        lock = std::unique_lock<std::mutex>(shard->mutex);
+        // Re-check under the lock: one order of each kind per market at a
+        // time, and no hedge while an add is working
+        bool busy = false;
+        switch (intent) {
+            case OrderIntent::ENTRY:
+                busy = market->entry_order != 0 || market->position;
+                break;
+            case OrderIntent::ADD:
+                busy = market->dca_order != 0 || market->hedge_order != 0 ||
+                       !market->position || !market->position->filled;
+                break;
+            case OrderIntent::HEDGE:
+                busy = market->hedge_order != 0 || market->dca_order != 0 || !market->position ||
+                       !market->position->filled;
+                break;
+        }
+        if (busy) return false;
+    }
     
-    if (sum <= config_.sum_target) {
-        price_out = opposite_ask;
-        return true;
+    // Reserve the order's cost up front so concurrent shards can't
+    // overcommit the same cash. A hedge is never refused - leaving the
+    // first leg naked is the bigger risk.
+    const Price reserved = notional(price, shares);
+    if (!hedge) {
+        if (!ledger_.try_debit(reserved)) {
+            const char* what = intent == OrderIntent::ADD ? "Add" : "Entry";
+            POLY_LOG_WARN("ENGINE", "✗ {} refused - insufficient cash for ${} [{}]", what, reserved.to_double(),
+                          market_slug);
+            add_log("warn", "ENGINE", std::string(what) + " refused - insufficient cash [" + market_slug + "]");
+            return false;
+        }
+    } else {
+        ledger_.debit(reserved);
     }
     
-    return false;
+    uint64_t id = orders_.submit(request, [this, shard, market, intent, open_position, reserved, on_done](const ManagedOrder& order) {
+        on_order_update(shard, market, intent, open_position, reserved, on_done, order);
+    });
+    if (id == 0) {
+        ledger_.credit(reserved);
+        POLY_LOG_ERROR("ENGINE", "✗ Order manager not running - order dropped [{}]", market_slug);
+        return false;
+    }
+    
+    if (shard && market) {
+        switch (intent) {
+            case OrderIntent::ENTRY: market->entry_order = id; break;
+            case OrderIntent::ADD: market->dca_order = id; break;
+            case OrderIntent::HEDGE: market->hedge_order = id; break;
+        }
+    }
+    mark_dirty();
+    return true;
 }
 
-std::optional<Trade> TradingEngine::execute_trade(
-    const std::string& market_slug,
-    const std::string& side,
-    const std::string& token_id,
-    double shares,
-    double price
+void TradingEngine::on_order_update(
+    Shard* shard,
+    const std::shared_ptr<MarketState>& market,
+    OrderIntent intent,
+    const std::optional<Position>& open_position,
+    Price reserved,
+    const TradeDone& on_done,
+    const ManagedOrder& order
 ) {
-    // Route to appropriate trade execution method
-    if (trading_mode_ == TradingMode::LIVE && polymarket_client_) {
-        return execute_live_trade(market_slug, side, token_id, shares, price);
+    const OrderRequest& request = order.request;
+    
+    if (order.state == OrderState::ACKED) {
+        // Leg 1 is on the book: the market holds it (no new entry) until it fills
+        if (intent == OrderIntent::ENTRY && shard && market) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            if (market->entry_order == order.id && !market->position) {
+                const Qty shares = Qty::from_double(request.shares);
+                const Price price = Price::from_double(request.price);
+                market->position = Position{
+                    .market_slug = request.market_slug,
+                    .side = request.side,
+                    .shares = shares,
+                    .avg_cost = price,
+                    .total_cost = notional(price, shares),
+                    .trades = {},
+                    .order_id = order.id,
+                    .filled = false
+                };
+            }
+        }
+        mark_dirty();
+        return;
+    }
+    if (!is_terminal(order.state)) return;  // Partial fills are booked once the order is done
+    
+    std::optional<Trade> trade;
+    if (order.filled_shares > 0) {
+        trade = book_fill(order, open_position, reserved);
     } else {
-        return execute_paper_trade(market_slug, side, token_id, shares, price);
+        ledger_.credit(reserved);
+        POLY_LOG_WARN("ORDERS", "✗ Leg {} {}: {} [{}]", request.leg, order_state_name(order.state), order.error,
+                      request.market_slug);
+        add_log(order.state == OrderState::REJECTED ? "error" : "warn", "ORDERS",
+                "Leg " + std::to_string(request.leg) + " " + order_state_name(order.state) + ": " +
+                order.error + " [" + request.market_slug + "]");
+    }
+    
+    std::optional<CycleStatus> completed;
+    std::optional<Position> presign_for;  // Leg 1 settled or grew: its hedge can be signed
+    if (shard && market) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        if (intent == OrderIntent::ADD) {
+            if (market->dca_order == order.id) market->dca_order = 0;
+            auto& pos = market->position;
+            if (trade && pos) {
+                // Average cost moves with the add; the hedge check sees it next tick
+                pos->shares += Qty::from_double(trade->shares);
+                pos->total_cost += Price::from_double(trade->cost);
+                pos->avg_cost = average_price(pos->total_cost, pos->shares);
+                pos->trades.push_back(*trade);
+                presign_for = pos;
+            } else if (trade) {
+                // Filled after its market was retired: abandoned with the leg
+                book_realized(request.market_slug, -Price::from_double(trade->cost));
+                ledger_.add_exposure(-Price::from_double(trade->cost));
+            }
+        } else if (request.leg == 1) {
+            if (market->entry_order == order.id) market->entry_order = 0;
+            auto& pos = market->position;
+            if (pos && pos->order_id == order.id) {
+                // A hedge working against the armed leg was sized for the
+                // order, not the fill - pull it; the next tick re-hedges
+                // what actually filled
+                const Qty filled = trade ? Qty::from_double(trade->shares) : Qty{};
+                if (market->hedge_order != 0 && filled != pos->shares) orders_.cancel(market->hedge_order);
+                if (trade) {
+                    pos->shares = filled;
+                    pos->avg_cost = Price::from_double(trade->price);
+                    pos->total_cost = Price::from_double(trade->cost);
+                    pos->trades = {*trade};
+                    pos->filled = true;
+                    market->dca = config_.dca_enabled
+                        ? DCAManager(config_.dca_levels, Qty::from_units(config_.shares), config_.dca_multiplier,
+                                     pos->avg_cost)
+                        : DCAManager();
+                    presign_for = pos;
+                } else {
+                    pos.reset();  // Never filled - nothing to hedge
+                }
+            } else if (trade && !market->active) {
+                // Filled after its market was retired: the leg is abandoned
+                book_realized(request.market_slug, -Price::from_double(trade->cost));
+                ledger_.add_exposure(-Price::from_double(trade->cost));
+            }
+        } else {
+            if (market->hedge_order == order.id) market->hedge_order = 0;
+            auto& pos = market->position;
+            if (trade && pos) {
+                Qty remaining = pos->shares - Qty::from_double(trade->shares);
+                if (remaining.positive()) {
+                    // Partial hedge - the rest of leg 1 stays open
+                    pos->total_cost = notional(pos->avg_cost, remaining);
+                    pos->shares = remaining;
+                } else {
+                    CycleStatus cycle;
+                    cycle.active = false;
+                    cycle.status = "complete";
+                    cycle.leg1_side = side_name(pos->side);
+                    cycle.leg1_price = pos->avg_cost.to_double();
+                    cycle.leg1_shares = pos->shares.to_double();
+                    cycle.leg2_side = side_name(trade->side);
+                    cycle.leg2_price = trade->price;
+                    cycle.leg2_shares = trade->shares;
+                    cycle.total_cost = (pos->total_cost + Price::from_double(trade->cost)).to_double();
+                    cycle.pnl = trade->pnl;
+                    record_cycle(*market, cycle);
+                    pos.reset();
+                    market->last_cycle_complete_time = now();
+                    completed = cycle;
+                }
+            }
+        }
+    }
+    mark_dirty();
+    
+    if (request.live && market) {
+        if (presign_for) {
+            presign_hedge(*market, *presign_for);
+        } else if (completed && polymarket_client_) {
+            polymarket_client_->drop_presigned(trade->token_id);
+        }
     }
+    
+    if (trade && !quiet_) {
+        if (trade->leg == 2 && open_position) {
+            log_hedge(*trade, open_position->side, open_position->avg_cost.to_double(), ledger_.realized_pnl(), ledger_.cash());
+        } else {
+            log_entry(*trade, intent == OrderIntent::ADD ? "DCA" : "ENTRY", ledger_.cash());
+        }
+    }
+    if (on_done) on_done(trade);
 }
 
-std::optional<Trade> TradingEngine::execute_paper_trade(
-    const std::string& market_slug,
-    const std::string& side,
-    const std::string& token_id,
-    double shares,
-    double price
-) {
+void TradingEngine::presign_hedge(const MarketState& market, const Position& position) {
+    auto client = polymarket_client_;
+    if (!client || config_.presign_ticks <= 0) return;
+    
+    // Every price the hedge check could accept, from break-even down
+    const std::string& token = position.side == Side::UP ? market.down_token_id : market.up_token_id;
+    Price max_price = Price::from_double(config_.sum_target) - position.avg_cost;
+    if (!max_price.positive()) return;
+    
+    size_t count = client->presign_buys(token, position.shares.to_double(), max_price.to_double(),
+                                        config_.presign_ticks);
+    auto stats = client->presign_stats();
+    POLY_LOG_INFO("LIVE", "Pre-signed {} hedge order(s): {} x{} up to ${:.3f} (hits {}, misses {}) [{}]",
+                  count, side_name(opposite(position.side)), position.shares.to_double(), max_price.to_double(),
+                  stats.hits, stats.misses, market.slug);
+}
+
+Trade TradingEngine::book_fill(const ManagedOrder& order, const std::optional<Position>& open_position, Price reserved) {
+    const OrderRequest& request = order.request;
+    auto now = this->now();
+    
+    // Exchange reports are doubles; the books are kept in fixed point
+    const Qty shares = Qty::from_double(order.filled_shares);
+    const Price price = Price::from_double(order.avg_fill_price);
+    const Price cost = notional(price, shares);
+    std::string fallback_id = std::string(request.live ? "live_" : "paper_") +
+                              std::to_string(now.time_since_epoch().count());
     
     Trade trade{
-        .id = "paper_" + std::to_string(
-            std::chrono::system_clock::now().time_since_epoch().count()
-        ),
-        .market_slug = market_slug,
-        .leg = current_position_ ? 2 : 1,
-        .side = side,
-        .token_id = token_id,
-        .shares = shares,
-        .price = price,
-        .cost = shares * price,
+        .id = order.exchange_id.empty() ? fallback_id : order.exchange_id,
+        .market_slug = request.market_slug,
+        .leg = request.leg,
+        .side = request.side,
+        .token_id = TokenRegistry::instance().name(request.token),
+        .shares = shares.to_double(),
+        .price = price.to_double(),
+        .cost = cost.to_double(),
         .fee = 0.0,
         .pnl = 0.0,
-        .is_live = false,
-        .timestamp = std::chrono::system_clock::now()
+        .is_live = request.live,
+        .timestamp = now
     };
     
+    // If this is leg 2 (hedge), lock in the cycle's PnL - on no more
+    // shares than leg 1 actually filled; any excess is a naked buy
+    Qty paired;
+    if (trade.leg == 2 && open_position && open_position->filled) {
+        paired = std::min(shares, open_position->shares);
+    }
+    Price pnl;
+    if (paired.positive()) {
+        pnl = notional(Price::from_units(1) - open_position->avg_cost - price, paired);
+        trade.pnl = pnl.to_double();
+    }
+    
+    // Settle the reservation against the actual fill
+    ledger_.credit(reserved - cost);
+    if (paired.positive()) {
+        book_realized(request.market_slug, pnl);
+        ledger_.add_exposure(-notional(open_position->avg_cost, paired));
+        ledger_.credit(notional(Price::from_units(1), paired));  // Settlement payout
+        ledger_.add_exposure(notional(price, shares - paired));
+    } else {
+        ledger_.add_exposure(cost);
+    }
+    
+    pnl_.add_fill(trade.market_slug, cost, epoch_ms(now));
+    
     // Store trade in history
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<std::mutex> lock(history_mutex_);
         trade_history_.push_back(trade);
-        
-        // Queue for async database write
-        if (async_writer_) {
-            poly::TradeRecord record{
-                .id = trade.id,
-                .market_slug = trade.market_slug,
-                .leg = trade.leg,
-                .side = trade.side,
-                .token_id = trade.token_id,
-                .shares = trade.shares,
-                .price = trade.price,
-                .cost = trade.cost,
-                .fee = 0.0,
-                .timestamp = std::chrono::duration_cast<std::chrono::seconds>(trade.timestamp.time_since_epoch()).count()
-            };
-            async_writer_->queue_trade(record);
-        }
-        
-        // Update cash balance
-        cash_ -= trade.cost;
-        
-        // If this is leg 2 (hedge), update realized PnL
-        if (trade.leg == 2 && current_position_) {
-            double profit = (1.0 - current_position_->avg_cost - trade.price) * shares;
-            realized_pnl_ += profit;
-            trade.pnl = profit;
-            cash_ += shares; // Settlement payout
-        }
     }
     
+    // Queue for async database write - a copy into the writer's ring
+    if (async_writer_) {
+        async_writer_->queue_trade(PackedTrade::pack(
+            trade.id, trade.market_slug, trade.leg, side_name(trade.side), trade.token_id, trade.shares, trade.price,
+            trade.cost, 0.0,
+            std::chrono::duration_cast<std::chrono::seconds>(trade.timestamp.time_since_epoch()).count()));
+    }
+    
+    if (trade.is_live) {
+        POLY_LOG_INFO("LIVE", "✓ Order filled: {}", trade.id);
+        add_log("info", "LIVE", "Order confirmed: " + trade.id);
+    }
     return trade;
 }
 
-std::optional<Trade> TradingEngine::execute_live_trade(
-    const std::string& market_slug,
-    const std::string& side,
-    const std::string& token_id,
-    double shares,
-    double price
-) {
-    if (!polymarket_client_) {
-        std::cerr << "[LIVE] ✗ No Polymarket client configured!" << std::endl;
-        add_log("error", "LIVE", "No Polymarket client configured");
-        return std::nullopt;
-    }
+OrderResult TradingEngine::send_order(const OrderRequest& request) {
+    if (request.live) return send_live_order(request);
     
-    std::cout << "[LIVE] 🔴 Executing LIVE trade: " << side << " " << shares << " @ $" << price << std::endl;
-    add_log("warn", "LIVE", "Executing LIVE order: " + side + " x" + std::to_string((int)shares) + " @ $" + std::to_string(price));
+    stamp_submit(request);
+    return send_paper_order(request);
+}
+
+OrderResult TradingEngine::send_paper_order(const OrderRequest& request) {
+    OrderResult result;
+    result.success = true;
+    result.order_id = "paper_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    result.status = "matched";
+    result.filled_amount = request.shares;
+    result.price = request.price;
     
-    // Place order via Polymarket API
-    auto result = polymarket_client_->place_order(token_id, side == "UP" ? "BUY" : "BUY", shares, price);
+    // No book to walk (or depth fills off): in full at the limit
+    std::shared_ptr<MarketState> market;
+    Shard* shard = config_.paper_depth_fill ? find_market(request.market_slug, market) : nullptr;
+    if (!shard) return result;
     
-    if (!result.success) {
-        std::cerr << "[LIVE] ✗ Order failed: " << result.error << std::endl;
-        add_log("error", "LIVE", "Order failed: " + result.error);
-        return std::nullopt;
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    bool up = request.token == market->up_token;
+    if (config_.paper_latency_ms > 0) {
+        // Rests until the book has moved on by the latency, then fills as it
+        // stands (collect_paper_fills)
+        market->paper_orders.push_back(MarketState::PaperOrder{
+            .exchange_id = result.order_id,
+            .up = up,
+            .shares = Qty::from_double(request.shares),
+            .limit = Price::from_double(request.price),
+            .due = now() + std::chrono::milliseconds(config_.paper_latency_ms)
+        });
+        result.status = "live";
+        result.filled_amount = 0.0;
+        return result;
     }
     
-    Trade trade{
-        .id = result.order_id.empty() ? ("live_" + std::to_string(
-            std::chrono::system_clock::now().time_since_epoch().count()
-        )) : result.order_id,
-        .market_slug = market_slug,
-        .leg = current_position_ ? 2 : 1,
-        .side = side,
-        .token_id = token_id,
-        .shares = shares,
-        .price = result.price > 0 ? result.price : price,
-        .cost = shares * (result.price > 0 ? result.price : price),
-        .fee = 0.0,
-        .pnl = 0.0,
-        .is_live = true,
-        .timestamp = std::chrono::system_clock::now()
-    };
-    
-    // Store trade in history
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        trade_history_.push_back(trade);
-        
-        // Queue for async database write
-        if (async_writer_) {
-            poly::TradeRecord record{
-                .id = trade.id,
-                .market_slug = trade.market_slug,
-                .leg = trade.leg,
-                .side = trade.side,
-                .token_id = trade.token_id,
-                .shares = trade.shares,
-                .price = trade.price,
-                .cost = trade.cost,
-                .fee = 0.0,
-                .timestamp = std::chrono::duration_cast<std::chrono::seconds>(trade.timestamp.time_since_epoch()).count()
-            };
-            async_writer_->queue_trade(record);
-        }
-        
-        // Update cash balance (will be synced from Polymarket later)
-        cash_ -= trade.cost;
-        
-        // If this is leg 2 (hedge), update realized PnL
-        if (trade.leg == 2 && current_position_) {
-            double profit = (1.0 - current_position_->avg_cost - trade.price) * shares;
-            realized_pnl_ += profit;
-            trade.pnl = profit;
-            cash_ += shares; // Settlement payout
+    const Qty shares = Qty::from_double(request.shares);
+    const Price limit = Price::from_double(request.price);
+    SimulatedFill fill = up ? simulate_buy(market->up_view(), shares, limit, config_.paper_queue_ahead)
+                            : simulate_buy(market->down_view(), shares, limit, config_.paper_queue_ahead);
+    if (fill.shares < shares) result.status = "killed";
+    result.filled_amount = fill.shares.to_double();
+    result.price = fill.shares.positive() ? fill.vwap().to_double() : request.price;
+    return result;
+}
+
+void TradingEngine::collect_paper_fills(MarketState& market, std::vector<PaperFill>& out) {
+    if (market.paper_orders.empty()) return;
+    auto now = this->now();
+    auto& pending = market.paper_orders;
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it->due > now) {
+            ++it;
+            continue;
         }
+        SimulatedFill fill = it->up ? simulate_buy(market.up_view(), it->shares, it->limit, config_.paper_queue_ahead)
+                                    : simulate_buy(market.down_view(), it->shares, it->limit, config_.paper_queue_ahead);
+        out.push_back(PaperFill{it->exchange_id, it->shares.to_double(), fill.shares.to_double(), fill.vwap().to_double()});
+        it = pending.erase(it);
     }
-    
-    std::cout << "[LIVE] ✓ Order placed: " << trade.id << std::endl;
-    add_log("info", "LIVE", "Order confirmed: " + trade.id);
-    return trade;
 }
 
-double TradingEngine::get_best_bid(const OrderbookSnapshot& book) const {
-    if (book.bids.empty()) return 0.0;
-    // Best bid is the HIGHEST price in the bids (buyers want highest to fill first)
-    double max_bid = book.bids[0].first;
-    for (const auto& level : book.bids) {
-        if (level.first > max_bid) max_bid = level.first;
+void TradingEngine::report_paper_fills(const std::vector<PaperFill>& fills) {
+    // The same path as exchange reports: one execution, then the rest killed
+    for (const auto& fill : fills) {
+        if (fill.shares > 0) orders_.on_exchange_trade(fill.exchange_id, fill.exchange_id + "_fill", fill.shares, fill.price);
+        if (fill.shares < fill.ordered - 1e-9) orders_.on_exchange_cancel(fill.exchange_id);
     }
-    return max_bid;
 }
 
-double TradingEngine::get_best_ask(const OrderbookSnapshot& book) const {
-    if (book.asks.empty()) return 1.0;
-    // Best ask is the LOWEST price in the asks (sellers want lowest to fill first)
-    double min_ask = book.asks[0].first;
-    for (const auto& level : book.asks) {
-        if (level.first < min_ask) min_ask = level.first;
+OrderResult TradingEngine::send_live_order(const OrderRequest& request) {
+    if (!polymarket_client_) {
+        POLY_LOG_ERROR("LIVE", "✗ No Polymarket client configured!");
+        add_log("error", "LIVE", "No Polymarket client configured");
+        OrderResult result;
+        result.error = "No Polymarket client configured";
+        return result;
+    }
+    
+    POLY_LOG_WARN("LIVE", "🔴 Executing LIVE trade: {} {} @ ${}", side_name(request.side), request.shares, request.price);
+    add_log("warn", "LIVE", std::string("Executing LIVE order: ") + side_name(request.side) + " x" + std::to_string((int)request.shares) +
+            " @ $" + std::to_string(request.price));
+    
+    // Place order via Polymarket API
+    uint64_t submit_ns = stamp_submit(request);
+    auto result = polymarket_client_->place_order(TokenRegistry::instance().name(request.token), "BUY",
+                                                  request.shares, request.price);
+    uint64_t ack_ns = latency::now_ns();
+    LatencyMonitor::instance().record(latency::Span::SUBMIT_TO_ACK, submit_ns, ack_ns);
+    LatencyMonitor::instance().record(latency::Span::TICK_TO_ACK, request.frame_ns, ack_ns);
+    
+    if (!result.success) {
+        add_log("error", "LIVE", "Order failed: " + result.error);
     }
-    return min_ask;
+    return result;
 }
 
 // Config setters
@@ -618,31 +1754,47 @@ void TradingEngine::set_entry_threshold(double value) {
     std::lock_guard<std::mutex> lock(mutex_);
     config_.move = value;
     config_.entry_threshold = value;
-    std::cout << "[CONFIG] Entry threshold set to $" << std::fixed << std::setprecision(2) << value << std::endl;
+    rebuild_strategy();
+    mark_dirty();
+    POLY_LOG_INFO("CONFIG", "Entry threshold set to ${:.2f}", value);
 }
 
 void TradingEngine::set_shares(int value) {
     std::lock_guard<std::mutex> lock(mutex_);
     config_.shares = value;
-    std::cout << "[CONFIG] Shares set to " << value << std::endl;
+    rebuild_strategy();
+    mark_dirty();
+    POLY_LOG_INFO("CONFIG", "Shares set to {}", value);
 }
 
 void TradingEngine::set_sum_target(double value) {
     std::lock_guard<std::mutex> lock(mutex_);
     config_.sum_target = value;
-    std::cout << "[CONFIG] Sum target set to $" << std::fixed << std::setprecision(2) << value << std::endl;
+    rebuild_strategy();
+    mark_dirty();
+    POLY_LOG_INFO("CONFIG", "Sum target set to ${:.2f}", value);
 }
 
 void TradingEngine::set_dca_enabled(bool value) {
     std::lock_guard<std::mutex> lock(mutex_);
     config_.dca_enabled = value;
-    std::cout << "[CONFIG] DCA " << (value ? "ENABLED" : "DISABLED") << std::endl;
+    rebuild_strategy();
+    mark_dirty();
+    POLY_LOG_INFO("CONFIG", "DCA {}", value ? "ENABLED" : "DISABLED");
 }
 
 void TradingEngine::set_trading_window(int seconds) {
     std::lock_guard<std::mutex> lock(mutex_);
     config_.dump_window_sec = seconds;
-    std::cout << "[CONFIG] Trading window set to " << seconds << "s" << std::endl;
+    rebuild_strategy();
+    mark_dirty();
+    POLY_LOG_INFO("CONFIG", "Trading window set to {}s", seconds);
+}
+
+void TradingEngine::rebuild_strategy() {
+    auto strategy = make_strategy(config_, trading_mode_ == TradingMode::LIVE);
+    POLY_LOG_DEBUG("ENGINE", "Strategy: {}", strategy->name());
+    std::atomic_store(&strategy_, std::move(strategy));
 }
 
 Config TradingEngine::get_config() const {
@@ -664,40 +1816,41 @@ bool TradingEngine::set_trading_mode(TradingMode mode) {
         // Check if live trading is available
         const char* pk = std::getenv("POLYMARKET_PRIVATE_KEY");
         if (!pk || std::strlen(pk) == 0) {
-            std::cerr << "[MODE] Cannot enable LIVE trading: No private key configured" << std::endl;
+            POLY_LOG_ERROR("MODE", "Cannot enable LIVE trading: No private key configured");
             add_log("error", "MODE", "Cannot enable LIVE trading: No private key configured");
             return false;
         }
         
         trading_mode_ = TradingMode::LIVE;
-        std::cout << "[MODE] 🔴 LIVE TRADING ENABLED - Real money trades!" << std::endl;
+        rebuild_strategy();
+        POLY_LOG_WARN("MODE", "🔴 LIVE TRADING ENABLED - Real money trades!");
         add_log("warn", "MODE", "🔴 LIVE TRADING ENABLED - Real money trades!");
         
         // Refresh balance from Polymarket
         if (polymarket_client_) {
             auto balance = polymarket_client_->get_balance();
             if (balance.success) {
-                cash_ = balance.balance;
-                std::cout << "[MODE] Balance synced: $" << cash_ << " USDC" << std::endl;
-                add_log("info", "MODE", "Balance synced: $" + std::to_string(cash_) + " USDC");
+                ledger_.set_cash(balance.balance);
+                POLY_LOG_INFO("MODE", "Balance synced: ${} USDC", balance.balance);
+                add_log("info", "MODE", "Balance synced: $" + std::to_string(balance.balance) + " USDC");
             }
         }
     } else {
         trading_mode_ = TradingMode::PAPER;
-        std::cout << "[MODE] 📝 Paper trading mode enabled" << std::endl;
+        rebuild_strategy();
+        POLY_LOG_INFO("MODE", "📝 Paper trading mode enabled");
         add_log("info", "MODE", "📝 Paper trading mode enabled");
     }
+    mark_dirty();
     
     return true;
 }
 
 TradingMode TradingEngine::get_trading_mode() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return trading_mode_;
 }
 
 std::string TradingEngine::get_trading_mode_string() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return (trading_mode_ == TradingMode::LIVE) ? "LIVE" : "PAPER";
 }
 
@@ -709,32 +1862,34 @@ bool TradingEngine::is_live_trading_available() const {
 void TradingEngine::set_polymarket_client(std::shared_ptr<PolymarketClient> client) {
     std::lock_guard<std::mutex> lock(mutex_);
     polymarket_client_ = client;
-    std::cout << "[ENGINE] Polymarket client configured" << std::endl;
+    has_client_ = client != nullptr;
+    POLY_LOG_INFO("ENGINE", "Polymarket client configured");
 }
 
 void TradingEngine::refresh_balance() {
     std::lock_guard<std::mutex> lock(mutex_);
     
     if (!polymarket_client_) {
-        std::cerr << "[ENGINE] Cannot refresh balance: No Polymarket client" << std::endl;
+        POLY_LOG_WARN("ENGINE", "Cannot refresh balance: No Polymarket client");
         return;
     }
     
     auto balance = polymarket_client_->get_balance();
     if (balance.success) {
-        cash_ = balance.balance;
-        std::cout << "[ENGINE] Balance refreshed: $" << cash_ << " USDC" << std::endl;
-        add_log("info", "WALLET", "Balance: $" + std::to_string(cash_) + " USDC");
+        ledger_.set_cash(balance.balance);
+        mark_dirty();
+        POLY_LOG_INFO("ENGINE", "Balance refreshed: ${} USDC", balance.balance);
+        add_log("info", "WALLET", "Balance: $" + std::to_string(balance.balance) + " USDC");
     } else {
-        std::cerr << "[ENGINE] Failed to refresh balance: " << balance.error << std::endl;
+        POLY_LOG_ERROR("ENGINE", "Failed to refresh balance: {}", balance.error);
         add_log("error", "WALLET", "Failed to refresh balance: " + balance.error);
     }
 }
 
 void TradingEngine::set_cash(double amount) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    cash_ = amount;
-    std::cout << "[ENGINE] Cash set to $" << amount << std::endl;
+    ledger_.set_cash(amount);
+    mark_dirty();
+    POLY_LOG_INFO("ENGINE", "Cash set to ${}", amount);
 }
 
 void TradingEngine::reset_paper_trading() {
@@ -742,16 +1897,350 @@ void TradingEngine::reset_paper_trading() {
     
     // Reset to paper mode
     trading_mode_ = TradingMode::PAPER;
+    rebuild_strategy();
     
     // Reset portfolio
-    cash_ = 1000.0;
-    realized_pnl_ = 0.0;
-    current_position_.reset();
+    ledger_.reset(1000.0);
+    pnl_.reset();
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
+        for (auto& [slug, market] : shard->markets) {
+            market->position.reset();
+            market->last_cycle = CycleStatus{};
+        }
+    }
+    std::lock_guard<std::mutex> history_lock(history_mutex_);
     trade_history_.clear();
     last_completed_cycle_ = CycleStatus{};
+    mark_dirty();
     
-    std::cout << "[ENGINE] Paper trading reset - Cash: $1000" << std::endl;
+    POLY_LOG_INFO("ENGINE", "Paper trading reset - Cash: $1000");
     add_log("info", "ENGINE", "Paper trading reset - starting fresh with $1000");
 }
 
+bool TradingEngine::checkpoint(std::vector<uint8_t>& out, uint64_t& version) const {
+    const uint64_t current = state_version_.load(std::memory_order_acquire);
+    if (current == version) return false;
+    
+    out.clear();
+    SnapshotWriter w(out);
+    w.u32(kSnapshotVersion);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        w.str(config_bytes(launch_config_));
+        w.str(config_bytes(config_));
+    }
+    w.i64(ledger_.cash_micros());
+    w.i64(ledger_.realized_micros());
+    w.i64(ledger_.exposure_micros());
+    w.u64(cycles_completed_.load(std::memory_order_relaxed));
+    w.u64(cycles_abandoned_.load(std::memory_order_relaxed));
+    
+    // Market count patched in once every shard was walked
+    const size_t count_at = out.size();
+    w.u32(0);
+    uint32_t markets = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
+        for (const auto& [slug, market] : shard->markets) {
+            ++markets;
+            w.str(slug);
+            w.str(market->up_token_id);
+            w.str(market->down_token_id);
+            w.boolean(market->primary);
+            w.boolean(market->active);
+            encode_cycle(w, market->last_cycle);
+            w.i64(epoch_ms(market->last_cycle_complete_time));
+            
+            w.boolean(market->position.has_value());
+            if (market->position) {
+                const Position& pos = *market->position;
+                w.u8(static_cast<uint8_t>(pos.side));
+                w.qty(pos.shares);
+                w.price(pos.avg_cost);
+                w.price(pos.total_cost);
+                w.boolean(pos.filled);
+                w.boolean(pos.order_id != 0 && pos.order_id == market->entry_order);
+                w.u32(static_cast<uint32_t>(pos.trades.size()));
+                for (const auto& trade : pos.trades) encode_trade(w, trade);
+            }
+            
+            encode_levels(w, market->up_book, BookSide::BID);
+            encode_levels(w, market->up_book, BookSide::ASK);
+            encode_levels(w, market->down_book, BookSide::BID);
+            encode_levels(w, market->down_book, BookSide::ASK);
+            
+            // Orders in flight, as the order manager has them now
+            std::vector<std::pair<OrderIntent, ManagedOrder>> orders;
+            for (auto [intent, id] : {std::pair{OrderIntent::ENTRY, market->entry_order},
+                                      std::pair{OrderIntent::HEDGE, market->hedge_order},
+                                      std::pair{OrderIntent::ADD, market->dca_order}}) {
+                if (id == 0) continue;
+                if (auto order = orders_.find(id)) orders.emplace_back(intent, std::move(*order));
+            }
+            w.u32(static_cast<uint32_t>(orders.size()));
+            for (const auto& [intent, order] : orders) {
+                w.u8(static_cast<uint8_t>(intent));
+                w.str(order.exchange_id);
+                w.u8(static_cast<uint8_t>(order.state));
+                w.boolean(order.request.live);
+                w.i64(order.request.leg);
+                w.u8(static_cast<uint8_t>(order.request.side));
+                w.str(TokenRegistry::instance().name(order.request.token));
+                w.f64(order.request.shares);
+                w.f64(order.request.price);
+                w.f64(order.filled_shares);
+                w.f64(order.avg_fill_price);
+            }
+        }
+    }
+    std::memcpy(out.data() + count_at, &markets, sizeof(markets));
+    
+    {
+        std::lock_guard<std::mutex> lock(history_mutex_);
+        encode_cycle(w, last_completed_cycle_);
+        const size_t n = std::min(trade_history_.size(), kSnapshotTrades);
+        w.u32(static_cast<uint32_t>(n));
+        for (size_t i = trade_history_.size() - n; i < trade_history_.size(); ++i) encode_trade(w, trade_history_[i]);
+    }
+    version = current;
+    return true;
+}
+
+bool TradingEngine::restore(const std::vector<uint8_t>& payload, int64_t written_ms, RestoreReport& report,
+                            std::string& error) {
+    struct SavedOrder {
+        OrderIntent intent = OrderIntent::ENTRY;
+        ManagedOrder order;
+    };
+    struct SavedMarket {
+        std::string slug;
+        std::string up_token_id;
+        std::string down_token_id;
+        bool primary = false;
+        bool active = false;
+        CycleStatus last_cycle;
+        int64_t last_cycle_complete_ms = 0;
+        std::optional<Position> position;
+        bool position_on_entry = false;  // Its leg 1 order is among `orders`
+        std::vector<BookLevel> up_bids, up_asks, down_bids, down_asks;
+        std::vector<SavedOrder> orders;
+    };
+    
+    // Decode everything first: a bad checkpoint changes nothing
+    SnapshotReader r(payload.data(), payload.size());
+    if (r.u32() != kSnapshotVersion) {
+        error = "unknown snapshot version";
+        return false;
+    }
+    const std::string launch = r.str();
+    const std::string saved_config = r.str();
+    const Price cash = r.price();
+    const Price realized = r.price();
+    const Price exposure = r.price();
+    const uint64_t completed = r.u64();
+    const uint64_t abandoned = r.u64();
+    
+    std::vector<SavedMarket> markets(std::min<uint32_t>(r.u32(), 1 << 16));
+    for (auto& saved : markets) {
+        if (!r.ok()) break;
+        saved.slug = r.str();
+        saved.up_token_id = r.str();
+        saved.down_token_id = r.str();
+        saved.primary = r.boolean();
+        saved.active = r.boolean();
+        saved.last_cycle = decode_cycle(r);
+        saved.last_cycle_complete_ms = r.i64();
+        if (r.boolean()) {
+            Position pos;
+            pos.market_slug = saved.slug;
+            pos.side = r.u8() == static_cast<uint8_t>(Side::DOWN) ? Side::DOWN : Side::UP;
+            pos.shares = r.qty();
+            pos.avg_cost = r.price();
+            pos.total_cost = r.price();
+            pos.filled = r.boolean();
+            saved.position_on_entry = r.boolean();
+            pos.trades.resize(std::min<uint32_t>(r.u32(), 1024));
+            for (auto& trade : pos.trades) trade = decode_trade(r);
+            saved.position = std::move(pos);
+        }
+        saved.up_bids = decode_levels(r);
+        saved.up_asks = decode_levels(r);
+        saved.down_bids = decode_levels(r);
+        saved.down_asks = decode_levels(r);
+        saved.orders.resize(std::min<uint32_t>(r.u32(), 3));
+        for (auto& [intent, order] : saved.orders) {
+            const uint8_t kind = r.u8();
+            intent = kind == static_cast<uint8_t>(OrderIntent::HEDGE) ? OrderIntent::HEDGE
+                   : kind == static_cast<uint8_t>(OrderIntent::ADD) ? OrderIntent::ADD : OrderIntent::ENTRY;
+            order.exchange_id = r.str();
+            order.state = static_cast<OrderState>(std::min<uint8_t>(r.u8(), static_cast<uint8_t>(OrderState::REJECTED)));
+            order.request.market_slug = saved.slug;
+            order.request.live = r.boolean();
+            order.request.leg = static_cast<int>(r.i64());
+            order.request.side = r.u8() == static_cast<uint8_t>(Side::DOWN) ? Side::DOWN : Side::UP;
+            order.request.token = TokenRegistry::instance().intern(r.str());
+            order.request.shares = r.f64();
+            order.request.price = r.f64();
+            order.filled_shares = r.f64();
+            order.avg_fill_price = r.f64();
+        }
+    }
+    const CycleStatus last_completed = decode_cycle(r);
+    std::vector<Trade> trades(std::min<uint32_t>(r.u32(), kSnapshotTrades));
+    for (auto& trade : trades) trade = decode_trade(r);
+    
+    std::optional<Config> config;
+    if (r.ok() && launch == config_bytes(launch_config_)) {
+        SnapshotReader config_reader(reinterpret_cast<const uint8_t*>(saved_config.data()), saved_config.size());
+        config = decode_config(config_reader);
+        if (!config_reader.ok() || !config_reader.done()) config.reset();
+    }
+    if (!r.ok() || !r.done()) {
+        error = "truncated or malformed snapshot";
+        return false;
+    }
+    
+    report = RestoreReport{};
+    report.age_ms = epoch_ms(std::chrono::system_clock::now()) - written_ms;
+    
+    // Settings changed at runtime (API) survive a restart launched the same way
+    if (config) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = *config;
+        rebuild_strategy();
+        report.config_restored = true;
+    }
+    ledger_.restore(cash, realized, exposure);
+    cycles_completed_.store(completed, std::memory_order_relaxed);
+    cycles_abandoned_.store(abandoned, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(history_mutex_);
+        trade_history_ = std::move(trades);
+        last_completed_cycle_ = last_completed;
+    }
+    
+    // The dashboard's series first, so it is primary again, and a series'
+    // active market before its staged one (activating retires the others)
+    std::stable_sort(markets.begin(), markets.end(), [](const SavedMarket& a, const SavedMarket& b) {
+        return std::make_pair(a.primary, a.active) > std::make_pair(b.primary, b.active);
+    });
+    const int64_t now_sec = std::chrono::duration_cast<std::chrono::seconds>(now().time_since_epoch()).count();
+    for (auto& saved : markets) {
+        stage_market(saved.slug, saved.up_token_id, saved.down_token_id);
+        if (saved.active) activate_market(saved.slug);
+        std::shared_ptr<MarketState> market;
+        Shard* shard = find_market(saved.slug, market);
+        if (!shard) continue;
+        report.markets++;
+        
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            market->last_cycle = saved.last_cycle;
+            market->last_cycle_complete_time = from_epoch_ms(saved.last_cycle_complete_ms);
+            market->position = saved.position;
+            if (market->position) {
+                // Re-pointed at the adopted entry below; a pre-armed leg
+                // whose order didn't survive never filled
+                market->position->order_id = 0;
+                if (!market->position->filled && !saved.position_on_entry) market->position.reset();
+            }
+            // No DCA ladder: adds already bought aren't known, so none are
+            // made for the rest of the cycle
+            
+            // The last books, for the dashboard and paper fills - left
+            // unsynced, so nothing trades on them until the feed's first
+            // book (or a REST snapshot) confirms them
+            market->up_book.apply_snapshot(saved.up_bids, saved.up_asks);
+            market->down_book.apply_snapshot(saved.down_bids, saved.down_asks);
+            market->up_sync.synced = market->down_sync.synced = false;
+        }
+        
+        // Live orders still working are taken back; the rest are gone with
+        // the old process and their reservation goes back to cash
+        for (auto& [intent, order] : saved.orders) {
+            const Price reserved = notional(Price::from_double(order.request.price),
+                                            Qty::from_double(order.request.shares));
+            std::optional<Position> open_position;
+            if (intent != OrderIntent::ENTRY) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                open_position = market->position;
+            }
+            uint64_t id = 0;
+            if (order.request.live) {
+                const OrderIntent kind = intent;
+                id = orders_.adopt(order, [this, shard, market, kind, open_position, reserved](const ManagedOrder& o) {
+                    on_order_update(shard, market, kind, open_position, reserved, nullptr, o);
+                });
+            }
+            
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            auto& pos = market->position;
+            if (id == 0) {
+                ledger_.credit(reserved);
+                if (intent == OrderIntent::ENTRY && pos && !pos->filled) pos.reset();
+                report.orders_dropped++;
+                continue;
+            }
+            switch (intent) {
+                case OrderIntent::ENTRY:
+                    market->entry_order = id;
+                    if (pos && !pos->filled) pos->order_id = id;
+                    break;
+                case OrderIntent::ADD: market->dca_order = id; break;
+                case OrderIntent::HEDGE: market->hedge_order = id; break;
+            }
+            report.orders_adopted++;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            if (market->position) report.positions++;
+        }
+        
+        // Its window ended while we were down: abandoned as usual
+        if (market->window_start > 0 && market->window_start + market->period_sec <= now_sec) {
+            retire_market(saved.slug);
+            report.markets_expired++;
+        }
+    }
+    mark_dirty();
+    
+    POLY_LOG_INFO("ENGINE", "Restored {} market(s), {} position(s), {} order(s) adopted, {} dropped, {} expired "
+                  "(checkpoint {}ms old)", report.markets, report.positions, report.orders_adopted,
+                  report.orders_dropped, report.markets_expired, report.age_ms);
+    return true;
+}
+
+void TradingEngine::reconcile_orders() {
+    std::shared_ptr<PolymarketClient> client;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        client = polymarket_client_;
+    }
+    if (!client) return;
+    
+    size_t checked = 0;
+    size_t moved = 0;
+    for (const auto& order : orders_.open_orders()) {
+        if (!order.request.live || order.exchange_id.empty()) continue;
+        auto state = client->get_order(order.exchange_id);
+        if (!state.success) {
+            POLY_LOG_WARN("ENGINE", "Order {} not reconciled: {}", order.exchange_id, state.error);
+            continue;
+        }
+        ++checked;
+        // Cumulative, priced at the limit (the order manager keeps the larger total)
+        if (state.filled_amount > order.filled_shares) {
+            orders_.on_exchange_fill(order.exchange_id, state.filled_amount, 0.0);
+            ++moved;
+        }
+        if (state.status.rfind("CANCELED", 0) == 0 || state.status == "INVALID") {
+            orders_.on_exchange_cancel(order.exchange_id);
+            ++moved;
+        }
+    }
+    if (checked > 0) POLY_LOG_INFO("ENGINE", "Reconciled {} live order(s) with the exchange ({} moved)", checked, moved);
+}
+
 } // namespace poly
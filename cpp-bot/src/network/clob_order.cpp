@@ -0,0 +1,185 @@
+#include "clob_order.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace poly {
+
+namespace {
+    constexpr const char* kDomainType =
+        "EIP712Domain(string name,string version,uint256 chainId,address verifyingContract)";
+    constexpr const char* kOrderType =
+        "Order(uint256 salt,address maker,address signer,address taker,uint256 tokenId,"
+        "uint256 makerAmount,uint256 takerAmount,uint256 expiration,uint256 nonce,"
+        "uint256 feeRateBps,uint8 side,uint8 signatureType)";
+    constexpr const char* kDomainName = "Polymarket CTF Exchange";
+    constexpr const char* kDomainVersion = "1";
+
+    // ABI encoding: every field is one 32-byte word
+    void put_uint(uint8_t* word, uint64_t value) {
+        std::memset(word, 0, 32);
+        for (int i = 0; i < 8; ++i) word[31 - i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    bool put_decimal(uint8_t* word, const std::string& value) {
+        return crypto::uint256_from_decimal(value, word);
+    }
+
+    bool put_address(uint8_t* word, const std::string& address) {
+        std::vector<uint8_t> bytes;
+        if (!crypto::from_hex(address, bytes) || bytes.size() != 20) return false;
+        std::memset(word, 0, 12);
+        std::memcpy(word + 12, bytes.data(), 20);
+        return true;
+    }
+
+    void put_hash(uint8_t* word, const crypto::Hash256& h) {
+        std::memcpy(word, h.data(), 32);
+    }
+
+    crypto::Hash256 domain_separator(int chain_id, const char* exchange) {
+        uint8_t buf[5 * 32];
+        put_hash(buf, crypto::keccak256(kDomainType));
+        put_hash(buf + 32, crypto::keccak256(kDomainName));
+        put_hash(buf + 64, crypto::keccak256(kDomainVersion));
+        put_uint(buf + 96, static_cast<uint64_t>(chain_id));
+        put_address(buf + 128, exchange);
+        return crypto::keccak256(buf, sizeof(buf));
+    }
+
+    uint64_t generate_salt() {
+        // Same range as py-clob-client (timestamp scaled by a random factor)
+        static thread_local std::mt19937_64 rng(std::random_device{}());
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        uint64_t secs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+        return std::uniform_int_distribution<uint64_t>(1, secs)(rng);
+    }
+}
+
+nlohmann::json ClobOrder::to_json() const {
+    return {
+        {"salt", salt},
+        {"maker", maker},
+        {"signer", signer},
+        {"taker", taker},
+        {"tokenId", token_id},
+        {"makerAmount", maker_amount},
+        {"takerAmount", taker_amount},
+        {"expiration", expiration},
+        {"nonce", nonce},
+        {"feeRateBps", fee_rate_bps},
+        {"side", side == 0 ? "BUY" : "SELL"},
+        {"signatureType", signature_type},
+        {"signature", signature}
+    };
+}
+
+ClobOrderBuilder::ClobOrderBuilder(const crypto::Secp256k1Signer& signer, int chain_id)
+    : signer_(signer)
+    , domain_separator_(domain_separator(chain_id, kCtfExchangeAddress))
+    , neg_risk_domain_separator_(domain_separator(chain_id, kNegRiskCtfExchangeAddress)) {
+}
+
+void ClobOrderBuilder::quantize(double size, double price, double tick_size, int64_t& size_cents,
+                                int64_t& price_ticks) {
+    price_ticks = std::llround(price * std::llround(1.0 / tick_size));
+    size_cents = static_cast<int64_t>(std::floor(size * 100.0 + 1e-9));
+}
+
+bool ClobOrderBuilder::build(
+    const std::string& token_id,
+    const std::string& side,
+    double size,
+    double price,
+    const ClobMarketParams& params,
+    ClobOrder& out,
+    std::string& error
+) const {
+    if (!signer_.loaded()) {
+        error = "Signing key not loaded";
+        return false;
+    }
+    if (side != "BUY" && side != "SELL") {
+        error = "Invalid side: " + side;
+        return false;
+    }
+    if (!(params.tick_size > 0.0) || params.tick_size >= 1.0) {
+        error = "Invalid tick size";
+        return false;
+    }
+
+    // Integer arithmetic throughout: shares in 0.01 units, price in ticks.
+    // One share = 1e6 base units, so all amounts come out exact.
+    const int64_t ticks_per_unit = std::llround(1.0 / params.tick_size);
+    int64_t size_cents = 0;
+    int64_t price_ticks = 0;
+    quantize(size, price, params.tick_size, size_cents, price_ticks);
+
+    if (price_ticks < 1 || price_ticks > ticks_per_unit - 1) {
+        error = "Price outside (tick, 1 - tick): " + std::to_string(price);
+        return false;
+    }
+    if (size_cents <= 0) {
+        error = "Size rounds to zero: " + std::to_string(size);
+        return false;
+    }
+
+    const int64_t shares_units = size_cents * 10000;
+    const int64_t usdc_units = size_cents * price_ticks * (1000000 / (100 * ticks_per_unit));
+
+    out = ClobOrder{};
+    out.salt = generate_salt();
+    out.maker = signer_.address();
+    out.signer = signer_.address();
+    out.token_id = token_id;
+    out.fee_rate_bps = std::to_string(params.fee_rate_bps);
+    if (side == "BUY") {
+        out.side = 0;
+        out.maker_amount = std::to_string(usdc_units);
+        out.taker_amount = std::to_string(shares_units);
+    } else {
+        out.side = 1;
+        out.maker_amount = std::to_string(shares_units);
+        out.taker_amount = std::to_string(usdc_units);
+    }
+
+    crypto::Hash256 digest = order_digest(out, params.neg_risk);
+    std::array<uint8_t, 65> sig;
+    if (!signer_.sign_digest(digest, sig)) {
+        error = "Signing failed";
+        return false;
+    }
+    out.signature = crypto::to_hex(sig.data(), sig.size());
+    return true;
+}
+
+crypto::Hash256 ClobOrderBuilder::order_digest(const ClobOrder& order, bool neg_risk) const {
+    static const crypto::Hash256 order_typehash = crypto::keccak256(kOrderType);
+
+    uint8_t fields[13 * 32];
+    put_hash(fields, order_typehash);
+    put_uint(fields + 32, order.salt);
+    put_address(fields + 64, order.maker);
+    put_address(fields + 96, order.signer);
+    put_address(fields + 128, order.taker);
+    put_decimal(fields + 160, order.token_id);
+    put_decimal(fields + 192, order.maker_amount);
+    put_decimal(fields + 224, order.taker_amount);
+    put_decimal(fields + 256, order.expiration);
+    put_decimal(fields + 288, order.nonce);
+    put_decimal(fields + 320, order.fee_rate_bps);
+    put_uint(fields + 352, order.side);
+    put_uint(fields + 384, order.signature_type);
+    crypto::Hash256 struct_hash = crypto::keccak256(fields, sizeof(fields));
+
+    // "\x19\x01" || domainSeparator || hashStruct(order)
+    uint8_t message[2 + 32 + 32];
+    message[0] = 0x19;
+    message[1] = 0x01;
+    put_hash(message + 2, neg_risk ? neg_risk_domain_separator_ : domain_separator_);
+    put_hash(message + 34, struct_hash);
+    return crypto::keccak256(message, sizeof(message));
+}
+
+} // namespace poly
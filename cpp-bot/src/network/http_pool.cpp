@@ -0,0 +1,226 @@
+#include "http_pool.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace poly {
+
+namespace {
+    size_t write_body(void* contents, size_t size, size_t nmemb, std::string* out) {
+        out->append(static_cast<char*>(contents), size * nmemb);
+        return size * nmemb;
+    }
+
+    std::string host_of(const std::string& url) {
+        size_t start = url.find("://");
+        start = (start == std::string::npos) ? 0 : start + 3;
+        size_t end = url.find_first_of("/?", start);
+        return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    }
+}
+
+HttpPool& HttpPool::instance() {
+    static HttpPool pool;
+    return pool;
+}
+
+HttpPool::HttpPool() {
+    share_ = curl_share_init();
+    if (share_) {
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &HttpPool::lock_share);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &HttpPool::unlock_share);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    }
+}
+
+HttpPool::~HttpPool() {
+    stop();
+    if (share_) curl_share_cleanup(share_);
+}
+
+void HttpPool::lock_share(CURL*, curl_lock_data data, curl_lock_access, void* user) {
+    static_cast<HttpPool*>(user)->share_locks_[data].lock();
+}
+
+void HttpPool::unlock_share(CURL*, curl_lock_data data, void* user) {
+    static_cast<HttpPool*>(user)->share_locks_[data].unlock();
+}
+
+CURL* HttpPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(handles_mutex_);
+        if (!idle_.empty()) {
+            CURL* handle = idle_.back();
+            idle_.pop_back();
+            return handle;
+        }
+    }
+    return curl_easy_init();
+}
+
+void HttpPool::release(CURL* handle) {
+    // Options are per request; the connection cache lives in the share
+    curl_easy_reset(handle);
+    std::lock_guard<std::mutex> lock(handles_mutex_);
+    idle_.push_back(handle);
+}
+
+HttpPool::Response HttpPool::request(
+    const std::string& method,
+    const std::string& url,
+    const std::string& body,
+    const std::vector<std::string>& headers,
+    long timeout_ms
+) {
+    Response response;
+    CURL* curl = acquire();
+    if (!curl) {
+        response.error = "Failed to initialize CURL";
+        return response;
+    }
+
+    struct curl_slist* header_list = nullptr;
+    for (const auto& h : headers) header_list = curl_slist_append(header_list, h.c_str());
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    if (share_) curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "PolyTrader/1.0");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_body);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    if (header_list) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+
+    if (method == "HEAD") {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (method != "GET") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+    }
+    if (!body.empty()) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+    }
+
+    CURLcode res = curl_easy_perform(curl);
+    if (res != CURLE_OK) {
+        response.error = std::string("CURL error: ") + curl_easy_strerror(res);
+    }
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    record(url, curl, res == CURLE_OK, response);
+
+    curl_slist_free_all(header_list);
+    release(curl);
+    return response;
+}
+
+void HttpPool::record(const std::string& url, CURL* handle, bool ok, Response& response) {
+    long connects = 0;
+    long version = 0;
+    curl_off_t connect_us = 0, appconnect_us = 0, total_us = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version);
+    curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect_us);
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &appconnect_us);
+    curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total_us);
+
+    response.reused = ok && connects == 0;
+    response.total_ms = total_us / 1000.0;
+
+    std::string host = host_of(url);
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    HostStats& s = hosts_[host];
+    s.host = host;
+    s.requests++;
+    s.total_request_ms += response.total_ms;
+    if (!ok) {
+        s.errors++;
+        return;
+    }
+    if (connects == 0) {
+        s.reused++;
+    } else {
+        // Name lookup + TCP + TLS, i.e. what a warm connection saves
+        double handshake_ms = std::max(appconnect_us, connect_us) / 1000.0;
+        s.new_connections++;
+        s.last_handshake_ms = handshake_ms;
+        s.max_handshake_ms = std::max(s.max_handshake_ms, handshake_ms);
+        s.total_handshake_ms += handshake_ms;
+    }
+    if (version == CURL_HTTP_VERSION_2_0) s.http_version = 2;
+    else if (version == CURL_HTTP_VERSION_1_1 || version == CURL_HTTP_VERSION_1_0) s.http_version = 1;
+}
+
+// ============ WARMER ============
+
+void HttpPool::add_warm_target(const std::string& origin) {
+    std::lock_guard<std::mutex> lock(warm_mutex_);
+    if (std::find(warm_targets_.begin(), warm_targets_.end(), origin) == warm_targets_.end()) {
+        warm_targets_.push_back(origin);
+    }
+}
+
+void HttpPool::start(std::chrono::seconds interval) {
+    std::lock_guard<std::mutex> lock(warm_mutex_);
+    if (running_) return;
+    running_ = true;
+    warm_interval_ = interval;
+    warmer_ = std::thread(&HttpPool::warm_loop, this);
+    std::cout << "[HTTP] Connection pool warmer started (" << warm_targets_.size()
+              << " hosts, every " << interval.count() << "s)" << std::endl;
+}
+
+void HttpPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(warm_mutex_);
+        running_ = false;
+    }
+    warm_cv_.notify_all();
+    if (warmer_.joinable()) warmer_.join();
+
+    std::lock_guard<std::mutex> lock(handles_mutex_);
+    for (CURL* handle : idle_) curl_easy_cleanup(handle);
+    idle_.clear();
+}
+
+void HttpPool::warm_loop() {
+    std::unique_lock<std::mutex> lock(warm_mutex_);
+    while (running_) {
+        std::vector<std::string> targets = warm_targets_;
+        lock.unlock();
+
+        // A HEAD keeps the TCP/TLS (and HTTP/2) session open, or re-opens
+        // it if the server closed it, off the trading path
+        for (const auto& origin : targets) {
+            auto response = request("HEAD", origin + "/", "", {}, 5000);
+            warm_pings_++;
+            if (!response.error.empty()) {
+                std::cerr << "[HTTP] Warm ping to " << origin << " failed: " << response.error << std::endl;
+            }
+        }
+
+        lock.lock();
+        warm_cv_.wait_for(lock, warm_interval_, [this] { return !running_; });
+    }
+}
+
+HttpPool::Stats HttpPool::stats() const {
+    Stats s;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        for (const auto& [host, hs] : hosts_) s.hosts.push_back(hs);
+    }
+    s.warm_pings = warm_pings_.load();
+    {
+        std::lock_guard<std::mutex> lock(handles_mutex_);
+        s.idle_handles = idle_.size();
+    }
+    return s;
+}
+
+} // namespace poly
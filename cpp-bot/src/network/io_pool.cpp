@@ -0,0 +1,47 @@
+#include "io_pool.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace poly {
+
+IoPool& IoPool::instance() {
+    static IoPool pool;
+    return pool;
+}
+
+IoPool::IoPool() : guard_(boost::asio::make_work_guard(ioc_)) {}
+
+IoPool::~IoPool() {
+    stop();
+}
+
+void IoPool::start(size_t threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) return;
+    started_ = true;
+
+    if (threads == 0) threads = std::min(2u, std::max(1u, std::thread::hardware_concurrency()));
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this] { ioc_.run(); });
+    }
+    std::cout << "[IO] " << threads << " I/O thread(s) for the API and dashboard" << std::endl;
+}
+
+void IoPool::stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    guard_.reset();
+    ioc_.stop();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+    threads_.clear();
+    blocking_.stop();
+    blocking_.join();
+}
+
+size_t IoPool::threads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threads_.size();
+}
+
+} // namespace poly
@@ -0,0 +1,542 @@
+#include "market_parser.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace poly {
+
+namespace {
+
+constexpr int kMaxDepth = 32;
+constexpr int kMaxFastDigits = 15;  // mantissa stays below 2^53, so it is exact
+
+// Powers of ten that are exactly representable as doubles
+constexpr double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+    1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+enum class Kind : uint8_t { NONE, STRING, NUMBER, ARRAY, OBJECT, LITERAL };
+
+// A value located in the message buffer. Strings point at their contents
+// (without quotes); containers span from the opening to the closing bracket.
+struct Value {
+    Kind kind = Kind::NONE;
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    bool escaped = false;
+
+    bool present() const { return kind != Kind::NONE; }
+    bool plain_string() const { return kind == Kind::STRING && !escaped; }
+    std::string_view view() const { return {begin, static_cast<size_t>(end - begin)}; }
+};
+
+struct Cursor {
+    const char* p;
+    const char* end;
+
+    void skip_ws() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    }
+    bool consume(char c) {
+        skip_ws();
+        if (p < end && *p == c) { ++p; return true; }
+        return false;
+    }
+};
+
+bool scan_value(Cursor& c, Value& v, int depth);
+
+bool scan_string(Cursor& c, Value& v) {
+    ++c.p;  // opening quote
+    v.kind = Kind::STRING;
+    v.begin = c.p;
+    v.escaped = false;
+    while (c.p < c.end) {
+        const char ch = *c.p;
+        if (ch == '"') {
+            v.end = c.p++;
+            return true;
+        }
+        if (ch == '\\') {
+            if (c.end - c.p < 2) return false;
+            v.escaped = true;
+            c.p += 2;
+            continue;
+        }
+        if (static_cast<unsigned char>(ch) < 0x20) return false;
+        ++c.p;
+    }
+    return false;
+}
+
+bool scan_literal(Cursor& c, Value& v, const char* word, size_t len) {
+    if (static_cast<size_t>(c.end - c.p) < len || std::memcmp(c.p, word, len) != 0) return false;
+    v.kind = Kind::LITERAL;
+    v.begin = c.p;
+    c.p += len;
+    v.end = c.p;
+    return true;
+}
+
+bool scan_number(Cursor& c, Value& v) {
+    v.kind = Kind::NUMBER;
+    v.begin = c.p;
+    while (c.p < c.end) {
+        const char ch = *c.p;
+        if ((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E') {
+            ++c.p;
+        } else {
+            break;
+        }
+    }
+    v.end = c.p;
+    return v.end != v.begin;
+}
+
+bool scan_container(Cursor& c, Value& v, int depth) {
+    if (depth >= kMaxDepth) return false;
+    const bool is_object = (*c.p == '{');
+    const char close = is_object ? '}' : ']';
+    v.kind = is_object ? Kind::OBJECT : Kind::ARRAY;
+    v.begin = c.p++;
+
+    if (c.consume(close)) {
+        v.end = c.p;
+        return true;
+    }
+    Value item;
+    while (true) {
+        if (is_object) {
+            c.skip_ws();
+            if (c.p >= c.end || *c.p != '"' || !scan_string(c, item)) return false;
+            if (!c.consume(':')) return false;
+        }
+        if (!scan_value(c, item, depth + 1)) return false;
+        if (c.consume(',')) continue;
+        if (c.consume(close)) break;
+        return false;
+    }
+    v.end = c.p;
+    return true;
+}
+
+bool scan_value(Cursor& c, Value& v, int depth) {
+    c.skip_ws();
+    if (c.p >= c.end) return false;
+    switch (*c.p) {
+        case '"': return scan_string(c, v);
+        case '{':
+        case '[': return scan_container(c, v, depth);
+        case 't': return scan_literal(c, v, "true", 4);
+        case 'f': return scan_literal(c, v, "false", 5);
+        case 'n': return scan_literal(c, v, "null", 4);
+        default:  return scan_number(c, v);
+    }
+}
+
+// Walk the members of an already-validated object. f(key, value)
+template <typename F>
+bool for_each_member(const Value& obj, F&& f) {
+    Cursor c{obj.begin + 1, obj.end - 1};
+    Value key, value;
+    while (true) {
+        c.skip_ws();
+        if (c.p >= c.end) return true;
+        scan_string(c, key);
+        c.consume(':');
+        scan_value(c, value, 0);
+        if (key.escaped) return false;
+        f(key.view(), value);
+        c.consume(',');
+    }
+}
+
+// Walk the elements of an already-validated array. f(value) -> bool
+template <typename F>
+bool for_each_element(const Value& arr, F&& f) {
+    Cursor c{arr.begin + 1, arr.end - 1};
+    Value value;
+    while (true) {
+        c.skip_ws();
+        if (c.p >= c.end) return true;
+        scan_value(c, value, 0);
+        if (!f(value)) return false;
+        c.consume(',');
+    }
+}
+
+struct Fields {
+    Value asset_id;
+    Value bids;
+    Value asks;
+    Value price_changes;
+    Value event_type;
+    Value type;
+    Value price;
+    Value size;
+    Value best_bid;
+    Value best_ask;
+    Value side;
+    Value changes;
+    Value timestamp;
+};
+
+bool scan_fields(const Value& obj, Fields& f) {
+    f = Fields{};
+    return for_each_member(obj, [&f](std::string_view key, const Value& value) {
+        if (key == "asset_id") f.asset_id = value;
+        else if (key == "price") f.price = value;
+        else if (key == "size") f.size = value;
+        else if (key == "bids") f.bids = value;
+        else if (key == "asks") f.asks = value;
+        else if (key == "best_bid") f.best_bid = value;
+        else if (key == "best_ask") f.best_ask = value;
+        else if (key == "event_type") f.event_type = value;
+        else if (key == "type") f.type = value;
+        else if (key == "side") f.side = value;
+        else if (key == "price_changes") f.price_changes = value;
+        else if (key == "changes") f.changes = value;
+        else if (key == "timestamp") f.timestamp = value;
+    });
+}
+
+// Numeric field that may arrive either as "0.48" or 0.48
+bool number_from(const Value& v, double& out) {
+    if (v.kind == Kind::NUMBER || v.plain_string()) {
+        return MarketMessageParser::parse_decimal(v.view(), out);
+    }
+    return false;
+}
+
+// Book price or size. Plain decimals convert exactly; anything else
+// (exponents, long mantissas) goes through the double parse.
+template <typename Tag>
+bool fixed_from_text(std::string_view text, Fixed<Tag>& out) {
+    if (Fixed<Tag>::parse(text, out)) return true;
+    double value = 0.0;
+    if (!MarketMessageParser::parse_decimal(text, value)) return false;
+    out = Fixed<Tag>::from_double(value);
+    return true;
+}
+
+template <typename Tag>
+bool number_from(const Value& v, Fixed<Tag>& out) {
+    if (v.kind == Kind::NUMBER || v.plain_string()) return fixed_from_text(v.view(), out);
+    return false;
+}
+
+// Server timestamp (ms) as 1700000000000 or "1700000000000"; false if not digits
+bool uint_from(const Value& v, uint64_t& out) {
+    if (v.kind != Kind::NUMBER && !v.plain_string()) return false;
+    std::string_view text = v.view();
+    if (text.empty() || text.size() > 19) return false;
+    uint64_t value = 0;
+    for (char ch : text) {
+        if (ch < '0' || ch > '9') return false;
+        value = value * 10 + static_cast<uint64_t>(ch - '0');
+    }
+    out = value;
+    return true;
+}
+
+// Asset id -> interned handle; kNoToken for assets we never registered
+bool resolve_token(const Value& v, TokenId& out) {
+    if (!v.plain_string()) return false;
+    out = TokenRegistry::instance().find(v.view());
+    return true;
+}
+
+bool fill_levels(const Value& arr, std::vector<BookLevel>& out) {
+    return for_each_element(arr, [&out](const Value& level) {
+        if (level.kind != Kind::OBJECT) return true;  // not a level - ignore
+        Value price, size;
+        bool ok = for_each_member(level, [&](std::string_view key, const Value& value) {
+            if (key == "price") price = value;
+            else if (key == "size") size = value;
+        });
+        if (!ok) return false;
+        if (!price.present() || !size.present()) return true;
+
+        BookLevel lvl;
+        if (!price.plain_string() || !size.plain_string()) return false;
+        if (!fixed_from_text(price.view(), lvl.price)) return false;
+        if (!fixed_from_text(size.view(), lvl.size)) return false;
+        out.push_back(lvl);
+        return true;
+    });
+}
+
+bool fill_book(const Fields& f, OrderbookUpdate& book) {
+    if (!resolve_token(f.asset_id, book.token)) return false;
+    if (!f.timestamp.present() || !uint_from(f.timestamp, book.timestamp)) book.timestamp = 0;
+    book.bids.clear();
+    book.asks.clear();
+    if (f.asks.kind == Kind::ARRAY && !fill_levels(f.asks, book.asks)) return false;
+    if (f.bids.kind == Kind::ARRAY && !fill_levels(f.bids, book.bids)) return false;
+    return true;
+}
+
+// "BUY" / "SELL" -> book side. False for anything else.
+bool side_from(const Value& v, BookSide& out) {
+    if (!v.plain_string()) return false;
+    if (v.view() == "BUY") { out = BookSide::BID; return true; }
+    if (v.view() == "SELL") { out = BookSide::ASK; return true; }
+    return false;
+}
+
+} // namespace
+
+bool MarketMessageParser::parse_decimal(std::string_view text, double& out) {
+    const char* p = text.data();
+    const char* const end = p + text.size();
+    if (p == end) return false;
+
+    bool negative = false;
+    if (*p == '-') {
+        negative = true;
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int frac_digits = 0;
+    bool seen_dot = false;
+    bool fast = true;
+    for (; p < end; ++p) {
+        const char ch = *p;
+        if (ch >= '0' && ch <= '9') {
+            if (++digits > kMaxFastDigits) { fast = false; break; }
+            mantissa = mantissa * 10 + static_cast<uint64_t>(ch - '0');
+            if (seen_dot) ++frac_digits;
+        } else if (ch == '.' && !seen_dot) {
+            seen_dot = true;
+        } else {
+            fast = false;
+            break;
+        }
+    }
+
+    if (fast) {
+        if (digits == 0) return false;
+        // Both operands are exact, so the IEEE division is correctly rounded -
+        // bit-for-bit what strtod produces for the same decimal.
+        double value = static_cast<double>(mantissa);
+        if (frac_digits > 0) value /= kPow10[frac_digits];
+        out = negative ? -value : value;
+        return true;
+    }
+
+    // Exponents, long mantissas etc. - rare, hand to strtod on a stack copy
+    char buf[64];
+    if (text.size() >= sizeof(buf)) return false;
+    std::memcpy(buf, text.data(), text.size());
+    buf[text.size()] = '\0';
+    char* parsed_end = nullptr;
+    double value = std::strtod(buf, &parsed_end);
+    if (parsed_end != buf + text.size()) return false;
+    out = value;
+    return true;
+}
+
+OrderbookUpdate& MarketMessageParser::next_book() {
+    if (book_count_ == books_.size()) books_.emplace_back();
+    return books_[book_count_++];
+}
+
+PriceUpdate& MarketMessageParser::next_price() {
+    if (price_count_ == prices_.size()) prices_.emplace_back();
+    PriceUpdate& update = prices_[price_count_++];
+    update.token = kNoToken;
+    update.price = 0.0;
+    update.best_bid = 0.0;
+    update.best_ask = 0.0;
+    update.timestamp = 0;
+    update.trade = false;
+    return update;
+}
+
+BookDelta& MarketMessageParser::next_delta() {
+    if (delta_count_ == deltas_.size()) deltas_.emplace_back();
+    return deltas_[delta_count_++];
+}
+
+void MarketMessageParser::stamp(const FrameStamp& stamp) {
+    for (size_t i = 0; i < book_count_; ++i) books_[i].stamp = stamp;
+    for (size_t i = 0; i < delta_count_; ++i) deltas_[i].stamp = stamp;
+}
+
+MarketMessageParser::Result MarketMessageParser::parse(std::string_view msg) {
+    book_count_ = 0;
+    price_count_ = 0;
+    delta_count_ = 0;
+
+    Cursor c{msg.data(), msg.data() + msg.size()};
+    Value root;
+    if (!scan_value(c, root, 0)) return Result::UNRECOGNIZED;
+    c.skip_ws();
+    if (c.p != c.end) return Result::UNRECOGNIZED;
+
+    auto emit_book = [this](const Fields& f) {
+        OrderbookUpdate& book = next_book();
+        if (!fill_book(f, book)) return false;
+        if (book.token == kNoToken || (book.bids.empty() && book.asks.empty())) --book_count_;
+        return true;
+    };
+
+    // Emit nothing unless the whole message was understood
+    auto fail = [this]() {
+        book_count_ = 0;
+        price_count_ = 0;
+        delta_count_ = 0;
+        return Result::UNRECOGNIZED;
+    };
+
+    Fields f;
+
+    // Top of book the server reports with a change (best_bid / best_ask of
+    // `top`): both or neither
+    auto read_top = [](const Fields& top, bool& has_top, Price& best_bid, Price& best_ask) {
+        auto given = [](const Value& v) { return v.kind == Kind::NUMBER || v.kind == Kind::STRING; };
+        has_top = given(top.best_bid) && given(top.best_ask);
+        if (given(top.best_bid) && !number_from(top.best_bid, best_bid)) return false;
+        if (given(top.best_ask) && !number_from(top.best_ask, best_ask)) return false;
+        return true;
+    };
+    uint64_t timestamp = 0;
+
+    // Level change: needs a token, a BUY/SELL side, a price and the new size
+    auto emit_delta = [this, &read_top, &timestamp](TokenId token, const Fields& cf, Price price, const Fields& top) {
+        BookSide side;
+        if (token == kNoToken || !side_from(cf.side, side) || !cf.size.present()) return true;
+        Qty size;
+        if (!number_from(cf.size, size)) return false;
+        bool has_top = false;
+        Price best_bid, best_ask;
+        if (!read_top(top, has_top, best_bid, best_ask)) return false;
+        BookDelta& delta = next_delta();
+        delta.token = token;
+        delta.side = side;
+        delta.has_top = has_top;
+        delta.price = price;
+        delta.size = size;
+        delta.best_bid = best_bid;
+        delta.best_ask = best_ask;
+        delta.timestamp = timestamp;
+        return true;
+    };
+
+    // Initial snapshot: array of full books
+    if (root.kind == Kind::ARRAY) {
+        bool ok = for_each_element(root, [&](const Value& item) {
+            if (item.kind != Kind::OBJECT) return true;
+            Fields item_fields;
+            if (!scan_fields(item, item_fields)) return false;
+            if (item_fields.asset_id.present() &&
+                (item_fields.bids.present() || item_fields.asks.present())) {
+                return emit_book(item_fields);
+            }
+            return true;
+        });
+        return ok ? Result::PARSED : fail();
+    }
+
+    if (root.kind != Kind::OBJECT) return Result::PARSED;
+    if (!scan_fields(root, f)) return fail();
+    if (f.timestamp.present() && !uint_from(f.timestamp, timestamp)) timestamp = 0;
+
+    const bool has_book = f.asset_id.present() && (f.bids.present() || f.asks.present());
+
+    // Single full book
+    if (has_book && !f.price_changes.present()) {
+        return emit_book(f) ? Result::PARSED : fail();
+    }
+
+    // price_changes batch
+    if (f.price_changes.kind == Kind::ARRAY) {
+        bool ok = for_each_element(f.price_changes, [&](const Value& change) {
+            if (change.kind != Kind::OBJECT) return false;
+            Fields cf;
+            if (!scan_fields(change, cf)) return false;
+
+            PriceUpdate& update = next_price();
+            update.timestamp = timestamp;
+            if (cf.asset_id.present() && !resolve_token(cf.asset_id, update.token)) return false;
+            Price price;
+            if (cf.price.present() && !number_from(cf.price, price)) return false;
+            update.price = price.to_double();
+
+            // best_bid / best_ask are validated even when no delta comes of
+            // the change; emit_delta puts them on the delta
+            bool has_top = false;
+            Price best_bid, best_ask;
+            if (!read_top(cf, has_top, best_bid, best_ask)) return false;
+
+            if (price.positive() && !emit_delta(update.token, cf, price, cf)) return false;
+            if (update.token == kNoToken || !price.positive()) --price_count_;
+            return true;
+        });
+        return ok ? Result::PARSED : fail();
+    }
+
+    // event_type format
+    if (f.event_type.present()) {
+        if (!f.event_type.plain_string()) return fail();
+        if (f.event_type.view() == "price_change" && f.asset_id.present()) {
+            PriceUpdate& update = next_price();
+            update.timestamp = timestamp;
+            if (!resolve_token(f.asset_id, update.token)) return fail();
+            if (f.price.present() && !number_from(f.price, update.price)) return fail();
+            if (f.best_bid.present() && !number_from(f.best_bid, update.best_bid)) return fail();
+            if (f.best_ask.present() && !number_from(f.best_ask, update.best_ask)) return fail();
+
+            // Older format: level changes nested under "changes"
+            if (f.changes.kind == Kind::ARRAY) {
+                const TokenId token = update.token;
+                bool ok = for_each_element(f.changes, [&](const Value& change) {
+                    if (change.kind != Kind::OBJECT) return true;
+                    Fields cf;
+                    if (!scan_fields(change, cf)) return false;
+                    Price price;
+                    if (!cf.price.present()) return true;
+                    if (!number_from(cf.price, price)) return false;
+                    return emit_delta(token, cf, price, f);
+                });
+                if (!ok) return fail();
+            }
+            if (update.token == kNoToken) --price_count_;
+        }
+        return Result::PARSED;
+    }
+
+    if (has_book) {
+        return emit_book(f) ? Result::PARSED : fail();
+    }
+
+    // last_trade_price, as "type" or "event_type"
+    const Value& trade_type = f.type.kind == Kind::STRING ? f.type : f.event_type;
+    if (trade_type.kind == Kind::STRING) {
+        if (trade_type.escaped) return fail();
+        if (trade_type.view() == "last_trade_price") {
+            PriceUpdate& update = next_price();
+            update.timestamp = timestamp;
+            update.trade = true;
+            if (f.asset_id.present() && !resolve_token(f.asset_id, update.token)) return fail();
+            if (f.price.present() && !number_from(f.price, update.price)) return fail();
+            if (update.token == kNoToken || update.price <= 0) --price_count_;
+            return Result::PARSED;
+        }
+    }
+
+    // Legacy direct price update
+    if (f.asset_id.present() && f.price.present()) {
+        PriceUpdate& update = next_price();
+        update.timestamp = timestamp;
+        if (!resolve_token(f.asset_id, update.token)) return fail();
+        if (!number_from(f.price, update.price)) return fail();
+        if (update.token == kNoToken) --price_count_;
+    }
+
+    return Result::PARSED;
+}
+
+} // namespace poly
@@ -1,22 +1,18 @@
 #include "polymarket_client.hpp"
 #include <curl/curl.h>
+#include <openssl/crypto.h>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
 #include <array>
+#include <chrono>
+#include <cmath>
 #include <memory>
 #include <cstdio>
 #include <cstring>
 
 namespace poly {
 
-namespace {
-    size_t write_callback(void* contents, size_t size, size_t nmemb, std::string* userp) {
-        userp->append(static_cast<char*>(contents), size * nmemb);
-        return size * nmemb;
-    }
-}
-
 PolymarketClient::PolymarketClient(
     const std::string& api_url,
     const std::string& gamma_url
@@ -28,6 +24,12 @@ void PolymarketClient::set_executor_path(const std::string& path) {
     executor_path_ = path;
 }
 
+void PolymarketClient::set_executor_mode(ExecutorMode mode) {
+    executor_mode_ = mode;
+    std::cout << "[LIVE] Order executor: "
+              << (mode == ExecutorMode::NATIVE ? "native" : "python") << std::endl;
+}
+
 std::vector<Market> PolymarketClient::get_markets(const std::string& query) {
     std::string url = gamma_url_ + "/markets";
     if (!query.empty()) {
@@ -174,24 +176,28 @@ OrderResult PolymarketClient::place_order(
     double size,
     double price
 ) {
-    std::ostringstream cmd;
-    cmd << "place --token \"" << token_id << "\" "
-        << "--side " << side << " "
-        << "--size " << size << " "
-        << "--price " << price;
-    
     std::cout << "[LIVE] Placing order: " << side << " " << size 
               << " @ $" << price << std::endl;
     
-    auto response = execute_python(cmd.str());
-    
     OrderResult result;
-    result.success = response.value("success", false);
-    result.order_id = response.value("order_id", "");
-    result.status = response.value("status", "");
-    result.filled_amount = response.value("size", 0.0);
-    result.price = response.value("price", price);
-    result.error = response.value("error", "");
+    if (executor_mode_ == ExecutorMode::NATIVE) {
+        result = native_order(token_id, side, size, price, "GTC");
+    } else {
+        std::ostringstream cmd;
+        cmd << "place --token \"" << token_id << "\" "
+            << "--side " << side << " "
+            << "--size " << size << " "
+            << "--price " << price;
+        
+        auto response = execute_python(cmd.str());
+        
+        result.success = response.value("success", false);
+        result.order_id = response.value("order_id", "");
+        result.status = response.value("status", "");
+        result.filled_amount = response.value("size", 0.0);
+        result.price = response.value("price", price);
+        result.error = response.value("error", "");
+    }
     
     if (result.success) {
         std::cout << "[LIVE] ✓ Order placed: " << result.order_id << std::endl;
@@ -207,22 +213,46 @@ OrderResult PolymarketClient::place_market_order(
     const std::string& side,
     double size
 ) {
-    std::ostringstream cmd;
-    cmd << "market --token \"" << token_id << "\" "
-        << "--side " << side << " "
-        << "--size " << size;
-    
     std::cout << "[LIVE] Placing market order: " << side << " " << size << std::endl;
     
-    auto response = execute_python(cmd.str());
-    
     OrderResult result;
-    result.success = response.value("success", false);
-    result.order_id = response.value("order_id", "");
-    result.status = response.value("status", "");
-    result.filled_amount = response.value("filled_size", response.value("size", 0.0));
-    result.price = response.value("price", 0.0);
-    result.error = response.value("error", "");
+    if (executor_mode_ == ExecutorMode::NATIVE) {
+        // Cross the book at the current best level, Fill-or-Kill
+        double price = 0.0;
+        try {
+            auto book = get_orderbook(token_id);
+            if (side == "BUY") {
+                for (const auto& ask : book.asks) {
+                    if (ask.size > 0 && (price == 0.0 || ask.price < price)) price = ask.price;
+                }
+            } else {
+                for (const auto& bid : book.bids) {
+                    if (bid.size > 0 && bid.price > price) price = bid.price;
+                }
+            }
+        } catch (const std::exception& e) {
+            result.error = std::string("Orderbook fetch failed: ") + e.what();
+        }
+        if (price > 0.0) {
+            result = native_order(token_id, side, size, price, "FOK");
+        } else if (result.error.empty()) {
+            result.error = side == "BUY" ? "No asks available" : "No bids available";
+        }
+    } else {
+        std::ostringstream cmd;
+        cmd << "market --token \"" << token_id << "\" "
+            << "--side " << side << " "
+            << "--size " << size;
+        
+        auto response = execute_python(cmd.str());
+        
+        result.success = response.value("success", false);
+        result.order_id = response.value("order_id", "");
+        result.status = response.value("status", "");
+        result.filled_amount = response.value("filled_size", response.value("size", 0.0));
+        result.price = response.value("price", 0.0);
+        result.error = response.value("error", "");
+    }
     
     if (result.success) {
         std::cout << "[LIVE] ✓ Market order filled: " << result.order_id 
@@ -235,6 +265,11 @@ OrderResult PolymarketClient::place_market_order(
 }
 
 bool PolymarketClient::cancel_order(const std::string& order_id) {
+    if (executor_mode_ == ExecutorMode::NATIVE) {
+        auto response = clob_request("DELETE", "/order", json{{"orderID", order_id}}.dump());
+        return response.error.empty() && response.status == 200;
+    }
+    
     std::ostringstream cmd;
     cmd << "cancel --order-id \"" << order_id << "\"";
     
@@ -243,14 +278,78 @@ bool PolymarketClient::cancel_order(const std::string& order_id) {
 }
 
 bool PolymarketClient::cancel_all_orders() {
+    if (executor_mode_ == ExecutorMode::NATIVE) {
+        auto response = clob_request("DELETE", "/cancel-all", "");
+        return response.error.empty() && response.status == 200;
+    }
+    
     auto response = execute_python("cancel-all");
     return response.value("success", false);
 }
 
+OrderResult PolymarketClient::get_order(const std::string& order_id) {
+    OrderResult result;
+    result.order_id = order_id;
+    if (executor_mode_ != ExecutorMode::NATIVE) {
+        result.error = "Order lookup needs the native executor";
+        return result;
+    }
+    auto response = clob_request("GET", "/data/order/" + order_id, "");
+    if (!response.error.empty()) {
+        result.error = response.error;
+        return result;
+    }
+    try {
+        auto j = json::parse(response.body);
+        if (response.status != 200 || !j.is_object()) {
+            result.error = j.is_object() ? j.value("error", "HTTP " + std::to_string(response.status))
+                                         : "HTTP " + std::to_string(response.status);
+            return result;
+        }
+        // Sizes and prices come back as decimal strings
+        auto number = [&j](const char* key) {
+            if (!j.contains(key)) return 0.0;
+            const auto& v = j[key];
+            return v.is_string() ? std::stod(v.get<std::string>()) : v.get<double>();
+        };
+        result.status = j.value("status", "");
+        result.filled_amount = number("size_matched");
+        result.price = number("price");
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.error = std::string("Bad order response: ") + e.what();
+    }
+    return result;
+}
+
 BalanceResult PolymarketClient::get_balance() {
+    BalanceResult result;
+    
+    if (executor_mode_ == ExecutorMode::NATIVE) {
+        auto response = clob_request("GET", "/balance-allowance?asset_type=COLLATERAL&signature_type=0", "");
+        if (!response.error.empty()) {
+            result.error = response.error;
+            return result;
+        }
+        try {
+            auto j = json::parse(response.body);
+            if (response.status != 200) {
+                result.error = j.value("error", "HTTP " + std::to_string(response.status));
+                return result;
+            }
+            // USDC has 6 decimals; the API reports base units as a string
+            const auto& balance = j["balance"];
+            double units = balance.is_string() ? std::stod(balance.get<std::string>()) : balance.get<double>();
+            result.balance = units / 1e6;
+            result.success = true;
+        } catch (const std::exception& e) {
+            result.error = std::string("Bad balance response: ") + e.what();
+        }
+        return result;
+    }
+    
     auto response = execute_python("balance");
     
-    BalanceResult result;
     result.success = response.value("success", false);
     result.balance = response.value("balance", 0.0);
     result.currency = response.value("currency", "USDC");
@@ -260,9 +359,30 @@ BalanceResult PolymarketClient::get_balance() {
 }
 
 PositionsResult PolymarketClient::get_positions() {
+    PositionsResult result;
+    
+    if (executor_mode_ == ExecutorMode::NATIVE) {
+        if (!ensure_native(result.error)) return result;
+        try {
+            auto response = http_get(data_url_ + "/positions?user=" + signer_.address());
+            if (response.is_array()) {
+                for (const auto& pos : response) {
+                    Position p;
+                    p.token_id = pos.value("asset", "");
+                    p.size = pos.value("size", 0.0);
+                    p.avg_price = pos.value("avgPrice", 0.0);
+                    result.positions.push_back(p);
+                }
+            }
+            result.success = true;
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        return result;
+    }
+    
     auto response = execute_python("positions");
     
-    PositionsResult result;
     result.success = response.value("success", false);
     result.error = response.value("error", "");
     
@@ -286,63 +406,252 @@ bool PolymarketClient::is_live_trading_available() const {
 }
 
 json PolymarketClient::http_get(const std::string& url) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        throw std::runtime_error("Failed to initialize CURL");
+    auto response = HttpPool::instance().get(url);
+    
+    if (!response.error.empty()) {
+        throw std::runtime_error(response.error);
     }
     
-    std::string response_data;
+    if (response.status != 200) {
+        throw std::runtime_error("HTTP error: " + std::to_string(response.status));
+    }
     
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "PolyTrader/1.0");
+    return json::parse(response.body);
+}
+
+json PolymarketClient::http_post(const std::string& url, const json& body) {
+    auto response = HttpPool::instance().request(
+        "POST", url, body.dump(), {"Content-Type: application/json"});
     
-    CURLcode res = curl_easy_perform(curl);
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-    curl_easy_cleanup(curl);
+    if (!response.error.empty()) {
+        throw std::runtime_error(response.error);
+    }
     
-    if (res != CURLE_OK) {
-        throw std::runtime_error(std::string("CURL error: ") + curl_easy_strerror(res));
+    return json::parse(response.body);
+}
+
+// ============ NATIVE EXECUTOR ============
+
+bool PolymarketClient::ensure_native(std::string& error) {
+    std::lock_guard<std::mutex> lock(native_mutex_);
+    if (native_loaded_) return true;
+    if (!native_error_.empty()) {
+        error = native_error_;
+        return false;
     }
     
-    if (http_code != 200) {
-        throw std::runtime_error("HTTP error: " + std::to_string(http_code));
+    auto env = [](const char* name) {
+        const char* v = std::getenv(name);
+        return std::string(v ? v : "");
+    };
+    
+    std::string key = env("POLYMARKET_PRIVATE_KEY");
+    if (key.empty()) {
+        native_error_ = "POLYMARKET_PRIVATE_KEY environment variable not set";
+    } else if (!signer_.load_private_key(key)) {
+        native_error_ = "POLYMARKET_PRIVATE_KEY is not a valid secp256k1 key";
+    } else {
+        api_key_ = env("POLYMARKET_API_KEY");
+        api_passphrase_ = env("POLYMARKET_PASSPHRASE");
+        std::string secret = env("POLYMARKET_SECRET");
+        if (api_key_.empty() || secret.empty() || api_passphrase_.empty()) {
+            native_error_ = "POLYMARKET_API_KEY/SECRET/PASSPHRASE not set "
+                            "(derive them with: python3 scripts/order_executor.py derive-key)";
+        } else if (!crypto::base64url_decode(secret, api_secret_) || api_secret_.empty()) {
+            native_error_ = "POLYMARKET_SECRET is not valid base64";
+        }
     }
+    if (!key.empty()) OPENSSL_cleanse(&key[0], key.size());
     
-    return json::parse(response_data);
+    if (!native_error_.empty()) {
+        std::cerr << "[LIVE] ✗ Native executor unavailable: " << native_error_ << std::endl;
+        error = native_error_;
+        return false;
+    }
+    
+    native_loaded_ = true;
+    std::cout << "[LIVE] ✓ Native signer ready for " << signer_.address() << std::endl;
+    return true;
 }
 
-json PolymarketClient::http_post(const std::string& url, const json& body) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        throw std::runtime_error("Failed to initialize CURL");
+HttpPool::Response PolymarketClient::clob_request(
+    const std::string& method,
+    const std::string& path,
+    const std::string& body
+) {
+    HttpPool::Response response;
+    if (!ensure_native(response.error)) return response;
+    
+    // L2 auth: HMAC-SHA256(secret, timestamp + method + path + body),
+    // path without the query string
+    std::string timestamp = std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    std::string sign_path = path.substr(0, path.find('?'));
+    auto mac = crypto::hmac_sha256(api_secret_, timestamp + method + sign_path + body);
+    std::string signature = crypto::base64url_encode(mac.data(), mac.size());
+    
+    std::vector<std::string> headers = {
+        "Content-Type: application/json",
+        "POLY_ADDRESS: " + signer_.address(),
+        "POLY_SIGNATURE: " + signature,
+        "POLY_TIMESTAMP: " + timestamp,
+        "POLY_API_KEY: " + api_key_,
+        "POLY_PASSPHRASE: " + api_passphrase_
+    };
+    
+    return HttpPool::instance().request(method, api_url_ + path, body, headers);
+}
+
+ClobMarketParams PolymarketClient::market_params(const std::string& token_id) {
+    {
+        std::lock_guard<std::mutex> lock(params_mutex_);
+        auto it = market_params_.find(token_id);
+        if (it != market_params_.end()) return it->second;
     }
     
-    std::string response_data;
-    std::string post_data = body.dump();
-    
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+    // Public endpoints; fall back to defaults (0.01 tick, no fee) on failure
+    ClobMarketParams params;
+    bool complete = true;
+    try {
+        auto tick = http_get(api_url_ + "/tick-size?token_id=" + token_id);
+        params.tick_size = tick.value("minimum_tick_size", params.tick_size);
+    } catch (const std::exception&) { complete = false; }
+    try {
+        auto neg = http_get(api_url_ + "/neg-risk?token_id=" + token_id);
+        params.neg_risk = neg.value("neg_risk", false);
+    } catch (const std::exception&) { complete = false; }
+    try {
+        auto fee = http_get(api_url_ + "/fee-rate?token_id=" + token_id);
+        params.fee_rate_bps = fee.value("base_fee", 0);
+    } catch (const std::exception&) { complete = false; }
     
-    CURLcode res = curl_easy_perform(curl);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    if (complete) {
+        std::lock_guard<std::mutex> lock(params_mutex_);
+        market_params_[token_id] = params;
+    }
+    return params;
+}
+
+void PolymarketClient::warm_market(const std::string& token_id) {
+    if (executor_mode_ != ExecutorMode::NATIVE || !is_live_trading_available()) return;
+    market_params(token_id);
+}
+
+size_t PolymarketClient::presign_buys(const std::string& token_id, double size, double max_price, int steps) {
+    std::string error;
+    if (executor_mode_ != ExecutorMode::NATIVE || steps <= 0 || !ensure_native(error)) return 0;
+    
+    // Signing happens outside the lock: the send path may take from the old set meanwhile
+    ClobMarketParams params = market_params(token_id);
+    PresignedSet set;
+    set.tick_size = params.tick_size;
+    int64_t top_ticks = 0;
+    ClobOrderBuilder::quantize(size, max_price, params.tick_size, set.size_cents, top_ticks);
+    const int64_t ticks_per_unit = std::llround(1.0 / params.tick_size);
+    if (top_ticks * params.tick_size > max_price + 1e-9) --top_ticks;  // Never above max_price
+    
+    for (int i = 0; i < steps && top_ticks - i >= 1; ++i) {
+        int64_t ticks = top_ticks - i;
+        if (ticks >= ticks_per_unit) continue;
+        ClobOrder order;
+        double price = static_cast<double>(ticks) / static_cast<double>(ticks_per_unit);
+        if (!order_builder_.build(token_id, "BUY", size, price, params, order, error)) break;
+        set.bodies.emplace(ticks, json{
+            {"order", order.to_json()},
+            {"owner", api_key_},
+            {"orderType", "GTC"}
+        }.dump());
+    }
     
-    if (res != CURLE_OK) {
-        throw std::runtime_error(std::string("CURL error: ") + curl_easy_strerror(res));
+    size_t count = set.bodies.size();
+    presigned_count_.fetch_add(count, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(presign_mutex_);
+    if (count == 0) {
+        presigned_.erase(token_id);
+    } else {
+        presigned_[token_id] = std::move(set);
+    }
+    return count;
+}
+
+void PolymarketClient::drop_presigned(const std::string& token_id) {
+    std::lock_guard<std::mutex> lock(presign_mutex_);
+    presigned_.erase(token_id);
+}
+
+bool PolymarketClient::take_presigned(const std::string& token_id, double size, double price, std::string& body) {
+    std::lock_guard<std::mutex> lock(presign_mutex_);
+    auto it = presigned_.find(token_id);
+    if (it == presigned_.end()) return false;
+    
+    PresignedSet& set = it->second;
+    int64_t size_cents = 0;
+    int64_t price_ticks = 0;
+    ClobOrderBuilder::quantize(size, price, set.tick_size, size_cents, price_ticks);
+    auto order = size_cents == set.size_cents ? set.bodies.find(price_ticks) : set.bodies.end();
+    if (order == set.bodies.end()) {
+        presign_misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    body = std::move(order->second);
+    set.bodies.erase(order);
+    presign_hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+PolymarketClient::PresignStats PolymarketClient::presign_stats() const {
+    return PresignStats{
+        presigned_count_.load(std::memory_order_relaxed),
+        presign_hits_.load(std::memory_order_relaxed),
+        presign_misses_.load(std::memory_order_relaxed)
+    };
+}
+
+OrderResult PolymarketClient::native_order(
+    const std::string& token_id,
+    const std::string& side,
+    double size,
+    double price,
+    const char* order_type
+) {
+    OrderResult result;
+    result.price = price;
+    if (!ensure_native(result.error)) return result;
+    
+    std::string body;
+    if (side != "BUY" || std::strcmp(order_type, "GTC") != 0 || !take_presigned(token_id, size, price, body)) {
+        ClobOrder order;
+        if (!order_builder_.build(token_id, side, size, price, market_params(token_id), order, result.error)) {
+            return result;
+        }
+        body = json{
+            {"order", order.to_json()},
+            {"owner", api_key_},
+            {"orderType", order_type}
+        }.dump();
+    }
+    auto response = clob_request("POST", "/order", body);
+    if (!response.error.empty()) {
+        result.error = response.error;
+        return result;
     }
     
-    return json::parse(response_data);
+    try {
+        auto j = json::parse(response.body);
+        result.success = response.status == 200 && j.value("success", false);
+        result.order_id = j.value("orderID", "");
+        result.status = j.value("status", "");
+        result.error = j.value("errorMsg", "");
+        if (result.error.empty() && !result.success) {
+            result.error = j.value("error", "HTTP " + std::to_string(response.status));
+        }
+        if (result.success && result.status == "matched") {
+            result.filled_amount = size;
+        }
+    } catch (const std::exception&) {
+        result.error = "Bad order response (HTTP " + std::to_string(response.status) + "): " + response.body;
+    }
+    return result;
 }
 
 } // namespace poly
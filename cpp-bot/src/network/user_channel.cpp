@@ -0,0 +1,122 @@
+#include "user_channel.hpp"
+#include <iostream>
+
+namespace poly {
+
+namespace {
+
+// Sizes and prices arrive as strings ("10", "0.57")
+double number_field(const nlohmann::json& j, const char* key) {
+    auto it = j.find(key);
+    if (it == j.end() || it->is_null()) return 0.0;
+    if (it->is_string()) {
+        const auto& s = it->get_ref<const std::string&>();
+        return s.empty() ? 0.0 : std::stod(s);
+    }
+    return it->is_number() ? it->get<double>() : 0.0;
+}
+
+std::string string_field(const nlohmann::json& j, const char* key) {
+    auto it = j.find(key);
+    return it != j.end() && it->is_string() ? it->get<std::string>() : std::string();
+}
+
+} // namespace
+
+UserChannelStream::UserChannelStream(std::string api_key, std::string api_secret, std::string api_passphrase)
+    : WebSocketStream("USER WS", "/ws/user", "Polymarket user channel")
+    , api_key_(std::move(api_key))
+    , api_secret_(std::move(api_secret))
+    , api_passphrase_(std::move(api_passphrase)) {
+}
+
+UserChannelStream::~UserChannelStream() {
+    stop();
+}
+
+void UserChannelStream::on_connected() {
+    try {
+        // Empty market list = every market this key trades
+        nlohmann::json sub = {
+            {"auth", {
+                {"apiKey", api_key_},
+                {"secret", api_secret_},
+                {"passphrase", api_passphrase_}
+            }},
+            {"type", "user"},
+            {"markets", nlohmann::json::array()}
+        };
+        send_text(sub.dump());
+        std::cout << "[USER WS] Subscribed to fills and order status" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "[USER WS] Subscribe error: " << e.what() << std::endl;
+    }
+    
+    if (connected_callback_) connected_callback_();
+}
+
+void UserChannelStream::on_message(std::string_view msg, uint64_t /*frame_ns*/) {
+    if (msg.empty() || (msg.front() != '{' && msg.front() != '[')) return;  // PONG etc.
+    try {
+        auto j = nlohmann::json::parse(msg);
+        if (j.is_array()) {
+            for (const auto& item : j) dispatch_event(item);
+        } else {
+            dispatch_event(j);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[USER WS] Bad message: " << e.what() << std::endl;
+    }
+}
+
+void UserChannelStream::dispatch_event(const nlohmann::json& j) {
+    if (!j.is_object()) return;
+    std::string event_type = string_field(j, "event_type");
+    
+    if (event_type == "trade") {
+        dispatch_trade(j);
+    } else if (event_type == "order") {
+        if (!order_callback_) return;
+        UserOrderEvent event;
+        event.order_id = string_field(j, "id");
+        event.asset_id = string_field(j, "asset_id");
+        event.type = string_field(j, "type");
+        event.original_size = number_field(j, "original_size");
+        event.size_matched = number_field(j, "size_matched");
+        event.price = number_field(j, "price");
+        order_callback_(event);
+    }
+}
+
+void UserChannelStream::dispatch_trade(const nlohmann::json& j) {
+    if (!trade_callback_) return;
+    
+    UserTrade trade;
+    trade.trade_id = string_field(j, "id");
+    trade.status = string_field(j, "status");
+    
+    // We took liquidity: one execution at the trade price for the full size
+    if (string_field(j, "trader_side") != "MAKER") {
+        trade.order_id = string_field(j, "taker_order_id");
+        trade.asset_id = string_field(j, "asset_id");
+        trade.shares = number_field(j, "size");
+        trade.price = number_field(j, "price");
+        if (!trade.order_id.empty()) trade_callback_(trade);
+        return;
+    }
+    
+    // Our resting order(s) were hit: the match lists every maker, only ours count
+    auto makers = j.find("maker_orders");
+    if (makers == j.end() || !makers->is_array()) return;
+    for (const auto& maker : *makers) {
+        std::string owner = string_field(maker, "owner");
+        if (!owner.empty() && owner != api_key_) continue;
+        trade.order_id = string_field(maker, "order_id");
+        trade.asset_id = string_field(maker, "asset_id");
+        trade.shares = number_field(maker, "matched_amount");
+        trade.price = number_field(maker, "price");
+        if (!trade.order_id.empty()) trade_callback_(trade);
+    }
+}
+
+} // namespace poly
@@ -1,68 +1,54 @@
 #include "websocket_client.hpp"
-#include <iostream>
+#include "latency.hpp"
+#include "logger.hpp"
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
 
 namespace poly {
 
-WebSocketPriceStream::WebSocketPriceStream() {
+// ============ WebSocketStream (connection, reconnect, keepalive) ============
+
+WebSocketStream::WebSocketStream(std::string tag, std::string target, std::string description)
+    : tag_(std::move(tag))
+    , target_(std::move(target))
+    , description_(std::move(description)) {
     ctx_.set_default_verify_paths();
     ctx_.set_verify_mode(ssl::verify_none);
+    
+    // Client-side session cache: we keep the sessions ourselves (on_new_session)
+    SSL_CTX_set_session_cache_mode(ctx_.native_handle(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx_.native_handle(), &WebSocketStream::on_new_session);
 }
 
-WebSocketPriceStream::~WebSocketPriceStream() {
+WebSocketStream::~WebSocketStream() {
     stop();
 }
 
-void WebSocketPriceStream::set_callback(PriceCallback cb) {
-    callback_ = std::move(cb);
-}
-
-void WebSocketPriceStream::set_orderbook_callback(OrderbookCallback cb) {
-    orderbook_callback_ = std::move(cb);
-}
-
-void WebSocketPriceStream::subscribe(const std::string& token_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Check if already subscribed
-    for (const auto& t : subscribed_tokens_) {
-        if (t == token_id) return;
-    }
-    
-    subscribed_tokens_.push_back(token_id);
-    
-    // Send immediately if connected (for instant market switching)
-    if (connected_ && ws_) {
-        send_subscribe(token_id);
-    }
-}
-
-void WebSocketPriceStream::unsubscribe(const std::string& token_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+void WebSocketStream::start() {
+    if (running_.exchange(true)) return;
+    worker_thread_ = std::thread(&WebSocketStream::run, this);
     
-    auto it = std::find(subscribed_tokens_.begin(), subscribed_tokens_.end(), token_id);
-    if (it != subscribed_tokens_.end()) {
-        subscribed_tokens_.erase(it);
-        if (connected_) {
-            send_unsubscribe(token_id);
+    if (options_.spin_cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options_.spin_cpu, &cpus);
+        int rc = pthread_setaffinity_np(worker_thread_.native_handle(), sizeof(cpus), &cpus);
+        if (rc == 0) {
+            POLY_LOG_INFO("WS", "{} reader pinned to cpu {}", description_, options_.spin_cpu);
+        } else {
+            POLY_LOG_WARN("WS", "{} reader pin to cpu {} failed: {}", description_, options_.spin_cpu, rc);
         }
     }
 }
 
-void WebSocketPriceStream::clear_subscriptions() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    // Just clear the list - don't send unsubscribe (thread safety)
-    // The reconnect will establish fresh subscriptions
-    subscribed_tokens_.clear();
-}
-
-void WebSocketPriceStream::start() {
-    if (running_.exchange(true)) return;
-    worker_thread_ = std::thread(&WebSocketPriceStream::run, this);
-}
-
-void WebSocketPriceStream::stop() {
+void WebSocketStream::stop() {
     running_ = false;
     
     if (ws_ && connected_) {
@@ -78,8 +64,8 @@ void WebSocketPriceStream::stop() {
     connected_ = false;
 }
 
-void WebSocketPriceStream::reconnect() {
-    std::cout << "[WS] Reconnect requested" << std::endl;
+void WebSocketStream::reconnect() {
+    POLY_LOG_INFO("WS", "Reconnect requested: {}", description_);
     
     // Set connected to false first to break read_loop
     connected_ = false;
@@ -106,7 +92,14 @@ void WebSocketPriceStream::reconnect() {
     // The run loop will automatically reconnect after read_loop exits
 }
 
-void WebSocketPriceStream::run() {
+bool WebSocketStream::send_text(const std::string& text) {
+    if (!connected_ || !ws_) return false;
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    ws_->write(net::buffer(text));
+    return true;
+}
+
+void WebSocketStream::run() {
     while (running_) {
         try {
             // Create fresh io_context for each connection attempt
@@ -114,44 +107,131 @@ void WebSocketPriceStream::run() {
             
             connect();
             if (connected_) {
-                std::cout << "[WS] ✓ Connected to Polymarket real-time stream" << std::endl;
+                POLY_LOG_INFO("WS", "✓ Connected to {}", description_);
                 read_loop();
             }
         } catch (const std::exception& e) {
-            std::cerr << "[WS] Error: " << e.what() << std::endl;
+            POLY_LOG_ERROR("WS", "{} error: {}", description_, e.what());
             connected_ = false;
         }
         
         if (running_) {
-            std::cout << "[WS] Reconnecting in 2s..." << std::endl;
+            POLY_LOG_INFO("WS", "Reconnecting to {} in 2s...", description_);
             std::this_thread::sleep_for(std::chrono::seconds(2));
         }
     }
 }
 
-void WebSocketPriceStream::connect() {
+namespace {
+    // SSL ex-data slot pointing back at the stream (asio owns app data)
+    int stream_ex_index() {
+        static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+        return index;
+    }
+}
+
+int WebSocketStream::on_new_session(SSL* ssl, SSL_SESSION* session) {
+    auto* self = static_cast<WebSocketStream*>(SSL_get_ex_data(ssl, stream_ex_index()));
+    if (!self) return 0;
+    self->tls_session_.reset(session);
+    return 1;  // Ours now
+}
+
+void WebSocketStream::tune_socket(tcp::socket& socket) {
+    beast::error_code ec;
+    if (options_.tcp_nodelay) {
+        socket.set_option(tcp::no_delay(true), ec);
+        if (ec) POLY_LOG_WARN("WS", "{} TCP_NODELAY: {}", description_, ec.message());
+    }
+    if (options_.recv_buffer > 0) {
+        socket.set_option(net::socket_base::receive_buffer_size(options_.recv_buffer), ec);
+        if (ec) POLY_LOG_WARN("WS", "{} SO_RCVBUF: {}", description_, ec.message());
+    }
+    if (options_.busy_poll_us > 0) {
+#ifdef SO_BUSY_POLL
+        int busy_poll = options_.busy_poll_us;
+        if (::setsockopt(socket.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) != 0) {
+            POLY_LOG_WARN("WS", "{} SO_BUSY_POLL {}us: {}", description_, busy_poll, std::strerror(errno));
+        }
+#else
+        POLY_LOG_WARN("WS", "{} SO_BUSY_POLL is not supported on this platform", description_);
+#endif
+    }
+}
+
+void WebSocketStream::connect() {
     const std::string host = "ws-subscriptions-clob.polymarket.com";
     const std::string port = "443";
-    const std::string target = "/ws/market";
     
-    tcp::resolver resolver(ioc_);
-    auto const results = resolver.resolve(host, port);
+    const uint64_t start_ns = latency::now_ns();
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.attempts++;
+    }
+    
+    // Addresses are cached - a reconnect doesn't wait on DNS
+    bool looked_up = false;
+    auto now = std::chrono::steady_clock::now();
+    if (endpoints_.empty() || now - resolved_at_ > std::chrono::seconds(options_.dns_ttl_sec)) {
+        tcp::resolver resolver(ioc_);
+        endpoints_.clear();
+        for (const auto& entry : resolver.resolve(host, port)) endpoints_.push_back(entry.endpoint());
+        preferred_endpoint_ = endpoints_.empty() ? 0 : options_.first_address % endpoints_.size();
+        resolved_at_ = now;
+        looked_up = true;
+    }
+    const uint64_t dns_ns = latency::now_ns();
     
     ws_ = std::make_unique<websocket::stream<beast::ssl_stream<tcp::socket>>>(ioc_, ctx_);
+    SSL* ssl = ws_->next_layer().native_handle();
+    SSL_set_ex_data(ssl, stream_ex_index(), this);
     
     // Set SNI hostname
-    if (!SSL_set_tlsext_host_name(ws_->next_layer().native_handle(), host.c_str())) {
+    if (!SSL_set_tlsext_host_name(ssl, host.c_str())) {
         throw beast::system_error(
             beast::error_code(static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()),
             "Failed to set SNI hostname"
         );
     }
     
-    // Connect TCP
-    auto ep = net::connect(beast::get_lowest_layer(*ws_), results);
+    // Connect TCP: the address that worked last time first, then the others.
+    // Options go on before connect - the receive buffer sizes the TCP window.
+    auto& socket = beast::get_lowest_layer(*ws_);
+    tcp::endpoint ep;
+    bool tcp_up = false;
+    uint64_t failovers = 0;
+    for (size_t n = 0; n < endpoints_.size(); ++n) {
+        size_t index = (preferred_endpoint_ + n) % endpoints_.size();
+        beast::error_code ec;
+        if (socket.is_open()) socket.close(ec);
+        socket.open(endpoints_[index].protocol(), ec);
+        if (!ec) {
+            tune_socket(socket);
+            socket.connect(endpoints_[index], ec);
+        }
+        if (ec) {
+            POLY_LOG_WARN("WS", "{} connect to {} failed: {}", description_,
+                          endpoints_[index].address().to_string(), ec.message());
+            failovers++;
+            continue;
+        }
+        preferred_endpoint_ = index;
+        ep = endpoints_[index];
+        tcp_up = true;
+        break;
+    }
+    if (!tcp_up) {
+        // Every address refused - resolve afresh next time
+        endpoints_.clear();
+        throw std::runtime_error("no address of " + host + " accepted the connection");
+    }
+    const uint64_t tcp_ns = latency::now_ns();
     
-    // SSL handshake
+    // SSL handshake, resuming the previous session if there is one
+    if (options_.tls_resume && tls_session_) SSL_set_session(ssl, tls_session_.get());
     ws_->next_layer().handshake(ssl::stream_base::client);
+    const bool resumed = SSL_session_reused(ssl) == 1;
+    const uint64_t tls_ns = latency::now_ns();
     
     // Set WebSocket options with aggressive keepalive
     websocket::stream_base::timeout opt{
@@ -165,6 +245,11 @@ void WebSocketPriceStream::connect() {
             req.set(http::field::user_agent, "PolyTrader/1.0");
         }
     ));
+    if (options_.compression) {
+        websocket::permessage_deflate deflate;
+        deflate.client_enable = true;
+        ws_->set_option(deflate);
+    }
     
     // Control callback for ping/pong
     ws_->control_callback(
@@ -179,10 +264,371 @@ void WebSocketPriceStream::connect() {
     
     // WebSocket handshake
     std::string ws_host = host + ":" + std::to_string(ep.port());
-    ws_->handshake(ws_host, target);
+    ws_->handshake(ws_host, target_);
+    const uint64_t ws_ns = latency::now_ns();
+    
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.connects++;
+        if (looked_up) stats_.dns_lookups++;
+        stats_.failovers += failovers;
+        if (resumed) stats_.tls_resumed++;
+        stats_.endpoint = ep.address().to_string();
+        stats_.resumed = resumed;
+        stats_.dns_us = (dns_ns - start_ns) / 1000;
+        stats_.tcp_us = (tcp_ns - start_ns) / 1000;
+        stats_.tls_us = (tls_ns - start_ns) / 1000;
+        stats_.ws_us = (ws_ns - start_ns) / 1000;
+        stats_.first_frame_us = 0;
+        stats_.first_book_us = 0;
+    }
+    POLY_LOG_INFO("WS", "{} up in {:.1f}ms via {} (dns {:.1f}{} | tcp {:.1f} | tls {:.1f}{} | ws {:.1f})",
+                  description_, (ws_ns - start_ns) / 1e6, ep.address().to_string(), (dns_ns - start_ns) / 1e6,
+                  looked_up ? "" : " cached", (tcp_ns - dns_ns) / 1e6, (tls_ns - tcp_ns) / 1e6,
+                  resumed ? " resumed" : "", (ws_ns - tls_ns) / 1e6);
     
+    connect_start_ns_ = start_ns;
+    awaiting_frame_ = true;
+    awaiting_book_ = book_timing_;
     connected_ = true;
+    on_connected();
+}
+
+void WebSocketStream::read_frame(beast::flat_buffer& buffer) {
+    if (!options_.busy_spin) {
+        ws_->read(buffer);
+        return;
+    }
+    
+    // Busy-spin: the read is an async op and this thread polls the reactor
+    // until it completes, never sleeping in epoll_wait
+    if (ioc_.stopped()) ioc_.restart();
+    bool done = false;
+    beast::error_code result;
+    ws_->async_read(buffer, [&](beast::error_code ec, std::size_t) {
+        result = ec;
+        done = true;
+    });
+    bool cancelled = false;
+    while (!done) {
+        ioc_.poll();
+        if (!cancelled && (!running_ || !connected_)) {
+            beast::error_code ec;
+            beast::get_lowest_layer(*ws_).cancel(ec);
+            cancelled = true;
+        }
+    }
+    if (result) throw beast::system_error(result);
+}
+
+void WebSocketStream::record_first_book() {
+    awaiting_book_ = false;
+    const uint64_t now_ns = latency::now_ns();
+    LatencyMonitor::instance().record(latency::Span::CONNECT_TO_BOOK, connect_start_ns_, now_ns);
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.first_book_us = (now_ns - connect_start_ns_) / 1000;
+    }
+    POLY_LOG_INFO("WS", "{} first book {:.1f}ms after connect started", description_,
+                  (now_ns - connect_start_ns_) / 1e6);
+}
+
+ConnectStats WebSocketStream::connect_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+void WebSocketStream::read_loop() {
+    beast::flat_buffer buffer;
+    int msg_count = 0;
+    
+    while (running_ && connected_) {
+        try {
+            buffer.clear();
+            read_frame(buffer);
+            uint64_t frame_ns = latency::now_ns();
+            
+            if (awaiting_frame_) {
+                awaiting_frame_ = false;
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                stats_.first_frame_us = (frame_ns - connect_start_ns_) / 1000;
+            }
+            
+            // flat_buffer is contiguous - parse straight out of it
+            auto data = buffer.cdata();
+            std::string_view msg(static_cast<const char*>(data.data()), data.size());
+            msg_count++;
+            if (awaiting_book_ && msg.find("\"bids\"") != std::string_view::npos) record_first_book();
+            
+            // First frames of each connection, in debug builds (POLY_LOG_MIN_LEVEL=0)
+            if (msg_count <= 20) {
+                POLY_LOG_DEBUG("WS", "{} MSG #{}: {}...", tag_, msg_count, msg.substr(0, 300));
+            }
+            
+            on_message(msg, frame_ns);
+            
+        } catch (const beast::system_error& e) {
+            POLY_LOG_ERROR("WS", "{} read error: {} (code: {})", description_, e.what(), e.code().value());
+            break;
+        }
+    }
+    
+    connected_ = false;
+    awaiting_book_ = false;
+    POLY_LOG_INFO("WS", "{} disconnected after {} messages", description_, msg_count);
+}
+
+// ============ WebSocketPriceStream (market channel) ============
+
+namespace {
+
+// MARKET and BOOK channel frames that (un)subscribe a token
+std::vector<std::string> subscription_frames(const char* type, const std::string& token_id) {
+    std::vector<std::string> frames;
+    for (const char* channel : {"market", "book"}) {
+        nlohmann::json msg = {
+            {"type", type},
+            {"channel", channel},
+            {"assets_ids", {token_id}}
+        };
+        frames.push_back(msg.dump());
+    }
+    return frames;
+}
+
+// Content identity of one parsed update, for arbitration. FNV-1a over its
+// fields; tagged by kind so a book never matches a delta.
+struct UpdateHash {
+    uint64_t h = 14695981039346656037ull;
+    void mix(uint64_t v) {
+        for (int i = 0; i < 8; ++i) {
+            h ^= (v >> (i * 8)) & 0xff;
+            h *= 1099511628211ull;
+        }
+    }
+    uint64_t value() const { return h ? h : 1; }
+};
+
+uint64_t update_key(const OrderbookUpdate& book) {
+    UpdateHash u;
+    u.mix(1);
+    u.mix(book.token);
+    for (const auto* levels : {&book.bids, &book.asks}) {
+        u.mix(levels->size());
+        for (const auto& level : *levels) {
+            u.mix(static_cast<uint64_t>(level.price.micros()));
+            u.mix(static_cast<uint64_t>(level.size.micros()));
+        }
+    }
+    return u.value();
+}
+
+uint64_t update_key(const BookDelta& delta) {
+    UpdateHash u;
+    u.mix(2);
+    u.mix(delta.token);
+    u.mix(static_cast<uint64_t>(delta.side));
+    u.mix(static_cast<uint64_t>(delta.price.micros()));
+    u.mix(static_cast<uint64_t>(delta.size.micros()));
+    return u.value();
+}
+
+uint64_t update_key(const PriceUpdate& price) {
+    UpdateHash u;
+    u.mix(3);
+    u.mix(price.token);
+    uint64_t bits = 0;
+    std::memcpy(&bits, &price.price, sizeof(bits));
+    u.mix(bits);
+    u.mix(price.trade ? 1 : 0);
+    return u.value();
+}
+
+// Raw text of every value of `key` (quoted, with the quotes) in a frame
+template <typename Fn>
+void for_each_value(std::string_view msg, std::string_view key, Fn&& fn) {
+    size_t pos = 0;
+    while ((pos = msg.find(key, pos)) != std::string_view::npos) {
+        pos += key.size();
+        while (pos < msg.size() && msg[pos] == ' ') ++pos;
+        if (pos >= msg.size() || msg[pos] != ':') continue;
+        ++pos;
+        while (pos < msg.size() && msg[pos] == ' ') ++pos;
+        size_t end = pos;
+        if (end < msg.size() && msg[end] == '"') {
+            end = msg.find('"', end + 1);
+            if (end == std::string_view::npos) return;
+            ++end;
+        } else {
+            while (end < msg.size() && msg[end] != ',' && msg[end] != '}' && msg[end] != ']') ++end;
+        }
+        fn(msg.substr(pos, end - pos));
+        pos = end;
+    }
+}
+
+} // namespace
+
+// One more connection of a redundant stream: the owner's subscriptions,
+// frames handed to the owner's arbitration
+class WebSocketPriceStream::Mirror : public WebSocketStream {
+public:
+    Mirror(WebSocketPriceStream& owner, size_t feed)
+        : WebSocketStream("WS", "/ws/market", "Polymarket real-time stream #" + std::to_string(feed + 1))
+        , owner_(owner)
+        , feed_(feed) {
+        set_book_timing(true);
+    }
+    ~Mirror() override { stop(); }
+    
+    // False once a write fails or the connection is down
+    bool send_frames(const std::vector<std::string>& frames) {
+        try {
+            for (const auto& frame : frames) {
+                if (!send_text(frame)) return false;
+            }
+            return true;
+        } catch (const std::exception& e) {
+            POLY_LOG_ERROR("WS", "Subscribe error on feed #{}: {}", feed_ + 1, e.what());
+            return false;
+        }
+    }
+    
+protected:
+    void on_connected() override {
+        std::lock_guard<std::mutex> lock(owner_.mutex_);
+        for (const auto& token : owner_.subscribed_tokens_) {
+            if (!send_frames(subscription_frames("subscribe", token))) return;
+        }
+    }
+    void on_message(std::string_view msg, uint64_t frame_ns) override { owner_.arbitrate(feed_, msg, frame_ns); }
+    
+private:
+    WebSocketPriceStream& owner_;
+    const size_t feed_;
+};
+
+WebSocketPriceStream::WebSocketPriceStream()
+    : WebSocketStream("WS", "/ws/market", "Polymarket real-time stream") {
+    set_book_timing(true);
+}
+
+WebSocketPriceStream::~WebSocketPriceStream() {
+    stop();
+}
+
+void WebSocketPriceStream::set_callback(PriceCallback cb) {
+    callback_ = std::move(cb);
+}
+
+void WebSocketPriceStream::set_orderbook_callback(OrderbookCallback cb) {
+    orderbook_callback_ = std::move(cb);
+}
+
+void WebSocketPriceStream::set_book_delta_callback(BookDeltaCallback cb) {
+    delta_callback_ = std::move(cb);
+}
+
+void WebSocketPriceStream::set_feed_count(size_t count) {
+    if (feed_counters_) return;  // Started
+    mirrors_.clear();
+    for (size_t feed = 1; feed < count; ++feed) mirrors_.push_back(std::make_unique<Mirror>(*this, feed));
+}
+
+void WebSocketPriceStream::start() {
+    if (!feed_counters_) {
+        feed_counters_ = std::make_unique<FeedCounters[]>(mirrors_.size() + 1);
+        seen_.assign(kDedupSlots, 0);
+        // Each connection starts from a different resolved address; only
+        // this one takes the reader pin
+        for (size_t i = 0; i < mirrors_.size(); ++i) {
+            NetworkOptions options = network_options();
+            options.first_address = options.first_address + i + 1;
+            options.spin_cpu = -1;
+            mirrors_[i]->set_network_options(options);
+        }
+        if (!mirrors_.empty()) {
+            POLY_LOG_INFO("WS", "{} redundant market feeds, first copy of each update wins", mirrors_.size() + 1);
+        }
+    }
+    WebSocketStream::start();
+    for (auto& mirror : mirrors_) mirror->start();
+}
+
+void WebSocketPriceStream::stop() {
+    WebSocketStream::stop();
+    for (auto& mirror : mirrors_) mirror->stop();
+}
+
+bool WebSocketPriceStream::is_connected() const {
+    if (connected_) return true;
+    for (const auto& mirror : mirrors_) {
+        if (mirror->is_connected()) return true;
+    }
+    return false;
+}
+
+std::vector<WebSocketPriceStream::FeedStats> WebSocketPriceStream::feed_stats() const {
+    std::vector<FeedStats> out;
+    for (size_t feed = 0; feed <= mirrors_.size(); ++feed) {
+        const WebSocketStream& stream = feed == 0 ? static_cast<const WebSocketStream&>(*this) : *mirrors_[feed - 1];
+        FeedStats stats;
+        stats.connected = feed == 0 ? connected_.load() : stream.is_connected();
+        if (feed_counters_) {
+            stats.forwarded = feed_counters_[feed].forwarded.load(std::memory_order_relaxed);
+            stats.duplicates = feed_counters_[feed].duplicates.load(std::memory_order_relaxed);
+        }
+        stats.connect = stream.connect_stats();
+        out.push_back(std::move(stats));
+    }
+    return out;
+}
+
+void WebSocketPriceStream::subscribe(const std::string& token_id) {
+    // Frames for the token resolve to this handle from now on
+    TokenRegistry::instance().intern(token_id);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Check if already subscribed
+    for (const auto& t : subscribed_tokens_) {
+        if (t == token_id) return;
+    }
+    
+    subscribed_tokens_.push_back(token_id);
     
+    // Send immediately if connected (for instant market switching)
+    if (connected_) {
+        send_subscribe(token_id);
+    }
+    for (auto& mirror : mirrors_) {
+        if (mirror->is_connected()) mirror->send_frames(subscription_frames("subscribe", token_id));
+    }
+}
+
+void WebSocketPriceStream::unsubscribe(const std::string& token_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = std::find(subscribed_tokens_.begin(), subscribed_tokens_.end(), token_id);
+    if (it != subscribed_tokens_.end()) {
+        subscribed_tokens_.erase(it);
+        if (connected_) {
+            send_unsubscribe(token_id);
+        }
+        for (auto& mirror : mirrors_) {
+            if (mirror->is_connected()) mirror->send_frames(subscription_frames("unsubscribe", token_id));
+        }
+    }
+}
+
+void WebSocketPriceStream::clear_subscriptions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Just clear the list - don't send unsubscribe (thread safety)
+    // The reconnect will establish fresh subscriptions
+    subscribed_tokens_.clear();
+}
+
+void WebSocketPriceStream::on_connected() {
     // Subscribe to all pending tokens
     std::lock_guard<std::mutex> lock(mutex_);
     for (const auto& token : subscribed_tokens_) {
@@ -191,295 +637,396 @@ void WebSocketPriceStream::connect() {
 }
 
 void WebSocketPriceStream::send_subscribe(const std::string& token_id) {
-    if (!connected_ || !ws_) return;
-    
     try {
-        // Subscribe to MARKET channel for price updates
-        nlohmann::json market_sub = {
-            {"type", "subscribe"},
-            {"channel", "market"},
-            {"assets_ids", {token_id}}
-        };
-        ws_->write(net::buffer(market_sub.dump()));
-        
-        // Subscribe to BOOK channel for orderbook depth
-        nlohmann::json book_sub = {
-            {"type", "subscribe"},
-            {"channel", "book"},
-            {"assets_ids", {token_id}}
-        };
-        ws_->write(net::buffer(book_sub.dump()));
-        
-        std::cout << "[WS] Subscribed market+book: " << token_id.substr(0, 20) << "..." << std::endl;
+        // MARKET channel for price updates, BOOK channel for orderbook depth
+        for (const auto& frame : subscription_frames("subscribe", token_id)) {
+            if (!send_text(frame)) return;
+        }
+        POLY_LOG_INFO("WS", "Subscribed market+book: {}...", std::string_view(token_id).substr(0, 20));
     } catch (const std::exception& e) {
-        std::cerr << "[WS] Subscribe error: " << e.what() << std::endl;
+        POLY_LOG_ERROR("WS", "Subscribe error: {}", e.what());
     }
 }
 
 void WebSocketPriceStream::send_unsubscribe(const std::string& token_id) {
-    if (!connected_ || !ws_) return;
+    try {
+        // Mirror send_subscribe: drop both MARKET and BOOK channels
+        for (const auto& frame : subscription_frames("unsubscribe", token_id)) {
+            if (!send_text(frame)) return;
+        }
+        POLY_LOG_INFO("WS", "Unsubscribed market+book: {}...", std::string_view(token_id).substr(0, 20));
+    } catch (const std::exception& e) {
+        POLY_LOG_ERROR("WS", "Unsubscribe error: {}", e.what());
+    }
+}
+
+void WebSocketPriceStream::on_message(std::string_view msg, uint64_t frame_ns) {
+    if (!mirrors_.empty()) {
+        arbitrate(0, msg, frame_ns);
+        return;
+    }
+    if (frame_tap_) frame_tap_(msg, frame_ns);
+    stamp_.frame_ns = frame_ns;
+    dispatch_message(msg);
+}
+
+void WebSocketPriceStream::arbitrate(size_t feed, std::string_view msg, uint64_t frame_ns) {
+    std::lock_guard<std::mutex> lock(arb_mutex_);
+    stamp_.frame_ns = frame_ns;
+    
+    if (parser_.parse(msg) != MarketMessageParser::Result::PARSED) {
+        // Shapes only the JSON fallback reads: whole frames, by key
+        const uint64_t key = frame_key(msg);
+        uint64_t& slot = seen_[key % kDedupSlots];
+        if (slot == key) {
+            feed_counters_[feed].duplicates.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        slot = key;
+        feed_counters_[feed].forwarded.fetch_add(1, std::memory_order_relaxed);
+        if (frame_tap_) frame_tap_(msg, frame_ns);
+        dispatch_message(msg);
+        return;
+    }
+    
+    // Each update on its own: the other feed may have batched it with
+    // different neighbours
+    const size_t books = parser_.book_count();
+    const size_t deltas = parser_.delta_count();
+    const size_t prices = parser_.price_count();
+    keep_.assign(books + deltas + prices, 0);
+    size_t kept = 0;
+    for (size_t i = 0; i < books; ++i) {
+        const auto& book = parser_.book(i);
+        kept += keep_[i] = admit(book.token, book.timestamp, update_key(book));
+    }
+    for (size_t i = 0; i < deltas; ++i) {
+        const auto& delta = parser_.delta(i);
+        kept += keep_[books + i] = admit(delta.token, delta.timestamp, update_key(delta));
+    }
+    for (size_t i = 0; i < prices; ++i) {
+        const auto& price = parser_.price(i);
+        kept += keep_[books + deltas + i] = admit(price.token, price.timestamp, update_key(price));
+    }
+    if (kept == 0) {
+        if (!keep_.empty()) feed_counters_[feed].duplicates.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    feed_counters_[feed].forwarded.fetch_add(1, std::memory_order_relaxed);
     
-    nlohmann::json unsub_msg = {
-        {"type", "unsubscribe"},
-        {"channel", "price"},
-        {"assets_ids", {token_id}}
+    // A frame only partly new is captured whole
+    if (frame_tap_) frame_tap_(msg, frame_ns);
+    stamp_.parsed_ns = latency::now_ns();
+    LatencyMonitor::instance().record(latency::Span::FRAME_TO_PARSE, stamp_.frame_ns, stamp_.parsed_ns);
+    parser_.stamp(stamp_);
+    dispatch_parsed(keep_.data(), keep_.data() + books, keep_.data() + books + deltas);
+}
+
+bool WebSocketPriceStream::admit(TokenId token, uint64_t ts, uint64_t key) {
+    if (ts == 0) {
+        // No timestamp to order it by: recent keys only, so a copy evicted
+        // by a collision can get through again
+        UpdateHash u;
+        u.mix(token);
+        u.mix(key);
+        uint64_t& slot = seen_[u.value() % kDedupSlots];
+        if (slot == u.value()) return false;
+        slot = u.value();
+        return true;
+    }
+    AssetClock& clock = clocks_[token];
+    if (ts < clock.ts) return false;  // Older than what this asset's book already has
+    if (ts > clock.ts) {
+        clock.ts = ts;
+        clock.keys.clear();
+    } else if (std::find(clock.keys.begin(), clock.keys.end(), key) != clock.keys.end()) {
+        return false;  // Same timestamp, same update: a copy
+    }
+    clock.keys.push_back(key);
+    return true;
+}
+
+uint64_t WebSocketPriceStream::frame_key(std::string_view msg) {
+    // FNV-1a; values are separated so "ab","c" differs from "a","bc"
+    constexpr uint64_t kOffset = 14695981039346656037ull;
+    constexpr uint64_t kPrime = 1099511628211ull;
+    uint64_t h = kOffset;
+    auto mix = [&h](std::string_view bytes) {
+        for (unsigned char c : bytes) {
+            h ^= c;
+            h *= kPrime;
+        }
+        h ^= 0xff;
+        h *= kPrime;
     };
     
+    // Books and price changes carry the book hash: with the assets and the
+    // server timestamp it names the update, however the copy is encoded
+    bool hashed = false;
+    for_each_value(msg, "\"hash\"", [&](std::string_view value) {
+        mix(value);
+        hashed = true;
+    });
+    if (hashed) {
+        for_each_value(msg, "\"asset_id\"", mix);
+        for_each_value(msg, "\"timestamp\"", mix);
+    } else {
+        mix(msg);
+    }
+    return h ? h : 1;
+}
+
+void WebSocketPriceStream::inject(std::string_view msg, uint64_t frame_ns) {
+    stamp_.frame_ns = frame_ns;
+    dispatch_message(msg);
+}
+
+void WebSocketPriceStream::dispatch_message(std::string_view msg) {
+    // FAST PATH: schema-specific parser, no DOM and no allocations
+    if (parser_.parse(msg) == MarketMessageParser::Result::PARSED) {
+        stamp_.parsed_ns = latency::now_ns();
+        LatencyMonitor::instance().record(latency::Span::FRAME_TO_PARSE, stamp_.frame_ns, stamp_.parsed_ns);
+        parser_.stamp(stamp_);
+        dispatch_parsed(nullptr, nullptr, nullptr);
+        return;
+    }
+    
+    // FALLBACK: shapes the fast parser doesn't know
     try {
-        ws_->write(net::buffer(unsub_msg.dump()));
-    } catch (...) {}
+        auto j = nlohmann::json::parse(msg.begin(), msg.end());
+        stamp_.parsed_ns = latency::now_ns();
+        LatencyMonitor::instance().record(latency::Span::FRAME_TO_PARSE, stamp_.frame_ns, stamp_.parsed_ns);
+        dispatch_json(j);
+    } catch (const nlohmann::json::exception& e) {
+        // Ignore JSON parse errors for non-price messages
+    }
 }
 
-void WebSocketPriceStream::read_loop() {
-    beast::flat_buffer buffer;
-    int msg_count = 0;
+void WebSocketPriceStream::dispatch_parsed(const uint8_t* keep_books, const uint8_t* keep_deltas,
+                                           const uint8_t* keep_prices) {
+    if (orderbook_callback_) {
+        for (size_t i = 0; i < parser_.book_count(); ++i) {
+            if (!keep_books || keep_books[i]) orderbook_callback_(parser_.book(i));
+        }
+    }
+    if (delta_callback_) {
+        for (size_t i = 0; i < parser_.delta_count(); ++i) {
+            if (!keep_deltas || keep_deltas[i]) delta_callback_(parser_.delta(i));
+        }
+    }
+    if (callback_) {
+        for (size_t i = 0; i < parser_.price_count(); ++i) {
+            if (!keep_prices || keep_prices[i]) callback_(parser_.price(i));
+        }
+    }
+}
+
+namespace {
+
+double number_from_json(const nlohmann::json& v) {
+    return v.is_string() ? std::stod(v.get<std::string>()) : v.get<double>();
+}
+
+// Book price or size: plain wire decimals convert exactly
+template <typename Tag>
+Fixed<Tag> fixed_from_json(const nlohmann::json& v) {
+    Fixed<Tag> out;
+    if (v.is_string() && Fixed<Tag>::parse(v.get_ref<const std::string&>(), out)) return out;
+    return Fixed<Tag>::from_double(number_from_json(v));
+}
+
+// Extract a full book (bids/asks arrays + asset_id) from a JSON object
+OrderbookUpdate book_from_json(const nlohmann::json& j) {
+    OrderbookUpdate book_update;
+    book_update.token = TokenRegistry::instance().find(j["asset_id"].get<std::string>());
     
-    while (running_ && connected_) {
-        try {
-            buffer.clear();
-            ws_->read(buffer);
+    // Extract ALL asks
+    if (j.contains("asks") && j["asks"].is_array()) {
+        for (const auto& ask : j["asks"]) {
+            if (ask.contains("price") && ask.contains("size")) {
+                book_update.asks.push_back(BookLevel{fixed_from_json<PriceTag>(ask["price"]),
+                                                     fixed_from_json<QtyTag>(ask["size"])});
+            }
+        }
+    }
+    
+    // Extract ALL bids
+    if (j.contains("bids") && j["bids"].is_array()) {
+        for (const auto& bid : j["bids"]) {
+            if (bid.contains("price") && bid.contains("size")) {
+                book_update.bids.push_back(BookLevel{fixed_from_json<PriceTag>(bid["price"]),
+                                                     fixed_from_json<QtyTag>(bid["size"])});
+            }
+        }
+    }
+    
+    return book_update;
+}
+
+TokenId token_from_json(const nlohmann::json& j) {
+    auto it = j.find("asset_id");
+    if (it == j.end() || !it->is_string()) return kNoToken;
+    return TokenRegistry::instance().find(it->get_ref<const std::string&>());
+}
+
+// Level change from a price_change entry ("side": BUY/SELL, "size": new total)
+bool delta_from_json(const nlohmann::json& change, TokenId token, Price price, BookDelta& out) {
+    if (token == kNoToken || !price.positive() || !change.contains("size")) return false;
+    std::string side = change.value("side", "");
+    if (side != "BUY" && side != "SELL") return false;
+    out.token = token;
+    out.side = (side == "BUY") ? BookSide::BID : BookSide::ASK;
+    out.price = price;
+    out.size = fixed_from_json<QtyTag>(change["size"]);
+    return true;
+}
+
+// best_bid / best_ask of `top` and the server timestamp of `root` onto a delta
+void top_from_json(const nlohmann::json& top, const nlohmann::json& root, BookDelta& out) {
+    auto given = [&top](const char* key) {
+        auto it = top.find(key);
+        return it != top.end() && (it->is_string() || it->is_number());
+    };
+    out.has_top = given("best_bid") && given("best_ask");
+    if (out.has_top) {
+        out.best_bid = fixed_from_json<PriceTag>(top["best_bid"]);
+        out.best_ask = fixed_from_json<PriceTag>(top["best_ask"]);
+    }
+    auto ts = root.find("timestamp");
+    if (ts != root.end()) {
+        if (ts->is_number_unsigned()) {
+            out.timestamp = ts->get<uint64_t>();
+        } else if (ts->is_string()) {
+            out.timestamp = std::strtoull(ts->get_ref<const std::string&>().c_str(), nullptr, 10);
+        }
+    }
+}
+
+} // namespace
+
+void WebSocketPriceStream::dispatch_json(const nlohmann::json& j) {
+    // PRIORITY 1: Handle array format (initial snapshot)
+    if (j.is_array() && !j.empty()) {
+        for (const auto& item : j) {
+            // Full orderbook snapshot (has bids/asks arrays + asset_id)
+            if (item.contains("asset_id") && (item.contains("bids") || item.contains("asks"))) {
+                auto book_update = book_from_json(item);
+                book_update.stamp = stamp_;
+                if (book_update.token != kNoToken && (!book_update.asks.empty() || !book_update.bids.empty())) {
+                    if (orderbook_callback_) {
+                        orderbook_callback_(book_update);
+                    }
+                }
+            }
+        }
+    }
+    // PRIORITY 2: Single object with full orderbook
+    else if (j.contains("asset_id") && (j.contains("bids") || j.contains("asks")) && !j.contains("price_changes")) {
+        auto book_update = book_from_json(j);
+        book_update.stamp = stamp_;
+        if (book_update.token != kNoToken && (!book_update.asks.empty() || !book_update.bids.empty())) {
+            if (orderbook_callback_) {
+                orderbook_callback_(book_update);
+            }
+        }
+    }
+    // PRIORITY 2: Handle price_changes array (trades, price updates)
+    else if (j.contains("price_changes") && j["price_changes"].is_array()) {
+        for (const auto& change : j["price_changes"]) {
+            PriceUpdate update;
+            update.token = token_from_json(change);
             
-            std::string msg = beast::buffers_to_string(buffer.data());
-            msg_count++;
+            Price price;
+            if (change.contains("price")) {
+                price = fixed_from_json<PriceTag>(change["price"]);
+                update.price = price.to_double();
+            }
             
-            // DEBUG: Show first 20 messages to see what we're getting
-            if (msg_count <= 20) {
-                std::cout << "[WS MSG #" << msg_count << "] " << msg.substr(0, 300) << "..." << std::endl;
+            // Level deltas go to the incremental book; full snapshots still
+            // come from the book channel
+            BookDelta delta;
+            if (delta_callback_ && delta_from_json(change, update.token, price, delta)) {
+                top_from_json(change, j, delta);
+                delta.stamp = stamp_;
+                delta_callback_(delta);
             }
             
-            try {
-                auto j = nlohmann::json::parse(msg);
-                
-                // PRIORITY 1: Handle array format (initial snapshot)
-                if (j.is_array() && !j.empty()) {
-                    for (const auto& item : j) {
-                        // Full orderbook snapshot (has bids/asks arrays + asset_id)
-                        if (item.contains("asset_id") && (item.contains("bids") || item.contains("asks"))) {
-                            OrderbookUpdate book_update;
-                            book_update.token_id = item["asset_id"].get<std::string>();
-                            
-                            // Extract ALL asks
-                            if (item.contains("asks") && item["asks"].is_array()) {
-                                for (const auto& ask : item["asks"]) {
-                                    if (ask.contains("price") && ask.contains("size")) {
-                                        double price = std::stod(ask["price"].get<std::string>());
-                                        double size = std::stod(ask["size"].get<std::string>());
-                                        book_update.asks.push_back(std::make_pair(price, size));
-                                    }
-                                }
-                            }
-                            
-                            // Extract ALL bids
-                            if (item.contains("bids") && item["bids"].is_array()) {
-                                for (const auto& bid : item["bids"]) {
-                                    if (bid.contains("price") && bid.contains("size")) {
-                                        double price = std::stod(bid["price"].get<std::string>());
-                                        double size = std::stod(bid["size"].get<std::string>());
-                                        book_update.bids.push_back(std::make_pair(price, size));
-                                    }
-                                }
-                            }
-                            
-                            if (!book_update.asks.empty() || !book_update.bids.empty()) {
-                                if (orderbook_callback_) {
-                                    orderbook_callback_(book_update);
-                                }
-                            }
-                        }
-                    }
-                }
-                // PRIORITY 2: Single object with full orderbook
-                else if (j.contains("asset_id") && (j.contains("bids") || j.contains("asks")) && !j.contains("price_changes")) {
-                    // Full orderbook snapshot from WebSocket
-                    OrderbookUpdate book_update;
-                    book_update.token_id = j["asset_id"].get<std::string>();
-                    
-                    // Extract ALL asks from book
-                    if (j.contains("asks") && j["asks"].is_array()) {
-                        for (const auto& ask : j["asks"]) {
-                            if (ask.contains("price") && ask.contains("size")) {
-                                double price = std::stod(ask["price"].get<std::string>());
-                                double size = std::stod(ask["size"].get<std::string>());
-                                book_update.asks.push_back(std::make_pair(price, size));
-                            }
-                        }
-                    }
-                    
-                    // Extract ALL bids from book
-                    if (j.contains("bids") && j["bids"].is_array()) {
-                        for (const auto& bid : j["bids"]) {
-                            if (bid.contains("price") && bid.contains("size")) {
-                                double price = std::stod(bid["price"].get<std::string>());
-                                double size = std::stod(bid["size"].get<std::string>());
-                                book_update.bids.push_back(std::make_pair(price, size));
-                            }
-                        }
-                    }
-                    
-                    // Send to orderbook callback (FULL depth)
-                    if (!book_update.asks.empty() || !book_update.bids.empty()) {
-                        if (orderbook_callback_) {
-                            orderbook_callback_(book_update);
-                        }
-                    }
-                }
-                // PRIORITY 2: Handle price_changes array (trades, price updates)
-                else if (j.contains("price_changes") && j["price_changes"].is_array()) {
-                    for (const auto& change : j["price_changes"]) {
-                        PriceUpdate update;
-                        update.token_id = change.value("asset_id", "");
-                        
-                        if (change.contains("price")) {
-                            if (change["price"].is_string()) {
-                                update.price = std::stod(change["price"].get<std::string>());
-                            } else {
-                                update.price = change["price"].get<double>();
-                            }
-                        }
-                        
-                        // Extract best_bid and best_ask for orderbook
-                        double best_bid = 0.0, best_ask = 0.0;
-                        if (change.contains("best_bid")) {
-                            if (change["best_bid"].is_string()) {
-                                best_bid = std::stod(change["best_bid"].get<std::string>());
-                            } else if (change["best_bid"].is_number()) {
-                                best_bid = change["best_bid"].get<double>();
-                            }
-                        }
-                        if (change.contains("best_ask")) {
-                            if (change["best_ask"].is_string()) {
-                                best_ask = std::stod(change["best_ask"].get<std::string>());
-                            } else if (change["best_ask"].is_number()) {
-                                best_ask = change["best_ask"].get<double>();
-                            }
-                        }
-                        
-                        // DON'T send orderbook updates from price_changes - 
-                        // they would overwrite full book snapshots from book channel
-                        // Just use price callback for price updates
-                        
-                        if (!update.token_id.empty() && update.price > 0 && callback_) {
-                            callback_(update);
-                        }
-                    }
-                }
-                // Handle event_type format
-                else if (j.contains("event_type")) {
-                    std::string event_type = j["event_type"];
-                    
-                    if (event_type == "price_change" && j.contains("asset_id")) {
-                        PriceUpdate update;
-                        update.token_id = j["asset_id"];
-                        
-                        if (j.contains("price")) {
-                            if (j["price"].is_string()) {
-                                update.price = std::stod(j["price"].get<std::string>());
-                            } else {
-                                update.price = j["price"].get<double>();
-                            }
-                        }
-                        
-                        if (j.contains("best_bid")) {
-                            if (j["best_bid"].is_string()) {
-                                update.best_bid = std::stod(j["best_bid"].get<std::string>());
-                            } else {
-                                update.best_bid = j["best_bid"].get<double>();
-                            }
-                        }
-                        
-                        if (j.contains("best_ask")) {
-                            if (j["best_ask"].is_string()) {
-                                update.best_ask = std::stod(j["best_ask"].get<std::string>());
-                            } else {
-                                update.best_ask = j["best_ask"].get<double>();
-                            }
-                        }
-                        
-                        if (callback_) {
-                            callback_(update);
-                        }
-                    }
-                }
-                // Handle book snapshots (has asset_id + bids/asks arrays)
-                else if (j.contains("asset_id") && (j.contains("bids") || j.contains("asks"))) {
-                    // Full orderbook snapshot from WebSocket
-                    OrderbookUpdate book_update;
-                    book_update.token_id = j["asset_id"].get<std::string>();
-                    
-                    // Extract ALL asks from book
-                    if (j.contains("asks") && j["asks"].is_array()) {
-                        for (const auto& ask : j["asks"]) {
-                            if (ask.contains("price") && ask.contains("size")) {
-                                double price = std::stod(ask["price"].get<std::string>());
-                                double size = std::stod(ask["size"].get<std::string>());
-                                book_update.asks.push_back(std::make_pair(price, size));
-                            }
-                        }
-                    }
-                    
-                    // Extract ALL bids from book
-                    if (j.contains("bids") && j["bids"].is_array()) {
-                        for (const auto& bid : j["bids"]) {
-                            if (bid.contains("price") && bid.contains("size")) {
-                                double price = std::stod(bid["price"].get<std::string>());
-                                double size = std::stod(bid["size"].get<std::string>());
-                                book_update.bids.push_back(std::make_pair(price, size));
-                            }
-                        }
-                    }
-                    
-                    // Send to orderbook callback (FULL depth)
-                    if (!book_update.asks.empty() || !book_update.bids.empty()) {
-                        if (orderbook_callback_) {
-                            orderbook_callback_(book_update);
-                        }
-                    }
-                }
-                // Handle last_trade_price updates
-                else if (j.contains("type") && j["type"] == "last_trade_price") {
-                    PriceUpdate update;
-                    update.token_id = j.value("asset_id", "");
-                    
-                    if (j.contains("price")) {
-                        if (j["price"].is_string()) {
-                            update.price = std::stod(j["price"].get<std::string>());
-                        } else {
-                            update.price = j["price"].get<double>();
-                        }
-                    }
-                    
-                    if (!update.token_id.empty() && update.price > 0 && callback_) {
-                        callback_(update);
-                    }
-                }
-                // Also handle direct price updates (legacy format)
-                else if (j.contains("asset_id") && j.contains("price")) {
-                    PriceUpdate update;
-                    update.token_id = j["asset_id"];
-                    
-                    if (j["price"].is_string()) {
-                        update.price = std::stod(j["price"].get<std::string>());
-                    } else {
-                        update.price = j["price"].get<double>();
-                    }
-                    
-                    if (callback_) {
-                        callback_(update);
+            if (update.token != kNoToken && update.price > 0 && callback_) {
+                callback_(update);
+            }
+        }
+    }
+    // Handle event_type format
+    else if (j.contains("event_type")) {
+        std::string event_type = j["event_type"];
+        
+        if (event_type == "price_change" && j.contains("asset_id")) {
+            PriceUpdate update;
+            update.token = token_from_json(j);
+            
+            if (j.contains("price")) update.price = number_from_json(j["price"]);
+            if (j.contains("best_bid")) update.best_bid = number_from_json(j["best_bid"]);
+            if (j.contains("best_ask")) update.best_ask = number_from_json(j["best_ask"]);
+            
+            // Older format: level changes nested under "changes"
+            if (delta_callback_ && j.contains("changes") && j["changes"].is_array()) {
+                for (const auto& change : j["changes"]) {
+                    if (!change.is_object() || !change.contains("price")) continue;
+                    BookDelta delta;
+                    if (delta_from_json(change, update.token, fixed_from_json<PriceTag>(change["price"]), delta)) {
+                        top_from_json(j, j, delta);
+                        delta.stamp = stamp_;
+                        delta_callback_(delta);
                     }
                 }
-                
-            } catch (const nlohmann::json::exception& e) {
-                // Ignore JSON parse errors for non-price messages
             }
             
-        } catch (const beast::system_error& e) {
-            std::cerr << "[WS] Read error: " << e.what() << " (code: " << e.code().value() << ")" << std::endl;
-            break;
+            if (update.token != kNoToken && callback_) {
+                callback_(update);
+            }
+        } else if (event_type == "last_trade_price") {
+            PriceUpdate update;
+            update.token = token_from_json(j);
+            update.trade = true;
+            if (j.contains("price")) update.price = number_from_json(j["price"]);
+            
+            if (update.token != kNoToken && update.price > 0 && callback_) {
+                callback_(update);
+            }
+        }
+    }
+    // Handle book snapshots (has asset_id + bids/asks arrays)
+    else if (j.contains("asset_id") && (j.contains("bids") || j.contains("asks"))) {
+        auto book_update = book_from_json(j);
+        book_update.stamp = stamp_;
+        if (book_update.token != kNoToken && (!book_update.asks.empty() || !book_update.bids.empty())) {
+            if (orderbook_callback_) {
+                orderbook_callback_(book_update);
+            }
+        }
+    }
+    // Handle last_trade_price updates
+    else if (j.contains("type") && j["type"] == "last_trade_price") {
+        PriceUpdate update;
+        update.token = token_from_json(j);
+        update.trade = true;
+        
+        if (j.contains("price")) update.price = number_from_json(j["price"]);
+        
+        if (update.token != kNoToken && update.price > 0 && callback_) {
+            callback_(update);
+        }
+    }
+    // Also handle direct price updates (legacy format)
+    else if (j.contains("asset_id") && j.contains("price")) {
+        PriceUpdate update;
+        update.token = token_from_json(j);
+        update.price = number_from_json(j["price"]);
+        
+        if (update.token != kNoToken && callback_) {
+            callback_(update);
         }
     }
-    
-    connected_ = false;
-    std::cout << "[WS] Disconnected after " << msg_count << " messages" << std::endl;
 }
 
 } // namespace poly
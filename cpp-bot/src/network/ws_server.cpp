@@ -1,4 +1,6 @@
 #include "ws_server.hpp"
+#include "io_pool.hpp"
+#include <algorithm>
 #include <iostream>
 
 namespace poly {
@@ -17,6 +19,8 @@ void WSSession::run() {
     
     ws_.async_accept([self = shared_from_this()](beast::error_code ec) {
         if (!ec) {
+            self->open_ = true;
+            if (!self->queue_.empty()) self->do_write();
             self->do_read();
         } else {
             self->on_close_(self);
@@ -35,17 +39,55 @@ void WSSession::do_read() {
     });
 }
 
-void WSSession::send(const std::string& msg) {
-    auto self = shared_from_this();
-    ws_.async_write(net::buffer(msg), [self](beast::error_code ec, std::size_t) {
+void WSSession::send(std::shared_ptr<const std::string> msg) {
+    net::post(ws_.get_executor(), [self = shared_from_this(), msg = std::move(msg)]() mutable {
+        if (self->queue_.size() >= kMaxQueued) return;
+        self->enqueue(Outbound{std::move(msg), false});
+    });
+}
+
+void WSSession::send_status(std::shared_ptr<const std::string> msg, bool full) {
+    net::post(ws_.get_executor(), [self = shared_from_this(), msg = std::move(msg), full]() mutable {
+        if (self->status_queued_ >= kMaxStatusQueued) {
+            // Falling behind: drop the waiting status frames (not the one
+            // on the wire); a full frame stands on its own, a delta doesn't
+            auto& q = self->queue_;
+            auto first = q.begin() + (self->writing_ ? 1 : 0);
+            q.erase(std::remove_if(first, q.end(), [](const Outbound& f) { return f.status; }), q.end());
+            self->status_queued_ = self->writing_ && q.front().status ? 1 : 0;
+            if (!full) {
+                self->resync_ = true;
+                return;
+            }
+        }
+        self->status_queued_++;
+        self->enqueue(Outbound{std::move(msg), true});
+    });
+}
+
+void WSSession::enqueue(Outbound frame) {
+    queue_.push_back(std::move(frame));
+    if (open_ && !writing_) do_write();
+}
+
+void WSSession::do_write() {
+    writing_ = true;
+    ws_.async_write(net::buffer(*queue_.front().data), [self = shared_from_this()](beast::error_code ec, std::size_t) {
+        self->writing_ = false;
         if (ec) {
+            self->queue_.clear();
+            self->status_queued_ = 0;
             self->on_close_(self);
+            return;
         }
+        if (self->queue_.front().status) self->status_queued_--;
+        self->queue_.pop_front();
+        if (!self->queue_.empty()) self->do_write();
     });
 }
 
 WSServer::WSServer(unsigned short port)
-    : acceptor_(ioc_, tcp::endpoint(tcp::v4(), port)) {
+    : acceptor_(net::make_strand(IoPool::instance().context()), tcp::endpoint(tcp::v4(), port)) {
     acceptor_.set_option(net::socket_base::reuse_address(true));
 }
 
@@ -53,19 +95,22 @@ WSServer::~WSServer() { stop(); }
 
 void WSServer::start() {
     if (running_.exchange(true)) return;
-    do_accept();
-    worker_ = std::thread([this] { ioc_.run(); });
+    IoPool::instance().start();
+    net::post(acceptor_.get_executor(), [this] { do_accept(); });
     std::cout << "[WS-SERVER] Dashboard WebSocket started on port 3002" << std::endl;
 }
 
 void WSServer::stop() {
-    running_ = false;
-    ioc_.stop();
-    if (worker_.joinable()) worker_.join();
+    if (!running_.exchange(false)) return;
+    net::post(acceptor_.get_executor(), [this] {
+        beast::error_code ec;
+        acceptor_.close(ec);
+    });
 }
 
 void WSServer::do_accept() {
-    acceptor_.async_accept([this](beast::error_code ec, tcp::socket socket) {
+    acceptor_.async_accept(net::make_strand(IoPool::instance().context()), [this](beast::error_code ec, tcp::socket socket) {
+        if (!running_) return;
         if (!ec) {
             auto session = std::make_shared<WSSession>(
                 std::move(socket),
@@ -77,7 +122,7 @@ void WSServer::do_accept() {
             }
             session->run();
         }
-        if (running_) do_accept();
+        do_accept();
     });
 }
 
@@ -87,9 +132,28 @@ void WSServer::on_session_close(std::shared_ptr<WSSession> session) {
 }
 
 void WSServer::broadcast(const std::string& msg) {
+    auto shared = std::make_shared<const std::string>(msg);  // One copy for every session
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    for (auto& session : sessions_) {
+        session->send(shared);
+    }
+}
+
+void WSServer::broadcast_status(uint64_t version, const std::shared_ptr<const std::string>& delta,
+                                const std::function<std::shared_ptr<const std::string>()>& make_full) {
+    std::shared_ptr<const std::string> full;
     std::lock_guard<std::mutex> lock(sessions_mutex_);
     for (auto& session : sessions_) {
-        session->send(msg);
+        bool resync = session->take_resync();
+        uint64_t synced = session->synced_version();
+        if (!resync && synced == version) continue;  // Already has everything
+        if (!resync && delta && synced != 0 && synced + 1 == version) {
+            session->send_status(delta, false);
+        } else {
+            if (!full) full = make_full();
+            session->send_status(full, true);
+        }
+        session->set_synced_version(version);
     }
 }
 
@@ -98,6 +162,10 @@ void start_ws_server(unsigned short port) {
     g_ws_server->start();
 }
 
+void stop_ws_server() {
+    if (g_ws_server) g_ws_server->stop();
+}
+
 void broadcast_status(const std::string& json) {
     if (g_ws_server) g_ws_server->broadcast(json);
 }
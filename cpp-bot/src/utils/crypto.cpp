@@ -0,0 +1,368 @@
+#include "crypto.hpp"
+#include <cstring>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/obj_mac.h>
+
+namespace poly {
+namespace crypto {
+
+// ============ KECCAK-256 ============
+
+namespace {
+    constexpr uint64_t kRoundConstants[24] = {
+        0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+        0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+        0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+        0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+        0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+        0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+        0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+        0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+    };
+    constexpr int kRotations[24] = {
+        1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
+    };
+    constexpr int kPiLanes[24] = {
+        10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
+    };
+    constexpr size_t kRate = 136;  // 1088-bit rate for a 256-bit output
+
+    inline uint64_t rotl(uint64_t x, int n) { return (x << n) | (x >> (64 - n)); }
+
+    void keccak_f(uint64_t st[25]) {
+        uint64_t bc[5];
+        for (int round = 0; round < 24; ++round) {
+            // Theta
+            for (int i = 0; i < 5; ++i) {
+                bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
+            }
+            for (int i = 0; i < 5; ++i) {
+                uint64_t t = bc[(i + 4) % 5] ^ rotl(bc[(i + 1) % 5], 1);
+                for (int j = 0; j < 25; j += 5) st[j + i] ^= t;
+            }
+            // Rho + Pi
+            uint64_t t = st[1];
+            for (int i = 0; i < 24; ++i) {
+                int j = kPiLanes[i];
+                uint64_t tmp = st[j];
+                st[j] = rotl(t, kRotations[i]);
+                t = tmp;
+            }
+            // Chi
+            for (int j = 0; j < 25; j += 5) {
+                for (int i = 0; i < 5; ++i) bc[i] = st[j + i];
+                for (int i = 0; i < 5; ++i) st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
+            }
+            // Iota
+            st[0] ^= kRoundConstants[round];
+        }
+    }
+
+    void absorb_block(uint64_t st[25], const uint8_t* block) {
+        for (size_t i = 0; i < kRate / 8; ++i) {
+            uint64_t lane = 0;
+            for (int b = 7; b >= 0; --b) lane = (lane << 8) | block[i * 8 + b];
+            st[i] ^= lane;
+        }
+        keccak_f(st);
+    }
+}
+
+Hash256 keccak256(const uint8_t* data, size_t len) {
+    uint64_t st[25] = {};
+    while (len >= kRate) {
+        absorb_block(st, data);
+        data += kRate;
+        len -= kRate;
+    }
+
+    uint8_t last[kRate] = {};
+    if (len) std::memcpy(last, data, len);
+    last[len] ^= 0x01;
+    last[kRate - 1] ^= 0x80;
+    absorb_block(st, last);
+
+    Hash256 out;
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = static_cast<uint8_t>(st[i / 8] >> (8 * (i % 8)));
+    }
+    return out;
+}
+
+// ============ HMAC / ENCODING ============
+
+std::array<uint8_t, 32> hmac_sha256(const std::vector<uint8_t>& key, std::string_view message) {
+    std::array<uint8_t, 32> out{};
+    unsigned int out_len = 0;
+    HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+         reinterpret_cast<const unsigned char*>(message.data()), message.size(),
+         out.data(), &out_len);
+    return out;
+}
+
+std::string to_hex(const uint8_t* data, size_t len, bool prefix) {
+    static const char* digits = "0123456789abcdef";
+    std::string out;
+    out.reserve(len * 2 + 2);
+    if (prefix) out += "0x";
+    for (size_t i = 0; i < len; ++i) {
+        out += digits[data[i] >> 4];
+        out += digits[data[i] & 0x0f];
+    }
+    return out;
+}
+
+namespace {
+    int hex_value(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+bool from_hex(std::string_view hex, std::vector<uint8_t>& out) {
+    if (hex.size() >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) hex.remove_prefix(2);
+    if (hex.size() % 2 != 0) return false;
+    out.clear();
+    out.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int hi = hex_value(hex[i]);
+        int lo = hex_value(hex[i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out.push_back(static_cast<uint8_t>((hi << 4) | lo));
+    }
+    return true;
+}
+
+bool uint256_from_decimal(std::string_view decimal, uint8_t out[32]) {
+    if (decimal.empty() || decimal.size() > 78) return false;
+    for (char c : decimal) {
+        if (c < '0' || c > '9') return false;
+    }
+    std::string digits(decimal);
+    BIGNUM* bn = nullptr;
+    if (!BN_dec2bn(&bn, digits.c_str())) return false;
+    bool ok = BN_num_bytes(bn) <= 32 && BN_bn2binpad(bn, out, 32) == 32;
+    BN_free(bn);
+    return ok;
+}
+
+std::string base64url_encode(const uint8_t* data, size_t len) {
+    static const char* alphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::string out;
+    out.reserve((len + 2) / 3 * 4);
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t n = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < len) n |= static_cast<uint32_t>(data[i + 1]) << 8;
+        if (i + 2 < len) n |= data[i + 2];
+        out += alphabet[(n >> 18) & 63];
+        out += alphabet[(n >> 12) & 63];
+        out += i + 1 < len ? alphabet[(n >> 6) & 63] : '=';
+        out += i + 2 < len ? alphabet[n & 63] : '=';
+    }
+    return out;
+}
+
+bool base64url_decode(std::string_view text, std::vector<uint8_t>& out) {
+    out.clear();
+    uint32_t acc = 0;
+    int bits = 0;
+    for (char c : text) {
+        int v;
+        if (c >= 'A' && c <= 'Z') v = c - 'A';
+        else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') v = c - '0' + 52;
+        else if (c == '-' || c == '+') v = 62;
+        else if (c == '_' || c == '/') v = 63;
+        else if (c == '=') break;
+        else return false;
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<uint8_t>(acc >> bits));
+        }
+    }
+    return true;
+}
+
+std::string checksum_address(const uint8_t* addr20) {
+    std::string lower = to_hex(addr20, 20, false);
+    Hash256 h = keccak256(lower);
+    std::string out = "0x";
+    for (size_t i = 0; i < lower.size(); ++i) {
+        char c = lower[i];
+        int nibble = (i % 2 == 0) ? (h[i / 2] >> 4) : (h[i / 2] & 0x0f);
+        out += (c >= 'a' && nibble >= 8) ? static_cast<char>(c - 'a' + 'A') : c;
+    }
+    return out;
+}
+
+// ============ SECP256K1 SIGNER ============
+
+struct Secp256k1Signer::Impl {
+    EC_GROUP* group = nullptr;
+    BIGNUM* key = nullptr;
+    std::array<uint8_t, 32> key_bytes{};
+
+    ~Impl() {
+        BN_clear_free(key);
+        EC_GROUP_free(group);
+        OPENSSL_cleanse(key_bytes.data(), key_bytes.size());
+    }
+};
+
+Secp256k1Signer::Secp256k1Signer() : impl_(new Impl) {
+    impl_->group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+}
+
+Secp256k1Signer::~Secp256k1Signer() {
+    delete impl_;
+}
+
+bool Secp256k1Signer::load_private_key(std::string_view hex) {
+    loaded_ = false;
+    std::vector<uint8_t> bytes;
+    if (!impl_->group || !from_hex(hex, bytes) || bytes.size() != 32) return false;
+
+    const BIGNUM* order = EC_GROUP_get0_order(impl_->group);
+    BIGNUM* d = BN_bin2bn(bytes.data(), 32, nullptr);
+    if (!d || BN_is_zero(d) || BN_cmp(d, order) >= 0) {
+        BN_clear_free(d);
+        return false;
+    }
+    BN_set_flags(d, BN_FLG_CONSTTIME);
+
+    // Address = last 20 bytes of keccak(uncompressed public key without 0x04)
+    BN_CTX* ctx = BN_CTX_new();
+    EC_POINT* pub = EC_POINT_new(impl_->group);
+    uint8_t pub_bytes[65];
+    bool ok = ctx && pub &&
+        EC_POINT_mul(impl_->group, pub, d, nullptr, nullptr, ctx) &&
+        EC_POINT_point2oct(impl_->group, pub, POINT_CONVERSION_UNCOMPRESSED,
+                           pub_bytes, sizeof(pub_bytes), ctx) == sizeof(pub_bytes);
+    EC_POINT_free(pub);
+    BN_CTX_free(ctx);
+    if (!ok) {
+        BN_clear_free(d);
+        return false;
+    }
+
+    Hash256 h = keccak256(pub_bytes + 1, 64);
+    address_ = checksum_address(h.data() + 12);
+
+    BN_clear_free(impl_->key);
+    impl_->key = d;
+    std::memcpy(impl_->key_bytes.data(), bytes.data(), 32);
+    OPENSSL_cleanse(bytes.data(), bytes.size());
+    loaded_ = true;
+    return true;
+}
+
+namespace {
+    // HMAC-SHA256 over the concatenation of up to four byte ranges
+    void hmac_concat(const uint8_t* key, const uint8_t* a, size_t a_len,
+                     const uint8_t* b, size_t b_len, const uint8_t* c, size_t c_len,
+                     const uint8_t* d, size_t d_len, uint8_t out[32]) {
+        uint8_t buf[32 + 1 + 32 + 32];
+        size_t n = 0;
+        std::memcpy(buf + n, a, a_len); n += a_len;
+        if (b_len) { std::memcpy(buf + n, b, b_len); n += b_len; }
+        if (c_len) { std::memcpy(buf + n, c, c_len); n += c_len; }
+        if (d_len) { std::memcpy(buf + n, d, d_len); n += d_len; }
+        unsigned int out_len = 0;
+        HMAC(EVP_sha256(), key, 32, buf, n, out, &out_len);
+        OPENSSL_cleanse(buf, sizeof(buf));
+    }
+}
+
+bool Secp256k1Signer::sign_digest(const Hash256& digest, std::array<uint8_t, 65>& sig_out) const {
+    if (!loaded_) return false;
+
+    const EC_GROUP* group = impl_->group;
+    const BIGNUM* n = EC_GROUP_get0_order(group);
+    BN_CTX* ctx = BN_CTX_new();
+    if (!ctx) return false;
+    BN_CTX_start(ctx);
+    BIGNUM* z = BN_CTX_get(ctx);
+    BIGNUM* k = BN_CTX_get(ctx);
+    BIGNUM* k_inv = BN_CTX_get(ctx);
+    BIGNUM* x = BN_CTX_get(ctx);
+    BIGNUM* y = BN_CTX_get(ctx);
+    BIGNUM* r = BN_CTX_get(ctx);
+    BIGNUM* s = BN_CTX_get(ctx);
+    BIGNUM* half_n = BN_CTX_get(ctx);
+    EC_POINT* R = EC_POINT_new(group);
+    bool ok = s && R;
+
+    // z = digest mod n, also the RFC 6979 h1 input
+    uint8_t h1[32];
+    if (ok) {
+        ok = BN_bin2bn(digest.data(), 32, z) && BN_nnmod(z, z, n, ctx) &&
+             BN_bn2binpad(z, h1, 32) == 32 && BN_rshift1(half_n, n);
+    }
+
+    // RFC 6979 section 3.2 with HMAC-SHA256
+    uint8_t V[32], K[32];
+    std::memset(V, 0x01, sizeof(V));
+    std::memset(K, 0x00, sizeof(K));
+    const uint8_t zero = 0x00, one = 0x01;
+    const uint8_t* x_bytes = impl_->key_bytes.data();
+    hmac_concat(K, V, 32, &zero, 1, x_bytes, 32, h1, 32, K);
+    hmac_concat(K, V, 32, nullptr, 0, nullptr, 0, nullptr, 0, V);
+    hmac_concat(K, V, 32, &one, 1, x_bytes, 32, h1, 32, K);
+    hmac_concat(K, V, 32, nullptr, 0, nullptr, 0, nullptr, 0, V);
+
+    int recid = 0;
+    while (ok) {
+        hmac_concat(K, V, 32, nullptr, 0, nullptr, 0, nullptr, 0, V);
+        ok = BN_bin2bn(V, 32, k) != nullptr;
+        if (!ok) break;
+        BN_set_flags(k, BN_FLG_CONSTTIME);
+
+        if (!BN_is_zero(k) && BN_cmp(k, n) < 0) {
+            // R = kG, r = R.x mod n, s = k^-1 (z + r d) mod n
+            ok = EC_POINT_mul(group, R, k, nullptr, nullptr, ctx) &&
+                 EC_POINT_get_affine_coordinates(group, R, x, y, ctx) &&
+                 BN_nnmod(r, x, n, ctx) &&
+                 BN_mod_inverse(k_inv, k, n, ctx) != nullptr &&
+                 BN_mod_mul(s, r, impl_->key, n, ctx) &&
+                 BN_mod_add(s, s, z, n, ctx) &&
+                 BN_mod_mul(s, s, k_inv, n, ctx);
+            if (!ok) break;
+
+            if (!BN_is_zero(r) && !BN_is_zero(s)) {
+                recid = (BN_is_odd(y) ? 1 : 0) | (BN_cmp(x, n) >= 0 ? 2 : 0);
+                // Low-s form (EIP-2); negating s flips the recovery parity
+                if (BN_cmp(s, half_n) > 0) {
+                    ok = BN_sub(s, n, s);
+                    recid ^= 1;
+                }
+                break;
+            }
+        }
+        hmac_concat(K, V, 32, &zero, 1, nullptr, 0, nullptr, 0, K);
+        hmac_concat(K, V, 32, nullptr, 0, nullptr, 0, nullptr, 0, V);
+    }
+
+    if (ok) {
+        ok = BN_bn2binpad(r, sig_out.data(), 32) == 32 &&
+             BN_bn2binpad(s, sig_out.data() + 32, 32) == 32;
+        sig_out[64] = static_cast<uint8_t>(27 + recid);
+    }
+
+    OPENSSL_cleanse(V, sizeof(V));
+    OPENSSL_cleanse(K, sizeof(K));
+    EC_POINT_free(R);
+    BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
+    return ok;
+}
+
+} // namespace crypto
+} // namespace poly
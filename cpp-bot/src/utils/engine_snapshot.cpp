@@ -0,0 +1,310 @@
+#include "engine_snapshot.hpp"
+#include "logger.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace poly {
+
+namespace {
+
+constexpr uint64_t kMinSlotBytes = 64 * 1024;
+
+int64_t wall_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint32_t payload_crc(const uint8_t* data, size_t n) {
+    return static_cast<uint32_t>(crc32(crc32(0L, Z_NULL, 0), data, static_cast<uInt>(n)));
+}
+
+size_t file_bytes(uint64_t slot_bytes) {
+    return sizeof(SnapshotFileHeader) + 2 * static_cast<size_t>(slot_bytes);
+}
+
+uint8_t* slot_at(uint8_t* base, uint64_t slot_bytes, size_t index) {
+    return base + sizeof(SnapshotFileHeader) + index * slot_bytes;
+}
+
+// Room for the payload twice over, so a growing engine rebuilds rarely
+uint64_t slot_size_for(size_t payload_bytes) {
+    uint64_t need = 2 * (sizeof(SnapshotSlotHeader) + payload_bytes);
+    uint64_t size = kMinSlotBytes;
+    while (size < need) size *= 2;
+    return size;
+}
+
+// The valid slot with the highest sequence; -1 if neither is
+int newest_slot(const uint8_t* base, size_t size, uint64_t slot_bytes) {
+    int best = -1;
+    uint64_t best_seq = 0;
+    for (size_t i = 0; i < 2; ++i) {
+        const uint8_t* slot = base + sizeof(SnapshotFileHeader) + i * slot_bytes;
+        if (slot + slot_bytes > base + size) break;
+        SnapshotSlotHeader header;
+        std::memcpy(&header, slot, sizeof(header));
+        if (header.seq == 0 || header.payload_bytes > slot_bytes - sizeof(header)) continue;
+        if (payload_crc(slot + sizeof(header), header.payload_bytes) != header.crc) continue;
+        if (best < 0 || header.seq > best_seq) {
+            best = static_cast<int>(i);
+            best_seq = header.seq;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+SnapshotFile::SnapshotFile(std::string path) : path_(std::move(path)) {}
+
+SnapshotFile::~SnapshotFile() {
+    unmap();
+}
+
+void SnapshotFile::unmap() {
+    if (base_) munmap(base_, mapped_);
+    if (fd_ >= 0) ::close(fd_);
+    base_ = nullptr;
+    mapped_ = 0;
+    fd_ = -1;
+    slot_bytes_ = 0;
+}
+
+bool SnapshotFile::map(uint64_t slot_bytes, std::string& error) {
+    fd_ = ::open(path_.c_str(), O_RDWR);
+    if (fd_ < 0) {
+        error = "cannot open " + path_ + ": " + std::strerror(errno);
+        return false;
+    }
+    const size_t size = file_bytes(slot_bytes);
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        error = "mmap failed for " + path_ + ": " + std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(data);
+    mapped_ = size;
+    slot_bytes_ = slot_bytes;
+    return true;
+}
+
+bool SnapshotFile::rebuild(uint64_t slot_bytes, const std::vector<uint8_t>& payload, int64_t written_ms,
+                           std::string& error) {
+    unmap();
+    const std::string tmp = path_ + ".tmp";
+    int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = "cannot create " + tmp + ": " + std::strerror(errno);
+        return false;
+    }
+    SnapshotFileHeader file_header{};
+    std::memcpy(file_header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    file_header.slot_bytes = slot_bytes;
+    SnapshotSlotHeader slot_header{};
+    slot_header.seq = ++seq_;
+    current_ = 0;
+    slot_header.written_ms = written_ms;
+    slot_header.payload_bytes = static_cast<uint32_t>(payload.size());
+    slot_header.crc = payload_crc(payload.data(), payload.size());
+
+    const off_t slot0 = static_cast<off_t>(sizeof(SnapshotFileHeader));
+    bool ok = ::ftruncate(fd, static_cast<off_t>(file_bytes(slot_bytes))) == 0 &&
+              ::pwrite(fd, &file_header, sizeof(file_header), 0) == static_cast<ssize_t>(sizeof(file_header)) &&
+              ::pwrite(fd, &slot_header, sizeof(slot_header), slot0) == static_cast<ssize_t>(sizeof(slot_header)) &&
+              ::pwrite(fd, payload.data(), payload.size(), slot0 + static_cast<off_t>(sizeof(slot_header))) ==
+                  static_cast<ssize_t>(payload.size()) &&
+              ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+        error = "cannot write " + tmp + ": " + std::strerror(errno);
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return map(slot_bytes, error);
+}
+
+bool SnapshotFile::write(const std::vector<uint8_t>& payload, int64_t written_ms, std::string& error) {
+    // First write: continue an existing file's sequence
+    if (!base_) {
+        int fd = ::open(path_.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            SnapshotFileHeader header{};
+            struct stat st {};
+            bool usable = ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                          std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0 &&
+                          ::fstat(fd, &st) == 0 && header.slot_bytes >= kMinSlotBytes &&
+                          static_cast<size_t>(st.st_size) == file_bytes(header.slot_bytes);
+            ::close(fd);
+            if (usable && map(header.slot_bytes, error)) {
+                for (size_t i = 0; i < 2; ++i) {
+                    SnapshotSlotHeader slot;
+                    std::memcpy(&slot, slot_at(base_, slot_bytes_, i), sizeof(slot));
+                    seq_ = std::max(seq_, slot.seq);
+                }
+                // Never overwrite the one intact checkpoint
+                int valid = newest_slot(base_, mapped_, slot_bytes_);
+                current_ = valid < 0 ? 1 : static_cast<size_t>(valid);
+            }
+        }
+    }
+    if (!base_ || sizeof(SnapshotSlotHeader) + payload.size() > slot_bytes_) {
+        return rebuild(slot_size_for(payload.size()), payload, written_ms, error);
+    }
+
+    // The other slot: retire its header, fill it, then stamp it
+    const size_t next = 1 - current_;
+    uint8_t* slot = slot_at(base_, slot_bytes_, next);
+    SnapshotSlotHeader header{};
+    std::memcpy(slot, &header, sizeof(header));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot + sizeof(header), payload.data(), payload.size());
+    header.written_ms = written_ms;
+    header.payload_bytes = static_cast<uint32_t>(payload.size());
+    header.crc = payload_crc(payload.data(), payload.size());
+    std::memcpy(slot, &header, sizeof(header));
+    std::atomic_thread_fence(std::memory_order_release);
+    const uint64_t seq = ++seq_;
+    std::memcpy(slot + offsetof(SnapshotSlotHeader, seq), &seq, sizeof(seq));
+    current_ = next;
+    return true;
+}
+
+void SnapshotFile::sync() {
+    if (base_) msync(base_, mapped_, MS_SYNC);
+}
+
+bool SnapshotFile::load(const std::string& path, std::vector<uint8_t>& payload, int64_t& written_ms,
+                        std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = errno == ENOENT ? "no snapshot at " + path : "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotFileHeader)) {
+        ::close(fd);
+        error = "not a snapshot file: " + path;
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        error = "mmap failed for " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    const auto* base = static_cast<const uint8_t*>(data);
+
+    SnapshotFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    bool found = false;
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 ||
+        header.slot_bytes < sizeof(SnapshotSlotHeader)) {
+        error = "not a snapshot file: " + path;
+    } else {
+        int slot = newest_slot(base, size, header.slot_bytes);
+        if (slot < 0) {
+            error = "no intact checkpoint in " + path;
+        } else {
+            const uint8_t* at = base + sizeof(SnapshotFileHeader) + static_cast<size_t>(slot) * header.slot_bytes;
+            SnapshotSlotHeader slot_header;
+            std::memcpy(&slot_header, at, sizeof(slot_header));
+            payload.assign(at + sizeof(slot_header), at + sizeof(slot_header) + slot_header.payload_bytes);
+            written_ms = slot_header.written_ms;
+            found = true;
+        }
+    }
+    munmap(data, size);
+    return found;
+}
+
+EngineCheckpointer::EngineCheckpointer(std::string path, Source source, Options options)
+    : file_(std::move(path))
+    , source_(std::move(source))
+    , options_(options) {
+}
+
+EngineCheckpointer::~EngineCheckpointer() {
+    stop();
+}
+
+void EngineCheckpointer::start() {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread(&EngineCheckpointer::run, this);
+    POLY_LOG_INFO("SNAPSHOT", "Checkpointing to {} every {}ms", file_.path(), options_.interval_ms);
+}
+
+void EngineCheckpointer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(run_mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    checkpoint();  // The state as the engine left it
+    file_.sync();
+    auto s = stats();
+    POLY_LOG_INFO("SNAPSHOT", "Stopped: {} checkpoints, last {} bytes, {} errors", s.checkpoints, s.last_bytes,
+                  s.errors);
+}
+
+void EngineCheckpointer::run() {
+    const auto interval = std::chrono::milliseconds(std::max(1, options_.interval_ms));
+    std::unique_lock<std::mutex> lock(run_mutex_);
+    while (running_) {
+        cv_.wait_for(lock, interval, [this] { return !running_; });
+        if (!running_) break;
+        lock.unlock();
+        checkpoint();
+        lock.lock();
+    }
+}
+
+void EngineCheckpointer::checkpoint() {
+    const auto started = std::chrono::steady_clock::now();
+    buffer_.clear();
+    if (!source_ || !source_(buffer_)) {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.unchanged++;
+        return;
+    }
+    std::string error;
+    const int64_t now_ms = wall_now_ms();
+    const bool ok = file_.write(buffer_, now_ms, error);
+    const uint64_t us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count());
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (!ok) {
+        stats_.errors++;
+        if (!failing_) POLY_LOG_ERROR("SNAPSHOT", "Checkpoint failed: {}", error);  // Once per run of failures
+        failing_ = true;
+        return;
+    }
+    failing_ = false;
+    stats_.checkpoints++;
+    stats_.last_bytes = buffer_.size();
+    stats_.last_us = us;
+    stats_.max_us = std::max(stats_.max_us, us);
+    stats_.last_ms = now_ms;
+}
+
+EngineCheckpointer::Stats EngineCheckpointer::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+} // namespace poly
@@ -0,0 +1,467 @@
+#include "frame_capture.hpp"
+#include "latency.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace poly {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kIoBufferBytes = 4u << 20;
+constexpr auto kFlushInterval = std::chrono::milliseconds(20);
+constexpr size_t kEarlyFlushBytes = 1u << 20;
+const std::string kUnrouted = "_unrouted";
+
+int64_t wall_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// First "asset_id":"..." in the frame - every market-channel message we
+// route on carries one, and both tokens of a market share a slug
+std::string_view first_asset_id(std::string_view frame) {
+    size_t key = frame.find("\"asset_id\"");
+    if (key == std::string_view::npos) return {};
+    size_t open = frame.find('"', key + 10);
+    if (open == std::string_view::npos) return {};
+    size_t close = frame.find('"', open + 1);
+    if (close == std::string_view::npos) return {};
+    return frame.substr(open + 1, close - open - 1);
+}
+
+std::string segment_name(const std::string& slug, uint32_t seq) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), ".%06u.cap", seq);
+    return slug + buf;
+}
+
+// "btc-updown-15m-1700000000.000012.cap" -> 12
+bool parse_segment_seq(const std::string& filename, uint32_t& seq) {
+    if (filename.size() < 11 || filename.compare(filename.size() - 4, 4, ".cap") != 0) return false;
+    size_t dot = filename.rfind('.', filename.size() - 5);
+    if (dot == std::string::npos) return false;
+    try {
+        seq = static_cast<uint32_t>(std::stoul(filename.substr(dot + 1, filename.size() - 5 - dot)));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// ============ FrameRecorder ============
+
+FrameRecorder::FrameRecorder(std::string dir, size_t segment_bytes, size_t max_buffered_bytes)
+    : dir_(std::move(dir))
+    , segment_bytes_(segment_bytes)
+    , max_buffered_bytes_(max_buffered_bytes) {
+}
+
+FrameRecorder::~FrameRecorder() {
+    stop();
+}
+
+void FrameRecorder::start() {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    if (running_) return;
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) std::cerr << "[CAPTURE] ✗ Cannot create " << dir_ << ": " << ec.message() << std::endl;
+    running_ = true;
+    writer_ = std::thread(&FrameRecorder::writer_loop, this);
+    std::cout << "[CAPTURE] Recording raw frames to " << dir_ << std::endl;
+}
+
+void FrameRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (writer_.joinable()) writer_.join();
+    for (auto& [slug, segment] : segments_) {
+        if (segment.file) std::fclose(segment.file);
+        segment.file = nullptr;
+    }
+    segments_.clear();
+    auto s = stats();
+    std::cout << "[CAPTURE] Stopped: " << s.frames << " frames, " << s.bytes << " bytes, "
+              << s.dropped << " dropped" << std::endl;
+}
+
+void FrameRecorder::add_market(const MarketInfo& market) {
+    {
+        std::lock_guard<std::mutex> lock(tokens_mutex_);
+        slug_by_token_[market.up_token] = market.slug;
+        slug_by_token_[market.down_token] = market.slug;
+    }
+    nlohmann::json meta = {
+        {"slug", market.slug},
+        {"question", market.question},
+        {"up_token", market.up_token},
+        {"down_token", market.down_token}
+    };
+    append(market.slug, CaptureKind::MARKET, meta.dump(), latency::now_ns());
+}
+
+void FrameRecorder::record(std::string_view frame, uint64_t mono_ns) {
+    std::string_view token = first_asset_id(frame);
+    std::string slug;
+    if (!token.empty()) {
+        std::lock_guard<std::mutex> lock(tokens_mutex_);
+        auto it = slug_by_token_.find(std::string(token));
+        if (it != slug_by_token_.end()) slug = it->second;
+    }
+    append(slug.empty() ? kUnrouted : slug, CaptureKind::FRAME, frame, mono_ns);
+}
+
+void FrameRecorder::append(std::string_view slug, CaptureKind kind, std::string_view payload, uint64_t mono_ns) {
+    CaptureRecordHeader header{
+        static_cast<uint32_t>(payload.size()),
+        static_cast<uint16_t>(kind),
+        0,
+        mono_ns,
+        wall_now_ns()
+    };
+    uint16_t slug_len = static_cast<uint16_t>(std::min<size_t>(slug.size(), 0xFFFF));
+    size_t need = sizeof(slug_len) + slug_len + sizeof(header) + payload.size();
+
+    bool flush_early = false;
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex_);
+        if (!running_ || batch_.size() + need > max_buffered_bytes_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t at = batch_.size();
+        batch_.resize(at + need);
+        char* out = batch_.data() + at;
+        std::memcpy(out, &slug_len, sizeof(slug_len));
+        out += sizeof(slug_len);
+        std::memcpy(out, slug.data(), slug_len);
+        out += slug_len;
+        std::memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        std::memcpy(out, payload.data(), payload.size());
+        flush_early = batch_.size() >= kEarlyFlushBytes;
+    }
+    if (kind == CaptureKind::FRAME) frames_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(sizeof(header) + payload.size(), std::memory_order_relaxed);
+    if (flush_early) cv_.notify_one();
+}
+
+void FrameRecorder::writer_loop() {
+    std::vector<char> batch;
+    batch.reserve(kEarlyFlushBytes * 2);
+    while (true) {
+        bool keep_going;
+        {
+            std::unique_lock<std::mutex> lock(batch_mutex_);
+            cv_.wait_for(lock, kFlushInterval, [this] { return !running_ || batch_.size() >= kEarlyFlushBytes; });
+            batch.swap(batch_);
+            keep_going = running_;
+        }
+        if (!batch.empty()) write_batch(batch);
+        batch.clear();
+        if (!keep_going) {
+            // Anything appended between the swap and running_ going false
+            std::lock_guard<std::mutex> lock(batch_mutex_);
+            if (batch_.empty()) return;
+        }
+    }
+}
+
+void FrameRecorder::write_batch(const std::vector<char>& batch) {
+    const char* p = batch.data();
+    const char* end = p + batch.size();
+    std::string slug;
+    while (p < end) {
+        uint16_t slug_len;
+        std::memcpy(&slug_len, p, sizeof(slug_len));
+        p += sizeof(slug_len);
+        slug.assign(p, slug_len);
+        p += slug_len;
+        CaptureRecordHeader header;
+        std::memcpy(&header, p, sizeof(header));
+        size_t record_bytes = sizeof(header) + header.length;
+
+        Segment& segment = segment_for(slug);
+        if (segment.file) {
+            std::fwrite(p, 1, record_bytes, segment.file);
+            segment.bytes += record_bytes;
+        }
+        p += record_bytes;
+    }
+    for (auto& [name, segment] : segments_) {
+        if (segment.file) std::fflush(segment.file);
+    }
+}
+
+FrameRecorder::Segment& FrameRecorder::segment_for(const std::string& slug) {
+    auto it = segments_.find(slug);
+    if (it == segments_.end()) {
+        it = segments_.emplace(slug, Segment{}).first;
+        // Append-only: continue after whatever an earlier run left behind
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(fs::path(dir_) / slug, ec)) {
+            uint32_t seq;
+            if (parse_segment_seq(entry.path().filename().string(), seq)) {
+                it->second.seq = std::max(it->second.seq, seq);
+            }
+        }
+        open_segment(slug, it->second);
+    } else if (it->second.file && it->second.bytes >= segment_bytes_) {
+        std::fclose(it->second.file);
+        it->second.file = nullptr;
+        open_segment(slug, it->second);
+    }
+    return it->second;
+}
+
+bool FrameRecorder::open_segment(const std::string& slug, Segment& segment) {
+    fs::path slug_dir = fs::path(dir_) / slug;
+    std::error_code ec;
+    fs::create_directories(slug_dir, ec);
+
+    segment.seq++;
+    fs::path path = slug_dir / segment_name(slug, segment.seq);
+    segment.file = std::fopen(path.c_str(), "wb");
+    if (!segment.file) {
+        std::cerr << "[CAPTURE] ✗ Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    segment.io_buffer.resize(kIoBufferBytes);
+    std::setvbuf(segment.file, segment.io_buffer.data(), _IOFBF, segment.io_buffer.size());
+    std::fwrite(kCaptureMagic, 1, sizeof(kCaptureMagic), segment.file);
+    segment.bytes = sizeof(kCaptureMagic);
+    segment_count_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+FrameRecorder::Stats FrameRecorder::stats() const {
+    Stats s;
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.bytes = bytes_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.segments = segment_count_.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool parse_market_record(std::string_view payload, MarketInfo& out) {
+    try {
+        auto j = nlohmann::json::parse(payload);
+        out.slug = j.value("slug", "");
+        out.question = j.value("question", "");
+        out.up_token = j.value("up_token", "");
+        out.down_token = j.value("down_token", "");
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+    return !out.slug.empty();
+}
+
+// ============ CaptureReader ============
+
+struct CaptureReader::Mapping {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    ~Mapping() {
+        if (data) munmap(const_cast<char*>(data), size);
+    }
+};
+
+// One slug's segments, in sequence order, with the next record pre-read
+struct CaptureReader::Stream {
+    std::string slug;
+    std::vector<std::string> paths;
+    size_t next_path = 0;
+    std::unique_ptr<Mapping> mapping;
+    size_t offset = 0;
+    bool has_record = false;
+    CaptureRecord record;
+};
+
+CaptureReader::CaptureReader() = default;
+CaptureReader::~CaptureReader() = default;
+
+bool CaptureReader::open(const std::string& path, std::string& error) {
+    streams_.clear();
+    last_ = nullptr;
+
+    std::error_code ec;
+    std::vector<fs::path> files;
+    if (fs::is_regular_file(path, ec)) {
+        files.push_back(path);
+    } else if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+            uint32_t seq;
+            if (entry.is_regular_file() && parse_segment_seq(entry.path().filename().string(), seq)) {
+                files.push_back(entry.path());
+            }
+        }
+    } else {
+        error = "No such capture: " + path;
+        return false;
+    }
+
+    // Group by slug (the segment's directory), each in sequence order
+    std::unordered_map<std::string, std::vector<std::pair<uint32_t, std::string>>> by_slug;
+    for (const auto& file : files) {
+        uint32_t seq = 0;
+        parse_segment_seq(file.filename().string(), seq);
+        by_slug[file.parent_path().filename().string()].emplace_back(seq, file.string());
+    }
+    for (auto& [slug, segs] : by_slug) {
+        std::sort(segs.begin(), segs.end());
+        auto stream = std::make_unique<Stream>();
+        stream->slug = slug;
+        for (auto& seg : segs) stream->paths.push_back(std::move(seg.second));
+        streams_.push_back(std::move(stream));
+    }
+    if (streams_.empty()) {
+        error = "No capture segments under " + path;
+        return false;
+    }
+    for (auto& stream : streams_) peek(*stream);
+    return true;
+}
+
+size_t CaptureReader::segment_count() const {
+    size_t n = 0;
+    for (const auto& stream : streams_) n += stream->paths.size();
+    return n;
+}
+
+bool CaptureReader::peek(Stream& stream) {
+    stream.has_record = false;
+    while (true) {
+        if (stream.mapping) {
+            const Mapping& m = *stream.mapping;
+            if (stream.offset + sizeof(CaptureRecordHeader) <= m.size) {
+                CaptureRecordHeader header;
+                std::memcpy(&header, m.data + stream.offset, sizeof(header));
+                size_t payload_at = stream.offset + sizeof(header);
+                // A torn record at the tail (crash mid-write) ends the segment
+                if (payload_at + header.length <= m.size) {
+                    stream.record.slug = stream.slug;
+                    stream.record.kind = static_cast<CaptureKind>(header.kind);
+                    stream.record.mono_ns = header.mono_ns;
+                    stream.record.wall_ns = header.wall_ns;
+                    stream.record.payload = std::string_view(m.data + payload_at, header.length);
+                    stream.offset = payload_at + header.length;
+                    stream.has_record = true;
+                    return true;
+                }
+            }
+            stream.mapping.reset();
+        }
+        if (stream.next_path >= stream.paths.size()) return false;
+
+        const std::string& path = stream.paths[stream.next_path++];
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "[REPLAY] ✗ Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+            continue;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(kCaptureMagic)) {
+            ::close(fd);
+            continue;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "[REPLAY] ✗ mmap failed for " << path << ": " << std::strerror(errno) << std::endl;
+            continue;
+        }
+        madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+        auto mapping = std::make_unique<Mapping>();
+        mapping->data = static_cast<const char*>(data);
+        mapping->size = static_cast<size_t>(st.st_size);
+        if (std::memcmp(mapping->data, kCaptureMagic, sizeof(kCaptureMagic)) != 0) {
+            std::cerr << "[REPLAY] ✗ Not a capture segment: " << path << std::endl;
+            continue;
+        }
+        stream.mapping = std::move(mapping);
+        stream.offset = sizeof(kCaptureMagic);
+    }
+}
+
+bool CaptureReader::next(CaptureRecord& out) {
+    if (last_) {
+        peek(*last_);
+        last_ = nullptr;
+    }
+    // Merge slugs by receive time; a handful of streams, so a linear scan
+    Stream* earliest = nullptr;
+    for (auto& stream : streams_) {
+        if (stream->has_record && (!earliest || stream->record.mono_ns < earliest->record.mono_ns)) {
+            earliest = stream.get();
+        }
+    }
+    if (!earliest) return false;
+    out = earliest->record;
+    // Advanced on the next call, so the mapping `out` points into stays put
+    last_ = earliest;
+    return true;
+}
+
+// ============ FrameReplayer ============
+
+FrameReplayer::FrameReplayer(CaptureReader& reader, double speed)
+    : reader_(reader)
+    , speed_(speed) {
+}
+
+FrameReplayer::Result FrameReplayer::run(const std::atomic<bool>* keep_running) {
+    Result result;
+    uint64_t start_ns = latency::now_ns();
+    uint64_t first_capture_ns = 0;
+    uint64_t last_capture_ns = 0;
+
+    CaptureRecord record;
+    while (reader_.next(record)) {
+        if (keep_running && !keep_running->load(std::memory_order_relaxed)) break;
+        if (first_capture_ns == 0) first_capture_ns = record.mono_ns;
+        last_capture_ns = std::max(last_capture_ns, record.mono_ns);
+
+        if (speed_ > 0 && record.mono_ns > first_capture_ns) {
+            auto due = start_ns + static_cast<uint64_t>((record.mono_ns - first_capture_ns) / speed_);
+            uint64_t now = latency::now_ns();
+            if (due > now) std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+        }
+
+        if (record.kind == CaptureKind::MARKET) {
+            MarketInfo market;
+            if (!parse_market_record(record.payload, market)) {
+                std::cerr << "[REPLAY] Bad market record" << std::endl;
+                continue;
+            }
+            result.markets++;
+            if (market_sink_) market_sink_(market);
+        } else {
+            result.frames++;
+            if (frame_sink_) frame_sink_(record.payload, record);
+        }
+    }
+
+    result.capture_ns = last_capture_ns - first_capture_ns;
+    result.elapsed_ns = latency::now_ns() - start_ns;
+    return result;
+}
+
+} // namespace poly
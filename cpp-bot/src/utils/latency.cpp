@@ -0,0 +1,111 @@
+#include "latency.hpp"
+#include <algorithm>
+
+namespace poly {
+
+namespace latency {
+
+const char* span_name(Span span) {
+    switch (span) {
+        case Span::FRAME_TO_PARSE: return "frame_to_parse";
+        case Span::PARSE_TO_BOOK: return "parse_to_book";
+        case Span::BOOK_TO_DECISION: return "book_to_decision";
+        case Span::DECISION_TO_SUBMIT: return "decision_to_submit";
+        case Span::SUBMIT_TO_ACK: return "submit_to_ack";
+        case Span::TICK_TO_TRADE: return "tick_to_trade";
+        case Span::TICK_TO_ACK: return "tick_to_ack";
+        case Span::CONNECT_TO_BOOK: return "connect_to_book";
+        default: return "unknown";
+    }
+}
+
+TickContext& current_tick() {
+    thread_local TickContext tick;
+    return tick;
+}
+
+} // namespace latency
+
+size_t LatencyHistogram::bucket_for(uint64_t ns) {
+    if (ns < kSubBuckets) return static_cast<size_t>(ns);
+    int msb = 63 - __builtin_clzll(ns);
+    if (msb >= kMaxBits) return kBuckets - 1;
+    // Top kSubBucketBits+1 bits: the leading one selects the power of two,
+    // the rest the linear sub-bucket within it
+    int shift = msb - kSubBucketBits;
+    return static_cast<size_t>(shift + 1) * kSubBuckets + static_cast<size_t>((ns >> shift) - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::bucket_upper(size_t index) {
+    if (index < kSubBuckets) return index;
+    size_t shift = (index >> kSubBucketBits) - 1;
+    uint64_t lower = (kSubBuckets + (index & (kSubBuckets - 1))) << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    counts_[bucket_for(ns)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    // Not atomic as a whole - concurrent records may land between loads,
+    // which only skews a percentile by a sample or two
+    std::array<uint64_t, kBuckets> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        counts[i] = counts_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Snapshot s;
+    s.count = total;
+    if (total == 0) return s;
+    s.max_ns = max_ns_.load(std::memory_order_relaxed);
+    s.mean_ns = static_cast<double>(sum_ns_.load(std::memory_order_relaxed)) /
+                static_cast<double>(std::max<uint64_t>(1, total_.load(std::memory_order_relaxed)));
+
+    const double quantiles[] = {0.50, 0.90, 0.99, 0.999};
+    uint64_t* outputs[] = {&s.p50_ns, &s.p90_ns, &s.p99_ns, &s.p999_ns};
+    size_t q = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets && q < 4; ++i) {
+        seen += counts[i];
+        while (q < 4 && seen >= static_cast<uint64_t>(quantiles[q] * total + 0.5)) {
+            // Reported as the bucket's highest value, never above the true max
+            *outputs[q++] = std::min(bucket_upper(i), s.max_ns);
+        }
+    }
+    return s;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+    total_.store(0, std::memory_order_relaxed);
+    sum_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+}
+
+LatencyMonitor& LatencyMonitor::instance() {
+    static LatencyMonitor monitor;
+    return monitor;
+}
+
+std::vector<LatencyMonitor::SpanStats> LatencyMonitor::stats() const {
+    std::vector<SpanStats> out;
+    out.reserve(histograms_.size());
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        out.push_back({latency::span_name(static_cast<latency::Span>(i)), histograms_[i].snapshot()});
+    }
+    return out;
+}
+
+void LatencyMonitor::reset() {
+    for (auto& h : histograms_) h.reset();
+}
+
+} // namespace poly
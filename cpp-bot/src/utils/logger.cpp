@@ -1,7 +1,290 @@
 #include "logger.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
 
-// Logger implementation is header-only, this file exists for linking purposes
 namespace poly {
-    // Empty implementation file
+
+// Per-thread SPSC byte ring. Offsets only grow; the slot is offset & mask.
+// head/tail are published with release stores, so the background thread
+// sees whole records only.
+struct Logger::ThreadBuffer {
+    static constexpr size_t kCapacity = size_t{1} << 18;
+    static constexpr size_t kMask = kCapacity - 1;
+    static constexpr size_t kMaxRecord = kCapacity / 4;
+
+    std::unique_ptr<char[]> data{new char[kCapacity]};
+
+    // Producer
+    alignas(64) std::atomic<uint64_t> tail{0};
+    uint64_t reserved_tail = 0;  // End of the reservation commit() publishes
+    uint64_t cached_head = 0;
+
+    // Consumer
+    alignas(64) std::atomic<uint64_t> head{0};
+    std::atomic<bool> retired{false};  // Thread gone; freed once drained
+};
+
+namespace {
+
+struct ThreadHandle {
+    std::shared_ptr<Logger::ThreadBuffer> buffer;
+    ~ThreadHandle();
+};
+
+thread_local ThreadHandle t_handle;
+thread_local Logger::ThreadBuffer* t_buffer = nullptr;
+
+ThreadHandle::~ThreadHandle() {
+    if (buffer) buffer->retired.store(true, std::memory_order_release);
+    t_buffer = nullptr;
+}
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO:  return "INFO ";
+        case LogLevel::WARN:  return "WARN ";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::FATAL: return "FATAL";
+        default:              return "     ";
+    }
+}
+
+} // namespace
+
+namespace log {
+
+char* reserve(size_t size) {
+    using Buffer = Logger::ThreadBuffer;
+    Buffer* b = t_buffer ? t_buffer : &Logger::instance().thread_buffer();
+
+    if (size > Buffer::kMaxRecord) {
+        Logger::instance().count_drop();
+        return nullptr;
+    }
+
+    uint64_t tail = b->tail.load(std::memory_order_relaxed);
+    size_t pos = tail & Buffer::kMask;
+    size_t contiguous = Buffer::kCapacity - pos;
+    // A record never straddles the end: skip the remainder if it won't fit
+    size_t need = size <= contiguous ? size : contiguous + size;
+    if (Buffer::kCapacity - (tail - b->cached_head) < need) {
+        b->cached_head = b->head.load(std::memory_order_acquire);
+        if (Buffer::kCapacity - (tail - b->cached_head) < need) {
+            Logger::instance().count_drop();
+            return nullptr;
+        }
+    }
+    if (size > contiguous) {
+        uint32_t wrap = 0;  // Records are 8-aligned, so the marker always fits
+        std::memcpy(b->data.get() + pos, &wrap, sizeof(wrap));
+        tail += contiguous;
+        pos = 0;
+    }
+    b->reserved_tail = tail + size;
+    return b->data.get() + pos;
+}
+
+void commit() {
+    t_buffer->tail.store(t_buffer->reserved_tail, std::memory_order_release);
+}
+
+int64_t wall_now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+template <typename T>
+static void append_integer(std::string& out, T value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr - buf);
+}
+
+void append_value(std::string& out, int64_t value, std::string_view) { append_integer(out, value); }
+void append_value(std::string& out, uint64_t value, std::string_view) { append_integer(out, value); }
+void append_value(std::string& out, bool value, std::string_view) { out.append(value ? "true" : "false"); }
+void append_value(std::string& out, char value, std::string_view) { out.push_back(value); }
+
+void append_value(std::string& out, double value, std::string_view spec) {
+    char buf[64];
+    int n;
+    if (!spec.empty() && spec.back() == 'f') {
+        // ".Nf" (or plain "f" for the printf default of 6)
+        int precision = 6;
+        if (spec.size() > 2 && spec.front() == '.') {
+            std::from_chars(spec.data() + 1, spec.data() + spec.size() - 1, precision);
+        }
+        n = std::snprintf(buf, sizeof(buf), "%.*f", precision, value);
+    } else {
+        n = std::snprintf(buf, sizeof(buf), "%g", value);  // What std::cout would print
+    }
+    if (n > 0) out.append(buf, std::min<size_t>(n, sizeof(buf) - 1));
+}
+
+bool next_placeholder(std::string_view& fmt, std::string& out, std::string_view& spec) {
+    size_t open = fmt.find('{');
+    size_t close = open == std::string_view::npos ? open : fmt.find('}', open);
+    if (close == std::string_view::npos) {
+        out.append(fmt);
+        fmt = {};
+        return false;
+    }
+    out.append(fmt.substr(0, open));
+    spec = fmt.substr(open + 1, close - open - 1);
+    if (!spec.empty() && spec.front() == ':') spec.remove_prefix(1);
+    fmt.remove_prefix(close + 1);
+    return true;
+}
+
+} // namespace log
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : thread_([this] { run(); }) {}
+
+Logger::~Logger() {
+    stop();
+    if (file_) std::fclose(file_);
+}
+
+Logger::ThreadBuffer& Logger::thread_buffer() {
+    if (!t_handle.buffer) {
+        t_handle.buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.push_back(t_handle.buffer);
+    }
+    t_buffer = t_handle.buffer.get();
+    return *t_buffer;
+}
+
+void Logger::set_file(const std::string& path) {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    if (file_) std::fclose(file_);
+    file_ = path.empty() ? nullptr : std::fopen(path.c_str(), "a");
+    if (!path.empty() && !file_) std::cerr << "[LOG] Cannot open " << path << std::endl;
+}
+
+void Logger::flush() {
+    drain();
+}
+
+void Logger::stop() {
+    if (running_.exchange(false) && thread_.joinable()) thread_.join();
+    drain();
+}
+
+void Logger::run() {
+    while (running_.load(std::memory_order_relaxed)) {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers = buffers_;
+    }
+
+    struct Line {
+        int64_t wall_ns;
+        LogLevel level;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<Line> lines;
+    std::string text;
+
+    time_t prefix_second = -1;
+    char date[32] = {};
+
+    for (auto& b : buffers) {
+        uint64_t head = b->head.load(std::memory_order_relaxed);
+        uint64_t tail = b->tail.load(std::memory_order_acquire);
+        while (head < tail) {
+            const char* p = b->data.get() + (head & ThreadBuffer::kMask);
+            uint32_t size;
+            std::memcpy(&size, p, sizeof(size));
+            if (size == 0) {
+                head += ThreadBuffer::kCapacity - (head & ThreadBuffer::kMask);
+                continue;
+            }
+            log::RecordHeader header;
+            std::memcpy(&header, p, sizeof(header));
+
+            time_t second = static_cast<time_t>(header.wall_ns / 1000000000LL);
+            if (second != prefix_second) {
+                std::tm tm_buf;
+                localtime_r(&second, &tm_buf);
+                std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &tm_buf);
+                prefix_second = second;
+            }
+            char prefix[96];
+            int n = std::snprintf(prefix, sizeof(prefix), "%s.%06d %s [%s] ", date,
+                                  static_cast<int>(header.wall_ns % 1000000000LL / 1000),
+                                  level_name(header.site->level), header.site->tag);
+
+            Line line{header.wall_ns, header.site->level, text.size(), 0};
+            text.append(prefix, std::min<size_t>(n, sizeof(prefix) - 1));
+            header.format(header.site->fmt, p + sizeof(header), text);
+            text.push_back('\n');
+            line.end = text.size();
+            lines.push_back(line);
+
+            head += size;
+        }
+        b->head.store(head, std::memory_order_release);
+    }
+
+    if (!lines.empty()) {
+        // Each thread's records are already in order; interleave by time
+        std::stable_sort(lines.begin(), lines.end(),
+                         [](const Line& a, const Line& b) { return a.wall_ns < b.wall_ns; });
+
+        std::string out;
+        std::string err;
+        std::string all;
+        bool console = console_.load(std::memory_order_relaxed);
+        for (const auto& line : lines) {
+            std::string_view s(text.data() + line.begin, line.end - line.begin);
+            if (console) (line.level >= LogLevel::WARN ? err : out).append(s);
+            if (file_) all.append(s);
+        }
+        if (!out.empty()) {
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            std::fflush(stdout);
+        }
+        if (!err.empty()) {
+            std::fwrite(err.data(), 1, err.size(), stderr);
+            std::fflush(stderr);
+        }
+        if (!all.empty()) {
+            std::fwrite(all.data(), 1, all.size(), file_);
+            std::fflush(file_);
+        }
+    }
+
+    // Buffers of finished threads go once drained
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                  [](const std::shared_ptr<ThreadBuffer>& b) {
+                                      return b->retired.load(std::memory_order_acquire) &&
+                                             b->head.load(std::memory_order_relaxed) ==
+                                                 b->tail.load(std::memory_order_acquire);
+                                  }),
+                   buffers_.end());
 }
 
+} // namespace poly
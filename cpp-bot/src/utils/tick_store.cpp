@@ -0,0 +1,616 @@
+#include "tick_store.hpp"
+#include "logger.hpp"
+#include <nlohmann/json.hpp>
+#include <zlib.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace poly {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::string kTickSuffix = ".ticks";
+const std::string kEquityName = "_equity";
+constexpr int64_t kIdleCloseMs = 60000;  // Retired markets' files are closed after this
+constexpr int kMaxWriteFailures = 3;     // In a row, before a file is given up on
+
+// Column layouts. Book: ts, side, last trade, then price / size pairs for
+// the bid levels and then the ask levels. Equity: ts and four amounts.
+constexpr size_t kBookColumns = 3 + 4 * kTickDepth;
+constexpr size_t kEquityColumns = 5;
+constexpr size_t kBidColumn = 3;
+constexpr size_t kAskColumn = 3 + 2 * kTickDepth;
+
+int64_t wall_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) return false;
+        uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Row-major values -> column-major zigzag deltas. Differences wrap in
+// uint64, so any pair of int64s round-trips.
+void encode_columns(const std::vector<int64_t>& rows, size_t columns, std::vector<uint8_t>& out) {
+    out.clear();
+    const size_t count = rows.size() / columns;
+    for (size_t c = 0; c < columns; ++c) {
+        uint64_t prev = 0;
+        for (size_t r = 0; r < count; ++r) {
+            uint64_t v = static_cast<uint64_t>(rows[r * columns + c]);
+            uint64_t d = v - prev;
+            put_varint(out, (d << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(d) >> 63));
+            prev = v;
+        }
+    }
+}
+
+bool decode_columns(const uint8_t* p, size_t bytes, size_t rows, size_t columns, std::vector<int64_t>& out) {
+    const uint8_t* end = p + bytes;
+    out.resize(rows * columns);
+    for (size_t c = 0; c < columns; ++c) {
+        uint64_t prev = 0;
+        for (size_t r = 0; r < rows; ++r) {
+            uint64_t z;
+            if (!get_varint(p, end, z)) return false;
+            prev += (z >> 1) ^ (~(z & 1) + 1);
+            out[c * rows + r] = static_cast<int64_t>(prev);
+        }
+    }
+    return p == end;
+}
+
+// End of the last whole block, or 0 if the file isn't a tick file
+size_t valid_length(std::FILE* file, size_t size) {
+    char magic[sizeof(kTickMagic)];
+    uint32_t meta_len = 0;
+    if (size < sizeof(magic) + sizeof(meta_len) || std::fseek(file, 0, SEEK_SET) != 0 ||
+        std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+        std::memcmp(magic, kTickMagic, sizeof(magic)) != 0 ||
+        std::fread(&meta_len, sizeof(meta_len), 1, file) != 1) {
+        return 0;
+    }
+    size_t at = sizeof(magic) + sizeof(meta_len) + meta_len;
+    if (at > size) return 0;
+    while (at + sizeof(TickBlockHeader) <= size) {
+        TickBlockHeader header;
+        if (std::fseek(file, static_cast<long>(at), SEEK_SET) != 0 ||
+            std::fread(&header, sizeof(header), 1, file) != 1) {
+            break;
+        }
+        if (at + sizeof(header) + header.stored_bytes > size) break;
+        at += sizeof(header) + header.stored_bytes;
+    }
+    return at;
+}
+
+} // namespace
+
+std::string tick_file_path(const std::string& dir, const std::string& slug) {
+    return (fs::path(dir) / (slug + kTickSuffix)).string();
+}
+
+std::vector<std::string> list_tick_files(const std::string& dir) {
+    std::vector<std::string> slugs;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.size() > kTickSuffix.size() &&
+            name.compare(name.size() - kTickSuffix.size(), kTickSuffix.size(), kTickSuffix) == 0) {
+            slugs.push_back(name.substr(0, name.size() - kTickSuffix.size()));
+        }
+    }
+    std::sort(slugs.begin(), slugs.end());
+    return slugs;
+}
+
+// ============ TickRecorder ============
+
+struct TickRecorder::File {
+    std::FILE* fp = nullptr;
+    std::string path;
+    size_t columns = 0;
+    int write_failures = 0;        // In a row
+    std::vector<int64_t> pending;  // Row-major, not yet written
+    int64_t first_pending_ms = 0;
+    int64_t touched_ms = 0;        // Last row added
+
+    // What the last rows recorded, to skip unchanged samples
+    bool sampled = false;
+    uint64_t version = 0;
+    uint64_t up_trade = 0;
+    uint64_t down_trade = 0;
+    EquityRow equity;
+
+    size_t pending_rows() const { return pending.size() / columns; }
+
+    ~File() {
+        if (fp) std::fclose(fp);
+    }
+};
+
+TickRecorder::TickRecorder(std::string dir, Options options)
+    : dir_(std::move(dir))
+    , options_(options) {
+}
+
+TickRecorder::~TickRecorder() {
+    stop();
+}
+
+void TickRecorder::start() {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    if (running_) return;
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) POLY_LOG_ERROR("TICKS", "Cannot create {}: {}", dir_, ec.message());
+    running_ = true;
+    thread_ = std::thread(&TickRecorder::run, this);
+    POLY_LOG_INFO("TICKS", "Recording ticks to {} every {}ms", dir_, options_.interval_ms);
+}
+
+void TickRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(run_mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    auto s = stats();
+    POLY_LOG_INFO("TICKS", "Stopped: {} rows in {} blocks, {} bytes stored ({} encoded)",
+                  s.rows, s.blocks, s.stored_bytes, s.raw_bytes);
+}
+
+void TickRecorder::record_trade(TokenId token, Price price) {
+    if (token == kNoToken || !price.positive()) return;
+    std::lock_guard<std::mutex> lock(trades_mutex_);
+    LastTrade& trade = trades_[token];
+    trade.price = price;
+    trade.seq++;
+}
+
+void TickRecorder::run() {
+    const auto interval = std::chrono::milliseconds(std::max(1, options_.interval_ms));
+    std::unique_lock<std::mutex> lock(run_mutex_);
+    while (running_) {
+        cv_.wait_for(lock, interval, [this] { return !running_; });
+        lock.unlock();
+        const int64_t now_ms = wall_now_ms();
+        sample(now_ms);
+        flush(now_ms, false);
+        lock.lock();
+    }
+    lock.unlock();
+    flush(wall_now_ms(), true);
+    files_.clear();
+    open_files_ = 0;
+}
+
+void TickRecorder::sample(int64_t now_ms) {
+    if (book_source_) {
+        samples_.clear();
+        book_source_(samples_);
+
+        // Last trades first, under one lock - the file opens below may hit the disk
+        std::vector<uint64_t> trade_seqs(samples_.size() * 2, 0);
+        {
+            std::lock_guard<std::mutex> lock(trades_mutex_);
+            for (size_t i = 0; i < samples_.size(); ++i) {
+                BookSample& s = samples_[i];
+                auto up = trades_.find(s.up_token);
+                if (up != trades_.end()) {
+                    s.up.last_trade = up->second.price;
+                    trade_seqs[2 * i] = up->second.seq;
+                }
+                auto down = trades_.find(s.down_token);
+                if (down != trades_.end()) {
+                    s.down.last_trade = down->second.price;
+                    trade_seqs[2 * i + 1] = down->second.seq;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < samples_.size(); ++i) {
+            const BookSample& s = samples_[i];
+            File* file = file_for(s.slug, true, &s);
+            if (!file) continue;
+            const bool book_moved = !file->sampled || s.version != file->version;
+            const bool up_traded = trade_seqs[2 * i] != file->up_trade;
+            const bool down_traded = trade_seqs[2 * i + 1] != file->down_trade;
+            for (const TickRow* row : {&s.up, &s.down}) {
+                if (!book_moved && !(row == &s.up ? up_traded : down_traded)) continue;
+                auto& out = file->pending;
+                out.push_back(now_ms);
+                out.push_back(row->side == Side::UP ? 0 : 1);
+                out.push_back(row->last_trade.micros());
+                for (const auto* levels : {&row->bids, &row->asks}) {
+                    for (const BookLevel& level : *levels) {
+                        out.push_back(level.price.micros());
+                        out.push_back(level.size.micros());
+                    }
+                }
+                if (file->pending_rows() == 1) file->first_pending_ms = now_ms;
+                file->touched_ms = now_ms;
+                rows_.fetch_add(1, std::memory_order_relaxed);
+            }
+            file->sampled = true;
+            file->version = s.version;
+            file->up_trade = trade_seqs[2 * i];
+            file->down_trade = trade_seqs[2 * i + 1];
+        }
+    }
+
+    EquityRow equity;
+    if (equity_source_ && equity_source_(equity)) {
+        File* file = file_for(kEquityName, false, nullptr);
+        const EquityRow& last = file ? file->equity : equity;
+        if (file && (!file->sampled || equity.equity != last.equity || equity.cash != last.cash ||
+                     equity.unrealized != last.unrealized || equity.realized != last.realized)) {
+            for (int64_t v : {now_ms, equity.equity.micros(), equity.cash.micros(), equity.unrealized.micros(),
+                              equity.realized.micros()}) {
+                file->pending.push_back(v);
+            }
+            if (file->pending_rows() == 1) file->first_pending_ms = now_ms;
+            file->touched_ms = now_ms;
+            file->sampled = true;
+            file->equity = equity;
+            rows_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TickRecorder::flush(int64_t now_ms, bool all) {
+    for (auto it = files_.begin(); it != files_.end();) {
+        if (!it->second) {
+            ++it;  // Unusable file - remembered so it isn't retried every sample
+            continue;
+        }
+        File& file = *it->second;
+        const size_t rows = file.pending_rows();
+        if (rows > 0 && (all || rows >= options_.block_rows || now_ms - file.first_pending_ms >= options_.flush_ms)) {
+            if (!write_block(file) && (!file.fp || file.write_failures >= kMaxWriteFailures)) {
+                POLY_LOG_ERROR("TICKS", "Giving up on {} ({} rows dropped)", file.path, file.pending_rows());
+                it->second.reset();  // Unusable from here on, like a file that never opened
+                ++it;
+                continue;
+            }
+        }
+        if (file.pending.empty() && now_ms - file.touched_ms >= kIdleCloseMs) {
+            it = files_.erase(it);
+            open_files_ = files_.size();
+        } else {
+            ++it;
+        }
+    }
+}
+
+TickRecorder::File* TickRecorder::file_for(const std::string& name, bool book, const BookSample* market) {
+    auto it = files_.find(name);
+    if (it != files_.end()) return it->second.get();
+
+    const std::string path = tick_file_path(dir_, name);
+    std::FILE* fp = std::fopen(path.c_str(), "r+b");
+    if (fp) {
+        // Continue after an earlier run's last whole block
+        std::error_code ec;
+        const size_t size = static_cast<size_t>(fs::file_size(path, ec));
+        const size_t keep = valid_length(fp, size);
+        if (keep == 0 && size > 0) {
+            POLY_LOG_ERROR("TICKS", "Not a tick file, not recording: {}", path);
+            std::fclose(fp);
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            files_.emplace(name, nullptr);
+            return nullptr;
+        }
+        if (keep < size) {
+            POLY_LOG_WARN("TICKS", "Dropping {} torn bytes at the end of {}", size - keep, path);
+            fs::resize_file(path, keep, ec);
+        }
+        if (keep == 0) {
+            std::fclose(fp);
+            fp = nullptr;
+        } else {
+            std::fseek(fp, 0, SEEK_END);
+        }
+    }
+    if (!fp) {
+        fp = std::fopen(path.c_str(), "wb");
+        if (!fp) {
+            POLY_LOG_ERROR("TICKS", "Cannot open {}: {}", path, std::strerror(errno));
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            files_.emplace(name, nullptr);
+            return nullptr;
+        }
+        nlohmann::json meta = {
+            {"slug", name},
+            {"kind", book ? "book" : "equity"},
+            {"columns", book ? kBookColumns : kEquityColumns},
+            {"depth", kTickDepth}
+        };
+        if (market) {
+            meta["up_token"] = market->up_token_id;
+            meta["down_token"] = market->down_token_id;
+        }
+        const std::string text = meta.dump();
+        const uint32_t meta_len = static_cast<uint32_t>(text.size());
+        std::fwrite(kTickMagic, 1, sizeof(kTickMagic), fp);
+        std::fwrite(&meta_len, sizeof(meta_len), 1, fp);
+        std::fwrite(text.data(), 1, text.size(), fp);
+        std::fflush(fp);
+    }
+
+    auto file = std::make_unique<File>();
+    file->fp = fp;
+    file->path = path;
+    file->columns = book ? kBookColumns : kEquityColumns;
+    File* out = file.get();
+    files_[name] = std::move(file);
+    open_files_ = files_.size();
+    return out;
+}
+
+bool TickRecorder::write_block(File& file) {
+    const size_t rows = file.pending_rows();
+    encode_columns(file.pending, file.columns, raw_);
+
+    TickBlockHeader header{};
+    header.rows = static_cast<uint32_t>(rows);
+    header.columns = static_cast<uint16_t>(file.columns);
+    header.raw_bytes = static_cast<uint32_t>(raw_.size());
+    header.first_ms = file.pending.front();
+    header.last_ms = file.pending[(rows - 1) * file.columns];
+
+    packed_.resize(compressBound(static_cast<uLong>(raw_.size())));
+    uLongf packed_len = static_cast<uLongf>(packed_.size());
+    const uint8_t* payload = raw_.data();
+    header.stored_bytes = header.raw_bytes;
+    if (compress2(packed_.data(), &packed_len, raw_.data(), static_cast<uLong>(raw_.size()),
+                  Z_DEFAULT_COMPRESSION) == Z_OK && packed_len < raw_.size()) {
+        payload = packed_.data();
+        header.stored_bytes = static_cast<uint32_t>(packed_len);
+        header.flags = kTickBlockDeflated;
+    }
+
+    // The block goes in whole or not at all: readers walk the headers in
+    // order, so a torn one would hide every block after it
+    const long offset = std::ftell(file.fp);
+    bool ok = offset >= 0 &&
+              std::fwrite(&header, sizeof(header), 1, file.fp) == 1 &&
+              std::fwrite(payload, 1, header.stored_bytes, file.fp) == header.stored_bytes &&
+              std::fflush(file.fp) == 0;
+    if (!ok) {
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        file.write_failures++;
+        POLY_LOG_WARN("TICKS", "Block write to {} failed ({}), rows kept for a retry", file.path,
+                      std::strerror(errno));
+        // Whatever stdio still buffers goes with the handle; cut the file
+        // back to the last whole block and carry on from there
+        std::fclose(file.fp);
+        file.fp = nullptr;
+        std::error_code ec;
+        if (offset >= 0) fs::resize_file(file.path, static_cast<uintmax_t>(offset), ec);
+        if (offset >= 0 && !ec) {
+            file.fp = std::fopen(file.path.c_str(), "r+b");
+            if (file.fp) std::fseek(file.fp, 0, SEEK_END);
+        }
+        return false;
+    }
+    file.pending.clear();
+    file.write_failures = 0;
+    blocks_.fetch_add(1, std::memory_order_relaxed);
+    raw_bytes_.fetch_add(header.raw_bytes, std::memory_order_relaxed);
+    stored_bytes_.fetch_add(header.stored_bytes, std::memory_order_relaxed);
+    return true;
+}
+
+TickRecorder::Stats TickRecorder::stats() const {
+    Stats s;
+    s.rows = rows_.load(std::memory_order_relaxed);
+    s.blocks = blocks_.load(std::memory_order_relaxed);
+    s.raw_bytes = raw_bytes_.load(std::memory_order_relaxed);
+    s.stored_bytes = stored_bytes_.load(std::memory_order_relaxed);
+    s.write_errors = write_errors_.load(std::memory_order_relaxed);
+    s.open_files = open_files_.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ============ TickReader ============
+
+struct TickReader::Mapping {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    ~Mapping() {
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+    }
+};
+
+TickReader::TickReader() = default;
+TickReader::~TickReader() = default;
+
+bool TickReader::open(const std::string& path, std::string& error) {
+    mapping_.reset();
+    blocks_.clear();
+    info_ = Info{};
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(kTickMagic) + sizeof(uint32_t)) {
+        ::close(fd);
+        error = "Not a tick file: " + path;
+        return false;
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        error = "mmap failed for " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    mapping_ = std::make_unique<Mapping>();
+    mapping_->data = static_cast<const uint8_t*>(data);
+    mapping_->size = static_cast<size_t>(st.st_size);
+    const uint8_t* base = mapping_->data;
+    const size_t size = mapping_->size;
+
+    uint32_t meta_len;
+    std::memcpy(&meta_len, base + sizeof(kTickMagic), sizeof(meta_len));
+    size_t at = sizeof(kTickMagic) + sizeof(meta_len);
+    if (std::memcmp(base, kTickMagic, sizeof(kTickMagic)) != 0 || at + meta_len > size) {
+        error = "Not a tick file: " + path;
+        return false;
+    }
+    try {
+        auto meta = nlohmann::json::parse(base + at, base + at + meta_len);
+        info_.slug = meta.value("slug", "");
+        info_.kind = meta.value("kind", "book") == "equity" ? Kind::EQUITY : Kind::BOOK;
+        info_.up_token_id = meta.value("up_token", "");
+        info_.down_token_id = meta.value("down_token", "");
+        info_.columns = meta.value("columns", size_t{0});
+    } catch (const nlohmann::json::exception& e) {
+        error = "Bad tick file header in " + path + ": " + e.what();
+        return false;
+    }
+    const size_t expected = info_.kind == Kind::EQUITY ? kEquityColumns : kBookColumns;
+    if (info_.columns != expected) {
+        error = "Unsupported tick layout in " + path;
+        return false;
+    }
+    at += meta_len;
+
+    // Index the whole blocks; a torn one ends the file
+    while (at + sizeof(TickBlockHeader) <= size) {
+        Block block;
+        std::memcpy(&block.header, base + at, sizeof(TickBlockHeader));
+        at += sizeof(TickBlockHeader);
+        if (at + block.header.stored_bytes > size) break;
+        block.payload = base + at;
+        at += block.header.stored_bytes;
+        if (block.header.columns != info_.columns || block.header.rows == 0) continue;
+        if (blocks_.empty()) info_.first_ms = block.header.first_ms;
+        info_.last_ms = block.header.last_ms;
+        info_.rows += block.header.rows;
+        blocks_.push_back(block);
+    }
+    info_.blocks = blocks_.size();
+    info_.file_bytes = size;
+    return true;
+}
+
+bool TickReader::scan(int64_t from_ms, int64_t to_ms, size_t limit, const RowFilter& filter,
+                      const RowFn& sink) const {
+    auto picked = [&](const int64_t* columns, size_t rows, size_t r) {
+        return columns[r] >= from_ms && columns[r] <= to_ms && (!filter || filter(columns, rows, r));
+    };
+    // Newest block first, so a limited query stops once it has enough
+    std::vector<std::vector<int64_t>> decoded;
+    std::vector<uint8_t> inflated;
+    size_t matched = 0;
+    for (size_t i = blocks_.size(); i-- > 0;) {
+        const Block& block = blocks_[i];
+        const TickBlockHeader& h = block.header;
+        if (h.first_ms > to_ms || h.last_ms < from_ms) continue;
+
+        const uint8_t* raw = block.payload;
+        if (h.flags & kTickBlockDeflated) {
+            inflated.resize(h.raw_bytes);
+            uLongf len = h.raw_bytes;
+            if (uncompress(inflated.data(), &len, block.payload, h.stored_bytes) != Z_OK || len != h.raw_bytes) {
+                return false;
+            }
+            raw = inflated.data();
+        } else if (h.stored_bytes != h.raw_bytes) {
+            return false;
+        }
+        decoded.emplace_back();
+        if (!decode_columns(raw, h.raw_bytes, h.rows, h.columns, decoded.back())) return false;
+        const int64_t* columns = decoded.back().data();
+        for (size_t r = 0; r < h.rows; ++r) {
+            if (picked(columns, h.rows, r)) ++matched;
+        }
+        if (limit > 0 && matched >= limit) break;
+    }
+
+    size_t skip = limit > 0 && matched > limit ? matched - limit : 0;
+    for (auto it = decoded.rbegin(); it != decoded.rend(); ++it) {
+        const size_t rows = it->size() / info_.columns;
+        const int64_t* columns = it->data();
+        for (size_t r = 0; r < rows; ++r) {
+            if (!picked(columns, rows, r)) continue;
+            if (skip > 0) {
+                --skip;
+                continue;
+            }
+            sink(columns, rows, r);
+        }
+    }
+    return true;
+}
+
+bool TickReader::read_book(int64_t from_ms, int64_t to_ms, std::vector<TickRow>& out, size_t limit,
+                           std::optional<Side> side) const {
+    if (!mapping_ || info_.kind != Kind::BOOK) return false;
+    RowFilter filter;
+    if (side) {
+        const int64_t want = *side == Side::UP ? 0 : 1;
+        filter = [want](const int64_t* columns, size_t rows, size_t r) { return columns[rows + r] == want; };
+    }
+    return scan(from_ms, to_ms, limit, filter, [&out](const int64_t* columns, size_t rows, size_t r) {
+        auto at = [&](size_t c) { return columns[c * rows + r]; };
+        TickRow row;
+        row.ts_ms = at(0);
+        row.side = at(1) == 0 ? Side::UP : Side::DOWN;
+        row.last_trade = Price::from_micros(at(2));
+        for (size_t k = 0; k < kTickDepth; ++k) {
+            row.bids[k].price = Price::from_micros(at(kBidColumn + 2 * k));
+            row.bids[k].size = Qty::from_micros(at(kBidColumn + 2 * k + 1));
+            row.asks[k].price = Price::from_micros(at(kAskColumn + 2 * k));
+            row.asks[k].size = Qty::from_micros(at(kAskColumn + 2 * k + 1));
+        }
+        out.push_back(row);
+    });
+}
+
+bool TickReader::read_equity(int64_t from_ms, int64_t to_ms, std::vector<EquityRow>& out, size_t limit) const {
+    if (!mapping_ || info_.kind != Kind::EQUITY) return false;
+    return scan(from_ms, to_ms, limit, nullptr, [&out](const int64_t* columns, size_t rows, size_t r) {
+        auto at = [&](size_t c) { return columns[c * rows + r]; };
+        EquityRow row;
+        row.ts_ms = at(0);
+        row.equity = Price::from_micros(at(1));
+        row.cash = Price::from_micros(at(2));
+        row.unrealized = Price::from_micros(at(3));
+        row.realized = Price::from_micros(at(4));
+        out.push_back(row);
+    });
+}
+
+} // namespace poly
@@ -0,0 +1,95 @@
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+
+namespace poly {
+
+namespace {
+    // Which pool and worker the current thread is, for submits from a task
+    thread_local const WorkStealingPool* tls_pool = nullptr;
+    thread_local size_t tls_worker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < threads; ++i) threads_.emplace_back(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    size_t target = tls_pool == this ? tls_worker
+                                     : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    work_cv_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+bool WorkStealingPool::take(size_t self, Task& out) {
+    {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        Queue& victim = *queues_[(self + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(size_t self) {
+    tls_pool = this;
+    tls_worker = self;
+    while (true) {
+        Task task;
+        if (take(self, task)) {
+            task();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) idle_cv_.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        // Re-check under the lock: a submit bumps pending_ before queueing,
+        // so if work is outstanding we only nap briefly and look again
+        if (pending_ == 0) {
+            work_cv_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+        } else {
+            work_cv_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+}
+
+} // namespace poly
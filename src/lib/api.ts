@@ -69,8 +69,11 @@ export async function getEquity(limit = 1000) {
   return fetchApi<{ success: boolean; data: any[] }>(`/api/equity?limit=${limit}`);
 }
 
-export async function getLogs(limit = 100) {
-  return fetchApi<{ success: boolean; data: any[] }>(`/api/logs?limit=${limit}`);
+// Pass the previous response's seq as since to get only newer lines
+export async function getLogs(limit = 100, since = 0) {
+  return fetchApi<{ success: boolean; data: any[]; seq?: number; missed?: number }>(
+    `/api/logs?limit=${limit}&since=${since}`
+  );
 }
 
 export async function getConfig() {